@@ -25,6 +25,7 @@
 #include "k3bversion.h"
 #include "k3bthreadwidget.h"
 #include "k3bglobalsettings.h"
+#include "k3bjobtelemetry.h"
 #include "k3bpluginmanager.h"
 #include "k3b_i18n.h"
 
@@ -35,6 +36,7 @@
 #endif
 
 #include <QCoreApplication>
+#include <QDebug>
 #include <QEvent>
 #include <QMutex>
 #include <QMutexLocker>
@@ -97,7 +99,8 @@ public:
           deviceManager(0),
           externalBinManager(0),
           pluginManager(0),
-          globalSettings(0) {
+          globalSettings(0),
+          jobTelemetry(0) {
     }
 
     K3b::Version version;
@@ -106,6 +109,7 @@ public:
     K3b::ExternalBinManager* externalBinManager;
     K3b::PluginManager* pluginManager;
     K3b::GlobalSettings* globalSettings;
+    K3b::JobTelemetry* jobTelemetry;
 
     QList<K3b::Job*> runningJobs;
     QList<K3b::Device::Device*> blockedDevices;
@@ -196,6 +200,15 @@ K3b::GlobalSettings* K3b::Core::globalSettings() const
 }
 
 
+K3b::JobTelemetry* K3b::Core::jobTelemetry() const
+{
+    if( !d->jobTelemetry ) {
+        d->jobTelemetry = new JobTelemetry( const_cast<Core*>( this ) );
+    }
+    return d->jobTelemetry;
+}
+
+
 K3b::Version K3b::Core::version() const
 {
     return d->version;
@@ -208,7 +221,7 @@ void K3b::Core::init()
     // they might add external bins
     pluginManager()->loadAll();
 
-    externalBinManager()->search();
+    externalBinManager()->startSearch();
 
     deviceManager()->scanBus();
 
@@ -225,6 +238,12 @@ K3b::Device::DeviceManager* K3b::Core::createDeviceManager() const
 void K3b::Core::readSettings( KSharedConfig::Ptr c )
 {
     globalSettings()->readSettings( c->group( "General Options" ) );
+
+    QString telemetryTarget = QString::fromLocal8Bit( qgetenv( "K3B_TELEMETRY" ) );
+    if( telemetryTarget.isEmpty() )
+        telemetryTarget = globalSettings()->telemetryTarget();
+    if( !jobTelemetry()->setTarget( telemetryTarget ) )
+        qDebug() << "(K3b::Core) unable to open telemetry target" << telemetryTarget;
     deviceManager()->readConfig( c->group( "Devices" ) );
     externalBinManager()->readConfig( c->group( "External Programs" ) );
 }
@@ -40,6 +40,7 @@ namespace K3b {
     class GlobalSettings;
     class PluginManager;
     class MediaCache;
+    class JobTelemetry;
 
     namespace Device {
         class DeviceManager;
@@ -104,6 +105,13 @@ namespace K3b {
          */
         GlobalSettings* globalSettings() const;
 
+        /**
+         * The telemetry recorder all jobs report to. Disabled unless a target
+         * is configured in the settings or with the K3B_TELEMETRY environment
+         * variable.
+         */
+        JobTelemetry* jobTelemetry() const;
+
         /**
          * returns the version of the library as defined by LIBK3B_VERSION
          */
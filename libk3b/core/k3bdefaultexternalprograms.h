@@ -106,6 +106,9 @@ namespace K3b {
     protected:
         QString versionIdentifier( const ExternalBin& bin ) const override;
         bool scanFeatures( ExternalBin& bin ) const override;
+
+        // the features depend on the installed modules
+        bool cacheScanResults() const override { return false; }
     };
 
 
@@ -19,10 +19,19 @@
 #include <KConfigGroup>
 #include <KProcess>
 
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
 #include <QtGlobal>
 #include <QRegExp>
 
@@ -41,6 +50,200 @@ namespace {
     }
 
     const int EXECUTE_TIMEOUT = 5000; // in seconds
+
+    // most of the time is spent waiting for the programs
+    const int s_maxSearchThreads = 8;
+
+    const quint32 s_probeCacheMagic = 0x4B334250; // "K3BP"
+    const quint16 s_probeCacheVersion = 1;
+
+
+    /**
+     * Identifies one version of a program file. The mode is part of it
+     * since changing the suid bit does not change the modification time.
+     */
+    struct FileIdentity
+    {
+        FileIdentity()
+            : device( 0 ), inode( 0 ), size( 0 ), mtime( 0 ), mode( 0 ), uid( 0 ) {
+        }
+
+        bool operator==( const FileIdentity& other ) const {
+            return( device == other.device &&
+                    inode == other.inode &&
+                    size == other.size &&
+                    mtime == other.mtime &&
+                    mode == other.mode &&
+                    uid == other.uid );
+        }
+
+        quint64 device;
+        quint64 inode;
+        qint64 size;
+        qint64 mtime;
+        quint32 mode;
+        quint32 uid;
+    };
+
+
+    bool fileIdentity( const QString& path, FileIdentity& id )
+    {
+#ifndef Q_OS_WIN32
+        struct stat s;
+        if( ::stat( QFile::encodeName( path ), &s ) )
+            return false;
+        id.device = s.st_dev;
+        id.inode = s.st_ino;
+        id.size = s.st_size;
+        id.mtime = s.st_mtime;
+        id.mode = s.st_mode;
+        id.uid = s.st_uid;
+#else
+        QFileInfo fi( path );
+        if( !fi.exists() )
+            return false;
+        id.size = fi.size();
+        id.mtime = fi.lastModified().toMSecsSinceEpoch();
+#endif
+        return true;
+    }
+
+
+    QDataStream& operator<<( QDataStream& s, const FileIdentity& id )
+    {
+        return s << id.device << id.inode << id.size << id.mtime << id.mode << id.uid;
+    }
+
+
+    QDataStream& operator>>( QDataStream& s, FileIdentity& id )
+    {
+        return s >> id.device >> id.inode >> id.size >> id.mtime >> id.mode >> id.uid;
+    }
+
+
+    /**
+     * The results of probing programs. Unchanged programs are not
+     * executed again, not even across K3b sessions.
+     */
+    class ProbeCache
+    {
+    public:
+        ProbeCache()
+            : m_loaded( false ),
+              m_dirty( false ) {
+        }
+
+        bool restore( K3b::ExternalBin& bin ) {
+            FileIdentity id;
+            if( !fileIdentity( bin.path(), id ) )
+                return false;
+
+            QMutexLocker locker( &m_mutex );
+            load();
+            QHash<QString, Entry>::const_iterator it = m_entries.constFind( key( bin ) );
+            if( it == m_entries.constEnd() || !( it->id == id ) )
+                return false;
+
+            bin.setNeedGroup( QString( "" ) );
+            bin.setVersion( K3b::Version( it->version ) );
+            bin.setCopyright( it->copyright );
+            Q_FOREACH( const QString& feature, it->features ) {
+                bin.addFeature( feature );
+            }
+            return bin.version().isValid();
+        }
+
+        void store( const K3b::ExternalBin& bin ) {
+            Entry entry;
+            if( !fileIdentity( bin.path(), entry.id ) )
+                return;
+            entry.version = bin.version().toString();
+            entry.copyright = bin.copyright();
+            entry.features = bin.features();
+
+            QMutexLocker locker( &m_mutex );
+            load();
+            m_entries.insert( key( bin ), entry );
+            m_dirty = true;
+        }
+
+        void save() {
+            QMutexLocker locker( &m_mutex );
+            if( !m_dirty )
+                return;
+
+            const QString dir = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+            if( dir.isEmpty() || !QDir().mkpath( dir ) )
+                return;
+
+            QSaveFile f( fileName() );
+            if( !f.open( QIODevice::WriteOnly ) )
+                return;
+
+            QDataStream s( &f );
+            s << s_probeCacheMagic << s_probeCacheVersion << quint32( m_entries.count() );
+            for( QHash<QString, Entry>::const_iterator it = m_entries.constBegin(); it != m_entries.constEnd(); ++it ) {
+                s << it.key() << it->id << it->version << it->copyright << it->features;
+            }
+
+            if( s.status() == QDataStream::Ok && f.commit() )
+                m_dirty = false;
+            else
+                qDebug() << "(K3b::ExternalBinManager) could not write" << fileName();
+        }
+
+    private:
+        struct Entry {
+            FileIdentity id;
+            QString version;
+            QString copyright;
+            QStringList features;
+        };
+
+        static QString key( const K3b::ExternalBin& bin ) {
+            return bin.name() + QLatin1Char( '\n' ) + bin.path();
+        }
+
+        static QString fileName() {
+            return QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + QLatin1String( "/externalprograms" );
+        }
+
+        void load() {
+            if( m_loaded )
+                return;
+            m_loaded = true;
+
+            QFile f( fileName() );
+            if( !f.open( QIODevice::ReadOnly ) )
+                return;
+
+            QDataStream s( &f );
+            quint32 magic = 0;
+            quint16 version = 0;
+            quint32 count = 0;
+            s >> magic >> version >> count;
+            if( magic != s_probeCacheMagic || version != s_probeCacheVersion )
+                return;
+
+            for( quint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i ) {
+                QString key;
+                Entry entry;
+                s >> key >> entry.id >> entry.version >> entry.copyright >> entry.features;
+                if( s.status() == QDataStream::Ok )
+                    m_entries.insert( key, entry );
+            }
+        }
+
+        QMutex m_mutex;
+        bool m_loaded;
+        bool m_dirty;
+        QHash<QString, Entry> m_entries;
+    };
+
+    Q_GLOBAL_STATIC( ProbeCache, s_probeCache )
+
+    // getgrgid() is not reentrant
+    Q_GLOBAL_STATIC( QMutex, s_groupMutex )
 }
 
 
@@ -347,11 +550,21 @@ bool K3b::SimpleExternalProgram::scan( const QString& p )
     if ( QFile::exists( path ) ) {
         K3b::ExternalBin* bin = new ExternalBin( *this, path );
 
+        // unchanged programs are not executed again
+        if( cacheScanResults() && s_probeCache()->restore( *bin ) ) {
+            addBin( bin );
+            return true;
+        }
+
         if ( ( !scanVersion( *bin ) || !scanFeatures( *bin ) ) && bin->needGroup().isEmpty() )  {
             delete bin;
             return false;
         }
 
+        // a missing group membership may be fixed without changing the program
+        if( cacheScanResults() && bin->needGroup().isEmpty() )
+            s_probeCache()->store( *bin );
+
         addBin( bin );
         return true;
     }
@@ -361,6 +574,12 @@ bool K3b::SimpleExternalProgram::scan( const QString& p )
 }
 
 
+bool K3b::SimpleExternalProgram::cacheScanResults() const
+{
+    return true;
+}
+
+
 bool K3b::SimpleExternalProgram::scanVersion( ExternalBin& bin ) const
 {
     // probe version
@@ -374,6 +593,7 @@ bool K3b::SimpleExternalProgram::scanVersion( ExternalBin& bin ) const
             // K3b::SystemProblemDialog::checkSystem work
             struct stat st;
             if( !::stat( QFile::encodeName(bin.path()), &st ) ) {
+                QMutexLocker locker( s_groupMutex() );
                 QString group( getgrgid( st.st_gid )->gr_name );
                 qDebug() << "Should be member of \"" << group << "\"";
                 bin.setNeedGroup( group.isEmpty() ? "N/A" : group );
@@ -480,15 +700,119 @@ QString K3b::SimpleExternalProgram::versionIdentifier( const ExternalBin& /*bin*
 class K3b::ExternalBinManager::Private
 {
 public:
+    Private()
+        : searched( false ),
+          searchMutex( QMutex::Recursive ) {
+    }
+
+    class SearchThread;
+
+    /**
+     * The settings read by readConfig() which can only be
+     * applied once the search has finished.
+     */
+    struct ProgramSettings {
+        QString defaultBin;
+        QStringList userParameters;
+        Version lastMax;
+    };
+
+    void waitForSearch();
+    void applySettings();
+
     QMap<QString, ExternalProgram*> programs;
     QStringList searchPath;
 
     static QString noPath;  // used for binPath() to return const string
 
     QString gatheredOutput;
+
+    // the search path used for the last search
+    QStringList searchedPaths;
+    bool searched;
+
+    // state of a running search, guarded by searchMutex since the
+    // accessors may be called from other threads during the search
+    QMutex searchMutex;
+    QList<SearchThread*> searchThreads;
+    QList<ExternalProgram*> searchPrograms;
+    QAtomicInt nextSearchProgram;
+
+    QHash<QString, ProgramSettings> pendingSettings;
 };
 
 
+/**
+ * Every program is scanned by one thread. Thus, the programs do not
+ * need to be thread-safe but can be scanned concurrently.
+ */
+class K3b::ExternalBinManager::Private::SearchThread : public QThread
+{
+public:
+    explicit SearchThread( ExternalBinManager::Private* d )
+        : m_d( d ) {
+    }
+
+protected:
+    void run() override {
+        int i = 0;
+        while( ( i = m_d->nextSearchProgram.fetchAndAddOrdered( 1 ) ) < m_d->searchPrograms.count() ) {
+            ExternalProgram* program = m_d->searchPrograms.at( i );
+            Q_FOREACH( const QString& path, m_d->searchedPaths ) {
+                program->scan( path );
+            }
+        }
+    }
+
+private:
+    ExternalBinManager::Private* m_d;
+};
+
+
+void K3b::ExternalBinManager::Private::waitForSearch()
+{
+    QMutexLocker locker( &searchMutex );
+    if( searchThreads.isEmpty() )
+        return;
+
+    Q_FOREACH( SearchThread* thread, searchThreads ) {
+        thread->wait();
+    }
+    qDeleteAll( searchThreads );
+    searchThreads.clear();
+    searchPrograms.clear();
+
+    s_probeCache()->save();
+
+    applySettings();
+}
+
+
+void K3b::ExternalBinManager::Private::applySettings()
+{
+    for( QHash<QString, ProgramSettings>::const_iterator it = pendingSettings.constBegin();
+         it != pendingSettings.constEnd(); ++it ) {
+        ExternalProgram* p = programs.value( it.key() );
+        if( !p )
+            continue;
+
+        if( !it->defaultBin.isEmpty() ) {
+            p->setDefault( it->defaultBin );
+        }
+
+        for( QStringList::const_iterator strIt = it->userParameters.constBegin(); strIt != it->userParameters.constEnd(); ++strIt )
+            p->addUserParameter( *strIt );
+
+        // now search for a newer version and use it (because it was installed after the last
+        // K3b run and most users would probably expect K3b to use a newly installed version)
+        const K3b::ExternalBin* newestBin = p->mostRecentBin();
+        if( newestBin && newestBin->version() > it->lastMax )
+            p->setDefault( newestBin );
+    }
+    pendingSettings.clear();
+}
+
+
 QString K3b::ExternalBinManager::Private::noPath = "";
 
 
@@ -501,6 +825,7 @@ K3b::ExternalBinManager::ExternalBinManager( QObject* parent )
 
 K3b::ExternalBinManager::~ExternalBinManager()
 {
+    d->waitForSearch();
     clear();
     delete d;
 }
@@ -508,37 +833,37 @@ K3b::ExternalBinManager::~ExternalBinManager()
 
 bool K3b::ExternalBinManager::readConfig( const KConfigGroup& grp )
 {
+    // a running search only uses its own copy of the search path
     loadDefaultSearchPath();
 
     if( grp.hasKey( "search path" ) ) {
         setSearchPath( grp.readPathEntry( QString( "search path" ), QStringList() ) );
     }
 
-    search();
-
+    // the settings are applied once the programs have been found
+    QMutexLocker locker( &d->searchMutex );
     Q_FOREACH( K3b::ExternalProgram* p, d->programs ) {
-        if( grp.hasKey( p->name() + " default" ) ) {
-            p->setDefault( grp.readEntry( p->name() + " default", QString() ) );
-        }
-
-        QStringList list = grp.readEntry( p->name() + " user parameters", QStringList() );
-        for( QStringList::const_iterator strIt = list.constBegin(); strIt != list.constEnd(); ++strIt )
-            p->addUserParameter( *strIt );
-
-        K3b::Version lastMax( grp.readEntry( p->name() + " last seen newest version", QString() ) );
-        // now search for a newer version and use it (because it was installed after the last
-        // K3b run and most users would probably expect K3b to use a newly installed version)
-        const K3b::ExternalBin* newestBin = p->mostRecentBin();
-        if( newestBin && newestBin->version() > lastMax )
-            p->setDefault( newestBin );
+        Private::ProgramSettings settings;
+        settings.defaultBin = grp.readEntry( p->name() + " default", QString() );
+        settings.userParameters = grp.readEntry( p->name() + " user parameters", QStringList() );
+        settings.lastMax = K3b::Version( grp.readEntry( p->name() + " last seen newest version", QString() ) );
+        d->pendingSettings.insert( p->name(), settings );
     }
 
+    // there is no need to search again if the search path did not change
+    if( !d->searched || d->searchedPaths != searchPaths() )
+        startSearch();
+    else if( d->searchThreads.isEmpty() )
+        d->applySettings();
+
     return true;
 }
 
 
 bool K3b::ExternalBinManager::saveConfig( KConfigGroup grp )
 {
+    d->waitForSearch();
+
     grp.writePathEntry( "search path", d->searchPath );
 
     Q_FOREACH( K3b::ExternalProgram* p, d->programs ) {
@@ -558,6 +883,8 @@ bool K3b::ExternalBinManager::saveConfig( KConfigGroup grp )
 
 bool K3b::ExternalBinManager::foundBin( const QString& name )
 {
+    d->waitForSearch();
+
     if( d->programs.constFind( name ) == d->programs.constEnd() )
         return false;
     else
@@ -567,6 +894,8 @@ bool K3b::ExternalBinManager::foundBin( const QString& name )
 
 QString K3b::ExternalBinManager::binPath( const QString& name )
 {
+    d->waitForSearch();
+
     if( d->programs.constFind( name ) == d->programs.constEnd() )
         return Private::noPath;
 
@@ -579,6 +908,8 @@ QString K3b::ExternalBinManager::binPath( const QString& name )
 
 const K3b::ExternalBin* K3b::ExternalBinManager::binObject( const QString& name )
 {
+    d->waitForSearch();
+
     if( d->programs.constFind( name ) == d->programs.constEnd() )
         return 0;
 
@@ -588,6 +919,8 @@ const K3b::ExternalBin* K3b::ExternalBinManager::binObject( const QString& name
 
 QString K3b::ExternalBinManager::binNeedGroup( const QString& name )
 {
+    d->waitForSearch();
+
     if( d->programs.constFind( name ) == d->programs.constEnd() )
         return QString();
 
@@ -600,12 +933,14 @@ QString K3b::ExternalBinManager::binNeedGroup( const QString& name )
 
 void K3b::ExternalBinManager::addProgram( K3b::ExternalProgram* p )
 {
+    d->waitForSearch();
     d->programs.insert( p->name(), p );
 }
 
 
 void K3b::ExternalBinManager::clear()
 {
+    d->waitForSearch();
     qDeleteAll( d->programs );
     d->programs.clear();
 }
@@ -613,6 +948,21 @@ void K3b::ExternalBinManager::clear()
 
 void K3b::ExternalBinManager::search()
 {
+    startSearch();
+    d->waitForSearch();
+}
+
+
+void K3b::ExternalBinManager::startSearch()
+{
+    QMutexLocker locker( &d->searchMutex );
+
+    // the settings read by readConfig() belong to the new search
+    QHash<QString, Private::ProgramSettings> settings;
+    settings.swap( d->pendingSettings );
+    d->waitForSearch();
+    d->pendingSettings.swap( settings );
+
     if( d->searchPath.isEmpty() )
         loadDefaultSearchPath();
 
@@ -620,6 +970,22 @@ void K3b::ExternalBinManager::search()
         program->clear();
     }
 
+    d->searched = true;
+    d->searchedPaths = searchPaths();
+    d->searchPrograms = d->programs.values();
+    d->nextSearchProgram = 0;
+
+    const int threads = qMin( d->searchPrograms.count(), s_maxSearchThreads );
+    for( int i = 0; i < threads; ++i ) {
+        Private::SearchThread* thread = new Private::SearchThread( d );
+        d->searchThreads.append( thread );
+        thread->start();
+    }
+}
+
+
+QStringList K3b::ExternalBinManager::searchPaths() const
+{
     // do not search one path twice
     QStringList paths;
 #ifdef Q_OS_WIN
@@ -638,16 +1004,14 @@ void K3b::ExternalBinManager::search()
             paths.append(p);
     }
 
-    Q_FOREACH( const QString& path, paths ) {
-        Q_FOREACH( K3b::ExternalProgram* program, d->programs ) {
-            program->scan( path );
-        }
-    }
+    return paths;
 }
 
 
 K3b::ExternalProgram* K3b::ExternalBinManager::program( const QString& name ) const
 {
+    d->waitForSearch();
+
     if( d->programs.constFind( name ) == d->programs.constEnd() )
         return 0;
     else
@@ -657,6 +1021,7 @@ K3b::ExternalProgram* K3b::ExternalBinManager::program( const QString& name ) co
 
 QMap<QString, K3b::ExternalProgram*> K3b::ExternalBinManager::programs() const
 {
+    d->waitForSearch();
     return d->programs;
 }
 
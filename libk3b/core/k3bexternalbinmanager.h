@@ -152,6 +152,14 @@ namespace K3b {
          */
         virtual bool scanVersion( ExternalBin& bin ) const;
 
+        /**
+         * The results of scanVersion() and scanFeatures() are cached as long as
+         * the program file does not change. Programs whose features also depend
+         * on other files need to return false here. The default implementation
+         * returns true.
+         */
+        virtual bool cacheScanResults() const;
+
         /**
          * Scan for features. The default implementation checks for suidroot and
          * calls the program with parameter --help and then calls parseFeatures.
@@ -198,8 +206,23 @@ namespace K3b {
         explicit ExternalBinManager( QObject* parent = 0 );
         ~ExternalBinManager() override;
 
+        /**
+         * Searches for all programs and blocks until they have been found.
+         */
         void search();
 
+        /**
+         * Starts searching for all programs in the background. The
+         * programs are probed by several threads in parallel. Programs
+         * which did not change since the last run of K3b are not
+         * executed again but their cached versions and features are used.
+         *
+         * All methods which access the programs wait for the search to finish.
+         * They may be called from any thread while the search is running. The
+         * search itself has to be started from the thread of the manager.
+         */
+        void startSearch();
+
         /**
          * read config and add changes to current map.
          * Takes care of setting the config group
@@ -231,6 +254,8 @@ namespace K3b {
         void clear();
 
     private:
+        QStringList searchPaths() const;
+
         class Private;
         Private* const d;
     };
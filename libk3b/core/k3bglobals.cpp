@@ -60,6 +60,10 @@
 #include <windows.h>
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 qint16 K3b::swapByteOrder( const qint16& i )
 {
@@ -81,6 +85,24 @@ qint64 K3b::swapByteOrder( const qint64& i )
 }
 
 
+void K3b::swapByteOrder16( char* data, qint64 len )
+{
+    qint64 i = 0;
+#ifdef __SSE2__
+    for( ; i + 16 <= len; i += 16 ) {
+        __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + i ) );
+        v = _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( data + i ), v );
+    }
+#endif
+    for( ; i + 1 < len; i += 2 ) {
+        const char b = data[i];
+        data[i] = data[i+1];
+        data[i+1] = b;
+    }
+}
+
+
 QString K3b::findUniqueFilePrefix( const QString& _prefix, const QString& path )
 {
     QString url;
@@ -130,6 +130,12 @@ namespace K3b {
     LIBK3B_EXPORT qint32 swapByteOrder( const qint32& i );
     LIBK3B_EXPORT qint64 swapByteOrder( const qint64& i );
 
+    /**
+     * Swaps the byte order of all 16 bit samples in \p data in place.
+     * Uses SSE2 where available. A trailing odd byte is left untouched.
+     */
+    LIBK3B_EXPORT void swapByteOrder16( char* data, qint64 len );
+
     /**
      * This checks the free space on the filesystem path is in.
      * We use this since we encountered problems with the KDE version.
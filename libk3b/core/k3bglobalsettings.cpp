@@ -25,6 +25,7 @@ K3b::GlobalSettings::GlobalSettings()
       m_overburn(false),
       m_useManualBufferSize(false),
       m_bufferSize(4),
+      m_pipeBufferSize(64),
       m_force(false)
 {
 }
@@ -42,7 +43,9 @@ void K3b::GlobalSettings::readSettings( const KConfigGroup& c )
     m_overburn = c.readEntry( "Allow overburning", false );
     m_useManualBufferSize = c.readEntry( "Manual buffer size", false );
     m_bufferSize = c.readEntry( "Fifo buffer", 4 );
+    m_pipeBufferSize = c.readEntry( "Pipe buffer", 64 );
     m_force = c.readEntry( "Force unsafe operations", false );
+    m_telemetryTarget = c.readEntry( "Telemetry target", QString() );
 	m_defaultTempPath = c.readPathEntry("Temp Dir",
             QStandardPaths::writableLocation(QStandardPaths::MoviesLocation));
     QFileInfo checkPath(m_defaultTempPath);
@@ -60,6 +63,8 @@ void K3b::GlobalSettings::saveSettings( KConfigGroup c )
     c.writeEntry( "Allow overburning", m_overburn );
     c.writeEntry( "Manual buffer size", m_useManualBufferSize );
     c.writeEntry( "Fifo buffer", m_bufferSize );
+    c.writeEntry( "Pipe buffer", m_pipeBufferSize );
     c.writeEntry( "Force unsafe operations", m_force );
     c.writeEntry( "Temp Dir", m_defaultTempPath );
+    c.writeEntry( "Telemetry target", m_telemetryTarget );
 }
@@ -47,6 +47,12 @@ namespace K3b {
         bool useManualBufferSize() const { return m_useManualBufferSize; }
         int bufferSize() const { return m_bufferSize; }
 
+        /**
+         * Size in MB of the FIFO K3b puts between the image creation
+         * and the writing application. 0 disables the FIFO.
+         */
+        int pipeBufferSize() const { return m_pipeBufferSize; }
+
         /**
          * If force is set to true K3b will continue in certain "unsafe" situations.
          * The most common being a medium not suitable for the writer in terms of
@@ -60,13 +66,21 @@ namespace K3b {
          */
         QString defaultTempPath() const { return m_defaultTempPath; }
 
+        /**
+         * Where to write the job telemetry to. Empty if disabled.
+         * \see JobTelemetry::setTarget
+         */
+        QString telemetryTarget() const { return m_telemetryTarget; }
+
         void setEjectMedia( bool b ) { m_eject = b; }
         void setBurnfree( bool b ) { m_burnfree = b; }
         void setOverburn( bool b ) { m_overburn = b; }
         void setUseManualBufferSize( bool b ) { m_useManualBufferSize = b; }
         void setBufferSize( int size ) { m_bufferSize = size; }
+        void setPipeBufferSize( int size ) { m_pipeBufferSize = size; }
         void setForce( bool b ) { m_force = b; }
         void setDefaultTempPath( const QString& s ) { m_defaultTempPath = s; }
+        void setTelemetryTarget( const QString& s ) { m_telemetryTarget = s; }
 
     private:
         // FIXME: d-pointer
@@ -75,8 +89,10 @@ namespace K3b {
         bool m_overburn;
         bool m_useManualBufferSize;
         int m_bufferSize;
+        int m_pipeBufferSize;
         bool m_force;
         QString m_defaultTempPath;
+        QString m_telemetryTarget;
     };
 }
 
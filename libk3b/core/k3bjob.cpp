@@ -16,6 +16,7 @@
 #include "k3bjob.h"
 #include "k3bglobals.h"
 #include "k3bcore.h"
+#include "k3bjobtelemetry.h"
 #include "k3b_i18n.h"
 
 #include <QDebug>
@@ -107,6 +108,9 @@ void K3b::Job::jobStarted()
     else
         k3bcore->registerJob( this );
 
+    if( k3bcore->jobTelemetry()->isEnabled() )
+        k3bcore->jobTelemetry()->attach( this );
+
     emit started();
 }
 
@@ -128,6 +132,14 @@ void K3b::Job::jobFinished( bool success )
 }
 
 
+void K3b::Job::reportTelemetry( const QString& event, const QVariantMap& data )
+{
+    JobTelemetry* telemetry = k3bcore->jobTelemetry();
+    if( telemetry->isEnabled() )
+        telemetry->record( this, event, data );
+}
+
+
 void K3b::Job::slotCanceled()
 {
     d->canceled = true;
@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QVariantMap>
 
 namespace K3b {
     namespace Device {
@@ -211,6 +212,14 @@ namespace K3b {
         void debuggingOutput(const QString&, const QString&);
         void nextTrack( int track, int numTracks );
 
+        /**
+         * The predicted remaining time of the job in seconds, -1 if unknown.
+         * Jobs which can predict their throughput (typically using the
+         * ThroughputEstimator) emit this. Otherwise the remaining time
+         * can only be extrapolated from percent().
+         */
+        void remainingTime( int seconds );
+
         void canceled();
 
         /**
@@ -253,6 +262,15 @@ namespace K3b {
          */
         virtual void jobFinished( bool success );
 
+        /**
+         * Report an event to the job telemetry. Use this for events not
+         * covered by the signals like read retries. Does nothing if the
+         * telemetry is disabled. Thread-safe.
+         *
+         * \see JobTelemetry
+         */
+        void reportTelemetry( const QString& event, const QVariantMap& data = QVariantMap() );
+
     private Q_SLOTS:
         void slotCanceled();
         void slotNewSubTask( const QString& str );
@@ -0,0 +1,429 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bjobtelemetry.h"
+#include "k3bjob.h"
+
+#include <QAtomicPointer>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QThread>
+
+
+namespace {
+    // events which may be emitted at a high rate are limited to one per interval
+    const qint64 s_throttleInterval = 500;
+
+    // the amount of unsent data after which the socket sink drops events
+    const qint64 s_maxSocketBacklog = 1024*1024;
+
+    // msecs between two attempts to connect to the telemetry socket
+    const qint64 s_reconnectInterval = 5000;
+
+    QString messageLevel( int type )
+    {
+        switch( type ) {
+        case K3b::Job::MessageWarning:
+            return QLatin1String( "warning" );
+        case K3b::Job::MessageError:
+            return QLatin1String( "error" );
+        case K3b::Job::MessageSuccess:
+            return QLatin1String( "success" );
+        default:
+            return QLatin1String( "info" );
+        }
+    }
+}
+
+
+K3b::TelemetrySink::~TelemetrySink()
+{
+}
+
+
+class K3b::FileTelemetrySink::Private
+{
+public:
+    QFile file;
+};
+
+
+K3b::FileTelemetrySink::FileTelemetrySink( const QString& filename )
+    : d( new Private() )
+{
+    d->file.setFileName( filename );
+    if( !d->file.open( QIODevice::WriteOnly|QIODevice::Append ) )
+        qDebug() << "(K3b::FileTelemetrySink) unable to open" << filename;
+}
+
+
+K3b::FileTelemetrySink::~FileTelemetrySink()
+{
+    delete d;
+}
+
+
+bool K3b::FileTelemetrySink::isOpen() const
+{
+    return d->file.isOpen();
+}
+
+
+void K3b::FileTelemetrySink::writeEvent( const QByteArray& line )
+{
+    if( d->file.isOpen() ) {
+        d->file.write( line );
+        d->file.flush();
+    }
+}
+
+
+class K3b::SocketTelemetrySink::Private
+{
+public:
+    QString serverName;
+    QLocalSocket socket;
+    QElapsedTimer lastConnectAttempt;
+};
+
+
+K3b::SocketTelemetrySink::SocketTelemetrySink( const QString& serverName )
+    : d( new Private() )
+{
+    d->serverName = serverName;
+    d->lastConnectAttempt.start();
+    d->socket.connectToServer( serverName, QIODevice::WriteOnly );
+}
+
+
+K3b::SocketTelemetrySink::~SocketTelemetrySink()
+{
+    d->socket.abort();
+    delete d;
+}
+
+
+void K3b::SocketTelemetrySink::writeEvent( const QByteArray& line )
+{
+    if( d->socket.state() == QLocalSocket::UnconnectedState &&
+        d->lastConnectAttempt.elapsed() > s_reconnectInterval ) {
+        d->lastConnectAttempt.start();
+        d->socket.connectToServer( d->serverName, QIODevice::WriteOnly );
+    }
+
+    // never block the jobs because of a slow listener
+    if( d->socket.state() == QLocalSocket::ConnectedState &&
+        d->socket.bytesToWrite() < s_maxSocketBacklog )
+        d->socket.write( line );
+}
+
+
+class K3b::JobTelemetry::Private
+{
+public:
+    Private()
+        : nextJobId( 1 ) {
+    }
+
+    struct JobState {
+        int id;
+        int parentId;
+        QByteArray type;
+        QElapsedTimer timer;
+        QHash<QString, qint64> lastEvent;
+    };
+
+    QAtomicPointer<TelemetrySink> sink;
+    QHash<QObject*, JobState> jobs;
+    int nextJobId;
+
+    // \return false if the event should be dropped to limit the rate
+    bool throttle( JobState& state, const QString& event ) {
+        const qint64 now = state.timer.elapsed();
+        QHash<QString, qint64>::iterator it = state.lastEvent.find( event );
+        if( it != state.lastEvent.end() && now - it.value() < s_throttleInterval )
+            return false;
+        state.lastEvent[event] = now;
+        return true;
+    }
+
+    void write( const JobState& state, const QString& event, const QVariantMap& data ) {
+        TelemetrySink* s = sink.loadAcquire();
+        if( !s )
+            return;
+
+        QJsonObject obj = QJsonObject::fromVariantMap( data );
+        obj.insert( QLatin1String( "time" ), QDateTime::currentDateTimeUtc().toString( Qt::ISODateWithMs ) );
+        obj.insert( QLatin1String( "elapsed" ), state.timer.elapsed() );
+        obj.insert( QLatin1String( "job" ), state.id );
+        obj.insert( QLatin1String( "parent" ), state.parentId );
+        obj.insert( QLatin1String( "type" ), QString::fromLatin1( state.type ) );
+        obj.insert( QLatin1String( "event" ), event );
+
+        s->writeEvent( QJsonDocument( obj ).toJson( QJsonDocument::Compact ) + '\n' );
+    }
+};
+
+
+K3b::JobTelemetry::JobTelemetry( QObject* parent )
+    : QObject( parent ),
+      d( new Private() )
+{
+}
+
+
+K3b::JobTelemetry::~JobTelemetry()
+{
+    delete d->sink.fetchAndStoreOrdered( 0 );
+    delete d;
+}
+
+
+void K3b::JobTelemetry::setSink( TelemetrySink* sink )
+{
+    delete d->sink.fetchAndStoreOrdered( sink );
+}
+
+
+bool K3b::JobTelemetry::setTarget( const QString& target )
+{
+    if( target.isEmpty() ) {
+        setSink( 0 );
+        return true;
+    }
+    else if( target.startsWith( QLatin1String( "local:" ) ) ) {
+        setSink( new SocketTelemetrySink( target.mid( 6 ) ) );
+        return true;
+    }
+    else {
+        FileTelemetrySink* sink = new FileTelemetrySink( target );
+        if( !sink->isOpen() ) {
+            delete sink;
+            setSink( 0 );
+            return false;
+        }
+        setSink( sink );
+        return true;
+    }
+}
+
+
+bool K3b::JobTelemetry::isEnabled() const
+{
+    return d->sink.loadAcquire() != 0;
+}
+
+
+void K3b::JobTelemetry::attach( K3b::Job* job )
+{
+    // a job may be started several times
+    disconnect( job, 0, this, 0 );
+
+    Private::JobState state;
+    state.id = d->nextJobId++;
+    state.parentId = 0;
+    if( job->jobHandler() && job->jobHandler()->isJob() ) {
+        QHash<QObject*, Private::JobState>::const_iterator it = d->jobs.constFind( static_cast<K3b::Job*>( job->jobHandler() ) );
+        if( it != d->jobs.constEnd() )
+            state.parentId = it->id;
+    }
+    state.type = job->metaObject()->className();
+    state.timer.start();
+    d->jobs.insert( job, state );
+
+    connect( job, SIGNAL(destroyed(QObject*)), this, SLOT(slotJobDestroyed(QObject*)) );
+    connect( job, SIGNAL(finished(bool)), this, SLOT(slotFinished(bool)) );
+    connect( job, SIGNAL(infoMessage(QString,int)), this, SLOT(slotInfoMessage(QString,int)) );
+    connect( job, SIGNAL(newTask(QString)), this, SLOT(slotNewTask(QString)) );
+    connect( job, SIGNAL(newSubTask(QString)), this, SLOT(slotNewSubTask(QString)) );
+    connect( job, SIGNAL(percent(int)), this, SLOT(slotPercent(int)) );
+    connect( job, SIGNAL(subPercent(int)), this, SLOT(slotSubPercent(int)) );
+    connect( job, SIGNAL(processedSize(int,int)), this, SLOT(slotProcessedSize(int,int)) );
+    connect( job, SIGNAL(processedSubSize(int,int)), this, SLOT(slotProcessedSubSize(int,int)) );
+
+    if( qobject_cast<K3b::BurnJob*>( job ) ) {
+        connect( job, SIGNAL(bufferStatus(int)), this, SLOT(slotBuffer(int)) );
+        connect( job, SIGNAL(deviceBuffer(int)), this, SLOT(slotDeviceBuffer(int)) );
+        connect( job, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)),
+                 this, SLOT(slotWriteSpeed(int,K3b::Device::SpeedMultiplicator)) );
+        connect( job, SIGNAL(burning(bool)), this, SLOT(slotBurning(bool)) );
+    }
+
+    QVariantMap data;
+    data.insert( QLatin1String( "description" ), job->jobDescription() );
+    data.insert( QLatin1String( "details" ), job->jobDetails() );
+    data.insert( QLatin1String( "source" ), job->jobSource() );
+    data.insert( QLatin1String( "target" ), job->jobTarget() );
+    d->write( state, QLatin1String( "started" ), data );
+}
+
+
+void K3b::JobTelemetry::record( K3b::Job* job, const QString& event, const QVariantMap& data )
+{
+    if( !isEnabled() )
+        return;
+
+    if( QThread::currentThread() != thread() )
+        QMetaObject::invokeMethod( this, "slotRecord", Qt::QueuedConnection,
+                                   Q_ARG( QObject*, job ),
+                                   Q_ARG( QString, event ),
+                                   Q_ARG( QVariantMap, data ) );
+    else
+        slotRecord( job, event, data );
+}
+
+
+void K3b::JobTelemetry::slotRecord( QObject* job, const QString& event, const QVariantMap& data )
+{
+    // the job is only used as a key. It might be gone already.
+    QHash<QObject*, Private::JobState>::const_iterator it = d->jobs.constFind( job );
+    if( it != d->jobs.constEnd() )
+        d->write( *it, event, data );
+}
+
+
+void K3b::JobTelemetry::slotJobDestroyed( QObject* job )
+{
+    d->jobs.remove( job );
+}
+
+
+void K3b::JobTelemetry::slotFinished( bool success )
+{
+    K3b::Job* job = static_cast<K3b::Job*>( sender() );
+    QHash<QObject*, Private::JobState>::iterator it = d->jobs.find( job );
+    if( it == d->jobs.end() )
+        return;
+
+    QVariantMap data;
+    data.insert( QLatin1String( "success" ), success );
+    data.insert( QLatin1String( "canceled" ), job->hasBeenCanceled() );
+    d->write( *it, QLatin1String( "finished" ), data );
+
+    d->jobs.erase( it );
+    disconnect( job, 0, this, 0 );
+}
+
+
+void K3b::JobTelemetry::slotInfoMessage( const QString& text, int type )
+{
+    QVariantMap data;
+    data.insert( QLatin1String( "level" ), messageLevel( type ) );
+    data.insert( QLatin1String( "text" ), text );
+    slotRecord( sender(), QLatin1String( "message" ), data );
+}
+
+
+void K3b::JobTelemetry::slotNewTask( const QString& text )
+{
+    QVariantMap data;
+    data.insert( QLatin1String( "text" ), text );
+    slotRecord( sender(), QLatin1String( "task" ), data );
+}
+
+
+void K3b::JobTelemetry::slotNewSubTask( const QString& text )
+{
+    QVariantMap data;
+    data.insert( QLatin1String( "text" ), text );
+    slotRecord( sender(), QLatin1String( "subTask" ), data );
+}
+
+
+void K3b::JobTelemetry::slotPercent( int p )
+{
+    QVariantMap data;
+    data.insert( QLatin1String( "value" ), p );
+    slotRecord( sender(), QLatin1String( "percent" ), data );
+}
+
+
+void K3b::JobTelemetry::slotSubPercent( int p )
+{
+    QVariantMap data;
+    data.insert( QLatin1String( "value" ), p );
+    slotRecord( sender(), QLatin1String( "subPercent" ), data );
+}
+
+
+void K3b::JobTelemetry::slotProcessedSize( int processed, int size )
+{
+    QHash<QObject*, Private::JobState>::iterator it = d->jobs.find( sender() );
+    if( it != d->jobs.end() && ( processed >= size || d->throttle( *it, QLatin1String( "processedSize" ) ) ) ) {
+        QVariantMap data;
+        data.insert( QLatin1String( "processed" ), processed );
+        data.insert( QLatin1String( "size" ), size );
+        d->write( *it, QLatin1String( "processedSize" ), data );
+    }
+}
+
+
+void K3b::JobTelemetry::slotProcessedSubSize( int processed, int size )
+{
+    QHash<QObject*, Private::JobState>::iterator it = d->jobs.find( sender() );
+    if( it != d->jobs.end() && ( processed >= size || d->throttle( *it, QLatin1String( "processedSubSize" ) ) ) ) {
+        QVariantMap data;
+        data.insert( QLatin1String( "processed" ), processed );
+        data.insert( QLatin1String( "size" ), size );
+        d->write( *it, QLatin1String( "processedSubSize" ), data );
+    }
+}
+
+
+void K3b::JobTelemetry::slotBuffer( int value )
+{
+    QHash<QObject*, Private::JobState>::iterator it = d->jobs.find( sender() );
+    if( it != d->jobs.end() && d->throttle( *it, QLatin1String( "buffer" ) ) ) {
+        QVariantMap data;
+        data.insert( QLatin1String( "value" ), value );
+        d->write( *it, QLatin1String( "buffer" ), data );
+    }
+}
+
+
+void K3b::JobTelemetry::slotDeviceBuffer( int value )
+{
+    QHash<QObject*, Private::JobState>::iterator it = d->jobs.find( sender() );
+    if( it != d->jobs.end() && d->throttle( *it, QLatin1String( "deviceBuffer" ) ) ) {
+        QVariantMap data;
+        data.insert( QLatin1String( "value" ), value );
+        d->write( *it, QLatin1String( "deviceBuffer" ), data );
+    }
+}
+
+
+void K3b::JobTelemetry::slotWriteSpeed( int speed, K3b::Device::SpeedMultiplicator multiplicator )
+{
+    QHash<QObject*, Private::JobState>::iterator it = d->jobs.find( sender() );
+    if( it != d->jobs.end() && d->throttle( *it, QLatin1String( "writeSpeed" ) ) ) {
+        QVariantMap data;
+        data.insert( QLatin1String( "speed" ), speed );
+        data.insert( QLatin1String( "multiplicator" ), (int)multiplicator );
+        d->write( *it, QLatin1String( "writeSpeed" ), data );
+    }
+}
+
+
+void K3b::JobTelemetry::slotBurning( bool b )
+{
+    QVariantMap data;
+    data.insert( QLatin1String( "value" ), b );
+    slotRecord( sender(), QLatin1String( "burning" ), data );
+}
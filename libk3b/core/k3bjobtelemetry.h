@@ -0,0 +1,172 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_JOB_TELEMETRY_H_
+#define _K3B_JOB_TELEMETRY_H_
+
+#include "k3b_export.h"
+#include "k3bdevicetypes.h"
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+
+namespace K3b {
+    class Job;
+
+    /**
+     * A telemetry sink receives the telemetry events as single lines
+     * of compact JSON including the trailing newline.
+     */
+    class LIBK3B_EXPORT TelemetrySink
+    {
+    public:
+        virtual ~TelemetrySink();
+
+        /**
+         * Write one event. Always called from the GUI thread.
+         * Implementations must not block.
+         */
+        virtual void writeEvent( const QByteArray& line ) = 0;
+    };
+
+
+    /**
+     * Appends the events to a file in the JSON lines format.
+     */
+    class LIBK3B_EXPORT FileTelemetrySink : public TelemetrySink
+    {
+    public:
+        explicit FileTelemetrySink( const QString& filename );
+        ~FileTelemetrySink() override;
+
+        bool isOpen() const;
+
+        void writeEvent( const QByteArray& line ) override;
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( FileTelemetrySink )
+    };
+
+
+    /**
+     * Sends the events to a local socket, i.e. a unix domain socket.
+     * If no one is listening, the events are dropped and the connection is
+     * retried every few seconds.
+     */
+    class LIBK3B_EXPORT SocketTelemetrySink : public TelemetrySink
+    {
+    public:
+        explicit SocketTelemetrySink( const QString& serverName );
+        ~SocketTelemetrySink() override;
+
+        void writeEvent( const QByteArray& line ) override;
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( SocketTelemetrySink )
+    };
+
+
+    /**
+     * Records machine readable telemetry of the running jobs.
+     *
+     * Every job attaches itself in Job::jobStarted() if a sink has been set.
+     * Without a sink nothing is connected and the only cost is one pointer
+     * check per started job.
+     *
+     * Every event is one JSON object with the fields "time" (ISO 8601, UTC),
+     * "elapsed" (msecs since the job started), "job" (a unique id), "parent"
+     * (the id of the parent job or 0), "type" (the class name of the job) and
+     * "event". The remaining fields depend on the event:
+     *
+     * \li started: description, details, source, target
+     * \li finished: success, canceled
+     * \li task, subTask: text
+     * \li message: level, text
+     * \li percent, subPercent: value
+     * \li processedSize, processedSubSize: processed, size (MB)
+     * \li buffer, deviceBuffer: value (percent)
+     * \li writeSpeed: speed (KB/s), multiplicator
+     * \li burning: value
+     *
+     * Jobs may report additional events like read retries through
+     * Job::reportTelemetry().
+     */
+    class LIBK3B_EXPORT JobTelemetry : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit JobTelemetry( QObject* parent = 0 );
+        ~JobTelemetry() override;
+
+        /**
+         * Set the sink to write the events to. JobTelemetry takes ownership
+         * of the sink. Passing 0 disables the telemetry.
+         */
+        void setSink( TelemetrySink* sink );
+
+        /**
+         * Configure the sink from a string. An empty string disables the
+         * telemetry, "local:<name>" selects a SocketTelemetrySink,
+         * everything else is treated as the name of a JSON lines file.
+         *
+         * \return false if the sink could not be created.
+         */
+        bool setTarget( const QString& target );
+
+        bool isEnabled() const;
+
+        /**
+         * Connect the signals of @p job. Called by Job::jobStarted().
+         */
+        void attach( Job* job );
+
+        /**
+         * Record an event for @p job. Thread-safe.
+         */
+        void record( Job* job, const QString& event, const QVariantMap& data = QVariantMap() );
+
+    private Q_SLOTS:
+        void slotRecord( QObject* job, const QString& event, const QVariantMap& data );
+        void slotJobDestroyed( QObject* );
+
+        void slotFinished( bool success );
+        void slotInfoMessage( const QString& text, int type );
+        void slotNewTask( const QString& text );
+        void slotNewSubTask( const QString& text );
+        void slotPercent( int );
+        void slotSubPercent( int );
+        void slotProcessedSize( int processed, int size );
+        void slotProcessedSubSize( int processed, int size );
+        void slotBuffer( int );
+        void slotDeviceBuffer( int );
+        void slotWriteSpeed( int speed, K3b::Device::SpeedMultiplicator multiplicator );
+        void slotBurning( bool );
+
+    private:
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
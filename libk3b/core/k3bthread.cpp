@@ -15,6 +15,7 @@
 
 #include "k3bthread.h"
 #include "k3bthreadjob.h"
+#include "k3bthreadjobexecutor.h"
 #include "k3bprogressinfoevent.h"
 #include "k3bthreadjobcommunicationevent.h"
 
@@ -91,6 +92,8 @@ void K3b::Thread::waitUntilFinished()
         thread->wait();
     }
 
+    K3b::ThreadJobExecutor::instance()->waitForDone();
+
     qDebug() << "Thread waiting done." << endl;
 }
 
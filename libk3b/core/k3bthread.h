@@ -30,6 +30,9 @@ namespace K3b {
     /**
      * \warning This class is internal to ThreadJob
      *
+     * \deprecated ThreadJobs are run by ThreadJobExecutor. The class is only
+     * kept for binary compatibility and not used by K3b anymore.
+     *
      * See ThreadJob for more information.
      */
     class LIBK3B_EXPORT Thread : public QThread
@@ -44,8 +47,8 @@ namespace K3b {
         bool success() const;
 
         /**
-         * waits until all running Thread have finished.
-         * This is used by Application.
+         * waits until all running Thread have finished and the
+         * ThreadJobExecutor ran all jobs.
          */
         static void waitUntilFinished();
 
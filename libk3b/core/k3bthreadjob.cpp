@@ -13,27 +13,81 @@
  */
 
 #include "k3bthreadjob.h"
-#include "k3bthread.h"
+#include "k3bthreadjobexecutor.h"
 #include "k3bprogressinfoevent.h"
 #include "k3bthreadjobcommunicationevent.h"
 
+#include <QAtomicInt>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QSharedPointer>
-#include <QThread>
+#include <QTimer>
+#include <QVariantMap>
+
+#include <climits>
+
+
+namespace {
+    // interval in ms in which the progress of the worker is published
+    const int s_progressInterval = 100;
+
+    // marks progress values which have not been reported yet
+    const int s_unset = INT_MIN;
+
+    // processed and total size are stored in one value so they are always read together
+    inline qint64 packSize( int processed, int size )
+    {
+        return qint64( ( quint64( quint32( processed ) ) << 32 ) | quint32( size ) );
+    }
+
+    inline int unpackProcessed( qint64 packed )
+    {
+        return int( quint32( quint64( packed ) >> 32 ) );
+    }
+
+    inline int unpackSize( qint64 packed )
+    {
+        return int( quint32( quint64( packed ) ) );
+    }
+}
 
 
 class K3b::ThreadJob::Private
 {
 public:
     Private()
-        : thread( 0 ),
-          running( false ),
-          canceled( false ) {
+        : running( false ),
+          canceled( false ),
+          progressTimer( 0 ) {
+        resetProgress();
+    }
+
+    void resetProgress() {
+        percent.store( s_unset );
+        subPercent.store( s_unset );
+        processedSize.store( packSize( s_unset, s_unset ) );
+        processedSubSize.store( packSize( s_unset, s_unset ) );
+        progressChanged.store( 0 );
+        publishedPercent = publishedSubPercent = s_unset;
+        publishedProcessedSize = publishedProcessedSubSize = packSize( s_unset, s_unset );
     }
-    K3b::Thread* thread;
+
     bool running;
     bool canceled;
+
+    // the progress block, written by the worker thread without locking
+    QAtomicInt percent;
+    QAtomicInt subPercent;
+    QAtomicInteger<qint64> processedSize;
+    QAtomicInteger<qint64> processedSubSize;
+    QAtomicInt progressChanged;
+
+    // the values last emitted, only used in the job's thread
+    QTimer* progressTimer;
+    int publishedPercent;
+    int publishedSubPercent;
+    qint64 publishedProcessedSize;
+    qint64 publishedProcessedSubSize;
 };
 
 
@@ -41,14 +95,20 @@ K3b::ThreadJob::ThreadJob( K3b::JobHandler* jh, QObject* parent )
     : K3b::Job( jh, parent ),
       d( new Private )
 {
-    d->thread = new K3b::Thread( this );
-    connect( d->thread, SIGNAL(finished()),
-             this, SLOT(slotThreadFinished()) );
+    d->progressTimer = new QTimer( this );
+    d->progressTimer->setInterval( s_progressInterval );
+    connect( d->progressTimer, SIGNAL(timeout()),
+             this, SLOT(slotPublishProgress()) );
 }
 
 
 K3b::ThreadJob::~ThreadJob()
 {
+    // the executor is gone when jobs are deleted on exit
+    if( K3b::ThreadJobExecutor* executor = K3b::ThreadJobExecutor::instance() ) {
+        executor->dequeue( this );
+        executor->wait( this );
+    }
     delete d;
 }
 
@@ -64,8 +124,17 @@ void K3b::ThreadJob::start()
     if( !d->running ) {
         d->canceled = false;
         d->running = true;
+        d->resetProgress();
         jobStarted();
-        d->thread->start();
+        d->progressTimer->start();
+
+        const int waiting = K3b::ThreadJobExecutor::instance()->enqueue( this, executionDevice() );
+        if( waiting > 0 ) {
+            qDebug() << "(K3b::ThreadJob)" << jobDescription() << "queued with" << waiting << "waiting jobs";
+            QVariantMap data;
+            data.insert( QLatin1String( "queueDepth" ), waiting );
+            reportTelemetry( QLatin1String( "queued" ), data );
+        }
     }
     else {
         qDebug() << "(K3b::ThreadJob) thread not finished yet.";
@@ -73,19 +142,27 @@ void K3b::ThreadJob::start()
 }
 
 
-void K3b::ThreadJob::slotThreadFinished()
+void K3b::ThreadJob::slotThreadFinished( bool success )
 {
     d->running = false;
+
+    // make sure the final progress is not lost
+    d->progressTimer->stop();
+    slotPublishProgress();
+
     if( canceled() )
         emit canceled();
-    jobFinished( d->thread->success() );
+    jobFinished( success );
 }
 
 
 void K3b::ThreadJob::cancel()
 {
     d->canceled = true;
-    d->thread->ensureDone();
+    if( K3b::ThreadJobExecutor::instance()->dequeue( this ) ) {
+        // the job did not run yet
+        QMetaObject::invokeMethod( this, "slotThreadFinished", Qt::QueuedConnection, Q_ARG( bool, false ) );
+    }
 }
 
 
@@ -95,6 +172,71 @@ bool K3b::ThreadJob::canceled() const
 }
 
 
+K3b::Device::Device* K3b::ThreadJob::executionDevice() const
+{
+    return 0;
+}
+
+
+void K3b::ThreadJob::setProgress( int percent )
+{
+    d->percent.store( percent );
+    d->progressChanged.storeRelease( 1 );
+}
+
+
+void K3b::ThreadJob::setSubProgress( int percent )
+{
+    d->subPercent.store( percent );
+    d->progressChanged.storeRelease( 1 );
+}
+
+
+void K3b::ThreadJob::setProcessedSize( int processed, int size )
+{
+    d->processedSize.store( packSize( processed, size ) );
+    d->progressChanged.storeRelease( 1 );
+}
+
+
+void K3b::ThreadJob::setProcessedSubSize( int processed, int size )
+{
+    d->processedSubSize.store( packSize( processed, size ) );
+    d->progressChanged.storeRelease( 1 );
+}
+
+
+void K3b::ThreadJob::slotPublishProgress()
+{
+    if( !d->progressChanged.fetchAndStoreAcquire( 0 ) )
+        return;
+
+    const int p = d->percent.load();
+    if( p != s_unset && p != d->publishedPercent ) {
+        d->publishedPercent = p;
+        emit percent( p );
+    }
+
+    const int sp = d->subPercent.load();
+    if( sp != s_unset && sp != d->publishedSubPercent ) {
+        d->publishedSubPercent = sp;
+        emit subPercent( sp );
+    }
+
+    const qint64 size = d->processedSize.load();
+    if( unpackProcessed( size ) != s_unset && size != d->publishedProcessedSize ) {
+        d->publishedProcessedSize = size;
+        emit processedSize( unpackProcessed( size ), unpackSize( size ) );
+    }
+
+    const qint64 subSize = d->processedSubSize.load();
+    if( unpackProcessed( subSize ) != s_unset && subSize != d->publishedProcessedSubSize ) {
+        d->publishedProcessedSubSize = subSize;
+        emit processedSubSize( unpackProcessed( subSize ), unpackSize( subSize ) );
+    }
+}
+
+
 K3b::Device::MediaType K3b::ThreadJob::waitForMedium( K3b::Device::Device* device,
                                                       Device::MediaStates mediaState,
                                                       Device::MediaTypes mediaType,
@@ -108,7 +250,9 @@ K3b::Device::MediaType K3b::ThreadJob::waitForMedium( K3b::Device::Device* devic
                                                                                                message );
     QSharedPointer<K3b::ThreadJobCommunicationEvent::Data> data( event->data() );
     QCoreApplication::postEvent( this, event );
+    K3b::ThreadJobExecutor::instance()->suspend( this );
     data->wait();
+    K3b::ThreadJobExecutor::instance()->resume( this );
     return (Device::MediaType)data->intResult();
 }
 
@@ -124,7 +268,9 @@ bool K3b::ThreadJob::questionYesNo( const QString& text,
                                                                                                buttonNo );
     QSharedPointer<K3b::ThreadJobCommunicationEvent::Data> data( event->data() );
     QCoreApplication::postEvent( this, event );
+    K3b::ThreadJobExecutor::instance()->suspend( this );
     data->wait();
+    K3b::ThreadJobExecutor::instance()->resume( this );
     return data->boolResult();
 }
 
@@ -136,7 +282,9 @@ void K3b::ThreadJob::blockingInformation( const QString& text,
                                                                                                      caption );
     QSharedPointer<K3b::ThreadJobCommunicationEvent::Data> data( event->data() );
     QCoreApplication::postEvent( this, event );
+    K3b::ThreadJobExecutor::instance()->suspend( this );
     data->wait();
+    K3b::ThreadJobExecutor::instance()->resume( this );
 }
 
 
@@ -173,7 +321,7 @@ void K3b::ThreadJob::customEvent( QEvent* e )
 
 bool K3b::ThreadJob::wait( unsigned long time )
 {
-    return d->thread->wait( time );
+    return K3b::ThreadJobExecutor::instance()->wait( this, time );
 }
 
 
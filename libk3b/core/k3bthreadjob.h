@@ -23,12 +23,16 @@
 
 namespace K3b {
 
-    class Thread;
+    class ThreadJobExecutor;
 
     /**
      * A Job that runs in a different thread. Instead of reimplementing
      * start() reimplement run() to perform all operations in a different
      * thread. Otherwise usage is the same as Job.
+     *
+     * The jobs are run by the shared ThreadJobExecutor. Jobs which use a
+     * drive should reimplement executionDevice() so they do not run at
+     * the same time as other jobs on the same drive.
      */
     class LIBK3B_EXPORT ThreadJob : public Job
     {
@@ -71,15 +75,16 @@ namespace K3b {
 
 
         /**
-         * Call QThread::wait() on job's thread
-         * \see QThread::wait()
+         * Waits until the job has been run in its thread or
+         * removed from the queue of the executor.
+         * \return false if \p time ms passed before.
          */
         bool wait( unsigned long time = ULONG_MAX );
 
     public Q_SLOTS:
         /**
-         * Starts the job in a different thread. Emits the started()
-         * signal.
+         * Queues the job to be run in a different thread. Emits
+         * the started() signal.
          *
          * When reimplementing this method to perform housekeeping
          * operations in the GUI thread make sure to call the
@@ -90,8 +95,10 @@ namespace K3b {
         void start() override;
 
         /**
-         * Cancel the job. The method will give the thread a certain
-         * time to actually cancel. After that the thread is terminated.
+         * Cancel the job. A job which has not been run yet is removed
+         * from the queue. A running job is only flagged, run() has to
+         * check canceled() and return. The worker threads are shared
+         * and thus never terminated.
          *
          * \sa canceled()
          */
@@ -113,13 +120,40 @@ namespace K3b {
          */
         bool canceled() const;
 
+        /**
+         * Reimplement in jobs which read from or write to a drive. Jobs
+         * on the same drive run one after the other in the order they
+         * were started. The default implementation returns 0 for jobs
+         * which only need the CPU.
+         */
+        virtual Device::Device* executionDevice() const;
+
+        /**
+         * Thread-safe progress reporting for run(). Instead of emitting
+         * the progress signals directly these only store the values in
+         * the job's atomic progress block. The job publishes the latest
+         * values from its own thread at most every 100 ms and once more
+         * before emitting finished(), so workers may report after every
+         * chunk without flooding the event loop with queued signals.
+         */
+        void setProgress( int percent );
+        void setSubProgress( int percent );
+        void setProcessedSize( int processed, int size );
+        void setProcessedSubSize( int processed, int size );
+
     private Q_SLOTS:
         /**
          * Called in the GUi thread once the job is done.
          * Emits the finished signal and performs some
          * housekeeping.
          */
-        void slotThreadFinished();
+        void slotThreadFinished( bool success );
+
+        /**
+         * Emits the progress signals for the values which changed
+         * since the last call.
+         */
+        void slotPublishProgress();
 
     private:
         void customEvent( QEvent* ) override;
@@ -128,6 +162,7 @@ namespace K3b {
         Private* const d;
 
         friend class Thread;
+        friend class ThreadJobExecutor;
     };
 }
 
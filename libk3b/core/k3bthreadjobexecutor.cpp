@@ -0,0 +1,425 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+#include "k3bthreadjobexecutor.h"
+#include "k3bthreadjob.h"
+#include "k3bdevice.h"
+
+#include <QElapsedTimer>
+#include <QGlobalStatic>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+
+namespace {
+    // time in ms after which an idle worker quits
+    const unsigned long s_idleTimeout = 30000;
+
+    /**
+     * Waits on \p condition for what is left of \p time ms since \p timer
+     * was started. \return false on timeout.
+     */
+    bool waitRemaining( QWaitCondition& condition, QMutex* mutex, const QElapsedTimer& timer, unsigned long time )
+    {
+        if( time == ULONG_MAX )
+            return condition.wait( mutex );
+
+        const qint64 elapsed = timer.elapsed();
+        if( elapsed >= qint64( time ) )
+            return false;
+        return condition.wait( mutex, time - elapsed );
+    }
+}
+
+
+class K3b::ThreadJobExecutor::Worker : public QThread
+{
+public:
+    explicit Worker( ThreadJobExecutor::Private* d )
+        : job( 0 ),
+          device( 0 ),
+          suspended( false ),
+          m_d( d ) {
+    }
+
+    // the job run by this worker and its drive, protected by the executor's mutex
+    ThreadJob* job;
+    Device::Device* device;
+
+    // true while a CPU bound job waits for the user
+    bool suspended;
+
+protected:
+    void run() override;
+
+private:
+    ThreadJobExecutor::Private* m_d;
+};
+
+
+class K3b::ThreadJobExecutor::Private
+{
+public:
+    Private()
+        : maxWorkers( 0 ),
+          idleWorkers( 0 ),
+          runningCpuJobs( 0 ),
+          stop( false ) {
+    }
+
+    int maxWorkers;
+
+    mutable QMutex mutex;
+    QWaitCondition jobAvailable;
+    QWaitCondition jobDone;
+
+    QList<Worker*> workers;
+
+    // workers which quit, deleted the next time a job is queued
+    QList<Worker*> retiredWorkers;
+
+    // workers without a job, including the ones just started
+    int idleWorkers;
+
+    // the CPU bound jobs
+    QList<ThreadJob*> queue;
+    int runningCpuJobs;
+
+    // the jobs waiting for a drive and the drives in use
+    QMap<Device::Device*, QList<ThreadJob*> > deviceQueues;
+    QSet<Device::Device*> busyDevices;
+
+    // all queued and running jobs
+    QSet<ThreadJob*> pendingJobs;
+
+    bool stop;
+
+    int runnableJobs() const;
+    bool takeJob( Worker* worker );
+    void finishJob( Worker* worker, bool success );
+    void startWorkers();
+    void reapWorkers();
+    Worker* findWorker( ThreadJob* job ) const;
+};
+
+
+int K3b::ThreadJobExecutor::Private::runnableJobs() const
+{
+    int n = qMax( 0, qMin( queue.count(), maxWorkers - runningCpuJobs ) );
+    for( QMap<Device::Device*, QList<ThreadJob*> >::const_iterator it = deviceQueues.constBegin();
+         it != deviceQueues.constEnd(); ++it ) {
+        if( !busyDevices.contains( it.key() ) )
+            ++n;
+    }
+    return n;
+}
+
+
+bool K3b::ThreadJobExecutor::Private::takeJob( Worker* worker )
+{
+    // drives are never shared so a job for an idle drive can always run
+    for( QMap<Device::Device*, QList<ThreadJob*> >::iterator it = deviceQueues.begin();
+         it != deviceQueues.end(); ++it ) {
+        if( !busyDevices.contains( it.key() ) ) {
+            worker->job = it->takeFirst();
+            worker->device = it.key();
+            busyDevices.insert( worker->device );
+            if( it->isEmpty() )
+                deviceQueues.erase( it );
+            return true;
+        }
+    }
+
+    if( !queue.isEmpty() && runningCpuJobs < maxWorkers ) {
+        worker->job = queue.takeFirst();
+        worker->device = 0;
+        ++runningCpuJobs;
+        return true;
+    }
+
+    return false;
+}
+
+
+void K3b::ThreadJobExecutor::Private::finishJob( Worker* worker, bool success )
+{
+    ThreadJob* job = worker->job;
+
+    if( worker->device )
+        busyDevices.remove( worker->device );
+    else if( !worker->suspended )
+        --runningCpuJobs;
+
+    worker->job = 0;
+    worker->device = 0;
+    worker->suspended = false;
+    pendingJobs.remove( job );
+
+    // ThreadJob handles the result in its own thread
+    QMetaObject::invokeMethod( job, "slotThreadFinished", Qt::QueuedConnection, Q_ARG( bool, success ) );
+    jobDone.wakeAll();
+}
+
+
+void K3b::ThreadJobExecutor::Private::startWorkers()
+{
+    if( stop )
+        return;
+
+    const int runnable = runnableJobs();
+    if( runnable == 0 )
+        return;
+
+    if( idleWorkers > 0 )
+        jobAvailable.wakeAll();
+
+    while( idleWorkers < runnable ) {
+        Worker* worker = new Worker( this );
+        workers.append( worker );
+        ++idleWorkers;
+        worker->start();
+    }
+}
+
+
+void K3b::ThreadJobExecutor::Private::reapWorkers()
+{
+    QList<Worker*>::iterator it = retiredWorkers.begin();
+    while( it != retiredWorkers.end() ) {
+        if( ( *it )->isFinished() ) {
+            delete *it;
+            it = retiredWorkers.erase( it );
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+
+K3b::ThreadJobExecutor::Worker* K3b::ThreadJobExecutor::Private::findWorker( ThreadJob* job ) const
+{
+    Q_FOREACH( Worker* worker, workers ) {
+        if( worker->job == job )
+            return worker;
+    }
+    return 0;
+}
+
+
+void K3b::ThreadJobExecutor::Worker::run()
+{
+    QMutexLocker locker( &m_d->mutex );
+    while( !m_d->stop ) {
+        if( m_d->takeJob( this ) ) {
+            --m_d->idleWorkers;
+
+            // a finished job may free more than one slot
+            m_d->startWorkers();
+
+            ThreadJob* const currentJob = job;
+            locker.unlock();
+            const bool success = ThreadJobExecutor::runJob( currentJob );
+            locker.relock();
+
+            m_d->finishJob( this, success );
+            ++m_d->idleWorkers;
+            continue;
+        }
+
+        const bool woken = m_d->jobAvailable.wait( &m_d->mutex, s_idleTimeout );
+        if( !woken && !m_d->stop && m_d->runnableJobs() == 0 ) {
+            --m_d->idleWorkers;
+            m_d->workers.removeOne( this );
+            m_d->retiredWorkers.append( this );
+            return;
+        }
+    }
+}
+
+
+K3b::ThreadJobExecutor::ThreadJobExecutor( int maxWorkers )
+    : d( new Private )
+{
+    d->maxWorkers = ( maxWorkers > 0 ? maxWorkers : qMax( 2, QThread::idealThreadCount() ) );
+}
+
+
+K3b::ThreadJobExecutor::~ThreadJobExecutor()
+{
+    d->mutex.lock();
+    d->stop = true;
+    d->queue.clear();
+    d->deviceQueues.clear();
+    d->jobAvailable.wakeAll();
+    const QList<Worker*> workers = d->workers + d->retiredWorkers;
+    d->mutex.unlock();
+
+    Q_FOREACH( Worker* worker, workers ) {
+        worker->wait();
+        delete worker;
+    }
+
+    delete d;
+}
+
+
+int K3b::ThreadJobExecutor::maxWorkers() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->maxWorkers;
+}
+
+
+void K3b::ThreadJobExecutor::setMaxWorkers( int maxWorkers )
+{
+    QMutexLocker locker( &d->mutex );
+    d->maxWorkers = qMax( 1, maxWorkers );
+    d->startWorkers();
+}
+
+
+K3b::ThreadJobExecutor::Statistics K3b::ThreadJobExecutor::statistics() const
+{
+    QMutexLocker locker( &d->mutex );
+
+    Statistics stats;
+    stats.workers = d->workers.count();
+    stats.idleWorkers = d->idleWorkers;
+    Q_FOREACH( Worker* worker, d->workers ) {
+        if( worker->job )
+            ++stats.runningJobs;
+    }
+    stats.queuedJobs = d->queue.count();
+    for( QMap<Device::Device*, QList<ThreadJob*> >::const_iterator it = d->deviceQueues.constBegin();
+         it != d->deviceQueues.constEnd(); ++it ) {
+        stats.deviceQueues.insert( it.key()->blockDeviceName(), it->count() );
+    }
+    return stats;
+}
+
+
+bool K3b::ThreadJobExecutor::waitForDone( unsigned long time )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker( &d->mutex );
+    while( !d->pendingJobs.isEmpty() ) {
+        if( !waitRemaining( d->jobDone, &d->mutex, timer, time ) )
+            return d->pendingJobs.isEmpty();
+    }
+    return true;
+}
+
+
+int K3b::ThreadJobExecutor::enqueue( ThreadJob* job, Device::Device* device )
+{
+    QMutexLocker locker( &d->mutex );
+    d->reapWorkers();
+    d->pendingJobs.insert( job );
+
+    int waiting = 0;
+    if( device ) {
+        QList<ThreadJob*>& deviceQueue = d->deviceQueues[device];
+        deviceQueue.append( job );
+        if( d->busyDevices.contains( device ) || deviceQueue.count() > 1 )
+            waiting = deviceQueue.count();
+    }
+    else {
+        d->queue.append( job );
+        if( d->queue.count() > d->maxWorkers - d->runningCpuJobs )
+            waiting = d->queue.count();
+    }
+
+    d->startWorkers();
+    return waiting;
+}
+
+
+bool K3b::ThreadJobExecutor::dequeue( ThreadJob* job )
+{
+    QMutexLocker locker( &d->mutex );
+
+    bool removed = d->queue.removeOne( job );
+    for( QMap<Device::Device*, QList<ThreadJob*> >::iterator it = d->deviceQueues.begin();
+         !removed && it != d->deviceQueues.end(); ++it ) {
+        if( it->removeOne( job ) ) {
+            removed = true;
+            if( it->isEmpty() )
+                d->deviceQueues.erase( it );
+            break;
+        }
+    }
+
+    if( removed ) {
+        d->pendingJobs.remove( job );
+        d->jobDone.wakeAll();
+    }
+    return removed;
+}
+
+
+bool K3b::ThreadJobExecutor::wait( ThreadJob* job, unsigned long time )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker( &d->mutex );
+    while( d->pendingJobs.contains( job ) ) {
+        if( !waitRemaining( d->jobDone, &d->mutex, timer, time ) )
+            return !d->pendingJobs.contains( job );
+    }
+    return true;
+}
+
+
+void K3b::ThreadJobExecutor::suspend( ThreadJob* job )
+{
+    QMutexLocker locker( &d->mutex );
+    Worker* worker = d->findWorker( job );
+    if( worker && !worker->device && !worker->suspended ) {
+        worker->suspended = true;
+        --d->runningCpuJobs;
+        d->startWorkers();
+    }
+}
+
+
+void K3b::ThreadJobExecutor::resume( ThreadJob* job )
+{
+    QMutexLocker locker( &d->mutex );
+    Worker* worker = d->findWorker( job );
+    if( worker && worker->suspended ) {
+        worker->suspended = false;
+        ++d->runningCpuJobs;
+    }
+}
+
+
+bool K3b::ThreadJobExecutor::runJob( ThreadJob* job )
+{
+    return job->run();
+}
+
+
+Q_GLOBAL_STATIC( K3b::ThreadJobExecutor, s_executor )
+
+K3b::ThreadJobExecutor* K3b::ThreadJobExecutor::instance()
+{
+    return s_executor();
+}
@@ -0,0 +1,134 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+#ifndef _K3B_THREAD_JOB_EXECUTOR_H_
+#define _K3B_THREAD_JOB_EXECUTOR_H_
+
+#include "k3b_export.h"
+
+#include <QMap>
+#include <QString>
+
+#include <climits>
+
+
+namespace K3b {
+    namespace Device {
+        class Device;
+    }
+    class ThreadJob;
+
+    /**
+     * Runs ThreadJobs on a shared pool of worker threads instead of
+     * starting a new thread for every job.
+     *
+     * Jobs without a device are CPU bound (decoding, hashing, imaging)
+     * and at most maxWorkers() of them run at the same time. Further jobs
+     * wait in a queue. Jobs which use a drive (see ThreadJob::executionDevice())
+     * wait in a separate queue per drive and run one after the other in the
+     * order they were started. They do not count against the CPU limit
+     * since they mostly wait for the drive.
+     *
+     * Idle workers are kept for a while to be reused by the next job.
+     *
+     * Jobs are submitted by ThreadJob. The executor itself is only used
+     * to configure the pool and to query its state.
+     */
+    class LIBK3B_EXPORT ThreadJobExecutor
+    {
+    public:
+        struct Statistics {
+            Statistics()
+                : workers( 0 ),
+                  idleWorkers( 0 ),
+                  runningJobs( 0 ),
+                  queuedJobs( 0 ) {
+            }
+
+            int workers;        /**< Number of worker threads. */
+            int idleWorkers;    /**< Workers waiting for a job. */
+            int runningJobs;    /**< Jobs currently running, with or without device. */
+            int queuedJobs;     /**< CPU bound jobs waiting for a worker. */
+
+            /**
+             * Number of jobs waiting for each drive, by block device name.
+             * Only drives with waiting jobs are listed.
+             */
+            QMap<QString, int> deviceQueues;
+        };
+
+        /**
+         * \param maxWorkers The maximum number of CPU bound jobs running
+         * at the same time. Defaults to the number of cores, at least two.
+         */
+        explicit ThreadJobExecutor( int maxWorkers = 0 );
+
+        /**
+         * Waits for the running jobs. Queued jobs are not started anymore.
+         */
+        ~ThreadJobExecutor();
+
+        int maxWorkers() const;
+        void setMaxWorkers( int maxWorkers );
+
+        Statistics statistics() const;
+
+        /**
+         * Waits until all queued and running jobs are done.
+         * \return false if \p time ms passed before.
+         */
+        bool waitForDone( unsigned long time = ULONG_MAX );
+
+        /**
+         * The executor used by all ThreadJobs.
+         */
+        static ThreadJobExecutor* instance();
+
+    private:
+        /**
+         * Queues \p job, to be run on \p device if not null.
+         * \return The number of jobs waiting in the same queue including
+         * \p job or 0 if it can be started right away.
+         */
+        int enqueue( ThreadJob* job, Device::Device* device );
+
+        /**
+         * Removes \p job from its queue if it has not been started yet.
+         */
+        bool dequeue( ThreadJob* job );
+
+        /**
+         * Waits until \p job has been run or removed from its queue.
+         */
+        bool wait( ThreadJob* job, unsigned long time = ULONG_MAX );
+
+        /**
+         * Called while a CPU bound job waits for the user so it does not
+         * keep other jobs from running.
+         */
+        void suspend( ThreadJob* job );
+        void resume( ThreadJob* job );
+
+        static bool runJob( ThreadJob* job );
+
+        class Worker;
+        class Private;
+        Private* const d;
+
+        friend class ThreadJob;
+
+        Q_DISABLE_COPY( ThreadJobExecutor )
+    };
+}
+
+#endif
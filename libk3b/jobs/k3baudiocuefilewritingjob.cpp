@@ -23,7 +23,6 @@
 #include "k3baudiotrack.h"
 #include "k3baudiofile.h"
 #include "k3bcuefileparser.h"
-#include "k3bthread.h"
 #include "k3bthreadjob.h"
 #include "k3b_i18n.h"
 
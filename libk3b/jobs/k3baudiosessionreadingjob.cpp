@@ -14,7 +14,6 @@
 
 #include "k3baudiosessionreadingjob.h"
 
-#include "k3bthread.h"
 #include "k3btoc.h"
 #include "k3bcdparanoialib.h"
 #include "k3bwavefilewriter.h"
@@ -28,6 +27,12 @@
 #include <unistd.h>
 
 
+namespace {
+    // one second of audio
+    const int s_maxBatchSectors = 75;
+}
+
+
 class K3b::AudioSessionReadingJob::Private
 {
 public:
@@ -84,6 +89,12 @@ void K3b::AudioSessionReadingJob::setDevice( K3b::Device::Device* dev )
 }
 
 
+K3b::Device::Device* K3b::AudioSessionReadingJob::executionDevice() const
+{
+    return d->device;
+}
+
+
 void K3b::AudioSessionReadingJob::setToc( const K3b::Device::Toc& toc )
 {
     d->toc = toc;
@@ -173,8 +184,11 @@ bool K3b::AudioSessionReadingJob::run()
     unsigned int lastTotalPercent = 0;
     bool newTrack = true;
     int status = 0;
+    int sectors = 0;
     char* buffer = 0;
-    while( !canceled() && (buffer = d->paranoia->read( &status, &trackNum, !d->ioDev /*when writing to a wav be want little endian */ )) ) {
+    while( !canceled() && (buffer = d->paranoia->readSectors( s_maxBatchSectors, &sectors, &status, &trackNum,
+                                                              !d->ioDev /*when writing to a wav be want little endian */ )) ) {
+        const qint64 length = qint64( sectors ) * CD_FRAMESIZE_RAW;
 
         if( currentTrack != trackNum ) {
             emit nextTrack( trackNum, d->paranoia->toc().count() );
@@ -186,7 +200,7 @@ bool K3b::AudioSessionReadingJob::run()
         }
 
         if( d->ioDev ) {
-            if( d->ioDev->write( buffer, CD_FRAMESIZE_RAW ) != CD_FRAMESIZE_RAW ) {
+            if( d->ioDev->write( buffer, length ) != length ) {
                 qDebug() << "(K3b::AudioSessionCopyJob::WorkThread) error while writing to device " << d->ioDev;
                 writeError = true;
                 break;
@@ -213,22 +227,22 @@ bool K3b::AudioSessionReadingJob::run()
             }
 
             d->waveFileWriter->write( buffer,
-                                      CD_FRAMESIZE_RAW,
+                                      length,
                                       K3b::WaveFileWriter::LittleEndian );
         }
 
-        trackRead++;
-        totalRead++;
+        trackRead += sectors;
+        totalRead += sectors;
 
         unsigned int trackPercent = 100 * trackRead / d->toc[currentTrack-1].length().lba();
         if( trackPercent > lastTrackPercent ) {
             lastTrackPercent = trackPercent;
-            emit subPercent( lastTrackPercent );
+            setSubProgress( lastTrackPercent );
         }
         unsigned int totalPercent = 100 * totalRead / d->paranoia->rippedDataLength();
         if( totalPercent > lastTotalPercent ) {
             lastTotalPercent = totalPercent;
-            emit percent( lastTotalPercent );
+            setProgress( lastTotalPercent );
         }
     }
 
@@ -67,6 +67,7 @@ namespace K3b {
     private:
         void jobFinished( bool ) override;
         bool run() override;
+        Device::Device* executionDevice() const override;
 
         class Private;
         Private* const d;
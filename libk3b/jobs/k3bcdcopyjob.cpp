@@ -31,6 +31,7 @@
 #include "k3binffilewriter.h"
 #include "k3bglobalsettings.h"
 #include "k3bcddb.h"
+#include "k3bfanoutpipe.h"
 #include "k3b_i18n.h"
 
 #include <KConfig>
@@ -65,7 +66,15 @@ public:
           audioSessionReader(0),
           cdrecordWriter(0),
           infFileWriter(0),
-          cddb(0) {
+          cddb(0),
+          fanOut(false),
+          runningWriters(0),
+          failedWriters(0),
+          fanOutWriterFailed(false) {
+    }
+
+    ~Private() {
+        qDeleteAll( fanOutWriters );
     }
 
     bool canceled;
@@ -113,6 +122,61 @@ public:
     // used to determine progress
     QVector<long> sessionSizes;
     long overallSize;
+
+    //
+    // Writing to several writers at once
+    //
+    class FanOutWriter
+    {
+    public:
+        FanOutWriter( K3b::Device::Device* dev, K3b::CdrecordWriter* writer )
+            : device( dev ),
+              writerJob( writer ),
+              percent( 0 ),
+              buffer( 100 ),
+              deviceBuffer( 100 ),
+              minDeviceBuffer( 100 ),
+              writeSpeed( 0 ),
+              speedMultiplicator( K3b::Device::SPEED_FACTOR_CD ),
+              running( false ) {
+        }
+
+        QString name() const {
+            return device->vendor() + ' ' + device->description();
+        }
+
+        K3b::Device::Device* device;
+
+        // a child of the job
+        K3b::CdrecordWriter* writerJob;
+
+        int percent;
+        int buffer;
+        int deviceBuffer;
+        int minDeviceBuffer;
+        int writeSpeed;
+        K3b::Device::SpeedMultiplicator speedMultiplicator;
+        bool running;
+    };
+
+    FanOutWriter* fanOutWriter( QObject* writer ) const {
+        for( int i = 0; i < fanOutWriters.count(); ++i ) {
+            if( fanOutWriters[i]->writerJob == writer )
+                return fanOutWriters[i];
+        }
+        return 0;
+    }
+
+    // The first device is m_writerDevice which is written by cdrecordWriter.
+    // fanOutWriters contains one entry for every device in the order of
+    // writerDevices, which is also the order of the sinks of fanOutPipe.
+    bool fanOut;
+    QList<K3b::Device::Device*> writerDevices;
+    QList<FanOutWriter*> fanOutWriters;
+    K3b::FanOutPipe fanOutPipe;
+    int runningWriters;
+    int failedWriters;
+    bool fanOutWriterFailed;
 };
 
 
@@ -125,12 +189,16 @@ K3b::CdCopyJob::CdCopyJob( K3b::JobHandler* hdl, QObject* parent )
       m_ignoreDataReadErrors(false),
       m_ignoreAudioReadErrors(true),
       m_noCorrection(false),
+      m_checkEdcEcc(false),
+      m_rescueMode(false),
       m_dataReadRetries(128),
       m_audioReadRetries(5),
       m_copyCdText(true),
       m_writingMode( K3b::WritingModeAuto )
 {
     d = new Private();
+
+    connect( &d->fanOutPipe, SIGNAL(sinkError(int)), this, SLOT(slotFanOutSinkError(int)) );
 }
 
 
@@ -153,6 +221,8 @@ void K3b::CdCopyJob::start()
     d->deleteTempDir = false;
     d->haveCdText = false;
     d->haveCddb = false;
+    d->fanOut = false;
+    d->fanOutWriterFailed = false;
 
     if ( m_onlyCreateImages )
         m_onTheFly = false;
@@ -195,6 +265,27 @@ void K3b::CdCopyJob::slotDiskInfoReady( K3b::Device::DeviceHandler* dh )
         bool audio = false;
         d->numSessions = dh->diskInfo().numSessions();
         d->doNotCloseLastSession = (dh->diskInfo().diskState() == K3b::Device::STATE_INCOMPLETE);
+
+        //
+        // Writing to several writers at once is only supported for single session sources.
+        // The writers would need to be kept in sync between the sessions otherwise.
+        //
+        if( !m_onlyCreateImages && d->writerDevices.count() > 1 ) {
+            if( d->numSessions > 1 ) {
+                emit infoMessage( i18n("Multisession CDs can only be written to one writer. Only writing to %1.",
+                                       m_writerDevice->vendor() + ' ' + m_writerDevice->description()),
+                                  MessageWarning );
+            }
+            else if( m_onTheFly && d->writerDevices.contains( m_readerDevice ) ) {
+                emit infoMessage( i18n("It is not possible to copy on the fly when the source device is also a writer."),
+                                  MessageError );
+                finishJob( false, true );
+                return;
+            }
+            else {
+                d->fanOut = true;
+            }
+        }
         switch( dh->toc().contentType() ) {
         case K3b::Device::DATA:
             // check if every track is in it's own session
@@ -504,6 +595,12 @@ void K3b::CdCopyJob::cancel()
         // anymore and will finish unsuccessfully, too
         //
         d->cdrecordWriter->cancel();
+        if( d->fanOut ) {
+            for( int i = 1; i < d->fanOutWriters.count(); ++i ) {
+                d->fanOutWriters[i]->writerJob->cancel();
+            }
+            d->fanOutPipe.abort();
+        }
     }
     else if( d->audioReaderRunning )
         d->audioSessionReader->cancel();
@@ -544,8 +641,22 @@ bool K3b::CdCopyJob::prepareImageFiles()
             }
         }
 
+        if( m_rescueMode ) {
+            // the images of a failed rescue are kept in a folder named after the disc
+            const QString rescueDir = K3b::prepareDir( m_tempPath ) + rescueFileName();
+            if( QFileInfo( rescueDir ).isDir() ) {
+                emit infoMessage( i18n("Resuming reading into folder %1.",rescueDir), MessageInfo );
+            }
+            else if( !QDir().mkdir( rescueDir ) ) {
+                emit infoMessage( i18n("Unable to create temporary folder '%1'.",rescueDir), MessageError );
+                return false;
+            }
+            m_tempPath = rescueDir;
+            d->deleteTempDir = true;
+        }
+
         // create temp dir
-        if( !tempDirReady ) {
+        else if( !tempDirReady ) {
             QDir dir( m_tempPath );
             m_tempPath = K3b::findUniqueFilePrefix( "k3bCdCopy", m_tempPath );
             qDebug() << "(K3b::CdCopyJob) creating temp dir: " << m_tempPath;
@@ -578,10 +689,19 @@ bool K3b::CdCopyJob::prepareImageFiles()
         return true;
     }
     else {
-        // we only need a single image file
-        if( !fi.isFile() ||
-            questionYesNo( i18n("Do you want to overwrite %1?",m_tempPath),
-                           i18n("File Exists") ) ) {
+        // the image of a failed rescue is kept under a name derived from the disc
+        if( m_rescueMode && fi.isDir() ) {
+            m_tempPath = K3b::prepareDir( m_tempPath ) + rescueFileName() + QLatin1String( ".iso" );
+            fi.setFile( m_tempPath );
+        }
+
+        // an image with a read error map is resumed instead of being overwritten
+        if( m_rescueMode && fi.isFile() && QFile::exists( m_tempPath + QLatin1String( ".map" ) ) ) {
+            emit infoMessage( i18n("Resuming reading into image file %1.",m_tempPath), MessageInfo );
+        }
+        else if( !fi.isFile() ||
+                 questionYesNo( i18n("Do you want to overwrite %1?",m_tempPath),
+                                i18n("File Exists") ) ) {
             if( fi.isDir() )
                 m_tempPath = K3b::findTempFile( "iso", m_tempPath );
             else if( !QFileInfo( m_tempPath.section( '/', 0, -2 ) ).isDir() ) {
@@ -602,6 +722,12 @@ bool K3b::CdCopyJob::prepareImageFiles()
 }
 
 
+QString K3b::CdCopyJob::rescueFileName() const
+{
+    return QString::fromLatin1( "k3bCdCopy-%1" ).arg( d->toc.discId(), 8, 16, QLatin1Char( '0' ) );
+}
+
+
 void K3b::CdCopyJob::readNextSession()
 {
     if( !m_onTheFly || m_onlyCreateImages ) {
@@ -635,7 +761,9 @@ void K3b::CdCopyJob::readNextSession()
         d->audioSessionReader->setParanoiaMode( m_paranoiaMode );
         d->audioSessionReader->setReadRetries( m_audioReadRetries );
         d->audioSessionReader->setNeverSkip( !m_ignoreAudioReadErrors );
-        if( m_onTheFly )
+        if( m_onTheFly && d->fanOut )
+            d->audioSessionReader->writeTo( &d->fanOutPipe );
+        else if( m_onTheFly )
             d->audioSessionReader->writeTo( d->cdrecordWriter->ioDevice() );
         else
             d->audioSessionReader->setImageNames( d->imageNames );  // the audio tracks are always the first tracks
@@ -657,6 +785,8 @@ void K3b::CdCopyJob::readNextSession()
         d->dataTrackReader->setDevice( m_readerDevice );
         d->dataTrackReader->setIgnoreErrors( m_ignoreDataReadErrors );
         d->dataTrackReader->setNoCorrection( m_noCorrection );
+        // sectors which are corrupted by intention have to be copied as they are
+        d->dataTrackReader->setCheckEdcEcc( m_checkEdcEcc && !m_noCorrection );
         d->dataTrackReader->setRetries( m_dataReadRetries );
         if( m_onlyCreateImages )
             d->dataTrackReader->setSectorSize( K3b::DataTrackReader::MODE1 );
@@ -685,11 +815,19 @@ void K3b::CdCopyJob::readNextSession()
         if( d->toc.contentType() == K3b::Device::MIXED )
             trackNum = d->toc.count();
 
-        if( m_onTheFly )
+        if( m_onTheFly && d->fanOut )
+            d->dataTrackReader->writeTo( &d->fanOutPipe );
+        else if( m_onTheFly )
             d->dataTrackReader->writeTo( d->cdrecordWriter->ioDevice() );
         else
             d->dataTrackReader->setImagePath( d->imageNames[trackNum-1] );
 
+        // rescue mode needs random access to the image
+        if( m_rescueMode && !m_onTheFly )
+            d->dataTrackReader->setRescueMapFile( d->imageNames[trackNum-1] + QLatin1String( ".map" ) );
+        else
+            d->dataTrackReader->setRescueMapFile( QString() );
+
         d->dataReaderRunning = true;
         if( !m_onTheFly || m_onlyCreateImages )
             slotReadingNextTrack( 1, 1 );
@@ -728,19 +866,31 @@ bool K3b::CdCopyJob::writeNextSession()
             finishJob( true, false );
             return false;
         }
+
+        // we need media in all writers before starting any of them
+        if( d->fanOut ) {
+            for( int i = 1; i < d->writerDevices.count(); ++i ) {
+                if( waitForMedium( d->writerDevices[i],
+                                   K3b::Device::STATE_EMPTY,
+                                   K3b::Device::MEDIA_WRITABLE_CD ) == Device::MEDIA_UNKNOWN ) {
+                    finishJob( true, false );
+                    return false;
+                }
+            }
+        }
     }
 
     if( !d->cdrecordWriter ) {
         d->cdrecordWriter = new K3b::CdrecordWriter( m_writerDevice, this, this );
-        connect( d->cdrecordWriter, SIGNAL(infoMessage(QString,int)), this, SIGNAL(infoMessage(QString,int)) );
+        connect( d->cdrecordWriter, SIGNAL(infoMessage(QString,int)), this, SLOT(slotWriterInfoMessage(QString,int)) );
         connect( d->cdrecordWriter, SIGNAL(percent(int)), this, SLOT(slotWriterProgress(int)) );
         connect( d->cdrecordWriter, SIGNAL(processedSize(int,int)), this, SIGNAL(processedSize(int,int)) );
         connect( d->cdrecordWriter, SIGNAL(subPercent(int)), this, SIGNAL(subPercent(int)) );
         connect( d->cdrecordWriter, SIGNAL(processedSubSize(int,int)), this, SIGNAL(processedSubSize(int,int)) );
         connect( d->cdrecordWriter, SIGNAL(nextTrack(int,int)), this, SLOT(slotWritingNextTrack(int,int)) );
-        connect( d->cdrecordWriter, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
-        connect( d->cdrecordWriter, SIGNAL(deviceBuffer(int)), this, SIGNAL(deviceBuffer(int)) );
-        connect( d->cdrecordWriter, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)) );
+        connect( d->cdrecordWriter, SIGNAL(buffer(int)), this, SLOT(slotWriterBuffer(int)) );
+        connect( d->cdrecordWriter, SIGNAL(deviceBuffer(int)), this, SLOT(slotWriterDeviceBuffer(int)) );
+        connect( d->cdrecordWriter, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SLOT(slotWriterWriteSpeed(int,K3b::Device::SpeedMultiplicator)) );
         connect( d->cdrecordWriter, SIGNAL(finished(bool)), this, SLOT(slotWriterFinished(bool)) );
         //    connect( d->cdrecordWriter, SIGNAL(newTask(QString)), this, SIGNAL(newTask(QString)) );
         connect( d->cdrecordWriter, SIGNAL(newSubTask(QString)), this, SIGNAL(newSubTask(QString)) );
@@ -748,10 +898,88 @@ bool K3b::CdCopyJob::writeNextSession()
                  this, SIGNAL(debuggingOutput(QString,QString)) );
     }
 
-    d->cdrecordWriter->setBurnDevice( m_writerDevice );
-    d->cdrecordWriter->clearArguments();
-    d->cdrecordWriter->setSimulate( m_simulate );
-    d->cdrecordWriter->setBurnSpeed( m_speed );
+    if( !prepareWriter( d->cdrecordWriter, m_writerDevice ) )
+        return false;
+
+    if( d->fanOut ) {
+        if( d->fanOutWriters.isEmpty() )
+            d->fanOutWriters.append( new Private::FanOutWriter( m_writerDevice, d->cdrecordWriter ) );
+        d->fanOutWriters.first()->device = m_writerDevice;
+
+        // the set of writers may have shrunk since the last run
+        while( d->fanOutWriters.count() > d->writerDevices.count() ) {
+            Private::FanOutWriter* w = d->fanOutWriters.takeLast();
+            w->writerJob->deleteLater();
+            delete w;
+        }
+
+        for( int i = 1; i < d->writerDevices.count(); ++i ) {
+            if( d->fanOutWriters.count() <= i ) {
+                // the secondary writers report like the main one, see slotWriterBuffer() and friends
+                K3b::CdrecordWriter* writer = new K3b::CdrecordWriter( d->writerDevices[i], this, this );
+                connect( writer, SIGNAL(infoMessage(QString,int)), this, SLOT(slotWriterInfoMessage(QString,int)) );
+                connect( writer, SIGNAL(percent(int)), this, SLOT(slotWriterProgress(int)) );
+                connect( writer, SIGNAL(buffer(int)), this, SLOT(slotWriterBuffer(int)) );
+                connect( writer, SIGNAL(deviceBuffer(int)), this, SLOT(slotWriterDeviceBuffer(int)) );
+                connect( writer, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SLOT(slotWriterWriteSpeed(int,K3b::Device::SpeedMultiplicator)) );
+                connect( writer, SIGNAL(finished(bool)), this, SLOT(slotWriterFinished(bool)) );
+                connect( writer, SIGNAL(debuggingOutput(QString,QString)),
+                         this, SIGNAL(debuggingOutput(QString,QString)) );
+                d->fanOutWriters.append( new Private::FanOutWriter( d->writerDevices[i], writer ) );
+            }
+
+            d->fanOutWriters[i]->device = d->writerDevices[i];
+            if( !prepareWriter( d->fanOutWriters[i]->writerJob, d->writerDevices[i] ) )
+                return false;
+        }
+    }
+
+
+    //
+    // Finally start the writer
+    //
+    emit burning(true);
+    d->writerRunning = true;
+    d->runningWriters = 1;
+    d->failedWriters = 0;
+
+    if( d->fanOut ) {
+        d->runningWriters = d->fanOutWriters.count();
+
+        d->fanOutPipe.clearSinks();
+        Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+            w->percent = 0;
+            w->buffer = w->deviceBuffer = w->minDeviceBuffer = 100;
+            w->writeSpeed = 0;
+            w->running = true;
+            w->writerJob->start();
+            d->fanOutPipe.addSink( w->writerJob->ioDevice() );
+        }
+
+        // when writing from images every cdrecord process reads the images itself
+        if( m_onTheFly && !d->fanOutPipe.open() ) {
+            emit infoMessage( i18n("Unable to pass the data to the writers."), MessageError );
+            d->error = true;
+            Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+                w->writerJob->cancel();
+            }
+            return false;
+        }
+    }
+    else {
+        d->cdrecordWriter->start();
+    }
+
+    return true;
+}
+
+
+bool K3b::CdCopyJob::prepareWriter( K3b::CdrecordWriter* writer, K3b::Device::Device* dev )
+{
+    writer->setBurnDevice( dev );
+    writer->clearArguments();
+    writer->setSimulate( m_simulate );
+    writer->setBurnSpeed( m_speed );
 
 
     // create the cdrecord arguments
@@ -840,22 +1068,22 @@ bool K3b::CdCopyJob::writeNextSession()
                 }
             }
 
-            if( zeroPregap && m_writerDevice->supportsRawWriting() ) {
+            if( zeroPregap && dev->supportsRawWriting() ) {
                 if( d->numSessions == 1 )
                     usedWritingMode = K3b::WritingModeRaw;
                 else
                     usedWritingMode = K3b::WritingModeTao;
             }
-            else if( m_writerDevice->dao() )
+            else if( dev->dao() )
                 usedWritingMode = K3b::WritingModeSao;
-            else if( m_writerDevice->supportsRawWriting() )
+            else if( dev->supportsRawWriting() )
                 usedWritingMode = K3b::WritingModeRaw;
             else
                 usedWritingMode = K3b::WritingModeTao;
         }
-        d->cdrecordWriter->setWritingMode( usedWritingMode  );
+        writer->setWritingMode( usedWritingMode  );
 
-        d->cdrecordWriter->setMulti( d->numSessions > 1 );
+        writer->setMulti( d->numSessions > 1 );
 
         if( d->haveCddb || d->haveCdText ) {
             if( usedWritingMode == K3b::WritingModeTao ) {
@@ -863,28 +1091,28 @@ bool K3b::CdCopyJob::writeNextSession()
             }
             else if( d->haveCdText ) {
                 // use the raw CDTEXT data
-                d->cdrecordWriter->setRawCdText( d->cdTextRaw );
+                writer->setRawCdText( d->cdTextRaw );
             }
             else {
                 // make sure the writer job does not create raw cdtext
-                d->cdrecordWriter->setRawCdText( QByteArray() );
+                writer->setRawCdText( QByteArray() );
                 // cdrecord will use the cdtext data in the inf files
-                d->cdrecordWriter->addArgument( "-text" );
+                writer->addArgument( "-text" );
             }
         }
 
-        d->cdrecordWriter->addArgument( "-useinfo" );
+        writer->addArgument( "-useinfo" );
 
         //
         // add all the audio tracks
         //
-        d->cdrecordWriter->addArgument( "-audio" )->addArgument( "-shorttrack" );
+        writer->addArgument( "-audio" )->addArgument( "-shorttrack" );
 
         for( int i = 0; i < d->infNames.count(); ++i ) {
             if( m_onTheFly )
-                d->cdrecordWriter->addArgument( d->infNames[i] );
+                writer->addArgument( d->infNames[i] );
             else
-                d->cdrecordWriter->addArgument( d->imageNames[i] );
+                writer->addArgument( d->imageNames[i] );
         }
     }
     else {
@@ -908,7 +1136,7 @@ bool K3b::CdCopyJob::writeNextSession()
             // at least the NEC3540a does write 2056 byte sectors only in tao mode. Same for LG4040b
             // since writing data tracks in TAO mode is no loss let's default to TAO in the case of 2056 byte
             // sectors (which is when writing xa form1 sectors here)
-            if( m_writerDevice->dao() &&
+            if( dev->dao() &&
                 d->toc.count() == 1 &&
                 !multi &&
                 track->mode() == K3b::Device::Track::MODE1 )
@@ -916,24 +1144,24 @@ bool K3b::CdCopyJob::writeNextSession()
             else
                 usedWritingMode = K3b::WritingModeTao;
         }
-        d->cdrecordWriter->setWritingMode( usedWritingMode );
+        writer->setWritingMode( usedWritingMode );
 
         //
         // all but the last session of a multisession disk are written in multi mode
         // and every data track has it's own session which we forced above
         //
-        d->cdrecordWriter->setMulti( multi );
+        writer->setMulti( multi );
 
         // just to let the reader init
         if( m_onTheFly )
-            d->cdrecordWriter->addArgument( "-waiti" );
+            writer->addArgument( "-waiti" );
 
         if( track->mode() == K3b::Device::Track::MODE1 )
-            d->cdrecordWriter->addArgument( "-data" );
+            writer->addArgument( "-data" );
         else if( track->mode() == K3b::Device::Track::XA_FORM1 )
-            d->cdrecordWriter->addArgument( "-xa1" );
+            writer->addArgument( "-xa1" );
         else
-            d->cdrecordWriter->addArgument( "-xamix" );
+            writer->addArgument( "-xamix" );
 
         if( m_onTheFly ) {
             // HACK: if the track is TAO recorded cut the two run-out sectors
@@ -948,25 +1176,18 @@ bool K3b::CdCopyJob::writeNextSession()
                 trackLen = trackLen * 2056; // see k3bdatatrackreader.h
             else
                 trackLen = trackLen * 2332; // see k3bdatatrackreader.h
-            d->cdrecordWriter->addArgument( QString("-tsize=%1").arg(trackLen) )->addArgument("-");
+            writer->addArgument( QString("-tsize=%1").arg(trackLen) )->addArgument("-");
         }
         else if( d->toc.contentType() == K3b::Device::MIXED )
-            d->cdrecordWriter->addArgument( d->imageNames[d->toc.count()-1] );
+            writer->addArgument( d->imageNames[d->toc.count()-1] );
         else
-            d->cdrecordWriter->addArgument( d->imageNames[d->currentWrittenSession-1] );
+            writer->addArgument( d->imageNames[d->currentWrittenSession-1] );
 
         // clear cd text from previous sessions
-        d->cdrecordWriter->setRawCdText( QByteArray() );
+        writer->setRawCdText( QByteArray() );
     }
 
 
-    //
-    // Finally start the writer
-    //
-    emit burning(true);
-    d->writerRunning = true;
-    d->cdrecordWriter->start();
-
     return true;
 }
 
@@ -982,6 +1203,10 @@ void K3b::CdCopyJob::slotSessionReaderFinished( bool success )
         else
             emit infoMessage( i18n("Successfully read source disk."), MessageSuccess );
 
+        // let the writers consume the remaining data
+        if( m_onTheFly && d->fanOut )
+            d->fanOutPipe.close();
+
         if( !m_onTheFly ) {
             if( d->numSessions > d->currentReadSession ) {
                 d->currentReadSession++;
@@ -990,7 +1215,7 @@ void K3b::CdCopyJob::slotSessionReaderFinished( bool success )
             else {
                 d->readingSuccessful = true;
                 if( !m_onlyCreateImages ) {
-                    if( m_readerDevice == m_writerDevice ) {
+                    if( m_readerDevice == m_writerDevice || d->writerDevices.contains( m_readerDevice ) ) {
                         // eject the media (we do this blocking to know if it worked
                         // because if it did not it might happen that k3b overwrites a CD-RW
                         // source)
@@ -1013,10 +1238,19 @@ void K3b::CdCopyJob::slotSessionReaderFinished( bool success )
     else {
         if( !d->canceled ) {
             emit infoMessage( i18n("Error while reading session %1.",d->currentReadSession), MessageError );
-            if( m_onTheFly )
+            if( m_onTheFly ) {
                 d->cdrecordWriter->setSourceUnreadable(true);
+                if( d->fanOut ) {
+                    for( int i = 1; i < d->fanOutWriters.count(); ++i ) {
+                        d->fanOutWriters[i]->writerJob->setSourceUnreadable(true);
+                    }
+                }
+            }
         }
 
+        if( m_onTheFly && d->fanOut )
+            d->fanOutPipe.abort();
+
         finishJob( d->canceled, !d->canceled );
     }
 }
@@ -1024,6 +1258,30 @@ void K3b::CdCopyJob::slotSessionReaderFinished( bool success )
 
 void K3b::CdCopyJob::slotWriterFinished( bool success )
 {
+    if( d->fanOut ) {
+        Private::FanOutWriter* w = d->fanOutWriter( sender() );
+        if( w ) {
+            w->running = false;
+            w->percent = 100;
+            emit infoMessage( i18n("%1: lowest device buffer fill level %2%, waited for the writer %3 times.",
+                                   w->name(), w->minDeviceBuffer, d->fanOutPipe.stalls( d->fanOutWriters.indexOf( w ) ) ),
+                              MessageInfo );
+        }
+
+        if( !success && !d->canceled ) {
+            if( w )
+                emit infoMessage( i18n("Writing to %1 failed.", w->name()), MessageError );
+            ++d->failedWriters;
+            d->fanOutWriterFailed = true;
+        }
+
+        // wait for the other writers
+        if( --d->runningWriters > 0 )
+            return;
+
+        success = !d->canceled && d->failedWriters < d->writerDevices.count();
+    }
+
     emit burning(false);
 
     d->writerRunning = false;
@@ -1061,6 +1319,13 @@ void K3b::CdCopyJob::slotWriterFinished( bool success )
                 if( !K3b::eject( m_writerDevice ) ) {
                     blockingInformation( i18n("K3b was unable to eject the written disk. Please do so manually.") );
                 }
+                if( d->fanOut ) {
+                    for( int i = 1; i < d->writerDevices.count(); ++i ) {
+                        if( !K3b::eject( d->writerDevices[i] ) ) {
+                            blockingInformation( i18n("K3b was unable to eject the written disk. Please do so manually.") );
+                        }
+                    }
+                }
 
                 d->currentWrittenSession = 1;
                 d->currentReadSession = 1;
@@ -1076,8 +1341,15 @@ void K3b::CdCopyJob::slotWriterFinished( bool success )
             else {
                 if ( k3bcore->globalSettings()->ejectMedia() ) {
                     K3b::Device::eject( m_writerDevice );
+                    if( d->fanOut ) {
+                        for( int i = 1; i < d->writerDevices.count(); ++i )
+                            K3b::Device::eject( d->writerDevices[i] );
+                    }
                 }
-                finishJob( false, false );
+
+                if( d->fanOutWriterFailed )
+                    emit infoMessage( i18n("Not all copies could be written successfully."), MessageError );
+                finishJob( false, d->fanOutWriterFailed );
             }
         }
     }
@@ -1111,16 +1383,30 @@ void K3b::CdCopyJob::slotMediaReloadedForNextSession( K3b::Device::DeviceHandler
 
 void K3b::CdCopyJob::cleanup()
 {
+    // in rescue mode the images and read error maps of a failed read are kept to resume it
+    const bool keepForRescue = ( m_rescueMode && !m_onTheFly && !d->readingSuccessful && !d->imageNames.isEmpty() );
+
     if( m_onTheFly || !m_keepImage || ((d->canceled || d->error) && !d->readingSuccessful) ) {
         emit infoMessage( i18n("Removing temporary files."), MessageInfo );
         for( QStringList::iterator it = d->infNames.begin(); it != d->infNames.end(); ++it )
             QFile::remove( *it );
     }
 
-    if( !m_onTheFly && (!m_keepImage || ((d->canceled || d->error) && !d->readingSuccessful)) ) {
-        emit infoMessage( i18n("Removing image files."), MessageInfo );
+    // the read error maps are not needed anymore once reading succeeded
+    if( m_rescueMode && d->readingSuccessful ) {
         for( QStringList::iterator it = d->imageNames.begin(); it != d->imageNames.end(); ++it )
+            QFile::remove( *it + QLatin1String( ".map" ) );
+    }
+
+    if( keepForRescue ) {
+        emit infoMessage( i18n("Keeping the image files in %1 to resume reading.",m_tempPath), MessageInfo );
+    }
+    else if( !m_onTheFly && (!m_keepImage || ((d->canceled || d->error) && !d->readingSuccessful)) ) {
+        emit infoMessage( i18n("Removing image files."), MessageInfo );
+        for( QStringList::iterator it = d->imageNames.begin(); it != d->imageNames.end(); ++it ) {
             QFile::remove( *it );
+            QFile::remove( *it + QLatin1String( ".map" ) );
+        }
 
         // remove the tempdir created in prepareImageFiles()
         if( d->deleteTempDir ) {
@@ -1164,6 +1450,18 @@ void K3b::CdCopyJob::slotReaderProcessedSize( int p, int pp )
 
 void K3b::CdCopyJob::slotWriterProgress( int p )
 {
+    if( d->fanOut ) {
+        if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) )
+            w->percent = p;
+
+        // every writer contributes the same part to the overall progress
+        int sum = 0;
+        Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+            sum += w->percent;
+        }
+        p = sum / d->fanOutWriters.count();
+    }
+
     int bigParts = ( m_simulate ? 1 : m_copies ) + ( m_onTheFly ? 0 : 1 );
     long done = ( m_onTheFly ? d->doneCopies : d->doneCopies+1 ) * d->overallSize
                 + (p * d->sessionSizes[d->currentWrittenSession-1] / 100);
@@ -1226,9 +1524,12 @@ QString K3b::CdCopyJob::jobDescription() const
 
 QString K3b::CdCopyJob::jobDetails() const
 {
+    int copies = (m_simulate||m_onlyCreateImages) ? 1 : m_copies;
+    if( !m_onlyCreateImages && d->writerDevices.count() > 1 )
+        copies *= d->writerDevices.count();
     return i18np("Creating 1 copy",
                  "Creating %1 copies",
-                 (m_simulate||m_onlyCreateImages) ? 1 : m_copies );
+                 copies );
 }
 
 
@@ -1243,7 +1544,14 @@ QString K3b::CdCopyJob::jobSource() const
 
 QString K3b::CdCopyJob::jobTarget() const
 {
-    if( Device::Device* device = writer() )
+    if( !m_onlyCreateImages && d->writerDevices.count() > 1 ) {
+        QStringList names;
+        Q_FOREACH( Device::Device* device, d->writerDevices ) {
+            names << device->vendor() + ' ' + device->description();
+        }
+        return names.join( QLatin1String( ", " ) );
+    }
+    else if( Device::Device* device = writer() )
         return device->vendor() + ' ' + device->description();
     else
         return m_tempPath;
@@ -1269,3 +1577,104 @@ void K3b::CdCopyJob::finishJob( bool c, bool e )
 }
 
 
+void K3b::CdCopyJob::setWriterDevice( K3b::Device::Device* dev )
+{
+    m_writerDevice = dev;
+    d->writerDevices.clear();
+}
+
+
+void K3b::CdCopyJob::setWriterDevices( const QList<K3b::Device::Device*>& devs )
+{
+    d->writerDevices = devs;
+    m_writerDevice = ( devs.isEmpty() ? 0 : devs.first() );
+}
+
+
+void K3b::CdCopyJob::setFanOutBufferSize( qint64 bytes )
+{
+    d->fanOutPipe.setBufferSize( bytes );
+}
+
+
+void K3b::CdCopyJob::slotWriterInfoMessage( const QString& msg, int type )
+{
+    Private::FanOutWriter* w = d->fanOutWriter( sender() );
+    if( d->fanOut && w )
+        emit infoMessage( w->name() + ": " + msg, type );
+    else
+        emit infoMessage( msg, type );
+}
+
+
+void K3b::CdCopyJob::slotWriterBuffer( int b )
+{
+    if( !d->fanOut ) {
+        emit bufferStatus( b );
+        return;
+    }
+
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) )
+        w->buffer = b;
+
+    // the slowest writer is the interesting one
+    int minBuffer = 100;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        if( w->running )
+            minBuffer = qMin( minBuffer, w->buffer );
+    }
+    emit bufferStatus( minBuffer );
+}
+
+
+void K3b::CdCopyJob::slotWriterDeviceBuffer( int b )
+{
+    if( !d->fanOut ) {
+        emit deviceBuffer( b );
+        return;
+    }
+
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) ) {
+        w->deviceBuffer = b;
+        w->minDeviceBuffer = qMin( w->minDeviceBuffer, b );
+    }
+
+    int minBuffer = 100;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        if( w->running )
+            minBuffer = qMin( minBuffer, w->deviceBuffer );
+    }
+    emit deviceBuffer( minBuffer );
+}
+
+
+void K3b::CdCopyJob::slotWriterWriteSpeed( int speed, K3b::Device::SpeedMultiplicator multiplicator )
+{
+    if( !d->fanOut ) {
+        emit writeSpeed( speed, multiplicator );
+        return;
+    }
+
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) ) {
+        w->writeSpeed = speed;
+        w->speedMultiplicator = multiplicator;
+    }
+
+    // all writers are fed at the speed of the slowest one
+    Private::FanOutWriter* slowest = 0;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        if( w->running && w->writeSpeed > 0 && ( !slowest || w->writeSpeed < slowest->writeSpeed ) )
+            slowest = w;
+    }
+    if( slowest )
+        emit writeSpeed( slowest->writeSpeed, slowest->speedMultiplicator );
+}
+
+
+void K3b::CdCopyJob::slotFanOutSinkError( int sink )
+{
+    if( sink >= 0 && sink < d->fanOutWriters.count() ) {
+        emit infoMessage( i18n("%1: the writer stopped accepting data.", d->fanOutWriters[sink]->name()),
+                          MessageError );
+    }
+}
@@ -23,12 +23,16 @@
 
 #include <KCddb/Kcddb>
 
+#include <QList>
+
 namespace K3b {
     namespace Device {
         class Device;
         class DeviceHandler;
     }
 
+    class CdrecordWriter;
+
 
 /**
  *@author Sebastian Trueg
@@ -55,7 +59,7 @@ namespace K3b {
         void cancel() override;
 
     public:
-        void setWriterDevice( K3b::Device::Device* dev ) { m_writerDevice = dev; }
+        void setWriterDevice( K3b::Device::Device* dev );
         void setReaderDevice( K3b::Device::Device* dev ) { m_readerDevice = dev; }
         void setWritingMode( K3b::WritingMode m ) { m_writingMode = m; }
         void setSpeed( int s ) { m_speed = s; }
@@ -73,6 +77,42 @@ namespace K3b {
         void setCopyCdText( bool b ) { m_copyCdText = b; }
         void setNoCorrection( bool b ) { m_noCorrection = b; }
 
+        /**
+         * Check the EDC and ECC of the data sectors, see DataTrackReader::setCheckEdcEcc().
+         * Ignored when the error correction is disabled since the sectors are
+         * expected to be copied as they are then.
+         */
+        void setCheckEdcEcc( bool b ) { m_checkEdcEcc = b; }
+
+        /**
+         * Read damaged data tracks in rescue mode, see DataTrackReader::setRescueMapFile().
+         * The read error maps are stored next to the images. If the temporary
+         * path is a folder the images are named after the disc id. If reading
+         * fails the images are kept and copying the same disc again with the
+         * same temporary path resumes the rescue instead of asking to overwrite
+         * the images. Ignored when copying on the fly.
+         */
+        void setRescueMode( bool b ) { m_rescueMode = b; }
+
+        /**
+         * Write to several writers at once. The source is only read once and
+         * fed to all writers. Each copy as set via setCopies() is written on
+         * all writers.
+         *
+         * Only single-session sources can be written to several writers.
+         * Multisession sources are only written to the first device.
+         *
+         * The first device is also used as writer(). Setting a single device
+         * is the same as calling setWriterDevice().
+         */
+        void setWriterDevices( const QList<K3b::Device::Device*>& devs );
+
+        /**
+         * The maximum amount of data in bytes a slow writer may lag behind the
+         * fastest writer when writing on the fly to several writers at once.
+         */
+        void setFanOutBufferSize( qint64 bytes );
+
     private Q_SLOTS:
         void slotDiskInfoReady( K3b::Device::DeviceHandler* );
         void slotCdTextReady( K3b::Device::DeviceHandler* );
@@ -86,14 +126,21 @@ namespace K3b {
         void slotReaderSubProgress( int p );
         void slotWriterProgress( int p );
         void slotReaderProcessedSize( int p, int pp );
+        void slotWriterInfoMessage( const QString&, int );
+        void slotWriterBuffer( int );
+        void slotWriterDeviceBuffer( int );
+        void slotWriterWriteSpeed( int, K3b::Device::SpeedMultiplicator );
+        void slotFanOutSinkError( int );
 
     private:
         void startCopy();
         void searchCdText();
         void queryCddb();
         bool writeNextSession();
+        bool prepareWriter( CdrecordWriter* writer, Device::Device* dev );
         void readNextSession();
         bool prepareImageFiles();
+        QString rescueFileName() const;
         void cleanup();
         void finishJob( bool canceled, bool error );
 
@@ -109,6 +156,8 @@ namespace K3b {
         bool m_ignoreDataReadErrors;
         bool m_ignoreAudioReadErrors;
         bool m_noCorrection;
+        bool m_checkEdcEcc;
+        bool m_rescueMode;
         int m_dataReadRetries;
         int m_audioReadRetries;
         bool m_copyCdText;
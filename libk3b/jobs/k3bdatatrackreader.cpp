@@ -17,14 +17,22 @@
 #include "k3blibdvdcss.h"
 #include "k3bdevice.h"
 #include "k3bdeviceglobals.h"
+#include "k3bedcecc.h"
 #include "k3btrack.h"
-#include "k3bthread.h"
 #include "k3bcore.h"
+#include "k3bbufferpool.h"
+#include "k3bmediacache.h"
+#include "k3breaderrormap.h"
+#include "k3bthroughputestimator.h"
+#include "k3bdiskinfo.h"
 #include "k3b_i18n.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 
+#include <string.h>
 #include <unistd.h>
 
 
@@ -32,6 +40,9 @@
 // FIXME: determine max DMA buffer size
 static int s_bufferSizeSectors = 10;
 
+// the read error map is saved at least this often while rescuing
+static const int s_mapSaveInterval = 5000;
+
 
 class K3b::DataTrackReader::Private
 {
@@ -41,6 +52,7 @@ public:
 
     bool ignoreReadErrors;
     bool noCorrection;
+    bool checkEdcEcc;
     int retries;
     K3b::Device::Device* device;
     K3b::Msf firstSector;
@@ -48,25 +60,38 @@ public:
     K3b::Msf nextReadSector;
     QIODevice* ioDevice;
     QString imagePath;
+    QString rescueMapFile;
     ReadSectorSize sectorSize;
     bool useLibdvdcss;
     K3b::LibDvdCss* libcss;
 
+    bool errorRecoverySaved;
     int oldErrorRecoveryMode;
+    int oldReadRetryCount;
 
     int errorSectorCount;
 
     ReadSectorSize usedSectorSize;
+
+    // rescue mode progress
+    int lastRescuePercent;
+    QElapsedTimer mapSaveTimer;
+
+    // raw sectors for the EDC/ECC check
+    bool useEdcEccCheck;
+    BufferPool::Buffer rawBuffer;
 };
 
 
 K3b::DataTrackReader::Private::Private()
     : ignoreReadErrors(false),
       noCorrection(false),
+      checkEdcEcc(false),
       retries(10),
       device(0),
       ioDevice(0),
-      libcss(0)
+      libcss(0),
+      errorRecoverySaved(false)
 {
 }
 
@@ -98,6 +123,12 @@ void K3b::DataTrackReader::setDevice( K3b::Device::Device* dev )
 }
 
 
+K3b::Device::Device* K3b::DataTrackReader::executionDevice() const
+{
+    return d->device;
+}
+
+
 void K3b::DataTrackReader::setSectorRange( const K3b::Msf& start, const K3b::Msf& end )
 {
     d->firstSector = start;
@@ -123,6 +154,18 @@ void K3b::DataTrackReader::setNoCorrection( bool b )
 }
 
 
+void K3b::DataTrackReader::setCheckEdcEcc( bool b )
+{
+    d->checkEdcEcc = b;
+}
+
+
+void K3b::DataTrackReader::setRescueMapFile( const QString& filename )
+{
+    d->rescueMapFile = filename;
+}
+
+
 void K3b::DataTrackReader::writeTo( QIODevice* ioDev )
 {
     d->ioDevice = ioDev;
@@ -153,6 +196,8 @@ bool K3b::DataTrackReader::run()
     //    if impossible or MODE2 (mode2 formless) finish(false)
 
     d->useLibdvdcss = false;
+    d->useEdcEccCheck = false;
+    d->errorRecoverySaved = false;
     d->usedSectorSize = d->sectorSize;
 
     Device::MediaType mediaType = d->device->mediaType();
@@ -218,6 +263,8 @@ bool K3b::DataTrackReader::run()
                 return false;
             }
         }
+
+        d->useEdcEccCheck = d->checkEdcEcc;
     }
 
     emit infoMessage( i18n("Reading with sector size %1.",d->usedSectorSize), K3b::Job::MessageInfo );
@@ -229,10 +276,30 @@ bool K3b::DataTrackReader::run()
                           .arg( d->lastSector.lba() - d->firstSector.lba() + 1 )
                           .arg( quint64(d->usedSectorSize) * (quint64)(d->lastSector.lba() - d->firstSector.lba() + 1) ) );
 
+    //
+    // In rescue mode an interrupted run is resumed if the read error map
+    // matches the sector range and the image has the expected size
+    //
+    const bool rescueMode = ( !d->rescueMapFile.isEmpty() && !d->ioDevice );
+    const qint64 imageSize = qint64( d->lastSector.lba() - d->firstSector.lba() + 1 ) * d->usedSectorSize;
+    ReadErrorMap errorMap;
+    bool resume = false;
+    if( rescueMode ) {
+        resume = ( errorMap.load( d->rescueMapFile ) &&
+                   errorMap.firstSector() == d->firstSector.lba() &&
+                   errorMap.lastSector() == d->lastSector.lba() &&
+                   QFileInfo( d->imagePath ).size() == imageSize );
+        if( resume )
+            emit infoMessage( i18n("Resuming from read error map %1.",d->rescueMapFile), K3b::Job::MessageInfo );
+        else
+            errorMap.reset( d->firstSector.lba(), d->lastSector.lba() );
+    }
+
     QFile file;
     if( !d->ioDevice ) {
         file.setFileName( d->imagePath );
-        if( !file.open( QIODevice::WriteOnly ) ) {
+        if( !file.open( resume ? QIODevice::ReadWrite : QIODevice::WriteOnly ) ||
+            ( rescueMode && !file.resize( imageSize ) ) ) {
             d->device->close();
             if( d->useLibdvdcss )
                 d->libcss->close();
@@ -260,7 +327,12 @@ bool K3b::DataTrackReader::run()
 #else
     s_bufferSizeSectors = 128;
 #endif
-    unsigned char* buffer = new unsigned char[d->usedSectorSize*s_bufferSizeSectors];
+    BufferPool::Buffer readBuffer = BufferPool::instance()->allocate( d->usedSectorSize*s_bufferSizeSectors );
+    unsigned char* buffer = reinterpret_cast<unsigned char*>( readBuffer.data() );
+    if( d->useEdcEccCheck ) {
+        emit infoMessage( i18n("Checking EDC and ECC of all sectors."), K3b::Job::MessageInfo );
+        d->rawBuffer = BufferPool::instance()->allocate( Device::RAW_SECTOR_SIZE*s_bufferSizeSectors );
+    }
     while( s_bufferSizeSectors > 0 && read( buffer, d->firstSector.lba(), s_bufferSizeSectors ) < 0 ) {
         qDebug() << "(K3b::DataTrackReader) determine max read sectors: "
                  << s_bufferSizeSectors << " too high." << endl;
@@ -269,6 +341,10 @@ bool K3b::DataTrackReader::run()
     qDebug() << "(K3b::DataTrackReader) determine max read sectors: "
              << s_bufferSizeSectors << " is max." << endl;
 
+    // an unreadable first sector is no reason to give up in rescue mode
+    if( s_bufferSizeSectors <= 0 && rescueMode )
+        s_bufferSizeSectors = 16;
+
     //    s_bufferSizeSectors = K3b::Device::determineMaxReadingBufferSize( d->device, d->firstSector );
     if( s_bufferSizeSectors <= 0 ) {
         emit infoMessage( i18n("Error while reading sector %1.",d->firstSector.lba()), K3b::Job::MessageError );
@@ -290,7 +366,26 @@ bool K3b::DataTrackReader::run()
     int lastPercent = 0;
     unsigned long lastReadMb = 0;
     int bufferLen = s_bufferSizeSectors*d->usedSectorSize;
-    while( !canceled() && currentSector <= d->lastSector ) {
+
+    //
+    // The estimator lives in this thread. Its signal is delivered to the
+    // reader in the GUI thread through a queued connection.
+    //
+    K3b::ThroughputEstimator speedEst;
+    const K3b::Device::DiskInfo info = k3bcore->mediaCache()->diskInfo( d->device );
+    speedEst.setSpeedProfile( K3b::ThroughputEstimator::SpeedProfile::forMediaType( info.mediaType(),
+                                                                                    info.size().mode1Bytes()/1024 ),
+                              d->firstSector.mode1Bytes()/1024 );
+    speedEst.setTotalSize( (unsigned long)( (quint64)(d->lastSector.lba() - d->firstSector.lba() + 1) * d->usedSectorSize / 1024 ) );
+    connect( &speedEst, SIGNAL(estimatedRemainingTime(int)), this, SIGNAL(remainingTime(int)) );
+    speedEst.reset();
+
+    if( rescueMode ) {
+        readError = !rescue( errorMap, file, buffer, speedEst );
+        totalReadSectors = errorMap.sectors( ReadErrorMap::Finished );
+    }
+
+    while( !rescueMode && !canceled() && currentSector <= d->lastSector ) {
 
         int maxReadSectors = qMin( bufferLen/d->usedSectorSize, d->lastSector.lba()-currentSector.lba()+1 );
 
@@ -340,15 +435,17 @@ bool K3b::DataTrackReader::run()
         int currentPercent = 100 * (currentSector.lba() - d->firstSector.lba() + 1 ) /
                              (d->lastSector.lba() - d->firstSector.lba() + 1 );
 
+        speedEst.dataWritten( (unsigned long)( (quint64)(currentSector.lba() - d->firstSector.lba()) * d->usedSectorSize / 1024 ) );
+
         if( currentPercent > lastPercent ) {
             lastPercent = currentPercent;
-            emit percent( currentPercent );
+            setProgress( currentPercent );
         }
 
         unsigned long readMb = (currentSector.lba() - d->firstSector.lba() + 1) / 512;
         if( readMb > lastReadMb ) {
             lastReadMb = readMb;
-            emit processedSize( readMb, ( d->lastSector.lba() - d->firstSector.lba() + 1 ) / 512 );
+            setProcessedSize( readMb, ( d->lastSector.lba() - d->firstSector.lba() + 1 ) / 512 );
         }
     }
 
@@ -357,7 +454,8 @@ bool K3b::DataTrackReader::run()
                           K3b::Job::MessageError );
 
     // reset the error recovery mode
-    setErrorRecovery( d->device, d->oldErrorRecoveryMode );
+    if( d->errorRecoverySaved )
+        setErrorRecovery( d->device, d->oldErrorRecoveryMode, d->oldReadRetryCount );
 
     d->device->block( false );
     k3bcore->unblockDevice( d->device );
@@ -366,7 +464,7 @@ bool K3b::DataTrackReader::run()
     if( d->useLibdvdcss )
         d->libcss->close();
     d->device->close();
-    delete [] buffer;
+    d->rawBuffer.release();
 
     emit debuggingOutput( "K3b::DataTrackReader",
                           QString("Read a total of %1 sectors (%2 bytes)")
@@ -377,6 +475,201 @@ bool K3b::DataTrackReader::run()
 }
 
 
+//
+// Rescue mode works like GNU ddrescue: the first pass copies as much as
+// possible quickly and skips ahead after read errors, the following passes
+// split the failed areas into single sectors and retry those which are still
+// unreadable. The state of every sector is kept in the read error map which
+// allows to resume an interrupted rescue.
+//
+bool K3b::DataTrackReader::rescue( ReadErrorMap& map, QFile& file, unsigned char* buffer, ThroughputEstimator& speedEst )
+{
+    const int errorRecoveryMode = d->noCorrection ? 0x21 : 0x20;
+    const long total = map.lastSector() - map.firstSector() + 1;
+    const long maxSkip = qMax<long>( s_bufferSizeSectors, total / 100 );
+
+    const Device::MediaTypes mediaType = k3bcore->mediaCache()->diskInfo( d->device ).mediaType();
+    int slowestSpeed = Device::SPEED_FACTOR_CD;
+    if( Device::isDvdMedia( mediaType ) )
+        slowestSpeed = Device::SPEED_FACTOR_DVD;
+    else if( Device::isBdMedia( mediaType ) )
+        slowestSpeed = Device::SPEED_FACTOR_BD;
+
+    d->lastRescuePercent = -1;
+    d->mapSaveTimer.start();
+
+    //
+    // 1. and 2. copy the sectors which have not been tried yet without drive retries
+    //
+    setErrorRecovery( d->device, errorRecoveryMode, 0 );
+    d->device->setSpeed( 0xffff, 0xffff );
+    for( int pass = 1; pass <= 2 && !canceled(); ++pass ) {
+        if( map.sectors( ReadErrorMap::NonTried ) == 0 )
+            continue;
+
+        emit infoMessage( pass == 1
+                          ? i18n("Copying the readable areas of the medium.")
+                          : i18n("Copying the areas skipped after read errors."),
+                          K3b::Job::MessageInfo );
+
+        long skip = 0;
+        long pos = map.firstSector();
+        long start, count;
+        while( !canceled() && map.nextRegion( ReadErrorMap::NonTried, pos, &start, &count ) ) {
+            const int len = qMin<long>( count, s_bufferSizeSectors );
+            if( read( buffer, start, len ) == len ) {
+                if( !writeRescued( file, map, buffer, start, len ) )
+                    return false;
+                map.setStatus( start, len, ReadErrorMap::Finished );
+                skip = 0;
+            }
+            else {
+                map.setStatus( start, len, ReadErrorMap::NonSplit );
+                saveRescueMap( map, true );
+
+                // damaged areas tend to be large, skip ahead exponentially in the first pass
+                if( pass == 1 )
+                    skip = qMin( skip > 0 ? skip*2 : (long)s_bufferSizeSectors, maxSkip );
+            }
+            pos = start + len + skip;
+
+            updateRescueProgress( map, speedEst );
+        }
+    }
+
+    //
+    // 3. split the failed areas into single sectors, read slowly and let the drive retry
+    //
+    if( !canceled() && map.sectors( ReadErrorMap::NonSplit ) > 0 ) {
+        emit infoMessage( i18np("Splitting the area with %1 unreadable sector.",
+                                "Splitting the areas with %1 unreadable sectors.",
+                                map.sectors( ReadErrorMap::NonSplit ) ),
+                          K3b::Job::MessageWarning );
+
+        setErrorRecovery( d->device, errorRecoveryMode, 255 );
+        d->device->setSpeed( slowestSpeed, 0xffff );
+
+        long start, count;
+        while( !canceled() && map.nextRegion( ReadErrorMap::NonSplit, map.firstSector(), &start, &count ) ) {
+            if( read( buffer, start, 1 ) == 1 ) {
+                if( !writeRescued( file, map, buffer, start, 1 ) )
+                    return false;
+                map.setStatus( start, 1, ReadErrorMap::Finished );
+            }
+            else {
+                map.setStatus( start, 1, ReadErrorMap::BadSector );
+                saveRescueMap( map, true );
+            }
+
+            updateRescueProgress( map, speedEst );
+        }
+    }
+
+    //
+    // 4. retry the bad sectors, alternating between the slowest and the fastest speed
+    //
+    for( int retry = 1; retry <= d->retries && !canceled() && map.sectors( ReadErrorMap::BadSector ) > 0; ++retry ) {
+        emit infoMessage( i18n("Retrying %1 bad sectors (attempt %2 of %3).",
+                               map.sectors( ReadErrorMap::BadSector ), retry, d->retries ),
+                          K3b::Job::MessageInfo );
+
+        QVariantMap retryData;
+        retryData.insert( QLatin1String( "sectors" ), (qlonglong)map.sectors( ReadErrorMap::BadSector ) );
+        retryData.insert( QLatin1String( "attempt" ), retry );
+        reportTelemetry( QLatin1String( "rescueRetry" ), retryData );
+
+        if( retry % 2 )
+            d->device->setSpeed( 0xffff, 0xffff );
+        else
+            d->device->setSpeed( slowestSpeed, 0xffff );
+
+        long pos = map.firstSector();
+        long start, count;
+        while( !canceled() && map.nextRegion( ReadErrorMap::BadSector, pos, &start, &count ) ) {
+            if( read( buffer, start, 1 ) == 1 ) {
+                if( !writeRescued( file, map, buffer, start, 1 ) )
+                    return false;
+                map.setStatus( start, 1, ReadErrorMap::Finished );
+                saveRescueMap( map, true );
+            }
+            pos = start + 1;
+        }
+    }
+
+    saveRescueMap( map, true );
+
+    if( canceled() )
+        return false;
+
+    const long badSectors = map.sectors( ReadErrorMap::BadSector );
+    if( badSectors > 0 ) {
+        QVariantMap errorData;
+        errorData.insert( QLatin1String( "sectors" ), (qlonglong)badSectors );
+        errorData.insert( QLatin1String( "ignored" ), d->ignoreReadErrors );
+        reportTelemetry( QLatin1String( "readError" ), errorData );
+
+        if( d->ignoreReadErrors ) {
+            d->errorSectorCount = badSectors;
+        }
+        else {
+            emit infoMessage( i18np("%1 sector could not be read. Reading again resumes from the read error map %2.",
+                                    "%1 sectors could not be read. Reading again resumes from the read error map %2.",
+                                    badSectors, d->rescueMapFile ),
+                              K3b::Job::MessageError );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool K3b::DataTrackReader::writeRescued( QFile& file, const ReadErrorMap& map, const unsigned char* buffer, long sector, int len )
+{
+    const qint64 bytes = qint64( len ) * d->usedSectorSize;
+    if( !file.seek( qint64( sector - map.firstSector() ) * d->usedSectorSize ) ||
+        file.write( reinterpret_cast<const char*>( buffer ), bytes ) != bytes ) {
+        qDebug() << "(K3b::DataTrackReader) error while writing to file " << d->imagePath
+                 << " current sector: " << ( sector - map.firstSector() );
+        emit debuggingOutput( "K3b::DataTrackReader",
+                              QString("Error while writing to file %1. Current sector is %2.")
+                              .arg(d->imagePath).arg(sector - map.firstSector()) );
+        saveRescueMap( map, true );
+        return false;
+    }
+
+    saveRescueMap( map, false );
+    return true;
+}
+
+
+void K3b::DataTrackReader::saveRescueMap( const ReadErrorMap& map, bool force )
+{
+    if( !force && !d->mapSaveTimer.hasExpired( s_mapSaveInterval ) )
+        return;
+
+    if( !map.save( d->rescueMapFile ) )
+        emit debuggingOutput( "K3b::DataTrackReader", QString( "Could not save the read error map %1." ).arg( d->rescueMapFile ) );
+    d->mapSaveTimer.restart();
+}
+
+
+void K3b::DataTrackReader::updateRescueProgress( const ReadErrorMap& map, ThroughputEstimator& speedEst )
+{
+    const long total = map.lastSector() - map.firstSector() + 1;
+    const long done = total - map.sectors( ReadErrorMap::NonTried ) - map.sectors( ReadErrorMap::NonSplit );
+
+    speedEst.dataWritten( (unsigned long)( (quint64)map.sectors( ReadErrorMap::Finished ) * d->usedSectorSize / 1024 ) );
+
+    const int currentPercent = 100 * done / total;
+    if( currentPercent > d->lastRescuePercent ) {
+        d->lastRescuePercent = currentPercent;
+        setProgress( currentPercent );
+        setProcessedSize( done / 512, total / 512 );
+    }
+}
+
+
 int K3b::DataTrackReader::read( unsigned char* buffer, unsigned long sector, unsigned int len )
 {
     //
@@ -386,6 +679,13 @@ int K3b::DataTrackReader::read( unsigned char* buffer, unsigned long sector, uns
         return d->libcss->readWrapped( reinterpret_cast<void*>(buffer), sector, len );
     }
 
+    //
+    // Raw reading with EDC/ECC check
+    //
+    else if( d->useEdcEccCheck ) {
+        return readChecked( buffer, sector, len );
+    }
+
     //
     // Standard reading
     //
@@ -418,12 +718,50 @@ int K3b::DataTrackReader::read( unsigned char* buffer, unsigned long sector, uns
 }
 
 
+int K3b::DataTrackReader::readChecked( unsigned char* buffer, unsigned long sector, unsigned int len )
+{
+    unsigned char* raw = reinterpret_cast<unsigned char*>( d->rawBuffer.data() );
+    if( !d->device->readCd( raw,
+                            len*Device::RAW_SECTOR_SIZE,
+                            0,     // all sector types
+                            false, // no dap
+                            sector,
+                            len,
+                            true,  // sync
+                            true,  // header
+                            true,  // subheader
+                            true,  // user data
+                            true,  // edc/ecc
+                            0,     // no c2 error info
+                            0 ) )  // no subchannel data
+        return -1;
+
+    for( unsigned int i = 0; i < len; ++i ) {
+        const unsigned char* rawSector = raw + i*Device::RAW_SECTOR_SIZE;
+        if( !Device::checkSector( rawSector ) ) {
+            emit debuggingOutput( "K3b::DataTrackReader", QString( "EDC/ECC mismatch in sector %1." ).arg( sector + i ) );
+            return -1;
+        }
+
+        // the user data including the subheader follows the sync pattern and the header
+        ::memcpy( buffer + i*d->usedSectorSize, rawSector + 16, d->usedSectorSize );
+    }
+
+    return len;
+}
+
+
 // here we read every single sector for itself to find the troubling ones
 bool K3b::DataTrackReader::retryRead( unsigned char* buffer, unsigned long startSector, unsigned int len )
 {
     emit debuggingOutput( "K3b::DataTrackReader", QString( "Problem while reading. Retrying from sector %1.").arg(startSector) );
     emit infoMessage( i18n("Problem while reading. Retrying from sector %1.",startSector), K3b::Job::MessageWarning );
 
+    QVariantMap retryData;
+    retryData.insert( QLatin1String( "sector" ), (qulonglong)startSector );
+    retryData.insert( QLatin1String( "length" ), len );
+    reportTelemetry( QLatin1String( "readRetry" ), retryData );
+
     int sectorsRead = -1;
     bool success = true;
     for( unsigned long sector = startSector; sector < startSector+len; ++sector ) {
@@ -437,6 +775,12 @@ bool K3b::DataTrackReader::retryRead( unsigned char* buffer, unsigned long start
             return false;
 
         if( !success ) {
+            QVariantMap errorData;
+            errorData.insert( QLatin1String( "sector" ), (qulonglong)sector );
+            errorData.insert( QLatin1String( "retries" ), d->retries );
+            errorData.insert( QLatin1String( "ignored" ), d->ignoreReadErrors );
+            reportTelemetry( QLatin1String( "readError" ), errorData );
+
             if( d->ignoreReadErrors ) {
                 emit infoMessage( i18n("Ignoring read error in sector %1.",sector), K3b::Job::MessageError );
                 emit debuggingOutput( "K3b::DataTrackReader", QString( "Ignoring read error in sector %1.").arg(sector) );
@@ -457,7 +801,7 @@ bool K3b::DataTrackReader::retryRead( unsigned char* buffer, unsigned long start
 }
 
 
-bool K3b::DataTrackReader::setErrorRecovery( K3b::Device::Device* dev, int code )
+bool K3b::DataTrackReader::setErrorRecovery( K3b::Device::Device* dev, int code, int readRetryCount )
 {
     Device::UByteArray data;
     if( !dev->modeSense( data, 0x01 ) )
@@ -469,11 +813,19 @@ bool K3b::DataTrackReader::setErrorRecovery( K3b::Device::Device* dev, int code
         return false;
     }
 
-    d->oldErrorRecoveryMode = data[8+2];
+    // remember the original settings only once, they are restored in the end
+    if( !d->errorRecoverySaved ) {
+        d->oldErrorRecoveryMode = data[8+2];
+        d->oldReadRetryCount = data[8+3];
+        d->errorRecoverySaved = true;
+    }
+
+    if( data[8+2] != code )
+        qDebug() << "(K3b::DataTrackReader) changing data recovery mode from " << int( data[8+2] ) << " to " << code;
     data[8+2] = code;
 
-    if( d->oldErrorRecoveryMode != code )
-        qDebug() << "(K3b::DataTrackReader) changing data recovery mode from " << d->oldErrorRecoveryMode << " to " << code;
+    if( readRetryCount >= 0 )
+        data[8+3] = readRetryCount;
 
     bool success = dev->modeSelect( data, true, false );
 
@@ -20,6 +20,7 @@
 #include "k3bglobals.h"
 #include "k3bmsf.h"
 
+class QFile;
 class QIODevice;
 
 namespace K3b {
@@ -27,6 +28,9 @@ namespace K3b {
         class Device;
     }
 
+    class ReadErrorMap;
+    class ThroughputEstimator;
+
     /**
      * This is a replacement for readcd. We need this since
      * it is not possible to influence the sector size used
@@ -75,14 +79,46 @@ namespace K3b {
 
         void setNoCorrection( bool b );
 
+        /**
+         * If true CD sectors are read in raw mode and their EDC and ECC are
+         * checked before the user data is written. Sectors which fail the
+         * check are handled like unreadable sectors. Ignored for DVD and
+         * Blu-ray media.
+         */
+        void setCheckEdcEcc( bool b );
+
+        /**
+         * Enables rescue mode for damaged media. Instead of failing on the
+         * first unreadable area the reader copies everything readable first
+         * and then retries the bad areas sector by sector with different
+         * speeds and error recovery settings. The state of every sector is
+         * stored in \p filename which allows to resume an interrupted or
+         * failed rescue into the same image.
+         *
+         * Only used when writing to an image file, not with writeTo().
+         * An empty filename disables rescue mode.
+         */
+        void setRescueMapFile( const QString& filename );
+
         void writeTo( QIODevice* ioDev );
 
     private:
         bool run() override;
+        Device::Device* executionDevice() const override;
 
         int read( unsigned char* buffer, unsigned long sector, unsigned int len );
+        int readChecked( unsigned char* buffer, unsigned long sector, unsigned int len );
         bool retryRead( unsigned char* buffer, unsigned long startSector, unsigned int len );
-        bool setErrorRecovery( Device::Device* dev, int code );
+        bool rescue( ReadErrorMap& map, QFile& file, unsigned char* buffer, ThroughputEstimator& speedEst );
+        bool writeRescued( QFile& file, const ReadErrorMap& map, const unsigned char* buffer, long sector, int len );
+        void saveRescueMap( const ReadErrorMap& map, bool force );
+        void updateRescueProgress( const ReadErrorMap& map, ThroughputEstimator& speedEst );
+
+        /**
+         * Sets the error recovery parameters of mode page 0x01. A negative
+         * \p readRetryCount keeps the drive's current setting.
+         */
+        bool setErrorRecovery( Device::Device* dev, int code, int readRetryCount = -1 );
 
         class Private;
         Private* const d;
@@ -31,6 +31,7 @@
 #include "k3biso9660.h"
 #include "k3bfilesplitter.h"
 #include "k3bchecksumpipe.h"
+#include "k3bfanoutpipe.h"
 #include "k3bverificationjob.h"
 #include "k3bglobalsettings.h"
 #include "k3b_i18n.h"
@@ -40,6 +41,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QStringList>
 
 
 class K3b::DvdCopyJob::Private
@@ -54,10 +56,15 @@ public:
           dataTrackReader(0),
           verificationJob(0),
           usedWritingMode(K3b::WritingModeAuto),
-          verifyData(false) {
+          verifyData(false),
+          fanOut(false) {
         outPipe.readFrom( &imageFile, true );
     }
 
+    ~Private() {
+        qDeleteAll( fanOutWriters );
+    }
+
     K3b::WritingApp usedWritingApp;
 
     int doneCopies;
@@ -83,6 +90,60 @@ public:
     K3b::ActivePipe outPipe;
 
     bool verifyData;
+
+    //
+    // Writing to several writers at once
+    //
+    class FanOutWriter
+    {
+    public:
+        FanOutWriter( K3b::Device::Device* dev )
+            : device( dev ),
+              usedWritingMode( K3b::WritingModeAuto ),
+              writerJob( 0 ),
+              verificationJob( 0 ),
+              percent( 0 ),
+              buffer( 100 ),
+              deviceBuffer( 100 ),
+              minDeviceBuffer( 100 ),
+              running( false ),
+              success( false ) {
+        }
+
+        ~FanOutWriter() {
+            delete writerJob;
+            delete verificationJob;
+        }
+
+        QString name() const {
+            return device->vendor() + ' ' + device->description();
+        }
+
+        K3b::Device::Device* device;
+        K3b::WritingMode usedWritingMode;
+        K3b::AbstractWriter* writerJob;
+        K3b::VerificationJob* verificationJob;
+
+        int percent;
+        int buffer;
+        int deviceBuffer;
+        int minDeviceBuffer;
+        bool running;
+        bool success;
+    };
+
+    FanOutWriter* fanOutWriter( QObject* job ) const {
+        for( int i = 0; i < fanOutWriters.count(); ++i ) {
+            if( fanOutWriters[i]->writerJob == job || fanOutWriters[i]->verificationJob == job )
+                return fanOutWriters[i];
+        }
+        return 0;
+    }
+
+    bool fanOut;
+    QList<K3b::Device::Device*> writerDevices;
+    QList<FanOutWriter*> fanOutWriters;
+    K3b::FanOutPipe fanOutPipe;
 };
 
 
@@ -101,6 +162,7 @@ K3b::DvdCopyJob::DvdCopyJob( K3b::JobHandler* hdl, QObject* parent )
       m_writingMode( K3b::WritingModeAuto )
 {
     d = new Private();
+    connect( &d->fanOutPipe, SIGNAL(sinkError(int)), this, SLOT(slotFanOutSinkError(int)) );
 }
 
 
@@ -118,6 +180,22 @@ void K3b::DvdCopyJob::start()
     d->canceled = false;
     d->running = true;
     d->readerRunning = d->writerRunning = false;
+    d->doneCopies = 0;
+
+    qDeleteAll( d->fanOutWriters );
+    d->fanOutWriters.clear();
+    d->fanOut = ( !m_onlyCreateImage && d->writerDevices.count() > 1 );
+    if( d->fanOut ) {
+        if( m_onTheFly && d->writerDevices.contains( m_readerDevice ) ) {
+            emit infoMessage( i18n("The source device cannot be used as a writer when copying on-the-fly to several writers."), MessageError );
+            d->running = false;
+            jobFinished( false );
+            return;
+        }
+        Q_FOREACH( K3b::Device::Device* dev, d->writerDevices ) {
+            d->fanOutWriters.append( new Private::FanOutWriter( dev ) );
+        }
+    }
 
     emit newTask( i18n("Checking Source Medium") );
 
@@ -238,7 +316,12 @@ void K3b::DvdCopyJob::slotDiskInfoReady( K3b::Device::DeviceHandler* dh )
             if( !m_onlyCreateImage ) {
                 if( dh->diskInfo().numLayers() > 1 &&
                     dh->diskInfo().size() > MediaSizeDvd4Gb ) {
-                    if( !(m_writerDevice->type() & (K3b::Device::DEVICE_DVD_R_DL|K3b::Device::DEVICE_DVD_PLUS_R_DL)) ) {
+                    bool writersSupportDl = ( m_writerDevice->type() & (K3b::Device::DEVICE_DVD_R_DL|K3b::Device::DEVICE_DVD_PLUS_R_DL) );
+                    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+                        if( !(w->device->type() & (K3b::Device::DEVICE_DVD_R_DL|K3b::Device::DEVICE_DVD_PLUS_R_DL)) )
+                            writersSupportDl = false;
+                    }
+                    if( !writersSupportDl ) {
                         emit infoMessage( i18n("The writer does not support writing Double Layer DVDs."), MessageError );
                         d->running = false;
                         jobFinished(false);
@@ -379,6 +462,15 @@ void K3b::DvdCopyJob::slotDiskInfoReady( K3b::Device::DeviceHandler* dh )
         if( m_onlyCreateImage || !m_onTheFly ) {
             emit newTask( i18n("Creating image") );
         }
+        else if( m_onTheFly && d->fanOut ) {
+            if( !startFanOutWriters() ) {
+                if( d->canceled )
+                    emit canceled();
+                jobFinished(false);
+                d->running = false;
+                return;
+            }
+        }
         else if( m_onTheFly && !m_onlyCreateImage ) {
             if( waitForDvd() ) {
                 prepareWriter();
@@ -419,8 +511,15 @@ void K3b::DvdCopyJob::cancel()
             d->writerJob->cancel();
         if ( d->verificationJob && d->verificationJob->active() )
             d->verificationJob->cancel();
+        Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+            if( w->running )
+                w->writerJob->cancel();
+            if( w->verificationJob && w->verificationJob->active() )
+                w->verificationJob->cancel();
+        }
         d->inPipe.close();
         d->outPipe.close();
+        d->fanOutPipe.abort();
         d->imageFile.close();
     }
     else {
@@ -447,7 +546,9 @@ void K3b::DvdCopyJob::prepareReader()
     d->dataTrackReader->setRetries( m_readRetries );
     d->dataTrackReader->setSectorRange( 0, d->lastSector );
 
-    if( m_onTheFly && !m_onlyCreateImage )
+    if( m_onTheFly && d->fanOut )
+        d->inPipe.writeTo( &d->fanOutPipe, true );
+    else if( m_onTheFly && !m_onlyCreateImage )
         // there are several uses of pipe->writeTo( d->writerJob->ioDevice(), ... ) in this file!
 #ifdef __GNUC__
 #warning Growisofs needs stdin to be closed in order to exit gracefully. Cdrecord does not. However,  if closed with cdrecord we loose parts of stderr. Why?
@@ -466,13 +567,32 @@ void K3b::DvdCopyJob::prepareWriter()
 {
     delete d->writerJob;
 
+    d->writerJob = createWriter( m_writerDevice, d->usedWritingMode );
+
+    connect( d->writerJob, SIGNAL(infoMessage(QString,int)), this, SIGNAL(infoMessage(QString,int)) );
+    connect( d->writerJob, SIGNAL(percent(int)), this, SLOT(slotWriterProgress(int)) );
+    connect( d->writerJob, SIGNAL(processedSize(int,int)), this, SIGNAL(processedSize(int,int)) );
+    connect( d->writerJob, SIGNAL(processedSubSize(int,int)), this, SIGNAL(processedSubSize(int,int)) );
+    connect( d->writerJob, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
+    connect( d->writerJob, SIGNAL(deviceBuffer(int)), this, SIGNAL(deviceBuffer(int)) );
+    connect( d->writerJob, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)) );
+    connect( d->writerJob, SIGNAL(finished(bool)), this, SLOT(slotWriterFinished(bool)) );
+    //  connect( d->writerJob, SIGNAL(newTask(QString)), this, SIGNAL(newTask(QString)) );
+    connect( d->writerJob, SIGNAL(newSubTask(QString)), this, SIGNAL(newSubTask(QString)) );
+    connect( d->writerJob, SIGNAL(debuggingOutput(QString,QString)),
+             this, SIGNAL(debuggingOutput(QString,QString)) );
+}
+
+
+K3b::AbstractWriter* K3b::DvdCopyJob::createWriter( K3b::Device::Device* dev, K3b::WritingMode usedWritingMode )
+{
     if ( d->usedWritingApp == K3b::WritingAppGrowisofs ) {
-        K3b::GrowisofsWriter* job = new K3b::GrowisofsWriter( m_writerDevice, this, this );
+        K3b::GrowisofsWriter* job = new K3b::GrowisofsWriter( dev, this, this );
 
         // these do only make sense with DVD-R(W)
         job->setSimulate( m_simulate );
         job->setBurnSpeed( m_speed );
-        job->setWritingMode( d->usedWritingMode );
+        job->setWritingMode( usedWritingMode );
         job->setCloseDvd( true );
 
         //
@@ -490,35 +610,21 @@ void K3b::DvdCopyJob::prepareWriter()
 
         job->setImageToWrite( QString() ); // write to stdin
 
-        d->writerJob = job;
+        return job;
     }
 
     else {
-        K3b::CdrecordWriter* writer = new K3b::CdrecordWriter( m_writerDevice, this, this );
+        K3b::CdrecordWriter* writer = new K3b::CdrecordWriter( dev, this, this );
 
-        writer->setWritingMode( d->usedWritingMode );
+        writer->setWritingMode( usedWritingMode );
         writer->setSimulate( m_simulate );
         writer->setBurnSpeed( m_speed );
 
         writer->addArgument( "-data" );
         writer->addArgument( QString("-tsize=%1s").arg( d->lastSector.lba()+1 ) )->addArgument("-");
 
-        d->writerJob = writer;
+        return writer;
     }
-
-
-    connect( d->writerJob, SIGNAL(infoMessage(QString,int)), this, SIGNAL(infoMessage(QString,int)) );
-    connect( d->writerJob, SIGNAL(percent(int)), this, SLOT(slotWriterProgress(int)) );
-    connect( d->writerJob, SIGNAL(processedSize(int,int)), this, SIGNAL(processedSize(int,int)) );
-    connect( d->writerJob, SIGNAL(processedSubSize(int,int)), this, SIGNAL(processedSubSize(int,int)) );
-    connect( d->writerJob, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
-    connect( d->writerJob, SIGNAL(deviceBuffer(int)), this, SIGNAL(deviceBuffer(int)) );
-    connect( d->writerJob, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)) );
-    connect( d->writerJob, SIGNAL(finished(bool)), this, SLOT(slotWriterFinished(bool)) );
-    //  connect( d->writerJob, SIGNAL(newTask(QString)), this, SIGNAL(newTask(QString)) );
-    connect( d->writerJob, SIGNAL(newSubTask(QString)), this, SIGNAL(newSubTask(QString)) );
-    connect( d->writerJob, SIGNAL(debuggingOutput(QString,QString)),
-             this, SIGNAL(debuggingOutput(QString,QString)) );
 }
 
 
@@ -527,7 +633,7 @@ void K3b::DvdCopyJob::slotReaderProgress( int p )
     if( !m_onTheFly || m_onlyCreateImage ) {
         emit subPercent( p );
 
-        int bigParts = ( m_onlyCreateImage ? 1 : (m_simulate ? 2 : ( d->verifyData ? m_copies*2 : m_copies ) + 1 ) );
+        int bigParts = ( m_onlyCreateImage ? 1 : (m_simulate ? 2 : ( d->verifyData && !d->fanOut ? m_copies*2 : m_copies ) + 1 ) );
         emit percent( p/bigParts );
     }
 }
@@ -583,7 +689,8 @@ void K3b::DvdCopyJob::slotReaderFinished( bool success )
             d->running = false;
         }
         else {
-            if( m_writerDevice == m_readerDevice ) {
+            if( m_writerDevice == m_readerDevice ||
+                ( d->fanOut && d->writerDevices.contains( m_readerDevice ) ) ) {
                 // eject the media (we do this blocking to know if it worked
                 // because if it did not it might happen that k3b overwrites a CD-RW
                 // source)
@@ -593,7 +700,28 @@ void K3b::DvdCopyJob::slotReaderFinished( bool success )
                 }
             }
 
-            if( !m_onTheFly ) {
+            if( m_onTheFly && d->fanOut ) {
+                // let the writers have the remaining data
+                d->fanOutPipe.close();
+            }
+            else if( !m_onTheFly && d->fanOut ) {
+
+                d->imageFile.close();
+
+                if( startFanOutWriters() ) {
+                    d->outPipe.writeTo( &d->fanOutPipe, true );
+                    d->outPipe.open( true );
+                }
+                else {
+                    if( m_removeImageFiles )
+                        removeImageFiles();
+                    if( d->canceled )
+                        emit canceled();
+                    jobFinished(false);
+                    d->running = false;
+                }
+            }
+            else if( !m_onTheFly ) {
 
                 d->imageFile.close();
 
@@ -626,6 +754,13 @@ void K3b::DvdCopyJob::slotReaderFinished( bool success )
         }
     }
     else {
+        if( d->fanOut ) {
+            Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+                if( w->running )
+                    w->writerJob->cancel();
+            }
+            d->fanOutPipe.abort();
+        }
         removeImageFiles();
         jobFinished(false);
         d->running = false;
@@ -790,6 +925,12 @@ void K3b::DvdCopyJob::slotVerificationFinished( bool success )
 // this is basically the same code as in K3b::DvdJob... :(
 // perhaps this should be moved to some K3b::GrowisofsHandler which also parses the growisofs output?
 bool K3b::DvdCopyJob::waitForDvd()
+{
+    return waitForDvd( m_writerDevice, &d->usedWritingMode );
+}
+
+
+bool K3b::DvdCopyJob::waitForDvd( K3b::Device::Device* writer, K3b::WritingMode* usedWritingMode )
 {
     if ( !K3b::Device::isDvdMedia( d->sourceDiskInfo.mediaType() ) &&
          !K3b::Device::isBdMedia( d->sourceDiskInfo.mediaType() ) ) {
@@ -798,7 +939,7 @@ bool K3b::DvdCopyJob::waitForDvd()
         return false;
     }
 
-    Device::MediaType m = waitForMedium( m_writerDevice,
+    Device::MediaType m = waitForMedium( writer,
                                          K3b::Device::STATE_EMPTY,
                                          Device::MEDIA_WRITABLE_DVD|Device::MEDIA_WRITABLE_BD,
                                          d->sourceDiskInfo.size() );
@@ -815,9 +956,9 @@ bool K3b::DvdCopyJob::waitForDvd()
         if( m & K3b::Device::MEDIA_DVD_PLUS_ALL ) {
 
             if ( m & ( Device::MEDIA_DVD_PLUS_R|Device::MEDIA_DVD_PLUS_R_DL ) )
-                d->usedWritingMode = K3b::WritingModeSao;
+                *usedWritingMode = K3b::WritingModeSao;
             else
-                d->usedWritingMode = K3b::WritingModeRestrictedOverwrite;
+                *usedWritingMode = K3b::WritingModeRestrictedOverwrite;
 
             if( m_simulate ) {
                 if( !questionYesNo( i18n("%1 media do not support write simulation. "
@@ -842,12 +983,12 @@ bool K3b::DvdCopyJob::waitForDvd()
         // DVD Minus
         // -------------------------------
         else if ( m & K3b::Device::MEDIA_DVD_MINUS_ALL ) {
-            if( m_simulate && !m_writerDevice->dvdMinusTestwrite() ) {
+            if( m_simulate && !writer->dvdMinusTestwrite() ) {
                 if( !questionYesNo( i18n("Your writer (%1 %2) does not support simulation with DVD-R(W) media. "
                                          "Do you really want to continue? The media will actually be "
                                          "written to.",
-                                         m_writerDevice->vendor(),
-                                         m_writerDevice->description()),
+                                         writer->vendor(),
+                                         writer->description()),
                                     i18n("No Simulation with DVD-R(W)") ) ) {
                     cancel();
                     return false;
@@ -870,7 +1011,7 @@ bool K3b::DvdCopyJob::waitForDvd()
 
             if( m & K3b::Device::MEDIA_DVD_RW_OVWR ) {
                 emit infoMessage( i18n("Writing DVD-RW in restricted overwrite mode."), MessageInfo );
-                d->usedWritingMode = K3b::WritingModeRestrictedOverwrite;
+                *usedWritingMode = K3b::WritingModeRestrictedOverwrite;
             }
             else if( m & (K3b::Device::MEDIA_DVD_RW_SEQ|
                           K3b::Device::MEDIA_DVD_RW) ) {
@@ -878,11 +1019,11 @@ bool K3b::DvdCopyJob::waitForDvd()
 // 	    ( m_writingMode ==  K3b::WritingModeAuto &&
 // 	      ( sizeWithDao || !m_onTheFly ) ) ) {
                     emit infoMessage( i18n("Writing DVD-RW in DAO mode."), MessageInfo );
-                    d->usedWritingMode = K3b::WritingModeSao;
+                    *usedWritingMode = K3b::WritingModeSao;
                 }
                 else {
                     emit infoMessage( i18n("Writing DVD-RW in incremental mode."), MessageInfo );
-                    d->usedWritingMode = K3b::WritingModeIncrementalSequential;
+                    *usedWritingMode = K3b::WritingModeIncrementalSequential;
                 }
             }
             else {
@@ -896,11 +1037,11 @@ bool K3b::DvdCopyJob::waitForDvd()
 // 	    ( m_writingMode ==  K3b::WritingModeAuto &&
 // 	      ( sizeWithDao || !m_onTheFly ) ) ) {
                     emit infoMessage( i18n("Writing %1 in DAO mode.",K3b::Device::mediaTypeString(m, true) ), MessageInfo );
-                    d->usedWritingMode = K3b::WritingModeSao;
+                    *usedWritingMode = K3b::WritingModeSao;
                 }
                 else {
                     emit infoMessage( i18n("Writing %1 in incremental mode.",K3b::Device::mediaTypeString(m, true) ), MessageInfo );
-                    d->usedWritingMode = K3b::WritingModeIncrementalSequential;
+                    *usedWritingMode = K3b::WritingModeIncrementalSequential;
                 }
             }
         }
@@ -910,7 +1051,7 @@ bool K3b::DvdCopyJob::waitForDvd()
         // Blu-ray
         // -------------------------------
         else {
-            d->usedWritingMode = K3b::WritingModeSao;
+            *usedWritingMode = K3b::WritingModeSao;
 
             if( m_simulate ) {
                 if( !questionYesNo( i18n("%1 media do not support write simulation. "
@@ -959,9 +1100,12 @@ QString K3b::DvdCopyJob::jobDescription() const
 
 QString K3b::DvdCopyJob::jobDetails() const
 {
+    int copies = (m_simulate||m_onlyCreateImage) ? 1 : m_copies;
+    if( !m_onlyCreateImage && d->writerDevices.count() > 1 )
+        copies *= d->writerDevices.count();
     return i18np("Creating 1 copy",
                  "Creating %1 copies",
-                 (m_simulate||m_onlyCreateImage) ? 1 : m_copies );
+                 copies );
 }
 
 
@@ -976,7 +1120,14 @@ QString K3b::DvdCopyJob::jobSource() const
 
 QString K3b::DvdCopyJob::jobTarget() const
 {
-    if( Device::Device* device = writer() )
+    if( !m_onlyCreateImage && d->writerDevices.count() > 1 ) {
+        QStringList names;
+        Q_FOREACH( Device::Device* device, d->writerDevices ) {
+            names << device->vendor() + ' ' + device->description();
+        }
+        return names.join( QLatin1String( ", " ) );
+    }
+    else if( Device::Device* device = writer() )
         return device->vendor() + ' ' + device->description();
     else
         return m_imagePath;
@@ -989,3 +1140,287 @@ void K3b::DvdCopyJob::setVerifyData( bool b )
 }
 
 
+
+
+void K3b::DvdCopyJob::setWriterDevice( K3b::Device::Device* w )
+{
+    m_writerDevice = w;
+    d->writerDevices.clear();
+}
+
+
+void K3b::DvdCopyJob::setWriterDevices( const QList<K3b::Device::Device*>& devs )
+{
+    d->writerDevices = devs;
+    m_writerDevice = ( devs.isEmpty() ? 0 : devs.first() );
+}
+
+
+void K3b::DvdCopyJob::setFanOutBufferSize( qint64 bytes )
+{
+    d->fanOutPipe.setBufferSize( bytes );
+}
+
+
+bool K3b::DvdCopyJob::startFanOutWriters()
+{
+    //
+    // Wait for a medium in every writer before starting any of them. Otherwise
+    // the first writer would run out of data while we wait for the others.
+    //
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        emit newSubTask( i18n("Waiting for medium in %1", w->name()) );
+        if( !waitForDvd( w->device, &w->usedWritingMode ) )
+            return false;
+    }
+
+    if( m_simulate )
+        emit newTask( i18n("Simulating copy") );
+    else if( m_copies > 1 )
+        emit newTask( i18np("Writing copy %2 on 1 writer", "Writing copy %2 on %1 writers",
+                            d->fanOutWriters.count(), d->doneCopies+1) );
+    else
+        emit newTask( i18np("Writing copy on 1 writer", "Writing copies on %1 writers",
+                            d->fanOutWriters.count()) );
+
+    emit burning(true);
+
+    d->fanOutPipe.clearSinks();
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        delete w->writerJob;
+        w->writerJob = createWriter( w->device, w->usedWritingMode );
+
+        connect( w->writerJob, SIGNAL(infoMessage(QString,int)), this, SLOT(slotFanOutWriterInfoMessage(QString,int)) );
+        connect( w->writerJob, SIGNAL(percent(int)), this, SLOT(slotFanOutWriterProgress(int)) );
+        connect( w->writerJob, SIGNAL(buffer(int)), this, SLOT(slotFanOutWriterBuffer(int)) );
+        connect( w->writerJob, SIGNAL(deviceBuffer(int)), this, SLOT(slotFanOutWriterDeviceBuffer(int)) );
+        connect( w->writerJob, SIGNAL(finished(bool)), this, SLOT(slotFanOutWriterFinished(bool)) );
+        connect( w->writerJob, SIGNAL(debuggingOutput(QString,QString)),
+                 this, SIGNAL(debuggingOutput(QString,QString)) );
+
+        w->percent = 0;
+        w->buffer = w->deviceBuffer = w->minDeviceBuffer = 100;
+        w->success = false;
+        w->running = true;
+        w->writerJob->start();
+
+        d->fanOutPipe.addSink( w->writerJob->ioDevice(), d->usedWritingApp == K3b::WritingAppGrowisofs );
+    }
+
+    if( !d->fanOutPipe.open() ) {
+        emit infoMessage( i18n("Unable to feed the writers."), MessageError );
+        cancel();
+        return false;
+    }
+
+    return true;
+}
+
+
+void K3b::DvdCopyJob::slotFanOutWriterProgress( int p )
+{
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) )
+        w->percent = p;
+
+    emitFanOutProgress();
+}
+
+
+void K3b::DvdCopyJob::slotFanOutVerificationProgress( int p )
+{
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) )
+        w->percent = 100 + p;
+
+    emitFanOutProgress();
+}
+
+
+void K3b::DvdCopyJob::emitFanOutProgress()
+{
+    // every writer contributes the same part to the overall progress
+    const int writerParts = ( d->verifyData && !m_simulate ? 2 : 1 );
+    int sum = 0;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        sum += w->percent;
+    }
+    const int roundPercent = sum / d->fanOutWriters.count() / writerParts;
+
+    int bigParts = ( m_simulate ? 1 : m_copies ) + ( m_onTheFly ? 0 : 1 );
+    int doneParts = ( m_simulate ? 0 : d->doneCopies ) + ( m_onTheFly ? 0 : 1 );
+    emit percent( 100*doneParts/bigParts + roundPercent/bigParts );
+
+    emit subPercent( roundPercent );
+}
+
+
+void K3b::DvdCopyJob::slotFanOutWriterBuffer( int b )
+{
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) )
+        w->buffer = b;
+
+    // the slowest writer is the interesting one
+    int minBuffer = 100;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        if( w->running )
+            minBuffer = qMin( minBuffer, w->buffer );
+    }
+    emit bufferStatus( minBuffer );
+}
+
+
+void K3b::DvdCopyJob::slotFanOutWriterDeviceBuffer( int b )
+{
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) ) {
+        w->deviceBuffer = b;
+        w->minDeviceBuffer = qMin( w->minDeviceBuffer, b );
+    }
+
+    int minBuffer = 100;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        if( w->running )
+            minBuffer = qMin( minBuffer, w->deviceBuffer );
+    }
+    emit deviceBuffer( minBuffer );
+}
+
+
+void K3b::DvdCopyJob::slotFanOutWriterInfoMessage( const QString& message, int type )
+{
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) )
+        emit infoMessage( QString( "%1: %2" ).arg( w->name() ).arg( message ), type );
+    else
+        emit infoMessage( message, type );
+}
+
+
+void K3b::DvdCopyJob::slotFanOutSinkError( int sink )
+{
+    if( sink >= 0 && sink < d->fanOutWriters.count() ) {
+        emit infoMessage( i18n("%1: the writer stopped accepting data.", d->fanOutWriters[sink]->name()),
+                          MessageError );
+    }
+}
+
+
+void K3b::DvdCopyJob::slotFanOutWriterFinished( bool success )
+{
+    Private::FanOutWriter* w = d->fanOutWriter( sender() );
+    if( !w )
+        return;
+
+    w->running = false;
+    w->success = success;
+    w->percent = 100;
+
+    const int sink = d->fanOutWriters.indexOf( w );
+    emit infoMessage( i18n("%1: lowest device buffer fill level %2%, waited for the writer %3 times.",
+                           w->name(), w->minDeviceBuffer, d->fanOutPipe.stalls( sink ) ),
+                      MessageInfo );
+
+    if( success && !d->canceled ) {
+        emit infoMessage( i18n("%1: successfully written copy %2.", w->name(), d->doneCopies+1), MessageInfo );
+
+        if( d->verifyData && !m_simulate ) {
+            if( !w->verificationJob ) {
+                w->verificationJob = new K3b::VerificationJob( this, this );
+                connect( w->verificationJob, SIGNAL(infoMessage(QString,int)),
+                         this, SLOT(slotFanOutWriterInfoMessage(QString,int)) );
+                connect( w->verificationJob, SIGNAL(percent(int)),
+                         this, SLOT(slotFanOutVerificationProgress(int)) );
+                connect( w->verificationJob, SIGNAL(finished(bool)),
+                         this, SLOT(slotFanOutVerificationFinished(bool)) );
+                connect( w->verificationJob, SIGNAL(debuggingOutput(QString,QString)),
+                         this, SIGNAL(debuggingOutput(QString,QString)) );
+            }
+            w->verificationJob->clear();
+            w->verificationJob->setDevice( w->device );
+            w->verificationJob->addTrack( 1, d->inPipe.checksum(), d->lastSector+1 );
+            w->verificationJob->start();
+            return;
+        }
+    }
+
+    fanOutCopyDone();
+}
+
+
+void K3b::DvdCopyJob::slotFanOutVerificationFinished( bool success )
+{
+    if( Private::FanOutWriter* w = d->fanOutWriter( sender() ) ) {
+        w->success = w->success && success;
+        w->percent = 200;
+    }
+
+    fanOutCopyDone();
+}
+
+
+void K3b::DvdCopyJob::fanOutCopyDone()
+{
+    // wait for all writers and verifications of this round
+    int successfulWriters = 0;
+    Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+        if( w->running || ( w->verificationJob && w->verificationJob->active() ) )
+            return;
+        if( w->success )
+            ++successfulWriters;
+    }
+
+    emit burning( false );
+
+    // already finished?
+    if( !d->running )
+        return;
+
+    if( d->canceled ) {
+        if( m_removeImageFiles )
+            removeImageFiles();
+        emit canceled();
+        d->running = false;
+        jobFinished( false );
+        return;
+    }
+
+    if( successfulWriters < d->fanOutWriters.count() ) {
+        emit infoMessage( i18n("%1 of %2 copies were written successfully.",
+                               successfulWriters, d->fanOutWriters.count() ),
+                          successfulWriters > 0 ? MessageWarning : MessageError );
+    }
+
+    if( successfulWriters > 0 && !m_simulate && ++d->doneCopies < m_copies ) {
+        Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+            if( !K3b::eject( w->device ) ) {
+                blockingInformation( i18n("K3b was unable to eject the written medium in %1. Please do so manually.", w->name()) );
+            }
+        }
+
+        if( !startFanOutWriters() ) {
+            if( m_removeImageFiles )
+                removeImageFiles();
+            if( d->canceled )
+                emit canceled();
+            d->running = false;
+            jobFinished( false );
+        }
+        else if( m_onTheFly ) {
+            prepareReader();
+            d->readerRunning = true;
+            d->dataTrackReader->start();
+        }
+        else {
+            d->outPipe.writeTo( &d->fanOutPipe, true );
+            d->outPipe.open( true );
+        }
+    }
+    else {
+        if( successfulWriters > 0 && k3bcore->globalSettings()->ejectMedia() ) {
+            Q_FOREACH( Private::FanOutWriter* w, d->fanOutWriters ) {
+                K3b::Device::eject( w->device );
+            }
+        }
+        if( m_removeImageFiles )
+            removeImageFiles();
+        d->running = false;
+        jobFinished( successfulWriters == d->fanOutWriters.count() );
+    }
+}
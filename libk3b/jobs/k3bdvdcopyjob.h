@@ -18,6 +18,7 @@
 
 #include "k3bjob.h"
 #include "k3b_export.h"
+#include <QList>
 #include <QString>
 
 
@@ -27,6 +28,7 @@ namespace K3b {
         class DeviceHandler;
     }
 
+    class AbstractWriter;
 
     class LIBK3B_EXPORT DvdCopyJob : public BurnJob
     {
@@ -49,7 +51,7 @@ namespace K3b {
         void start() override;
         void cancel() override;
 
-        void setWriterDevice( K3b::Device::Device* w ) { m_writerDevice = w; }
+        void setWriterDevice( K3b::Device::Device* w );
         void setReaderDevice( K3b::Device::Device* w ) { m_readerDevice = w; }
         void setImagePath( const QString& p ) { m_imagePath = p; }
         void setRemoveImageFiles( bool b ) { m_removeImageFiles = b; }
@@ -63,6 +65,22 @@ namespace K3b {
         void setReadRetries( int i ) { m_readRetries = i; }
         void setVerifyData( bool b );
 
+        /**
+         * Write to several writers at once. The source is only read once and
+         * fed to all writers through a shared buffer. Each copy as set via
+         * setCopies() is written on all writers.
+         *
+         * The first device is also used as writer(). Setting a single device
+         * is the same as calling setWriterDevice().
+         */
+        void setWriterDevices( const QList<K3b::Device::Device*>& devs );
+
+        /**
+         * The maximum amount of data in bytes a slow writer may lag behind the
+         * fastest writer when writing to several writers at once.
+         */
+        void setFanOutBufferSize( qint64 bytes );
+
     private Q_SLOTS:
         void slotDiskInfoReady( K3b::Device::DeviceHandler* );
         void slotReaderProgress( int );
@@ -73,12 +91,27 @@ namespace K3b {
         void slotVerificationFinished( bool );
         void slotVerificationProgress( int p );
 
+        void slotFanOutWriterProgress( int );
+        void slotFanOutWriterBuffer( int );
+        void slotFanOutWriterDeviceBuffer( int );
+        void slotFanOutWriterInfoMessage( const QString&, int );
+        void slotFanOutWriterFinished( bool );
+        void slotFanOutVerificationProgress( int );
+        void slotFanOutVerificationFinished( bool );
+        void slotFanOutSinkError( int );
+
     private:
         bool waitForDvd();
+        bool waitForDvd( Device::Device* writer, WritingMode* usedWritingMode );
         void prepareReader();
         void prepareWriter();
+        AbstractWriter* createWriter( Device::Device* writer, WritingMode usedWritingMode );
         void removeImageFiles();
 
+        bool startFanOutWriters();
+        void emitFanOutProgress();
+        void fanOutCopyDone();
+
         Device::Device* m_writerDevice;
         Device::Device* m_readerDevice;
         QString m_imagePath;
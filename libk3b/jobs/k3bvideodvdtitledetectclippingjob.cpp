@@ -18,14 +18,92 @@
 #include "k3bprocess.h"
 #include "k3bcore.h"
 #include "k3bglobals.h"
+#include "k3bmediacache.h"
+#include "k3bmedium.h"
 #include "k3b_i18n.h"
 
+#include <QDataStream>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
 
 
 static const int s_unrealisticHighClippingValue = 100000;
 
 
+namespace {
+    const quint32 s_magic = 0x4B33434C; // "K3CL"
+    const quint16 s_version = 1;
+
+    // title number -> top, left, bottom, right
+    typedef QHash<int, QVector<int> > TitleClipping;
+
+    Q_GLOBAL_STATIC(QMutex, s_clippingCacheMutex)
+
+    QString clippingCacheFileName( const QByteArray& fingerprint )
+    {
+        return QStandardPaths::writableLocation( QStandardPaths::CacheLocation )
+            + QLatin1String( "/videodvdclipping/" ) + QString::fromLatin1( fingerprint.toHex() );
+    }
+
+    QByteArray discFingerprint( const K3b::VideoDVD::VideoDVD& dvd )
+    {
+        if( !dvd.device() )
+            return QByteArray();
+        return k3bcore->mediaCache()->medium( dvd.device() ).fingerprint();
+    }
+
+    // needs to be called with the cache mutex locked
+    TitleClipping loadTitleClipping( const QByteArray& fingerprint )
+    {
+        TitleClipping clipping;
+
+        QFile f( clippingCacheFileName( fingerprint ) );
+        if( !f.open( QIODevice::ReadOnly ) )
+            return clipping;
+
+        QDataStream s( &f );
+        quint32 magic = 0;
+        quint16 version = 0;
+        s >> magic >> version >> clipping;
+        if( magic != s_magic || version != s_version || s.status() != QDataStream::Ok ) {
+            qDebug() << "(K3b::VideoDVDTitleDetectClippingJob) invalid clipping cache entry" << f.fileName();
+            clipping.clear();
+        }
+
+        return clipping;
+    }
+
+    void storeTitleClipping( const QByteArray& fingerprint, int title, const QVector<int>& values )
+    {
+        QMutexLocker locker( s_clippingCacheMutex() );
+
+        const QString fileName = clippingCacheFileName( fingerprint );
+        if( !QDir().mkpath( QFileInfo( fileName ).path() ) )
+            return;
+
+        TitleClipping clipping = loadTitleClipping( fingerprint );
+        clipping.insert( title, values );
+
+        QSaveFile f( fileName );
+        if( f.open( QIODevice::WriteOnly ) ) {
+            QDataStream s( &f );
+            s << s_magic << s_version << clipping;
+            if( s.status() == QDataStream::Ok )
+                f.commit();
+        }
+    }
+}
+
+
 class K3b::VideoDVDTitleDetectClippingJob::Private
 {
 public:
@@ -85,6 +163,13 @@ void K3b::VideoDVDTitleDetectClippingJob::start()
     m_clippingLeft = s_unrealisticHighClippingValue;
     m_clippingRight = s_unrealisticHighClippingValue;
 
+    if( cachedClipping( m_dvd, m_titleNumber, m_clippingTop, m_clippingLeft, m_clippingBottom, m_clippingRight ) ) {
+        emit infoMessage( i18n("Using the clipping values detected earlier for title %1.", m_titleNumber), MessageInfo );
+        emit percent( 100 );
+        jobFinished( true );
+        return;
+    }
+
     d->usedTranscodeBin = k3bcore->externalBinManager()->binObject("transcode");
     if( !d->usedTranscodeBin ) {
         emit infoMessage( i18n("%1 executable could not be found.",QString("transcode")), MessageError );
@@ -261,6 +346,11 @@ void K3b::VideoDVDTitleDetectClippingJob::slotTranscodeExited( int exitCode, QPr
             if( d->totalChapters < m_dvd[m_titleNumber-1].numPTTs() )
                 emit infoMessage( i18n("Ignoring clipping values of last chapter due to its short playback time."), MessageInfo );
 
+            const QByteArray fingerprint = discFingerprint( m_dvd );
+            if( !fingerprint.isEmpty() )
+                storeTitleClipping( fingerprint, m_titleNumber,
+                                    QVector<int>() << m_clippingTop << m_clippingLeft << m_clippingBottom << m_clippingRight );
+
             jobFinished( true );
         }
         else {
@@ -286,3 +376,21 @@ void K3b::VideoDVDTitleDetectClippingJob::slotTranscodeExited( int exitCode, QPr
 }
 
 
+bool K3b::VideoDVDTitleDetectClippingJob::cachedClipping( const K3b::VideoDVD::VideoDVD& dvd, int title,
+                                                         int& top, int& left, int& bottom, int& right )
+{
+    const QByteArray fingerprint = discFingerprint( dvd );
+    if( fingerprint.isEmpty() )
+        return false;
+
+    QMutexLocker locker( s_clippingCacheMutex() );
+    const QVector<int> values = loadTitleClipping( fingerprint ).value( title );
+    if( values.count() != 4 )
+        return false;
+
+    top = values[0];
+    left = values[1];
+    bottom = values[2];
+    right = values[3];
+    return true;
+}
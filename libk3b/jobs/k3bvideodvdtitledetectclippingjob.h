@@ -23,6 +23,10 @@
 namespace K3b {
     /**
      * Job to detect the clipping values for a Video DVD title.
+     *
+     * The values are detected by running transcode over the start of every
+     * chapter of the title. The results are cached per disc, see
+     * cachedClipping().
      */
     class LIBK3B_EXPORT VideoDVDTitleDetectClippingJob : public Job
     {
@@ -56,6 +60,16 @@ namespace K3b {
          */
         int clippingRight() const { return m_clippingRight; }
 
+        /**
+         * Look up the clipping values which have been detected for @p title
+         * on the disc in the drive of @p dvd before. Results are stored per
+         * disc so ripping a title again does not need another analysis pass.
+         *
+         * \return false if there are no cached values.
+         */
+        static bool cachedClipping( const VideoDVD::VideoDVD& dvd, int title,
+                                    int& top, int& left, int& bottom, int& right );
+
     public Q_SLOTS:
         void start() override;
         void cancel() override;
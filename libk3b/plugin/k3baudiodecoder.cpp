@@ -16,6 +16,7 @@
 
 #include "k3bcore.h"
 #include "k3baudiodecoder.h"
+#include "k3bbufferpool.h"
 #include "k3bpluginmanager.h"
 #include "k3b_i18n.h"
 
@@ -98,12 +99,37 @@ public:
           inBufferPos(0),
           inBufferFill(0),
           outBuffer(0),
+          samplerate(0),
+          channels(0),
           monoBuffer(0),
+          decodingBuffer(0),
           decodingBufferPos(0),
           decodingBufferFill(0),
           valid(true) {
     }
 
+    // decoders are kept for every file in a project, so the buffers are
+    // only taken from the pool between initDecoder() and cleanup()
+    bool acquireBuffers() {
+        if( !decodingBuffer ) {
+            decodingPoolBuffer = K3b::BufferPool::instance()->allocate( DECODING_BUFFER_SIZE );
+            decodingBuffer = decodingPoolBuffer.data();
+            decodingBufferPos = decodingBuffer;
+        }
+        if( channels == 1 && !monoBuffer ) {
+            monoPoolBuffer = K3b::BufferPool::instance()->allocate( DECODING_BUFFER_SIZE/2 );
+            monoBuffer = monoPoolBuffer.data();
+        }
+        return decodingBuffer && ( channels != 1 || monoBuffer );
+    }
+
+    void releaseBuffers() {
+        decodingPoolBuffer.release();
+        monoPoolBuffer.release();
+        decodingBuffer = decodingBufferPos = monoBuffer = 0;
+        decodingBufferFill = 0;
+    }
+
     // the current position of the decoder
     // This does NOT include the decodingBuffer
     K3b::Msf currentPos;
@@ -140,9 +166,11 @@ public:
     int channels;
 
     // mono -> stereo conversion
+    K3b::BufferPool::Buffer monoPoolBuffer;
     char* monoBuffer;
 
-    char decodingBuffer[DECODING_BUFFER_SIZE];
+    K3b::BufferPool::Buffer decodingPoolBuffer;
+    char* decodingBuffer;
     char* decodingBufferPos;
     int decodingBufferFill;
 
@@ -167,7 +195,6 @@ K3b::AudioDecoder::~AudioDecoder()
 
     if( d->inBuffer ) delete [] d->inBuffer;
     if( d->outBuffer ) delete [] d->outBuffer;
-    if( d->monoBuffer ) delete [] d->monoBuffer;
 
     delete d->resampleData;
     if (d->resampleState) {
@@ -241,11 +268,31 @@ bool K3b::AudioDecoder::initDecoder()
 
     d->decoderFinished = false;
 
-    return initDecoderInternal();
+    if( !initDecoderInternal() )
+        return false;
+
+    if( !d->acquireBuffers() ) {
+        qDebug() << "(K3b::AudioDecoder) unable to allocate the decoding buffers.";
+        return false;
+    }
+
+    return true;
 }
 
 
 int K3b::AudioDecoder::decode( char* _data, int maxLen )
+{
+    const char* data = 0;
+    const int read = peek( &data, maxLen );
+    if( read > 0 ) {
+        ::memcpy( _data, data, read );
+        consume( read );
+    }
+    return read;
+}
+
+
+int K3b::AudioDecoder::peek( const char** data, int maxLen )
 {
     unsigned long lengthToDecode = (m_length - d->decodingStartPos).audioBytes();
 
@@ -258,6 +305,12 @@ int K3b::AudioDecoder::decode( char* _data, int maxLen )
     int read = 0;
 
     if( d->decodingBufferFill == 0 ) {
+        // the buffers are released by cleanup() which decoders also call when seeking
+        if( !d->acquireBuffers() ) {
+            qDebug() << "(K3b::AudioDecoder) unable to allocate the decoding buffers.";
+            return -1;
+        }
+
         //
         // now we decode into the decoding buffer
         // to ensure a minimum buffer size
@@ -288,10 +341,6 @@ int K3b::AudioDecoder::decode( char* _data, int maxLen )
                 }
             }
             else if( d->channels == 1 ) {
-                if( !d->monoBuffer ) {
-                    d->monoBuffer = new char[DECODING_BUFFER_SIZE/2];
-                }
-
                 // we simply duplicate every frame
                 if( (read = decodeInternal( d->monoBuffer, DECODING_BUFFER_SIZE/2 )) == 0 )
                     d->decoderFinished = true;
@@ -347,18 +396,21 @@ int K3b::AudioDecoder::decode( char* _data, int maxLen )
         d->decodingBufferFill = read;
     }
 
+    *data = d->decodingBufferPos;
+    return qMin( maxLen, d->decodingBufferFill );
+}
+
 
+void K3b::AudioDecoder::consume( int len )
+{
     // clear out the decoding buffer
-    read = qMin( maxLen, d->decodingBufferFill );
-    ::memcpy( _data, d->decodingBufferPos, read );
+    const int read = qBound( 0, len, d->decodingBufferFill );
     d->decodingBufferPos += read;
     d->decodingBufferFill -= read;
 
     d->alreadyDecoded += read;
     d->currentPos += (read+d->currentPosOffset)/2352;
     d->currentPosOffset = (read+d->currentPosOffset)%2352;
-
-    return read;
 }
 
 
@@ -546,6 +598,8 @@ bool K3b::AudioDecoder::seek( const K3b::Msf& pos )
 
 void K3b::AudioDecoder::cleanup()
 {
+    d->releaseBuffers();
+
     if (d->metaDataCollection) {
         delete d->metaDataCollection;
         d->metaDataCollection = NULL;
@@ -121,11 +121,32 @@ namespace K3b {
          */
         int decode( char* data, int maxLen );
 
+        /**
+         * Decodes like decode() but provides the data in the internal decoding
+         * buffer instead of copying it. \p data points to maximal \p maxLen
+         * bytes which stay valid until the next call to consume(), decode(),
+         * seek() or cleanup().
+         *
+         * returns -1 on error, 0 when finished, length of data otherwise.
+         *
+         * The data is only marked as decoded once it is passed to consume().
+         * Peeking again without consuming returns the same data.
+         */
+        int peek( const char** data, int maxLen );
+
+        /**
+         * Marks \p len bytes returned by peek() as decoded.
+         */
+        void consume( int len );
+
         /**
          * Cleanup after decoding like closing files.
          * Be aware that this is the counterpart to @p initDecoder().
          *
          * There might happen multiple calls to initDecoder() and cleanup().
+         *
+         * Reimplementations have to call this implementation which returns
+         * the decoding buffers to the buffer pool.
          */
         virtual void cleanup();
 
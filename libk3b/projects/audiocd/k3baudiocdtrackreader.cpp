@@ -32,6 +32,11 @@
 
 namespace K3b {
 
+namespace {
+    // one second of audio
+    const int s_maxBatchSectors = 75;
+}
+
 class AudioCdTrackReader::Private
 {
 public:
@@ -39,7 +44,9 @@ public:
     :
         source( s ),
         initialized( false ),
-        cdParanoiaLib( 0 )
+        cdParanoiaLib( 0 ),
+        pending( 0 ),
+        pendingLength( 0 )
     {
     }
 
@@ -47,6 +54,10 @@ public:
     bool initialized;
     QScopedPointer<CdparanoiaLib> cdParanoiaLib;
 
+    // the part of the last batch which has not been consumed yet
+    const char* pending;
+    qint64 pendingLength;
+
     bool initParanoia();
     void closeParanoia();
 };
@@ -121,6 +132,8 @@ void AudioCdTrackReader::Private::closeParanoia()
         cdParanoiaLib->close();
     }
     initialized = false;
+    pending = 0;
+    pendingLength = 0;
 }
 
 
@@ -162,25 +175,31 @@ qint64 AudioCdTrackReader::writeData( const char* /*data*/, qint64 /*len*/ )
 }
 
 
-qint64 AudioCdTrackReader::readData( char* data, qint64 /*maxlen*/ )
+qint64 AudioCdTrackReader::readData( char* data, qint64 maxlen )
 {
     if( d->cdParanoiaLib && d->initialized ) {
-        int status = 0;
-        char* buf = d->cdParanoiaLib->read( &status, 0, false /* big endian */ );
-        if( status == CdparanoiaLib::S_OK ) {
-            if( buf == 0 ) {
+        if( d->pendingLength == 0 ) {
+            int status = 0;
+            int sectors = 0;
+            char* buf = d->cdParanoiaLib->readSectors( int( qBound<qint64>( 1, maxlen / CD_FRAMESIZE_RAW, s_maxBatchSectors ) ),
+                                                       &sectors, &status, 0, false /* big endian */ );
+            if( status != CdparanoiaLib::S_OK ) {
+                return -1;
+            }
+            else if( buf == 0 ) {
                 // done
                 d->closeParanoia();
                 return -1;
             }
-            else {
-                ::memcpy( data, buf, CD_FRAMESIZE_RAW );
-                return CD_FRAMESIZE_RAW;
-            }
-        }
-        else {
-            return -1;
+            d->pending = buf;
+            d->pendingLength = qint64( sectors ) * CD_FRAMESIZE_RAW;
         }
+
+        const qint64 len = qMin( maxlen, d->pendingLength );
+        ::memcpy( data, d->pending, len );
+        d->pending += len;
+        d->pendingLength -= len;
+        return len;
     }
     return -1;
 }
@@ -205,6 +224,8 @@ bool AudioCdTrackReader::seek( qint64 pos )
         const int start = d->source.toc()[d->source.cdTrackNumber()-1].firstSector().lba();
         d->cdParanoiaLib->initReading( start + d->source.startOffset().lba() + msfPos.lba(),
                                        start + d->source.lastSector().lba() );
+        d->pending = 0;
+        d->pendingLength = 0;
         return QIODevice::seek( pos );
     }
     else {
@@ -17,6 +17,11 @@
 #include "k3baudiodoc.h"
 
 
+K3b::AudioPeekReader::~AudioPeekReader()
+{
+}
+
+
 K3b::AudioDataSource::AudioDataSource()
     : QObject(),
       m_track(0),
@@ -25,6 +25,47 @@ namespace K3b {
     class AudioTrack;
     class AudioDoc;
 
+    /**
+     * Readers created by AudioDataSource::createReader() may implement this
+     * interface in addition to QIODevice. It hands out the data in the
+     * reader's own buffer instead of copying it into the caller's buffer.
+     *
+     * A typical loop looks like:
+     *
+     * \code
+     * const char* data = 0;
+     * qint64 len = 0;
+     * while( ( len = reader->peekData( &data, maxlen ) ) > 0 ) {
+     *     sink->write( data, len );
+     *     reader->consumeData( len );
+     * }
+     * \endcode
+     *
+     * The reader has to be opened with QIODevice::Unbuffered since data
+     * buffered by QIODevice would be skipped. peekData() and read() may be
+     * mixed otherwise.
+     */
+    class LIBK3B_EXPORT AudioPeekReader
+    {
+    public:
+        virtual ~AudioPeekReader();
+
+        /**
+         * Makes maximal \p maxlen bytes from the current position available
+         * in \p data without consuming them. The data stays valid until the
+         * next call to consumeData(), read(), seek(), or close().
+         *
+         * \return the number of available bytes, 0 or -1 at the end or on error.
+         */
+        virtual qint64 peekData( const char** data, qint64 maxlen ) = 0;
+
+        /**
+         * Consumes \p len bytes of the data returned by the last call to
+         * peekData() and advances the position.
+         */
+        virtual void consumeData( qint64 len ) = 0;
+    };
+
 
     /**
      * An AudioDataSource has an original length which represents the maximum amount of audio
@@ -153,7 +194,8 @@ namespace K3b {
         virtual AudioDataSource* split( const Msf& pos );
 
         /**
-         * Create reader associated with the source
+         * Create reader associated with the source. The reader may implement
+         * AudioPeekReader to avoid copying the data.
          */
         virtual QIODevice* createReader( QObject* parent = 0 ) = 0;
 
@@ -59,6 +59,9 @@ public:
     AudioTrack* firstTrack;
     AudioTrack* lastTrack;
 
+    // sum of the lengths of all tracks
+    Msf length;
+
     bool hideFirstTrack;
     bool normalize;
 
@@ -172,14 +175,7 @@ KIO::filesize_t K3b::AudioDoc::size() const
 
 K3b::Msf K3b::AudioDoc::length() const
 {
-    K3b::Msf length = 0;
-    K3b::AudioTrack* track = d->firstTrack;
-    while( track ) {
-        length += track->length();
-        track = track->next();
-    }
-
-    return length;
+    return d->length;
 }
 
 
@@ -526,6 +522,7 @@ void K3b::AudioDoc::addTrack( K3b::AudioTrack* track, int position )
         emit trackAboutToBeAdded( 0 );
         d->firstTrack = d->lastTrack = track;
         emit trackAdded( 0 );
+        track->updateDocLength();
     } else if( position == 0 ) {
         track->moveAhead( d->firstTrack );
     } else {
@@ -1014,6 +1011,7 @@ void K3b::AudioDoc::slotTrackChanged( K3b::AudioTrack* track )
 {
     qDebug() << "(K3b::AudioDoc::slotTrackChanged " << track;
     setModified( true );
+    track->updateDocLength();
     // if the track is empty now we simply delete it
     if( track->firstSource() ) {
         emit trackChanged( track );
@@ -1034,6 +1032,13 @@ void K3b::AudioDoc::slotTrackRemoved( int position )
     emit changed();
 }
 
+void K3b::AudioDoc::trackLengthChanged( const K3b::Msf& oldLength, const K3b::Msf& newLength )
+{
+    d->length -= oldLength;
+    d->length += newLength;
+}
+
+
 void K3b::AudioDoc::increaseDecoderUsage( K3b::AudioDecoder* decoder )
 {
     qDebug() << "(K3b::AudioDoc::increaseDecoderUsage)";
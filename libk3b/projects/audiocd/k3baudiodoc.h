@@ -224,6 +224,12 @@ namespace K3b {
         void decreaseDecoderUsage( AudioDecoder* );
         void increaseDecoderUsage( AudioDecoder* );
 
+        /**
+         * Used by AudioTrack to keep the total length up to date without
+         * walking all tracks and sources on every call to length().
+         */
+        void trackLengthChanged( const Msf& oldLength, const Msf& newLength );
+
         class Private;
         Private* d;
     };
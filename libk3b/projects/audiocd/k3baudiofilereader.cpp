@@ -17,6 +17,8 @@
 #include "k3baudiofile.h"
 #include "k3baudiodecoder.h"
 
+#include <limits.h>
+
 
 namespace K3b {
 
@@ -110,4 +112,26 @@ qint64 AudioFileReader::readData( char* data, qint64 maxlen )
         return -1;
 }
 
+
+qint64 AudioFileReader::peekData( const char** data, qint64 maxlen )
+{
+    if( maxlen + pos() > size() )
+        maxlen = size() - pos();
+
+    // the decoder works with int lengths
+    qint64 read = d->source.decoder()->peek( data, qMin( maxlen, qint64( INT_MAX ) ) );
+
+    if( read > 0 )
+        return read;
+    else
+        return -1;
+}
+
+
+void AudioFileReader::consumeData( qint64 len )
+{
+    d->source.decoder()->consume( len );
+    QIODevice::seek( pos() + len );
+}
+
 } // namespace K3b
@@ -16,6 +16,7 @@
 #define _K3B_AUDIO_FILE_READER_H_
 
 #include "k3b_export.h"
+#include "k3baudiodatasource.h"
 
 #include <QIODevice>
 #include <QScopedPointer>
@@ -24,7 +25,7 @@ namespace K3b {
 
     class AudioFile;
 
-    class LIBK3B_EXPORT AudioFileReader : public QIODevice
+    class LIBK3B_EXPORT AudioFileReader : public QIODevice, public AudioPeekReader
     {
     public:
         explicit AudioFileReader( AudioFile& source, QObject* parent = 0 );
@@ -36,6 +37,12 @@ namespace K3b {
         qint64 size() const override;
         bool seek( qint64 pos ) override;
 
+        /**
+         * Hands out the data from the decoder's buffer.
+         */
+        qint64 peekData( const char** data, qint64 maxlen ) override;
+        void consumeData( qint64 len ) override;
+
     protected:
         qint64 writeData( const char* data, qint64 len ) override;
         qint64 readData( char* data, qint64 maxlen ) override;
@@ -19,7 +19,6 @@
 #include "k3baudiotrack.h"
 #include "k3baudiotrackreader.h"
 #include "k3baudiodatasource.h"
-#include "k3bthread.h"
 #include "k3bwavefilewriter.h"
 #include "k3b_i18n.h"
 
@@ -80,7 +79,6 @@ bool K3b::AudioImager::run()
 
     qint64 totalSize = d->doc->length().audioBytes();
     qint64 totalRead = 0;
-    char buffer[2352 * 10];
 
     for( AudioTrack* track = d->doc->firstTrack(); track != 0; track = track->next() ) {
 
@@ -90,7 +88,7 @@ bool K3b::AudioImager::run()
         // Create track reader
         //
         AudioTrackReader trackReader( *track );
-        if( !trackReader.open() ) {
+        if( !trackReader.open( QIODevice::ReadOnly | QIODevice::Unbuffered ) ) {
             emit infoMessage( i18n("Unable to read track %1.", track->trackNumber()), K3b::Job::MessageError );
             return false;
         }
@@ -113,9 +111,11 @@ bool K3b::AudioImager::run()
         }
 
         //
-        // Read data from the track
+        // Read data from the track. The decoded data is written
+        // directly from the decoder's buffer.
         //
-        while( !trackReader.atEnd() && (read = trackReader.read( buffer, sizeof(buffer) )) > 0 ) {
+        const char* buffer = 0;
+        while( !trackReader.atEnd() && (read = trackReader.peekData( &buffer, 2352 * 10 )) > 0 ) {
             if( !d->ioDev ) {
                 waveFileWriter.write( buffer, read, K3b::WaveFileWriter::BigEndian );
             }
@@ -128,6 +128,8 @@ bool K3b::AudioImager::run()
                 }
             }
 
+            trackReader.consumeData( read );
+
             if( canceled() ) {
                 return false;
             }
@@ -138,10 +140,10 @@ bool K3b::AudioImager::run()
             totalRead += read;
             trackRead += read;
 
-            emit subPercent( 100LL*trackRead/trackReader.size() );
-            emit percent( 100LL*totalRead/totalSize );
-            emit processedSubSize( trackRead/1024LL/1024LL, trackReader.size()/1024LL/1024LL );
-            emit processedSize( totalRead/1024LL/1024LL, totalSize/1024LL/1024LL );
+            setSubProgress( 100LL*trackRead/trackReader.size() );
+            setProgress( 100LL*totalRead/totalSize );
+            setProcessedSubSize( trackRead/1024LL/1024LL, trackReader.size()/1024LL/1024LL );
+            setProcessedSize( totalRead/1024LL/1024LL, totalSize/1024LL/1024LL );
         }
 
         if( read < 0 ) {
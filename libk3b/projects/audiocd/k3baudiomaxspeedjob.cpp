@@ -18,8 +18,8 @@
 #include "k3baudiodoc.h"
 #include "k3baudiocdtracksource.h"
 #include "k3baudiodatasourceiterator.h"
+#include "k3bbufferpool.h"
 #include "k3bdevice.h"
-#include "k3bthread.h"
 #include "k3b_i18n.h"
 
 #include <QDateTime>
@@ -37,7 +37,7 @@ public:
 
     int maxSpeed;
     K3b::AudioDoc* doc;
-    char* buffer;
+    K3b::BufferPool::Buffer buffer;
 };
 
 
@@ -68,8 +68,19 @@ int K3b::AudioMaxSpeedJob::Private::speedTest( K3b::AudioDataSource* source, QIO
     t.start();
 
     // read ten seconds of audio data. This is some value which seemed about right. :)
-    while( dataRead < 2352*75*10 && (r = sourceReader.read( buffer, 2352LL*10LL )) > 0 ) {
-        dataRead += r;
+    // The data is not needed, so do not copy it if the reader allows.
+    if( K3b::AudioPeekReader* peekReader = dynamic_cast<K3b::AudioPeekReader*>( &sourceReader ) ) {
+        const char* data = 0;
+        while( dataRead < 2352*75*10 && !sourceReader.atEnd() &&
+               (r = peekReader->peekData( &data, 2352LL*10LL )) > 0 ) {
+            peekReader->consumeData( r );
+            dataRead += r;
+        }
+    }
+    else {
+        while( dataRead < 2352*75*10 && (r = sourceReader.read( buffer.data(), buffer.size() )) > 0 ) {
+            dataRead += r;
+        }
     }
 
     // elapsed millisec
@@ -119,13 +130,12 @@ K3b::AudioMaxSpeedJob::AudioMaxSpeedJob( K3b::AudioDoc* doc, K3b::JobHandler* jh
       d( new Private() )
 {
     d->doc = doc;
-    d->buffer = new char[2352*10];
+    d->buffer = K3b::BufferPool::instance()->allocate( 2352*10 );
 }
 
 
 K3b::AudioMaxSpeedJob::~AudioMaxSpeedJob()
 {
-    delete [] d->buffer;
     delete d;
 }
 
@@ -157,7 +167,7 @@ bool K3b::AudioMaxSpeedJob::run()
     while( it.current() && !canceled() ) {
         QScopedPointer<QIODevice> sourceReader( it.current()->createReader() );
 
-        if( !sourceReader->open( QIODevice::ReadOnly ) ) {
+        if( !sourceReader->open( QIODevice::ReadOnly | QIODevice::Unbuffered ) ) {
             qDebug() << "Cannot open source reader!";
             success = false;
             break;
@@ -167,7 +177,7 @@ bool K3b::AudioMaxSpeedJob::run()
         int speed = d->speedTest( it.current(), *sourceReader );
 
         ++sourcesDone;
-        emit percent( 100*numSources/sourcesDone );
+        setProgress( 100*numSources/sourcesDone );
 
         if( speed < 0 ) {
             success = false;
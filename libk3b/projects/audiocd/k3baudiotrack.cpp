@@ -57,6 +57,9 @@ public:
 
     Msf index0Offset;
 
+    // the length this track contributes to the length of the doc
+    Msf docLength;
+
     Device::TrackCdText cdText;
 
     // list
@@ -121,6 +124,16 @@ void K3b::AudioTrack::emitChanged()
 }
 
 
+void K3b::AudioTrack::updateDocLength()
+{
+    // only tracks in the list count
+    const Msf length = inList() ? this->length() : Msf();
+    if( d->parent && length != d->docLength )
+        d->parent->trackLengthChanged( d->docLength, length );
+    d->docLength = length;
+}
+
+
 void K3b::AudioTrack::setArtist( const QString& a )
 {
     setPerformer( a );
@@ -390,8 +403,10 @@ K3b::AudioTrack* K3b::AudioTrack::take()
         d->prev = d->next = 0;
 
         // remove from doc
-        if( doc() )
+        if( doc() ) {
+            updateDocLength();
             doc()->slotTrackRemoved( position );
+        }
 
         d->parent = 0;
     }
@@ -761,6 +776,9 @@ void K3b::AudioTrack::emitSourceRemoved( K3b::AudioDataSource* source )
         if ( !source->prev() )
             d->firstSource = source->next();
 
+        // the source is not part of the list anymore
+        updateDocLength();
+
         emit doc()->sourceRemoved( this, source->sourceIndex() );
     }
 
@@ -215,6 +215,12 @@ namespace K3b {
          */
         void emitChanged();
 
+        /**
+         * Updates the total length of the doc by the difference between
+         * the current length and the length accounted for the last time.
+         */
+        void updateDocLength();
+
         void debug();
 
         class Private;
@@ -16,15 +16,21 @@
 #include "k3baudiotrackreader.h"
 #include "k3baudiodatasource.h"
 #include "k3baudiotrack.h"
+#include "k3bbufferpool.h"
 
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
 
+#include <string.h>
+
 namespace K3b {
 
 namespace {
     typedef QList< QIODevice* > IODevices;
+
+    // the buffer for sources which cannot be peeked, one second of audio data
+    const qint64 s_scratchSize = 2352*75;
 }
 
 class AudioTrackReader::Private
@@ -33,12 +39,24 @@ public:
     Private( AudioTrackReader& audioTrackReader, AudioTrack& t );
     void slotSourceAdded( int position );
     void slotSourceAboutToBeRemoved( int position );
+    void releasePeekedReader();
 
     AudioTrackReader& q;
     AudioTrack& track;
     IODevices readers;
     int current;
 
+    // data peeked from readers which do not implement AudioPeekReader
+    BufferPool::Buffer scratch;
+    qint64 scratchPos;
+    qint64 scratchFill;
+
+    // the reader whose data peekData() handed out. If its source is removed
+    // before consumeData() the reader is kept alive until then since the
+    // caller may still use its data.
+    QIODevice* peekedReader;
+    bool peekedReaderRemoved;
+
     // used to make sure that no seek and read operation occur in parallel
     QMutex mutex;
 };
@@ -48,7 +66,11 @@ AudioTrackReader::Private::Private( AudioTrackReader& audioTrackReader, AudioTra
 :
     q( audioTrackReader ),
     track( t ),
-    current( -1 )
+    current( -1 ),
+    scratchPos( 0 ),
+    scratchFill( 0 ),
+    peekedReader( 0 ),
+    peekedReaderRemoved( false )
 {
 }
 
@@ -60,7 +82,7 @@ void AudioTrackReader::Private::slotSourceAdded( int position )
         if( position >= 0 && position <= readers.size() ) { // No mistake here, "position" can have size() value
             if( AudioDataSource* source = track.getSource( position ) ) {
                 readers.insert( position, source->createReader() );
-                readers.at( position )->open( q.openMode() );
+                readers.at( position )->open( q.openMode() | QIODevice::Unbuffered );
                 if( position == current )
                     readers.at( position )->seek( 0 );
             }
@@ -74,14 +96,35 @@ void AudioTrackReader::Private::slotSourceAboutToBeRemoved( int position )
     if( q.isOpen() ) {
         QMutexLocker locker( &mutex );
         if( position >= 0 && position < readers.size() ) {
-            if( position == current )
-                ++current;
-            readers.removeAt( position );
+            QIODevice* reader = readers.takeAt( position );
+            if( reader == peekedReader )
+                peekedReaderRemoved = true;
+            else
+                delete reader;
+
+            // the following reader moved to the removed position
+            if( position < current ) {
+                --current;
+            }
+            else if( position == current ) {
+                scratchPos = scratchFill = 0;
+                if( current < readers.size() )
+                    readers.at( current )->seek( 0 );
+            }
         }
     }
 }
 
 
+void AudioTrackReader::Private::releasePeekedReader()
+{
+    if( peekedReaderRemoved )
+        delete peekedReader;
+    peekedReader = 0;
+    peekedReaderRemoved = false;
+}
+
+
 AudioTrackReader::AudioTrackReader( AudioTrack& track, QObject* parent )
     : QIODevice( parent ),
       d( new Private( *this, track ) )
@@ -118,9 +161,10 @@ bool AudioTrackReader::open( QIODevice::OpenMode mode )
 {
     if( !mode.testFlag( QIODevice::WriteOnly ) && d->readers.empty() && d->track.numberSources() > 0 ) {
 
+        // we read the sources with our own chunk sizes, buffering them would only add another copy
         for( AudioDataSource* source = d->track.firstSource(); source != 0; source = source->next() ) {
             d->readers.push_back( source->createReader() );
-            if( !d->readers.back()->open( mode ) ) {
+            if( !d->readers.back()->open( mode | QIODevice::Unbuffered ) ) {
                 d->readers.clear();
                 return false;
             }
@@ -142,9 +186,12 @@ bool AudioTrackReader::open( QIODevice::OpenMode mode )
 
 void AudioTrackReader::close()
 {
+    d->releasePeekedReader();
     qDeleteAll( d->readers );
     d->readers.clear();
     d->current = -1;
+    d->scratch.release();
+    d->scratchPos = d->scratchFill = 0;
     QIODevice::close();
 }
 
@@ -165,6 +212,8 @@ bool AudioTrackReader::seek( qint64 pos )
 {
     QMutexLocker locker( &d->mutex );
 
+    d->releasePeekedReader();
+
     int next = 0;
     qint64 curPos = 0;
 
@@ -174,6 +223,7 @@ bool AudioTrackReader::seek( qint64 pos )
 
     if( next < d->readers.size() ) {
         d->current = next;
+        d->scratchPos = d->scratchFill = 0;
         d->readers.at( next )->seek( pos - curPos );
         return QIODevice::seek( pos );
     }
@@ -193,6 +243,16 @@ qint64 AudioTrackReader::readData( char* data, qint64 maxlen )
 {
     QMutexLocker locker( &d->mutex );
 
+    d->releasePeekedReader();
+
+    // hand out the data left from peekData() first
+    if( d->scratchPos < d->scratchFill ) {
+        const qint64 len = qMin( maxlen, d->scratchFill - d->scratchPos );
+        ::memcpy( data, d->scratch.constData() + d->scratchPos, len );
+        d->scratchPos += len;
+        return len;
+    }
+
     while( d->current >= 0 && d->current < d->readers.size() ) {
         qint64 readData = d->readers.at( d->current )->read( data, maxlen );
 
@@ -211,6 +271,76 @@ qint64 AudioTrackReader::readData( char* data, qint64 maxlen )
 }
 
 
+qint64 AudioTrackReader::peekData( const char** data, qint64 maxlen )
+{
+    QMutexLocker locker( &d->mutex );
+
+    d->releasePeekedReader();
+
+    // the scratch data always belongs to the current reader
+    if( d->scratchPos < d->scratchFill ) {
+        d->peekedReader = d->readers.value( d->current );
+        *data = d->scratch.constData() + d->scratchPos;
+        return qMin( maxlen, d->scratchFill - d->scratchPos );
+    }
+
+    while( d->current >= 0 && d->current < d->readers.size() ) {
+        QIODevice* reader = d->readers.at( d->current );
+        qint64 len = -1;
+
+        if( AudioPeekReader* peekReader = dynamic_cast<AudioPeekReader*>( reader ) ) {
+            len = peekReader->peekData( data, maxlen );
+        }
+        else {
+            if( d->scratch.isNull() )
+                d->scratch = BufferPool::instance()->allocate( s_scratchSize );
+            len = reader->read( d->scratch.data(), qMin( maxlen, d->scratch.size() ) );
+            if( len > 0 ) {
+                d->scratchPos = 0;
+                d->scratchFill = len;
+                *data = d->scratch.constData();
+            }
+        }
+
+        if( len > 0 ) {
+            d->peekedReader = reader;
+            return len;
+        }
+        else {
+            ++d->current;
+            if( d->current >= 0 && d->current < d->readers.size() ) {
+                d->readers.at( d->current )->seek( 0 );
+            }
+        }
+    }
+
+    return -1;
+}
+
+
+void AudioTrackReader::consumeData( qint64 len )
+{
+    QMutexLocker locker( &d->mutex );
+
+    // nothing has been peeked or the source of the peeked data has been removed meanwhile
+    QIODevice* reader = d->peekedReader;
+    const bool removed = d->peekedReaderRemoved;
+    d->releasePeekedReader();
+    if( !reader || removed )
+        return;
+
+    if( d->scratchPos < d->scratchFill ) {
+        d->scratchPos += qMin( len, d->scratchFill - d->scratchPos );
+    }
+    else if( AudioPeekReader* peekReader = dynamic_cast<AudioPeekReader*>( reader ) ) {
+        peekReader->consumeData( len );
+    }
+
+    // our own seek() would lock the mutex again
+    QIODevice::seek( pos() + len );
+}
+
+
 void AudioTrackReader::slotTrackChanged()
 {
     QMutexLocker locker( &d->mutex );
@@ -16,6 +16,7 @@
 #define _K3B_AUDIO_TRACK_READER_H_
 
 #include "k3b_export.h"
+#include "k3baudiodatasource.h"
 
 #include <QIODevice>
 #include <QScopedPointer>
@@ -24,7 +25,7 @@ namespace K3b {
 
     class AudioTrack;
 
-    class LIBK3B_EXPORT AudioTrackReader : public QIODevice
+    class LIBK3B_EXPORT AudioTrackReader : public QIODevice, public AudioPeekReader
     {
         Q_OBJECT
 
@@ -41,6 +42,19 @@ namespace K3b {
         qint64 size() const override;
         bool seek( qint64 pos ) override;
 
+        /**
+         * Hands out the data of sources whose readers implement AudioPeekReader
+         * without copying. The data of other sources is read into an internal
+         * buffer once.
+         */
+        qint64 peekData( const char** data, qint64 maxlen ) override;
+
+        /**
+         * Does nothing if the source of the peeked data has been removed from
+         * the track since peekData().
+         */
+        void consumeData( qint64 len ) override;
+
     protected:
         qint64 writeData( const char* data, qint64 len ) override;
         qint64 readData( char* data, qint64 maxlen ) override;
@@ -19,6 +19,12 @@
 
 namespace K3b {
 
+namespace {
+    // handed out by peekData(), one second of silence. Never written to,
+    // not const to keep it out of the binary.
+    char s_zeroData[2352*75];
+}
+
 
 class AudioZeroDataReader::Private
 {
@@ -84,4 +90,20 @@ qint64 AudioZeroDataReader::readData( char* data, qint64 maxlen )
     return maxlen;
 }
 
+
+qint64 AudioZeroDataReader::peekData( const char** data, qint64 maxlen )
+{
+    if( pos() + maxlen > size() )
+        maxlen = size() - pos();
+
+    *data = s_zeroData;
+    return qMin( maxlen, qint64( sizeof( s_zeroData ) ) );
+}
+
+
+void AudioZeroDataReader::consumeData( qint64 len )
+{
+    QIODevice::seek( pos() + len );
+}
+
 } // namespace K3b
@@ -16,6 +16,7 @@
 #define K3B_AUDIOZERODATAREADER_H
 
 #include "k3b_export.h"
+#include "k3baudiodatasource.h"
 
 #include <QIODevice>
 #include <QScopedPointer>
@@ -25,7 +26,7 @@ namespace K3b {
 
     class AudioZeroData;
 
-    class LIBK3B_EXPORT AudioZeroDataReader : public QIODevice
+    class LIBK3B_EXPORT AudioZeroDataReader : public QIODevice, public AudioPeekReader
     {
     public:
         explicit AudioZeroDataReader( AudioZeroData& source, QObject* parent = 0 );
@@ -35,6 +36,9 @@ namespace K3b {
         bool isSequential() const override;
         qint64 size() const override;
 
+        qint64 peekData( const char** data, qint64 maxlen ) override;
+        void consumeData( qint64 len ) override;
+
     protected:
         qint64 writeData(const char* data, qint64 len) override;
         qint64 readData(char* data, qint64 maxlen) override;
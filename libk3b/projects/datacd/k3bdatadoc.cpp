@@ -23,6 +23,8 @@
 #include "k3bbootitem.h"
 #include "k3bspecialdataitem.h"
 #include "k3bfilecompilationsizehandler.h"
+#include "k3bisosizeestimator.h"
+#include "k3bfilededuplicator.h"
 #include "k3bmkisofshandler.h"
 #include "k3bcore.h"
 #include "k3bglobals.h"
@@ -48,11 +50,24 @@
 #include <QStringList>
 #include <QTimer>
 #include <QApplication>
+#include <QAtomicInt>
 #include <QDomElement>
+#include <QHash>
+#include <QThread>
+#include <QVector>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <unistd.h>
+
+
+namespace {
+    // the number of files a loader thread handles in one go
+    const int s_loaderChunkSize = 256;
+}
 
 
 class K3b::DataDoc::Private
@@ -68,25 +83,31 @@ public:
         bootCataloge( 0 ),
         bExistingItemsReplaceAll( false ),
         bExistingItemsIgnoreAll( false ),
-        needToCutFilenames( false )
+        needToCutFilenames( false ),
+        revalidator( 0 )
     {
         sizeHandler = new K3b::FileCompilationSizeHandler();
+        deduplicator = new K3b::FileDeduplicator();
     }
 
     ~Private()
     {
         delete root;
         delete sizeHandler;
+        delete deduplicator;
         //  delete oldSessionSizeHandler;
     }
 
     FileCompilationSizeHandler* sizeHandler;
+    IsoSizeEstimator sizeEstimator;
+    FileDeduplicator* deduplicator;
 
     //  FileCompilationSizeHandler* oldSessionSizeHandler;
     KIO::filesize_t oldSessionSize;
 
     QStringList notFoundFiles;
     QStringList noPermissionFiles;
+    QStringList changedFiles;
 
     RootItem* root;
 
@@ -108,10 +129,308 @@ public:
     bool bExistingItemsIgnoreAll;
 
     bool needToCutFilenames;
+
+    // checks the files loaded from a stat snapshot
+    FileRevalidator* revalidator;
+
+    /**
+     * Folders may be inserted with their contents, e.g. copies or folders
+     * filled by the folder scanner. Thus, the contents need to be accounted
+     * for, too.
+     */
+    void addItem( DataItem* item )
+    {
+        // update the project size
+        if( !item->isFromOldSession() ) {
+            sizeHandler->addFile( item );
+            deduplicator->addFile( item );
+        }
+        sizeEstimator.addItem( item );
+
+        // update the boot item list
+        // (a moved folder still has its boot images in the list)
+        if( item->isBootItem() && !bootImages.contains( static_cast<BootItem*>( item ) ) )
+            bootImages.append( static_cast<BootItem*>( item ) );
+
+        if( item->isDir() ) {
+            Q_FOREACH( DataItem* child, static_cast<DirItem*>( item )->children() )
+                addItem( child );
+        }
+    }
+
+    void removeFromSizeHandler( DataItem* item )
+    {
+        if( !item->isFromOldSession() ) {
+            sizeHandler->removeFile( item );
+            deduplicator->removeFile( item );
+        }
+        sizeEstimator.removeItem( item );
+
+        if( item->isDir() ) {
+            Q_FOREACH( DataItem* child, static_cast<DirItem*>( item )->children() )
+                removeFromSizeHandler( child );
+        }
+    }
     QList<DataItem*> needToCutFilenameItems;
 };
 
 
+/**
+ * Creates the file items of a project which is being loaded.
+ *
+ * Checking the files and creating the items means several stat calls and an
+ * access check per file. This is done by several threads once the whole
+ * file list has been read. Afterwards all items are added to their folders
+ * in bulk.
+ */
+class K3b::DataDoc::ItemLoader
+{
+public:
+    explicit ItemLoader( DataDoc* doc )
+        : m_doc( doc ) {
+    }
+
+    /**
+     * Queue a file item to be created and added to @p parent.
+     */
+    void addFile( DirItem* parent, const QString& path, const QString& name, int sortWeight ) {
+        File file;
+        file.path = path;
+        file.name = name;
+        file.sortWeight = sortWeight;
+        file.item = 0;
+        file.state = File::Ok;
+        m_files.append( file );
+
+        Slot slot = { parent, 0, m_files.count()-1 };
+        m_slots.append( slot );
+    }
+
+    /**
+     * Queue an item which has already been created. It will be added
+     * to @p parent in document order.
+     */
+    void addItem( DirItem* parent, DataItem* item ) {
+        Slot slot = { parent, item, -1 };
+        m_slots.append( slot );
+    }
+
+    void finish( QStringList& notFoundFiles, QStringList& noPermissionFiles );
+
+private:
+    class Thread;
+
+    struct File {
+        enum State {
+            Ok,
+            NotFound,
+            NoPermission
+        };
+
+        QString path;
+        QString name;
+        int sortWeight;
+        FileItem* item;
+        State state;
+    };
+
+    struct Slot {
+        DirItem* parent;
+        DataItem* item;
+        int file;
+    };
+
+    void createFiles();
+    void createFile( File& file );
+
+    DataDoc* m_doc;
+    QVector<File> m_files;
+    QVector<Slot> m_slots;
+    QAtomicInt m_nextFile;
+};
+
+
+class K3b::DataDoc::ItemLoader::Thread : public QThread
+{
+public:
+    explicit Thread( ItemLoader* loader )
+        : m_loader( loader ) {
+    }
+
+protected:
+    void run() override {
+        m_loader->createFiles();
+    }
+
+private:
+    ItemLoader* m_loader;
+};
+
+
+void K3b::DataDoc::ItemLoader::finish( QStringList& notFoundFiles, QStringList& noPermissionFiles )
+{
+    // small projects are not worth the threads
+    QList<Thread*> threads;
+    if( m_files.count() > 2*s_loaderChunkSize ) {
+        for( int i = 1; i < qBound( 1, QThread::idealThreadCount(), 8 ); ++i ) {
+            Thread* thread = new Thread( this );
+            thread->start();
+            threads.append( thread );
+        }
+    }
+
+    // this thread helps out
+    createFiles();
+
+    Q_FOREACH( Thread* thread, threads ) {
+        thread->wait();
+    }
+    qDeleteAll( threads );
+
+    //
+    // Add the items to their folders in document order. A folder shows up
+    // before any of its children, so by going backwards every folder is
+    // complete before it is added to its parent. That way the project is
+    // informed only once per folder.
+    //
+    QHash<DirItem*, DirItem::Children> children;
+    QList<DirItem*> parents;
+    Q_FOREACH( const Slot& slot, m_slots ) {
+        DataItem* item = slot.item;
+        if( !item ) {
+            const File& file = m_files.at( slot.file );
+            if( file.state == File::NotFound ) {
+                notFoundFiles.append( file.path );
+                continue;
+            }
+            else if( file.state == File::NoPermission ) {
+                noPermissionFiles.append( file.path );
+                continue;
+            }
+            item = file.item;
+            item->setSortWeight( file.sortWeight );
+        }
+
+        QHash<DirItem*, DirItem::Children>::iterator it = children.find( slot.parent );
+        if( it == children.end() ) {
+            parents.append( slot.parent );
+            it = children.insert( slot.parent, DirItem::Children() );
+        }
+        it->append( item );
+    }
+
+    for( int i = parents.count()-1; i >= 0; --i ) {
+        parents[i]->addDataItems( children[parents[i]] );
+    }
+
+    m_files.clear();
+    m_slots.clear();
+}
+
+
+void K3b::DataDoc::ItemLoader::createFiles()
+{
+    while( true ) {
+        const int start = m_nextFile.fetchAndAddOrdered( s_loaderChunkSize );
+        if( start >= m_files.count() )
+            break;
+
+        const int end = qMin( start + s_loaderChunkSize, m_files.count() );
+        for( int i = start; i < end; ++i ) {
+            createFile( m_files[i] );
+        }
+    }
+}
+
+
+void K3b::DataDoc::ItemLoader::createFile( File& file )
+{
+    const QByteArray encodedPath = QFile::encodeName( file.path );
+    k3b_struct_stat statBuf;
+    k3b_struct_stat followedStatBuf;
+
+    // We cannot check for existence here since this always disqualifies broken symlinks
+    if( k3b_lstat( encodedPath, &statBuf ) != 0 ||
+        !( S_ISREG( statBuf.st_mode ) || S_ISLNK( statBuf.st_mode ) ) ) {
+        file.state = File::NotFound;
+        return;
+    }
+
+    const bool followed = ( k3b_stat( encodedPath, &followedStatBuf ) == 0 );
+
+    // broken symlinks are not readable which is wrong in our case
+    if( followed && S_ISREG( followedStatBuf.st_mode ) && ::access( encodedPath, R_OK ) != 0 ) {
+        file.state = File::NoPermission;
+        return;
+    }
+
+    file.item = new FileItem( &statBuf, followed ? &followedStatBuf : 0, file.path, *m_doc, file.name );
+}
+
+
+/**
+ * Checks the files which have been loaded from a stat snapshot against
+ * the file system in the background.
+ */
+class K3b::DataDoc::FileRevalidator : public QThread
+{
+public:
+    struct File {
+        QString path;
+        QString k3bPath;
+        KIO::filesize_t size;
+        time_t mtime;
+        FileItem::Id id;
+    };
+
+    FileRevalidator()
+        : m_canceled( 0 ) {
+    }
+
+    ~FileRevalidator() override {
+        m_canceled = 1;
+        wait();
+    }
+
+    void addFile( FileItem* item ) {
+        File file;
+        file.path = item->localPath();
+        file.k3bPath = item->k3bPath();
+        file.size = item->itemSize( false );
+        file.mtime = item->localModificationTime();
+        file.id = item->localId( false );
+        m_files.append( file );
+    }
+
+    bool isEmpty() const { return m_files.isEmpty(); }
+
+    QList<File> missingFiles;
+    QList<File> changedFiles;
+
+protected:
+    void run() override {
+        Q_FOREACH( const File& file, m_files ) {
+            if( m_canceled )
+                break;
+
+            k3b_struct_stat statBuf;
+            if( k3b_lstat( QFile::encodeName( file.path ), &statBuf ) != 0 )
+                missingFiles.append( file );
+            else if( KIO::filesize_t( statBuf.st_size ) != file.size ||
+                     statBuf.st_mtime != file.mtime ||
+                     statBuf.st_ino != file.id.inode ||
+                     statBuf.st_dev != file.id.device )
+                changedFiles.append( file );
+        }
+        m_files.clear();
+    }
+
+private:
+    QList<File> m_files;
+    QAtomicInt m_canceled;
+};
+
+
 /**
  * There are two ways to fill a data project with files and folders:
  * \li Use the addUrl and addUrlsT methods
@@ -122,11 +441,14 @@ K3b::DataDoc::DataDoc( QObject* parent )
     : K3b::Doc( parent ),
       d( new Private )
 {
+    connect( d->deduplicator, SIGNAL(savedBlocksChanged()),
+             this, SIGNAL(sizeChanged()) );
 }
 
 
 K3b::DataDoc::~DataDoc()
 {
+    delete d->revalidator;
     delete d;
 }
 
@@ -143,6 +465,7 @@ bool K3b::DataDoc::newDocument()
     d->dataMode = K3b::DataModeAuto;
 
     d->isoOptions = K3b::IsoOptions();
+    d->deduplicator->setEnabled( d->isoOptions.deduplicateFiles() );
 
     return K3b::Doc::newDocument();
 }
@@ -159,6 +482,8 @@ void K3b::DataDoc::clear()
             removeItem( d->root->children().first() );
     }
     d->sizeHandler->clear();
+    d->sizeEstimator.clear();
+    d->deduplicator->clear();
     emit importedSessionChanged( importedSession() );
 }
 
@@ -178,6 +503,7 @@ const K3b::IsoOptions& K3b::DataDoc::isoOptions() const
 void K3b::DataDoc::setIsoOptions( const K3b::IsoOptions& isoOptions )
 {
     d->isoOptions = isoOptions;
+    d->deduplicator->setEnabled( isoOptions.deduplicateFiles() );
     emit changed();
 }
 
@@ -297,11 +623,43 @@ K3b::DirItem* K3b::DataDoc::addEmptyDir( const QString& name, K3b::DirItem* pare
 
 KIO::filesize_t K3b::DataDoc::size() const
 {
-    if( d->isoOptions.doNotCacheInodes() )
-        return root()->blocks().mode1Bytes() + d->oldSessionSize;
+    // the filesystem structures are not part of the item sizes
+    const KIO::filesize_t overhead = d->sizeEstimator.blocks( root(),
+                                                              d->isoOptions,
+                                                              !d->bootImages.isEmpty(),
+                                                              d->isoOptions.createUdf() ).mode1Bytes();
+
+    // deduplication requires mkisofs to cache inodes
+    if( d->isoOptions.deduplicateFiles() )
+        return ( d->sizeHandler->blocks( d->isoOptions.followSymbolicLinks() ||
+                                         !d->isoOptions.createRockRidge() ) -
+                 d->deduplicator->savedBlocks() ).mode1Bytes() + overhead;
+    else if( d->isoOptions.doNotCacheInodes() )
+        return root()->blocks().mode1Bytes() + d->oldSessionSize + overhead;
     else
         return d->sizeHandler->blocks( d->isoOptions.followSymbolicLinks() ||
-                                      !d->isoOptions.createRockRidge() ).mode1Bytes();
+                                      !d->isoOptions.createRockRidge() ).mode1Bytes() + overhead;
+}
+
+
+QMap<K3b::FileItem::Id, QString> K3b::DataDoc::duplicateFiles() const
+{
+    if( d->isoOptions.deduplicateFiles() )
+        return d->deduplicator->duplicates();
+    else
+        return QMap<FileItem::Id, QString>();
+}
+
+
+bool K3b::DataDoc::isSearchingDuplicates() const
+{
+    return d->isoOptions.deduplicateFiles() && d->deduplicator->isBusy();
+}
+
+
+void K3b::DataDoc::itemChanged( DataItem* item )
+{
+    d->sizeEstimator.itemChanged( item );
 }
 
 
@@ -386,6 +744,100 @@ bool K3b::DataDoc::loadDocumentData( QDomElement* rootElem )
 
     // -----------------------------------------------------------------
 
+    //
+    // Old versions of K3b do not properly save the boot catalog location
+    // and name. So to ensure we have one around even if loading an old project
+    // file we create a default one here.
+    //
+    if( !d->bootImages.isEmpty() && !d->bootCataloge )
+        createBootCatalogeItem( d->bootImages.first()->parent() );
+
+    // check the files loaded from the snapshot
+    if( d->revalidator ) {
+        connect( d->revalidator, SIGNAL(finished()), this, SLOT(slotRevalidationDone()) );
+        d->revalidator->start( QThread::LowPriority );
+    }
+
+    informAboutNotFoundFiles();
+
+    return true;
+}
+
+
+bool K3b::DataDoc::loadDocumentStream( QXmlStreamReader* xml )
+{
+    if( !root() )
+        newDocument();
+
+    // the general section, the options, and the header are small. Thus,
+    // we simply reuse the DOM code. Only the files are streamed.
+    QDomDocument doc;
+
+    if( !xml->readNextStartElement() || xml->name() != "general" ) {
+        qDebug() << "(K3b::DataDoc) could not find 'general' section.";
+        return false;
+    }
+    if( !readGeneralDocumentData( readDomElement( xml, doc ) ) )
+        return false;
+
+
+    // parse options
+    // -----------------------------------------------------------------
+    if( !xml->readNextStartElement() || xml->name() != "options" ) {
+        qDebug() << "(K3b::DataDoc) could not find 'options' section.";
+        return false;
+    }
+    if( !loadDocumentDataOptions( readDomElement( xml, doc ) ) )
+        return false;
+    // -----------------------------------------------------------------
+
+
+
+    // parse header
+    // -----------------------------------------------------------------
+    if( !xml->readNextStartElement() || xml->name() != "header" ) {
+        qDebug() << "(K3b::DataDoc) could not find 'header' section.";
+        return false;
+    }
+    if( !loadDocumentDataHeader( readDomElement( xml, doc ) ) )
+        return false;
+    // -----------------------------------------------------------------
+
+
+
+    // parse files
+    // -----------------------------------------------------------------
+    if( !xml->readNextStartElement() || xml->name() != "files" ) {
+        qDebug() << "(K3b::DataDoc) could not find 'files' section.";
+        return false;
+    }
+
+    if( d->root == 0 )
+        d->root = new K3b::RootItem( *this );
+
+    ItemLoader loader( this );
+    bool success = true;
+    while( success && xml->readNextStartElement() ) {
+        success = loadDataItem( xml, root(), loader );
+    }
+
+    // even on failure the items are added to the project which deletes them
+    loader.finish( d->notFoundFiles, d->noPermissionFiles );
+
+    if( xml->hasError() ) {
+        qDebug() << "(K3b::DataDoc) parse error:" << xml->errorString();
+        return false;
+    }
+    else if( !success ) {
+        return false;
+    }
+
+    // ignore anything following the files
+    while( xml->readNextStartElement() ) {
+        xml->skipCurrentElement();
+    }
+    // -----------------------------------------------------------------
+
     //
     // Old versions of K3b do not properly save the boot catalog location
     // and name. So to ensure we have one around even if loading an old project
@@ -476,6 +928,11 @@ bool K3b::DataDoc::loadDocumentDataOptions( QDomElement elem )
         else if( e.nodeName() == "do_not_cache_inodes" )
             d->isoOptions.setDoNotCacheInodes( e.attributeNode( "activated" ).value() == "yes" );
 
+        else if( e.nodeName() == "deduplicate_files" ) {
+            d->isoOptions.setDeduplicateFiles( e.attributeNode( "activated" ).value() == "yes" );
+            d->deduplicator->setEnabled( d->isoOptions.deduplicateFiles() );
+        }
+
         else if( e.nodeName() == "whitespace_treatment" ) {
             if( e.text() == "strip" )
                 d->isoOptions.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
@@ -581,8 +1038,14 @@ bool K3b::DataDoc::loadDataItem( QDomElement& elem, K3b::DirItem* parent )
 
         QFileInfo f( urlElem.text() );
 
+        // Projects may contain a stat snapshot of the files. Then the items are
+        // created without touching the files which are checked in the background.
+        if( elem.hasAttribute( "mtime" ) && elem.attribute( "bootimage" ).isEmpty() ) {
+            newItem = loadFileItemSnapshot( elem, urlElem.text(), parent );
+        }
+
         // We cannot use exists() here since this always disqualifies broken symlinks
-        if( !f.isFile() && !f.isSymLink() )
+        else if( !f.isFile() && !f.isSymLink() )
             d->notFoundFiles.append( urlElem.text() );
 
         // broken symlinks are not readable according to QFileInfo which is wrong in our case
@@ -659,6 +1122,134 @@ bool K3b::DataDoc::loadDataItem( QDomElement& elem, K3b::DirItem* parent )
 }
 
 
+bool K3b::DataDoc::loadDataItem( QXmlStreamReader* xml, K3b::DirItem* parent, ItemLoader& loader )
+{
+    if( !parent )
+        return false;
+
+    const QXmlStreamAttributes attributes = xml->attributes();
+    const QString name = attributes.value( "name" ).toString();
+
+    K3b::DataItem* newItem = 0;
+
+    if( xml->name() == "file" ) {
+        if( !xml->readNextStartElement() ) {
+            qDebug() << "(K3b::DataDoc) file-element without url!";
+            return false;
+        }
+        const QString url = xml->readElementText();
+        while( xml->readNextStartElement() ) {
+            xml->skipCurrentElement();
+        }
+
+        if( !attributes.value( "bootimage" ).isEmpty() ) {
+            QFileInfo f( url );
+
+            // We cannot use exists() here since this always disqualifies broken symlinks
+            if( !f.isFile() && !f.isSymLink() )
+                d->notFoundFiles.append( url );
+
+            // broken symlinks are not readable according to QFileInfo which is wrong in our case
+            else if( f.isFile() && !f.isReadable() )
+                d->noPermissionFiles.append( url );
+
+            else {
+                K3b::BootItem* bootItem = new K3b::BootItem( url, *this, name );
+                if( attributes.value( "bootimage" ) == "floppy" )
+                    bootItem->setImageType( K3b::BootItem::FLOPPY );
+                else if( attributes.value( "bootimage" ) == "harddisk" )
+                    bootItem->setImageType( K3b::BootItem::HARDDISK );
+                else
+                    bootItem->setImageType( K3b::BootItem::NONE );
+                bootItem->setNoBoot( attributes.value( "no_boot" ) == "yes" );
+                bootItem->setBootInfoTable( attributes.value( "boot_info_table" ) == "yes" );
+                bootItem->setLoadSegment( attributes.value( "load_segment" ).toInt() );
+                bootItem->setLoadSize( attributes.value( "load_size" ).toInt() );
+                loader.addItem( parent, bootItem );
+
+                newItem = bootItem;
+            }
+        }
+
+        else {
+            loader.addFile( parent, url, name, attributes.value( "sort_weight" ).toInt() );
+        }
+    }
+    else if( xml->name() == "special" ) {
+        if( attributes.value( "type" ) == "boot cataloge" )
+            createBootCatalogeItem( parent )->setK3bName( name );
+        xml->skipCurrentElement();
+    }
+    else if( xml->name() == "directory" ) {
+        // This is for the VideoDVD project which already contains the *_TS folders
+        K3b::DirItem* newDirItem = 0;
+        if( K3b::DataItem* item = parent->find( name ) ) {
+            if( item->isDir() ) {
+                newDirItem = static_cast<K3b::DirItem*>(item);
+            }
+            else {
+                qCritical() << "(K3b::DataDoc) INVALID DOCUMENT: item " << item->k3bPath() << " saved twice" << endl;
+                return false;
+            }
+        }
+
+        if( !newDirItem ) {
+            newDirItem = new K3b::DirItem( name );
+            loader.addItem( parent, newDirItem );
+        }
+        while( xml->readNextStartElement() ) {
+            if( !loadDataItem( xml, newDirItem, loader ) )
+                return false;
+        }
+
+        newItem = newDirItem;
+    }
+    else {
+        qDebug() << "(K3b::DataDoc) wrong tag in files-section: " << xml->name();
+        return false;
+    }
+
+    // load the sort weight
+    if( newItem )
+        newItem->setSortWeight( attributes.value( "sort_weight" ).toInt() );
+
+    return true;
+}
+
+
+K3b::FileItem* K3b::DataDoc::loadFileItemSnapshot( const QDomElement& elem, const QString& path, K3b::DirItem* parent )
+{
+    k3b_struct_stat statBuf;
+    ::memset( &statBuf, 0, sizeof( statBuf ) );
+    const bool symlink = ( elem.attribute( "symlink" ) == "yes" );
+    statBuf.st_mode = symlink ? S_IFLNK : S_IFREG;
+    statBuf.st_size = elem.attribute( "size" ).toLongLong();
+    statBuf.st_mtime = elem.attribute( "mtime" ).toLongLong();
+    statBuf.st_ino = elem.attribute( "inode" ).toULongLong();
+    statBuf.st_dev = elem.attribute( "device" ).toULongLong();
+
+    k3b_struct_stat followedStatBuf = statBuf;
+    bool followed = true;
+    if( symlink ) {
+        followed = elem.hasAttribute( "target_inode" );
+        followedStatBuf.st_mode = S_IFREG;
+        followedStatBuf.st_size = elem.attribute( "target_size" ).toLongLong();
+        followedStatBuf.st_ino = elem.attribute( "target_inode" ).toULongLong();
+        followedStatBuf.st_dev = elem.attribute( "target_device" ).toULongLong();
+    }
+
+    K3b::FileItem* item = new K3b::FileItem( &statBuf, followed ? &followedStatBuf : 0, path, *this, elem.attribute( "name" ) );
+    parent->addDataItem( item );
+
+    // the revalidator needs the final path in the project
+    if( !d->revalidator )
+        d->revalidator = new FileRevalidator();
+    d->revalidator->addFile( item );
+
+    return item;
+}
+
+
 bool K3b::DataDoc::saveDocumentData( QDomElement* docElem )
 {
     QDomDocument doc = docElem->ownerDocument();
@@ -694,6 +1285,43 @@ bool K3b::DataDoc::saveDocumentData( QDomElement* docElem )
 }
 
 
+bool K3b::DataDoc::saveDocumentStream( QXmlStreamWriter* xml )
+{
+    // the general section, the options, and the header are small. Thus,
+    // we simply reuse the DOM code. Only the files are streamed.
+    QDomDocument doc;
+    QDomElement docElem = doc.createElement( "root" );
+    doc.appendChild( docElem );
+
+    saveGeneralDocumentData( &docElem );
+
+    QDomElement optionsElem = doc.createElement( "options" );
+    saveDocumentDataOptions( optionsElem );
+    docElem.appendChild( optionsElem );
+
+    QDomElement headerElem = doc.createElement( "header" );
+    saveDocumentDataHeader( headerElem );
+    docElem.appendChild( headerElem );
+
+    for( QDomElement e = docElem.firstChildElement(); !e.isNull(); e = e.nextSiblingElement() )
+        writeDomElement( xml, e );
+
+
+    // now do the "real" work: save the entries
+    // ----------------------------------------------------------------------
+    xml->writeStartElement( "files" );
+
+    Q_FOREACH( K3b::DataItem* item, root()->children() ) {
+        saveDataItem( item, xml );
+    }
+
+    xml->writeEndElement();
+    // ----------------------------------------------------------------------
+
+    return !xml->hasError();
+}
+
+
 void K3b::DataDoc::saveDocumentDataOptions( QDomElement& optionsElem )
 {
     QDomDocument doc = optionsElem.ownerDocument();
@@ -786,6 +1414,10 @@ void K3b::DataDoc::saveDocumentDataOptions( QDomElement& optionsElem )
     topElem.setAttribute( "activated", isoOptions().doNotCacheInodes() ? "yes" : "no" );
     optionsElem.appendChild( topElem );
 
+    topElem = doc.createElement( "deduplicate_files" );
+    topElem.setAttribute( "activated", isoOptions().deduplicateFiles() ? "yes" : "no" );
+    optionsElem.appendChild( topElem );
+
 
     topElem = doc.createElement( "whitespace_treatment" );
     switch( isoOptions().whiteSpaceTreatment() ) {
@@ -901,6 +1533,24 @@ void K3b::DataDoc::saveDataItem( K3b::DataItem* item, QDomDocument* doc, QDomEle
             if( item->sortWeight() != 0 )
                 topElem.setAttribute( "sort_weight", QString::number(item->sortWeight()) );
 
+            // save a snapshot of the local file which allows to skip
+            // the file checks when loading (see loadFileItemSnapshot())
+            if( !fileItem->isBootItem() && fileItem->localId().inode != 0 ) {
+                topElem.setAttribute( "size", QString::number( fileItem->itemSize( false ) ) );
+                topElem.setAttribute( "mtime", QString::number( qint64( fileItem->localModificationTime() ) ) );
+                topElem.setAttribute( "inode", QString::number( quint64( fileItem->localId().inode ) ) );
+                topElem.setAttribute( "device", QString::number( quint64( fileItem->localId().device ) ) );
+                if( fileItem->isSymLink() ) {
+                    topElem.setAttribute( "symlink", "yes" );
+                    const K3b::FileItem::Id targetId = fileItem->localId( true );
+                    if( targetId.inode != 0 ) {
+                        topElem.setAttribute( "target_size", QString::number( fileItem->itemSize( true ) ) );
+                        topElem.setAttribute( "target_inode", QString::number( quint64( targetId.inode ) ) );
+                        topElem.setAttribute( "target_device", QString::number( quint64( targetId.device ) ) );
+                    }
+                }
+            }
+
             parent->appendChild( topElem );
 
             // add boot options as attributes to preserve compatibility to older K3b versions
@@ -942,6 +1592,60 @@ void K3b::DataDoc::saveDataItem( K3b::DataItem* item, QDomDocument* doc, QDomEle
 }
 
 
+void K3b::DataDoc::saveDataItem( K3b::DataItem* item, QXmlStreamWriter* xml )
+{
+    if( K3b::FileItem* fileItem = dynamic_cast<K3b::FileItem*>( item ) ) {
+        if( d->oldSession.contains( fileItem ) ) {
+            qDebug() << "(K3b::DataDoc) ignoring fileitem " << fileItem->k3bName() << " from old session while saving...";
+        }
+        else {
+            xml->writeStartElement( "file" );
+            xml->writeAttribute( "name", fileItem->k3bName() );
+
+            if( item->sortWeight() != 0 )
+                xml->writeAttribute( "sort_weight", QString::number(item->sortWeight()) );
+
+            // add boot options as attributes to preserve compatibility to older K3b versions
+            if( K3b::BootItem* bootItem = dynamic_cast<K3b::BootItem*>( fileItem ) ) {
+                if( bootItem->imageType() == K3b::BootItem::FLOPPY )
+                    xml->writeAttribute( "bootimage", "floppy" );
+                else if( bootItem->imageType() == K3b::BootItem::HARDDISK )
+                    xml->writeAttribute( "bootimage", "harddisk" );
+                else
+                    xml->writeAttribute( "bootimage", "none" );
+
+                xml->writeAttribute( "no_boot", bootItem->noBoot() ? "yes" : "no" );
+                xml->writeAttribute( "boot_info_table", bootItem->bootInfoTable() ? "yes" : "no" );
+                xml->writeAttribute( "load_segment", QString::number( bootItem->loadSegment() ) );
+                xml->writeAttribute( "load_size", QString::number( bootItem->loadSize() ) );
+            }
+
+            xml->writeTextElement( "url", fileItem->localPath() );
+            xml->writeEndElement();
+        }
+    }
+    else if( item == d->bootCataloge ) {
+        xml->writeStartElement( "special" );
+        xml->writeAttribute( "name", d->bootCataloge->k3bName() );
+        xml->writeAttribute( "type", "boot cataloge" );
+        xml->writeEndElement();
+    }
+    else if( K3b::DirItem* dirItem = dynamic_cast<K3b::DirItem*>( item ) ) {
+        xml->writeStartElement( "directory" );
+        xml->writeAttribute( "name", dirItem->k3bName() );
+
+        if( item->sortWeight() != 0 )
+            xml->writeAttribute( "sort_weight", QString::number(item->sortWeight()) );
+
+        Q_FOREACH( K3b::DataItem* item, dirItem->children() ) {
+            saveDataItem( item, xml );
+        }
+
+        xml->writeEndElement();
+    }
+}
+
+
 void K3b::DataDoc::removeItem( K3b::DataItem* item )
 {
     if( !item )
@@ -972,14 +1676,7 @@ void K3b::DataDoc::beginInsertItems( DirItem* parent, int start, int end )
 void K3b::DataDoc::endInsertItems( DirItem* parent, int start, int end )
 {
     for( int i = start; i <= end; ++i ) {
-        DataItem* item = parent->children().at( i );
-        // update the project size
-        if( !item->isFromOldSession() )
-            d->sizeHandler->addFile( item );
-
-        // update the boot item list
-        if( item->isBootItem() )
-            d->bootImages.append( static_cast<K3b::BootItem*>( item ) );
+        d->addItem( parent->children().at( i ) );
     }
 
     emit itemsInserted( parent, start, end );
@@ -994,8 +1691,7 @@ void K3b::DataDoc::beginRemoveItems( DirItem* parent, int start, int end )
     for( int i = start; i <= end; ++i ) {
         DataItem* item = parent->children().at( i );
         // update the project size
-        if( !item->isFromOldSession() )
-            d->sizeHandler->removeFile( item );
+        d->removeFromSizeHandler( item );
 
         // update the boot item list
         if( item->isBootItem() ) {
@@ -1199,6 +1895,41 @@ QList<K3b::DataItem*> K3b::DataDoc::needToCutFilenameItems() const
 }
 
 
+void K3b::DataDoc::slotRevalidationDone()
+{
+    FileRevalidator* revalidator = d->revalidator;
+    d->revalidator = 0;
+
+    // the items might have been removed in the meantime
+    Q_FOREACH( const FileRevalidator::File& file, revalidator->missingFiles ) {
+        K3b::DataItem* item = root()->findByPath( file.k3bPath );
+        if( item && item->isFile() && item->localPath() == file.path ) {
+            qDebug() << "(K3b::DataDoc) file vanished since the project was saved:" << file.path;
+            d->notFoundFiles.append( file.path );
+            delete item;
+        }
+    }
+
+    // recreate changed items to get the proper size
+    Q_FOREACH( const FileRevalidator::File& file, revalidator->changedFiles ) {
+        K3b::DataItem* item = root()->findByPath( file.k3bPath );
+        if( item && item->isFile() && item->localPath() == file.path ) {
+            qDebug() << "(K3b::DataDoc) file changed since the project was saved:" << file.path;
+            d->changedFiles.append( file.path );
+            K3b::DirItem* parent = item->parent();
+            K3b::FileItem* newItem = new K3b::FileItem( file.path, *this, item->k3bName() );
+            newItem->setSortWeight( item->sortWeight() );
+            delete item;
+            parent->addDataItem( newItem );
+        }
+    }
+
+    delete revalidator;
+
+    informAboutNotFoundFiles();
+}
+
+
 void K3b::DataDoc::informAboutNotFoundFiles()
 {
     if( !d->notFoundFiles.isEmpty() ) {
@@ -1213,6 +1944,13 @@ void K3b::DataDoc::informAboutNotFoundFiles()
 
         d->noPermissionFiles.clear();
     }
+
+    if( !d->changedFiles.isEmpty() ) {
+        KMessageBox::informationList( qApp->activeWindow(), i18n("The following files have changed since the project was saved:"),
+                                      d->changedFiles, i18n("Changed Files") );
+
+        d->changedFiles.clear();
+    }
 }
 
 
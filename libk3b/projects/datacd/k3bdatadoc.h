@@ -18,10 +18,12 @@
 #define K3BDATADOC_H
 
 #include "k3bdoc.h"
+#include "k3bfileitem.h"
 
 #include "k3b_export.h"
 
 #include <KIO/Global>
+#include <QMap>
 
 class QString;
 class QDomDocument;
@@ -92,6 +94,21 @@ namespace K3b {
         Msf length() const override;
         virtual Msf burningLength() const;
 
+        /**
+         * Maps the ids of files with the same contents as another file in
+         * the project to the local path of the file which is written instead.
+         * Empty unless IsoOptions::deduplicateFiles() is set.
+         *
+         * The files are hashed in the background. Files which have not been
+         * hashed yet are not included.
+         */
+        QMap<FileItem::Id, QString> duplicateFiles() const;
+
+        /**
+         * \return true while files are still being hashed for the deduplication.
+         */
+        bool isSearchingDuplicates() const;
+
         /**
          * Simply deletes the item if it is removable (meaning isRemovable() returns true.
          * Be aware that you can remove items simply by deleting them even if isRemovable()
@@ -237,12 +254,19 @@ namespace K3b {
         bool loadDocumentData( QDomElement* root ) override;
         /** reimplemented from Doc */
         bool saveDocumentData( QDomElement* ) override;
+        /** reimplemented from Doc */
+        bool loadDocumentStream( QXmlStreamReader* xml ) override;
+        /** reimplemented from Doc */
+        bool saveDocumentStream( QXmlStreamWriter* xml ) override;
 
         void saveDocumentDataOptions( QDomElement& optionsElem );
         void saveDocumentDataHeader( QDomElement& headerElem );
         bool loadDocumentDataOptions( QDomElement optionsElem );
         bool loadDocumentDataHeader( QDomElement optionsElem );
 
+    private Q_SLOTS:
+        void slotRevalidationDone();
+
     private:
         void prepareFilenamesInDir( DirItem* dir );
         void createSessionImportItems( const Iso9660Directory*, DirItem* parent );
@@ -255,6 +279,11 @@ namespace K3b {
         void beginRemoveItems( DirItem* parent, int start, int end );
         void endRemoveItems( DirItem* parent, int start, int end );
 
+        /**
+         * used by DataItem to inform about renamed or hidden items.
+         */
+        void itemChanged( DataItem* item );
+
         /**
          * load recursively
          */
@@ -264,12 +293,32 @@ namespace K3b {
          */
         void saveDataItem( DataItem* item, QDomDocument* doc, QDomElement* parent );
 
+        class ItemLoader;
+        class FileRevalidator;
+
+        /**
+         * Create a file item from the stat snapshot saved with the item,
+         * add it to @p parent, and queue the file for revalidation.
+         */
+        FileItem* loadFileItemSnapshot( const QDomElement& elem, const QString& path, DirItem* parent );
+
+        /**
+         * load recursively from a stream. The file items are only
+         * queued in the loader which creates them in parallel.
+         */
+        bool loadDataItem( QXmlStreamReader* xml, DirItem* parent, ItemLoader& loader );
+        /**
+         * save recursively to a stream
+         */
+        void saveDataItem( DataItem* item, QXmlStreamWriter* xml );
+
         void informAboutNotFoundFiles();
 
         class Private;
         Private* d;
 
         friend class MixedDoc;
+        friend class DataItem;
         friend class DirItem;
     };
 }
@@ -164,6 +164,7 @@ void K3b::DataItem::setK3bName( const QString& name ) {
         m_k3bName = name;
 
         if( DataDoc* doc = getDoc() ) {
+            doc->itemChanged( this );
             doc->setModified();
         }
     }
@@ -278,6 +279,7 @@ void K3b::DataItem::setHideOnRockRidge( bool b )
         b != m_bHideOnRockRidge ) {
         m_bHideOnRockRidge = b;
         if( DataDoc* doc = getDoc() ) {
+            doc->itemChanged( this );
             doc->setModified();
         }
     }
@@ -292,6 +294,7 @@ void K3b::DataItem::setHideOnJoliet( bool b )
         b != m_bHideOnJoliet ) {
         m_bHideOnJoliet = b;
         if( DataDoc* doc = getDoc() ) {
+            doc->itemChanged( this );
             doc->setModified();
         }
     }
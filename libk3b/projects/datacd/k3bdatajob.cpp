@@ -189,11 +189,25 @@ void K3b::DataJob::prepareWriting()
         m_isoImager->setMultiSessionInfo( QString(), 0 );
     }
 
+    // the exact image size is only needed in advance when writing on-the-fly,
+    // otherwise we take the size of the written image file
+    m_isoImager->setCalculateSize( d->doc->onTheFly() && !d->doc->onlyCreateImages() );
+
     d->initializingImager = true;
     m_isoImager->init();
 }
 
 
+int K3b::DataJob::imageSize() const
+{
+    // the image may have been split into several files (see FileSplitter)
+    if( d->imageFinished )
+        return d->imageFile.size() / 2048;
+    else
+        return m_isoImager->size();
+}
+
+
 void K3b::DataJob::writeImage()
 {
     qDebug();
@@ -244,8 +258,20 @@ void K3b::DataJob::startPipe()
 #ifdef __GNUC__
 #warning Growisofs needs stdin to be closed in order to exit gracefully. Cdrecord does not. However,  if closed with cdrecord we loose parts of stderr. Why?
 #endif
-    if( d->imageFinished || ( d->doc->onTheFly() && !d->doc->onlyCreateImages() ) )
+    if( d->imageFinished || ( d->doc->onTheFly() && !d->doc->onlyCreateImages() ) ) {
         d->pipe->writeTo( m_writerJob->ioDevice(), d->usedWritingApp != K3b::WritingAppCdrecord );
+
+        //
+        // Decouple the image creation from the writing application. The FIFO is
+        // a lot bigger than the one of the writing application so we report its
+        // fill level instead.
+        //
+        if( k3bcore->globalSettings()->pipeBufferSize() > 0 ) {
+            d->pipe->setBufferSize( qint64( k3bcore->globalSettings()->pipeBufferSize() ) * 1024LL * 1024LL );
+            disconnect( m_writerJob, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
+            connect( d->pipe, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)), Qt::UniqueConnection );
+        }
+    }
     else
         d->pipe->writeTo( &d->imageFile, true );
 
@@ -513,8 +539,8 @@ void K3b::DataJob::finishCopy()
         }
         d->verificationJob->clear();
         d->verificationJob->setDevice( d->doc->burner() );
-        d->verificationJob->setGrownSessionSize( m_isoImager->size() );
-        d->verificationJob->addTrack( 0, d->checksumCache, m_isoImager->size() );
+        d->verificationJob->setGrownSessionSize( imageSize() );
+        d->verificationJob->addTrack( 0, d->checksumCache, imageSize() );
 
         emit burning(false);
 
@@ -618,13 +644,20 @@ void K3b::DataJob::setWriterJob( K3b::AbstractWriter* writer )
     connect( m_writerJob, SIGNAL(subPercent(int)), this, SIGNAL(subPercent(int)) );
     connect( m_writerJob, SIGNAL(processedSubSize(int,int)), this, SIGNAL(processedSubSize(int,int)) );
     connect( m_writerJob, SIGNAL(nextTrack(int,int)), this, SLOT(slotWriterNextTrack(int,int)) );
-    connect( m_writerJob, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
+    // the writer reads from the pipe whose FIFO reports the buffer status instead, see startPipe()
+    if( k3bcore->globalSettings()->pipeBufferSize() <= 0 )
+        connect( m_writerJob, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
     connect( m_writerJob, SIGNAL(deviceBuffer(int)), this, SIGNAL(deviceBuffer(int)) );
     connect( m_writerJob, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)), this, SIGNAL(writeSpeed(int,K3b::Device::SpeedMultiplicator)) );
     connect( m_writerJob, SIGNAL(finished(bool)), this, SLOT(slotWriterJobFinished(bool)) );
     connect( m_writerJob, SIGNAL(newSubTask(QString)), this, SIGNAL(newSubTask(QString)) );
     connect( m_writerJob, SIGNAL(debuggingOutput(QString,QString)),
              this, SIGNAL(debuggingOutput(QString,QString)) );
+
+    // the prediction of the writer only covers the whole job if writing is all we do
+    if( d->doc->onTheFly() && !d->doc->onlyCreateImages() &&
+        !d->doc->verifyData() && d->doc->copies() <= 1 )
+        connect( m_writerJob, SIGNAL(remainingTime(int)), this, SIGNAL(remainingTime(int)) );
 }
 
 
@@ -1082,7 +1115,7 @@ bool K3b::DataJob::setupCdrecordJob()
             writer->addArgument( "-xa1" );
     }
 
-    writer->addArgument( QString("-tsize=%1s").arg(m_isoImager->size()) )->addArgument("-");
+    writer->addArgument( QString("-tsize=%1s").arg(imageSize()) )->addArgument("-");
 
     setWriterJob( writer );
 
@@ -1118,7 +1151,7 @@ bool K3b::DataJob::setupCdrdaoJob()
         s << "TRACK MODE2_FORM1" << "\n";
     }
 
-    s << "DATAFILE \"-\" " << m_isoImager->size()*2048 << "\n";
+    s << "DATAFILE \"-\" " << imageSize()*2048 << "\n";
 
     d->tocFile->close();
 
@@ -1152,7 +1185,7 @@ bool K3b::DataJob::setupGrowisofsJob()
                          usedMultiSessionMode() == K3b::DataDoc::FINISH );
 
     writer->setImageToWrite( QString() );  // read from stdin
-    writer->setTrackSize( m_isoImager->size() );
+    writer->setTrackSize( imageSize() );
 
     if( usedMultiSessionMode() != K3b::DataDoc::NONE ) {
         //
@@ -102,6 +102,12 @@ namespace K3b {
         void startPipe();
         void finishCopy();
 
+        /**
+         * The size of the image in blocks. Once the image file has been
+         * written this is the size of the file.
+         */
+        int imageSize() const;
+
         class Private;
         Private* d;
     };
@@ -23,6 +23,7 @@
 
 #include <QDebug>
 #include <QMimeDatabase>
+#include <QSet>
 
 
 K3b::DirItem::DirItem(const QString& name, const ItemFlags& flags)
@@ -140,8 +141,15 @@ void K3b::DirItem::addDataItems( const Children& items )
         // pre-alloc space for items
         m_children.reserve( m_children.size() + newItems.size() );
 
+        // avoid searching the children for every new item
+        QSet<QString> names;
+        names.reserve( m_children.size() + newItems.size() );
+        Q_FOREACH( DataItem* item, m_children ) {
+            names.insert( item->k3bName() );
+        }
+
         Q_FOREACH( DataItem* item, newItems ) {
-            addDataItemImpl( item );
+            addDataItemImpl( item, &names );
         }
 
         if( DataDoc* doc = getDoc() ) {
@@ -446,7 +454,7 @@ bool K3b::DirItem::canAddDataItem( DataItem* item ) const
     if( dirItem && dirItem->isSubItem( this ) ) {
         qDebug() << "(K3b::DirItem) trying to move a dir item down in it's own tree.";
         return false;
-    } else if( !item || m_children.contains( item ) ) {
+    } else if( !item || item->parent() == this ) {
         return false;
     } else {
         return true;
@@ -454,13 +462,13 @@ bool K3b::DirItem::canAddDataItem( DataItem* item ) const
 }
 
 
-void K3b::DirItem::addDataItemImpl( DataItem* item )
+void K3b::DirItem::addDataItemImpl( DataItem* item, QSet<QString>* names )
 {
     if( item->isFile() ) {
         // do we replace an old item?
         QString name = item->k3bName();
         int cnt = 1;
-        while( DataItem* oldItem = find( name ) ) {
+        while( DataItem* oldItem = ( names && !names->contains( name ) ) ? 0 : find( name ) ) {
             if( !oldItem->isDir() && oldItem->isFromOldSession() ) {
                 // in this case we remove this item from it's parent and save it in the new one
                 // to be able to recover it
@@ -483,6 +491,8 @@ void K3b::DirItem::addDataItemImpl( DataItem* item )
     }
 
     m_children.append( item );
+    if( names )
+        names->insert( item->k3bName() );
     updateSize( item, false );
     if( item->isDir() )
         updateFiles( ((DirItem*)item)->numFiles(), ((DirItem*)item)->numDirs()+1 );
@@ -23,6 +23,7 @@
 #include <KIO/Global>
 
 #include <QList>
+#include <QSet>
 #include <QString>
 
 namespace K3b {
@@ -125,7 +126,11 @@ namespace K3b {
         void updateOldSessionFlag();
 
         bool canAddDataItem( DataItem* item ) const;
-        void addDataItemImpl( DataItem* item );
+        /**
+         * \param names The names of all children. Used to speed up adding
+         *              many items at once. May be 0.
+         */
+        void addDataItemImpl( DataItem* item, QSet<QString>* names = 0 );
 
         mutable Children m_children;
 
@@ -0,0 +1,642 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bfilededuplicator.h"
+#include "k3bdataitem.h"
+#include "k3bglobals.h"
+
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <string.h>
+
+
+namespace {
+    // hashing is mostly bound by the disk
+    const int s_maxThreads = 4;
+
+    const qint64 s_readBufferSize = 1024*1024;
+
+    qint64 usedBlocks( KIO::filesize_t bytes )
+    {
+        return ( bytes + 2047 ) / 2048;
+    }
+
+    struct Job {
+        K3b::FileItem::Id id;
+        QString path;
+        KIO::filesize_t size;
+        time_t mtime;
+        time_t ctime;
+
+        // set if the file is compared with the source of its group instead of being hashed
+        bool compare;
+        K3b::FileItem::Id sourceId;
+        QString sourcePath;
+        time_t sourceMtime;
+        time_t sourceCtime;
+    };
+
+    struct Result {
+        K3b::FileItem::Id id;
+        time_t mtime;
+        time_t ctime;
+
+        // empty if the file could not be hashed
+        QByteArray hash;
+
+        bool compare;
+        K3b::FileItem::Id sourceId;
+        bool same;
+    };
+
+    /**
+     * \return false if the file is gone or is not the one which has been
+     *         added anymore. Otherwise @p ctime is set to its change time.
+     */
+    bool statFile( const QString& path, const K3b::FileItem::Id& id, KIO::filesize_t size, time_t mtime, time_t& ctime )
+    {
+        k3b_struct_stat statBuf;
+        if( k3b_stat( QFile::encodeName( path ), &statBuf ) == 0 &&
+            KIO::filesize_t( statBuf.st_size ) == size &&
+            statBuf.st_mtime == mtime &&
+            statBuf.st_ino == id.inode &&
+            statBuf.st_dev == id.device ) {
+            ctime = statBuf.st_ctime;
+            return true;
+        }
+        return false;
+    }
+
+    // writing a file always updates its change time, even if the modification time is restored
+    bool isUnchanged( const QString& path, const K3b::FileItem::Id& id, KIO::filesize_t size, time_t mtime, time_t ctime )
+    {
+        time_t currentCtime = 0;
+        return( statFile( path, id, size, mtime, currentCtime ) && currentCtime == ctime );
+    }
+
+    // equal hashes are not proof enough to write one file in place of another
+    bool sameContents( const QString& path1, const QString& path2, KIO::filesize_t size, const QAtomicInt& canceled )
+    {
+        QFile f1( path1 );
+        QFile f2( path2 );
+        if( !f1.open( QIODevice::ReadOnly ) || !f2.open( QIODevice::ReadOnly ) ) {
+            qDebug() << "(K3b::FileDeduplicator) could not open" << path1 << "or" << path2;
+            return false;
+        }
+
+        QByteArray buffer1( s_readBufferSize, Qt::Uninitialized );
+        QByteArray buffer2( s_readBufferSize, Qt::Uninitialized );
+        KIO::filesize_t total = 0;
+        while( !canceled ) {
+            const qint64 read1 = f1.read( buffer1.data(), buffer1.size() );
+            const qint64 read2 = f2.read( buffer2.data(), buffer2.size() );
+            if( read1 < 0 || read1 != read2 )
+                return false;
+            else if( read1 == 0 )
+                break;
+            if( ::memcmp( buffer1.constData(), buffer2.constData(), read1 ) != 0 )
+                return false;
+            total += read1;
+        }
+
+        return( !canceled && total == size );
+    }
+}
+
+
+class K3b::FileDeduplicator::Private
+{
+public:
+    Private()
+        : enabled( false ),
+          savedBlocks( 0 ),
+          pending( 0 ),
+          canceled( 0 ) {
+    }
+
+    struct File {
+        enum Comparison {
+            NotCompared,
+            Comparing,
+            Same,
+            Different
+        };
+
+        File()
+            : count( 0 ),
+              size( 0 ),
+              mtime( 0 ),
+              ctime( 0 ),
+              hashed( false ),
+              queued( false ),
+              comparison( NotCompared ) {
+        }
+
+        // the number of items with this id
+        int count;
+        QString path;
+        KIO::filesize_t size;
+        time_t mtime;
+
+        // the change time when the file has been hashed
+        time_t ctime;
+
+        QByteArray hash;
+        bool hashed;
+        bool queued;
+
+        // the result of comparing the file with the source of its group
+        Comparison comparison;
+    };
+
+    static QByteArray groupKey( const File& file ) {
+        return file.hash + QByteArray::number( file.size );
+    }
+
+    void schedule( const QList<FileItem::Id>& ids );
+    void scheduleComparisons( const QList<FileItem::Id>& group );
+    void enqueue( const QList<Job>& jobs );
+    void addToGroup( const FileItem::Id& id, const File& file );
+    bool removeFromGroup( const FileItem::Id& id, const File& file );
+
+    FileDeduplicator* q;
+    bool enabled;
+
+    QMap<FileItem::Id, File> files;
+
+    // the ids of all files with the same size
+    QHash<KIO::filesize_t, QList<FileItem::Id> > sizes;
+
+    //
+    // The ids of all files with the same hash. The first file is the
+    // source of the group which is written instead of the others once
+    // their contents have been compared with it.
+    //
+    QHash<QByteArray, QList<FileItem::Id> > groups;
+
+    // the blocks of all files which are the same as the source of their group
+    qint64 savedBlocks;
+
+    // the number of queued jobs without result
+    int pending;
+
+    // shared with the threads
+    QMutex mutex;
+    QWaitCondition jobAdded;
+    QList<Job> queue;
+    QList<Result> results;
+    QVector<Thread*> threads;
+    QAtomicInt canceled;
+};
+
+
+class K3b::FileDeduplicator::Thread : public QThread
+{
+public:
+    explicit Thread( FileDeduplicator::Private* d )
+        : m_d( d ) {
+    }
+
+protected:
+    void run() override {
+        QMutexLocker locker( &m_d->mutex );
+        while( !m_d->canceled ) {
+            if( m_d->queue.isEmpty() ) {
+                m_d->jobAdded.wait( &m_d->mutex );
+                continue;
+            }
+
+            const Job job = m_d->queue.takeFirst();
+            locker.unlock();
+            const Result result = job.compare ? compare( job ) : hash( job );
+            locker.relock();
+
+            m_d->results.append( result );
+            if( m_d->results.count() == 1 )
+                QMetaObject::invokeMethod( m_d->q, "slotFilesHashed", Qt::QueuedConnection );
+        }
+    }
+
+private:
+    Result hash( const Job& job ) const {
+        Result result;
+        result.id = job.id;
+        result.mtime = job.mtime;
+        result.ctime = 0;
+        result.compare = false;
+        result.sourceId = FileItem::Id();
+        result.same = false;
+
+        // the file changed since it has been added
+        if( !statFile( job.path, job.id, job.size, job.mtime, result.ctime ) )
+            return result;
+
+        QFile f( job.path );
+        if( !f.open( QIODevice::ReadOnly ) ) {
+            qDebug() << "(K3b::FileDeduplicator) could not open" << job.path;
+            return result;
+        }
+
+        QCryptographicHash hash( QCryptographicHash::Sha256 );
+        QByteArray buffer( s_readBufferSize, Qt::Uninitialized );
+        KIO::filesize_t total = 0;
+        while( !m_d->canceled ) {
+            const qint64 read = f.read( buffer.data(), buffer.size() );
+            if( read < 0 )
+                return result;
+            else if( read == 0 )
+                break;
+            hash.addData( buffer.constData(), read );
+            total += read;
+        }
+
+        if( !m_d->canceled && total == job.size )
+            result.hash = hash.result();
+        return result;
+    }
+
+    Result compare( const Job& job ) const {
+        Result result;
+        result.id = job.id;
+        result.mtime = job.mtime;
+        result.ctime = job.ctime;
+        result.compare = true;
+        result.sourceId = job.sourceId;
+        result.same = ( isUnchanged( job.path, job.id, job.size, job.mtime, job.ctime ) &&
+                        isUnchanged( job.sourcePath, job.sourceId, job.size, job.sourceMtime, job.sourceCtime ) &&
+                        sameContents( job.sourcePath, job.path, job.size, m_d->canceled ) );
+        if( !result.same && !m_d->canceled )
+            qDebug() << "(K3b::FileDeduplicator)" << job.path << "differs from" << job.sourcePath << "despite the same hash";
+        return result;
+    }
+
+    FileDeduplicator::Private* m_d;
+};
+
+
+void K3b::FileDeduplicator::Private::schedule( const QList<FileItem::Id>& ids )
+{
+    if( !enabled )
+        return;
+
+    QList<Job> jobs;
+    Q_FOREACH( const FileItem::Id& id, ids ) {
+        File& file = files[id];
+        if( !file.hashed && !file.queued ) {
+            file.queued = true;
+            Job job = { id, file.path, file.size, file.mtime, 0, false, FileItem::Id(), QString(), 0, 0 };
+            jobs.append( job );
+        }
+    }
+
+    enqueue( jobs );
+}
+
+
+void K3b::FileDeduplicator::Private::scheduleComparisons( const QList<FileItem::Id>& group )
+{
+    if( !enabled || group.count() < 2 )
+        return;
+
+    const FileItem::Id& sourceId = group.first();
+    const File& source = files[sourceId];
+
+    QList<Job> jobs;
+    for( int i = 1; i < group.count(); ++i ) {
+        File& file = files[group[i]];
+        if( file.comparison == File::NotCompared ) {
+            file.comparison = File::Comparing;
+            Job job = { group[i], file.path, file.size, file.mtime, file.ctime,
+                        true, sourceId, source.path, source.mtime, source.ctime };
+            jobs.append( job );
+        }
+    }
+
+    enqueue( jobs );
+}
+
+
+void K3b::FileDeduplicator::Private::enqueue( const QList<Job>& jobs )
+{
+    if( jobs.isEmpty() )
+        return;
+
+    QMutexLocker locker( &mutex );
+
+    queue += jobs;
+    pending += jobs.count();
+
+    // the threads are started on first use and wait for more jobs afterwards
+    while( threads.count() < qMin( s_maxThreads, pending ) ) {
+        Thread* thread = new Thread( this );
+        thread->start( QThread::LowPriority );
+        threads.append( thread );
+    }
+
+    jobAdded.wakeAll();
+}
+
+
+void K3b::FileDeduplicator::Private::addToGroup( const FileItem::Id& id, const File& file )
+{
+    QList<FileItem::Id>& group = groups[groupKey( file )];
+    group.append( id );
+    scheduleComparisons( group );
+}
+
+
+bool K3b::FileDeduplicator::Private::removeFromGroup( const FileItem::Id& id, const File& file )
+{
+    const QByteArray key = groupKey( file );
+    QHash<QByteArray, QList<FileItem::Id> >::iterator it = groups.find( key );
+    if( it == groups.end() )
+        return false;
+
+    const int index = it->indexOf( id );
+    if( index < 0 )
+        return false;
+    it->removeAt( index );
+
+    bool changed = false;
+    if( file.comparison == File::Same ) {
+        savedBlocks -= usedBlocks( file.size );
+        changed = true;
+    }
+
+    if( it->isEmpty() ) {
+        groups.erase( it );
+        return changed;
+    }
+
+    if( index == 0 ) {
+        //
+        // The source is gone. A file which is the same as the source can
+        // take its place without changing the result for the others. All
+        // other files need to be compared with the new source.
+        //
+        for( int i = 0; i < it->count(); ++i ) {
+            if( files[it->at( i )].comparison == File::Same ) {
+                it->move( i, 0 );
+                break;
+            }
+        }
+
+        File& source = files[it->first()];
+        if( source.comparison == File::Same ) {
+            savedBlocks -= usedBlocks( source.size );
+            changed = true;
+        }
+        source.comparison = File::NotCompared;
+
+        for( int i = 1; i < it->count(); ++i ) {
+            File& other = files[it->at( i )];
+            if( other.comparison != File::Same )
+                other.comparison = File::NotCompared;
+        }
+        scheduleComparisons( it.value() );
+    }
+
+    return changed;
+}
+
+
+K3b::FileDeduplicator::FileDeduplicator( QObject* parent )
+    : QObject( parent ),
+      d( new Private() )
+{
+    d->q = this;
+}
+
+
+K3b::FileDeduplicator::~FileDeduplicator()
+{
+    d->mutex.lock();
+    d->canceled = 1;
+    d->queue.clear();
+    d->jobAdded.wakeAll();
+    d->mutex.unlock();
+
+    Q_FOREACH( Thread* thread, d->threads ) {
+        thread->wait();
+    }
+    qDeleteAll( d->threads );
+
+    delete d;
+}
+
+
+void K3b::FileDeduplicator::setEnabled( bool b )
+{
+    if( b == d->enabled )
+        return;
+
+    d->enabled = b;
+
+    if( b ) {
+        // hash all candidates collected so far
+        for( QHash<KIO::filesize_t, QList<FileItem::Id> >::const_iterator it = d->sizes.constBegin();
+             it != d->sizes.constEnd(); ++it ) {
+            if( it->count() > 1 )
+                d->schedule( it.value() );
+        }
+
+        // and finish the comparisons which have been dropped
+        for( QHash<QByteArray, QList<FileItem::Id> >::const_iterator it = d->groups.constBegin();
+             it != d->groups.constEnd(); ++it ) {
+            d->scheduleComparisons( it.value() );
+        }
+    }
+    else {
+        // drop the jobs which have not been started yet
+        QMutexLocker locker( &d->mutex );
+        Q_FOREACH( const Job& job, d->queue ) {
+            QMap<FileItem::Id, Private::File>::iterator it = d->files.find( job.id );
+            if( it == d->files.end() )
+                continue;
+            if( job.compare )
+                it->comparison = Private::File::NotCompared;
+            else
+                it->queued = false;
+        }
+        d->pending -= d->queue.count();
+        d->queue.clear();
+    }
+}
+
+
+bool K3b::FileDeduplicator::isEnabled() const
+{
+    return d->enabled;
+}
+
+
+void K3b::FileDeduplicator::addFile( DataItem* item )
+{
+    if( !item->isFile() || item->isSymLink() || item->isSpecialFile() || item->isBootItem() )
+        return;
+
+    FileItem* fileItem = static_cast<FileItem*>( item );
+    const KIO::filesize_t size = fileItem->itemSize( false );
+
+    // empty files do not occupy any blocks
+    if( size == 0 )
+        return;
+
+    const FileItem::Id id = fileItem->localId();
+    Private::File& file = d->files[id];
+    if( file.count++ > 0 )
+        return;
+
+    file.path = fileItem->localPath();
+    file.size = size;
+    file.mtime = fileItem->localModificationTime();
+
+    QList<FileItem::Id>& ids = d->sizes[size];
+    ids.append( id );
+    if( ids.count() > 1 )
+        d->schedule( ids );
+}
+
+
+void K3b::FileDeduplicator::removeFile( DataItem* item )
+{
+    if( !item->isFile() || item->isSymLink() || item->isSpecialFile() || item->isBootItem() )
+        return;
+
+    FileItem* fileItem = static_cast<FileItem*>( item );
+    QMap<FileItem::Id, Private::File>::iterator it = d->files.find( fileItem->localId() );
+    if( it == d->files.end() || --it->count > 0 )
+        return;
+
+    if( !it->hash.isEmpty() && d->removeFromGroup( it.key(), it.value() ) )
+        emit savedBlocksChanged();
+
+    QHash<KIO::filesize_t, QList<FileItem::Id> >::iterator sizeIt = d->sizes.find( it->size );
+    if( sizeIt != d->sizes.end() ) {
+        sizeIt->removeOne( it.key() );
+        if( sizeIt->isEmpty() )
+            d->sizes.erase( sizeIt );
+    }
+
+    d->files.erase( it );
+}
+
+
+void K3b::FileDeduplicator::clear()
+{
+    QMutexLocker locker( &d->mutex );
+    d->pending -= d->queue.count();
+    d->queue.clear();
+    d->files.clear();
+    d->sizes.clear();
+    d->groups.clear();
+    d->savedBlocks = 0;
+}
+
+
+bool K3b::FileDeduplicator::isBusy() const
+{
+    return d->pending > 0;
+}
+
+
+K3b::Msf K3b::FileDeduplicator::savedBlocks() const
+{
+    return Msf( int( d->savedBlocks ) );
+}
+
+
+QMap<K3b::FileItem::Id, QString> K3b::FileDeduplicator::duplicates() const
+{
+    QMap<FileItem::Id, QString> result;
+    for( QHash<QByteArray, QList<FileItem::Id> >::const_iterator it = d->groups.constBegin();
+         it != d->groups.constEnd(); ++it ) {
+        if( it->count() < 2 )
+            continue;
+
+        const FileItem::Id& sourceId = it->first();
+        const Private::File& source = d->files[sourceId];
+        if( !isUnchanged( source.path, sourceId, source.size, source.mtime, source.ctime ) )
+            continue;
+
+        for( int i = 1; i < it->count(); ++i ) {
+            const Private::File& file = d->files[it->at( i )];
+            if( file.comparison == Private::File::Same &&
+                isUnchanged( file.path, it->at( i ), file.size, file.mtime, file.ctime ) )
+                result.insert( it->at( i ), source.path );
+        }
+    }
+    return result;
+}
+
+
+void K3b::FileDeduplicator::slotFilesHashed()
+{
+    QList<Result> results;
+    d->mutex.lock();
+    results.swap( d->results );
+    d->mutex.unlock();
+
+    bool changed = false;
+    Q_FOREACH( const Result& result, results ) {
+        --d->pending;
+
+        // the file may have been removed or replaced in the meantime
+        QMap<FileItem::Id, Private::File>::iterator it = d->files.find( result.id );
+        if( it == d->files.end() || it->mtime != result.mtime )
+            continue;
+
+        if( result.compare ) {
+            // the file has been compared with a source which is gone in the meantime
+            if( it->comparison != Private::File::Comparing || it->ctime != result.ctime )
+                continue;
+            const QList<FileItem::Id> group = d->groups.value( Private::groupKey( it.value() ) );
+            if( group.isEmpty() || !( group.first() == result.sourceId ) )
+                continue;
+
+            if( result.same ) {
+                it->comparison = Private::File::Same;
+                d->savedBlocks += usedBlocks( it->size );
+                changed = true;
+            }
+            else {
+                it->comparison = Private::File::Different;
+            }
+        }
+        else {
+            if( !it->queued )
+                continue;
+
+            it->queued = false;
+            it->hashed = true;
+            it->hash = result.hash;
+            it->ctime = result.ctime;
+            if( !result.hash.isEmpty() )
+                d->addToGroup( result.id, it.value() );
+        }
+    }
+
+    if( changed )
+        emit savedBlocksChanged();
+}
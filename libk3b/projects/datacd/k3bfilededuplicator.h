@@ -0,0 +1,103 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_FILE_DEDUPLICATOR_H_
+#define _K3B_FILE_DEDUPLICATOR_H_
+
+#include "k3b_export.h"
+#include "k3bfileitem.h"
+#include "k3bmsf.h"
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+
+namespace K3b {
+    class DataItem;
+
+    /**
+     * Finds local files with identical contents in a data project.
+     *
+     * Only files which have the same size as another file in the project
+     * are candidates. Their contents are hashed by a few background
+     * threads. Files with the same hash are then compared byte by byte
+     * with the first of them by the same threads. Files with the same inode
+     * are handled by FileCompilationSizeHandler and count as one file here.
+     *
+     * The duplicates are written to the image by pointing their graft
+     * points to one of the identical files, mkisofs then shares the
+     * extent among them like it does for hard links.
+     */
+    class LIBK3B_EXPORT FileDeduplicator : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit FileDeduplicator( QObject* parent = 0 );
+        ~FileDeduplicator() override;
+
+        /**
+         * Files are only hashed while the deduplicator is enabled.
+         * Disabled by default.
+         */
+        void setEnabled( bool b );
+        bool isEnabled() const;
+
+        /**
+         * Regular files are considered, links, special files and boot
+         * images are ignored.
+         */
+        void addFile( DataItem* item );
+        void removeFile( DataItem* item );
+
+        void clear();
+
+        /**
+         * \return true while there are files waiting to be hashed or compared.
+         */
+        bool isBusy() const;
+
+        /**
+         * The number of blocks saved by writing the duplicates only once.
+         * Only files whose contents have been compared are counted.
+         */
+        Msf savedBlocks() const;
+
+        /**
+         * Maps the ids of duplicate files to the local path of the file
+         * whose contents are written instead. Files which changed on disk
+         * after they have been compared are left out.
+         *
+         * The files are compared in the background, this only checks
+         * their status.
+         */
+        QMap<FileItem::Id, QString> duplicates() const;
+
+    Q_SIGNALS:
+        /**
+         * Emitted when the saved size changed after files have been hashed.
+         */
+        void savedBlocksChanged();
+
+    private Q_SLOTS:
+        void slotFilesHashed();
+
+    private:
+        class Thread;
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
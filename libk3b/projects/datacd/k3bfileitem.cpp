@@ -105,6 +105,7 @@ K3b::FileItem::FileItem( const K3b::FileItem& item )
       m_sizeFollowed( item.m_sizeFollowed ),
       m_id( item.m_id ),
       m_idFollowed( item.m_idFollowed ),
+      m_mtime( item.m_mtime ),
       m_localPath( item.m_localPath ),
       m_mimeType( item.m_mimeType )
 {
@@ -126,6 +127,8 @@ K3b::DataItem* K3b::FileItem::copy() const
 
 QMimeType K3b::FileItem::mimeType() const
 {
+    if( !m_mimeType.isValid() )
+        m_mimeType = QMimeDatabase().mimeTypeForFile( m_localPath );
     return m_mimeType;
 }
 
@@ -270,11 +273,13 @@ void K3b::FileItem::init( const QString& filePath,
         //
         m_id.inode = stat->st_ino;
         m_id.device = stat->st_dev;
+        m_mtime = stat->st_mtime;
     }
     else {
         m_size = QFileInfo(filePath).size();
         m_id.inode = 0;
         m_id.device = 0;
+        m_mtime = 0;
 
         // since we have no proper inode info, disable the inode caching in the doc
         K3b::IsoOptions o( doc.isoOptions() );
@@ -303,8 +308,6 @@ void K3b::FileItem::init( const QString& filePath,
         m_idFollowed = m_id;
     }
 
-    m_mimeType = QMimeDatabase().mimeTypeForFile( filePath );
-
     // add automagically like a qlistviewitem
     if( parent() )
         parent()->addDataItem( this );
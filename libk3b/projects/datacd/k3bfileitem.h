@@ -83,10 +83,20 @@ namespace K3b {
          */
         Id localId( bool followSymlinks ) const;
 
+        /**
+         * The modification time of the local file at the time
+         * the item was created.
+         */
+        time_t localModificationTime() const { return m_mtime; }
+
         DirItem* getDirItem() const override;
 
         QString linkDest() const;
 
+        /**
+         * The mimetype is determined on first use since it may
+         * require reading the file.
+         */
         QMimeType mimeType() const override;
 
         /** returns true if the item is not a link or
@@ -115,10 +125,11 @@ namespace K3b {
         KIO::filesize_t m_sizeFollowed;
         Id m_id;
         Id m_idFollowed;
+        time_t m_mtime;
 
         QString m_localPath;
 
-        QMimeType m_mimeType;
+        mutable QMimeType m_mimeType;
     };
 
     bool operator==( const FileItem::Id&, const FileItem::Id& );
@@ -38,6 +38,7 @@
 #include <QDir>
 #include <QFile>
 #include <QRegExp>
+#include <QSet>
 #include <QStandardPaths>
 #include <QTemporaryFile>
 #include <QApplication>
@@ -67,6 +68,12 @@ public:
 
     bool knownError;
 
+    // run mkisofs -print-size in init()
+    bool printSize;
+
+    // maps the ids of duplicate files to the file written instead
+    QMap<K3b::FileItem::Id, QString> duplicates;
+
     K3b::DataPreparationJob* dataPreparationJob;
 };
 
@@ -85,6 +92,7 @@ K3b::IsoImager::IsoImager( K3b::DataDoc* doc, K3b::JobHandler* hdl, QObject* par
       m_mkisofsPrintSizeResult( 0 )
 {
     d = new Private();
+    d->printSize = true;
     d->dataPreparationJob = new K3b::DataPreparationJob( doc, this, this );
     connectSubJob( d->dataPreparationJob,
                    SLOT(slotDataPreparationDone(bool)),
@@ -211,6 +219,7 @@ void K3b::IsoImager::init()
     jobStarted();
 
     cleanup();
+    collectDuplicateFiles();
 
     d->dataPreparationJob->start();
 }
@@ -220,10 +229,16 @@ void K3b::IsoImager::slotDataPreparationDone( bool success )
 {
     if( success ) {
         //
-        // We always calculate the image size. It does not take long and at least the mixed job needs it
-        // anyway
+        // The mixed job and on-the-fly writing need the exact image size. Otherwise the
+        // estimation of the project is good enough and we spare the additional mkisofs run.
         //
-        startSizeCalculation();
+        if( d->printSize ) {
+            startSizeCalculation();
+        }
+        else {
+            m_mkisofsPrintSizeResult = m_doc->length().lba();
+            jobFinished( true );
+        }
     }
     else {
         if( d->dataPreparationJob->hasBeenCanceled() ) {
@@ -235,9 +250,16 @@ void K3b::IsoImager::slotDataPreparationDone( bool success )
 }
 
 
+void K3b::IsoImager::setCalculateSize( bool b )
+{
+    d->printSize = b;
+}
+
+
 void K3b::IsoImager::calculateSize()
 {
     jobStarted();
+    collectDuplicateFiles();
     startSizeCalculation();
 }
 
@@ -591,7 +613,8 @@ bool K3b::IsoImager::addMkisofsParameters( bool printSize )
             *m_process << "-hide-joliet-list" << m_jolietHideFile->fileName();
     }
 
-    if( m_doc->isoOptions().doNotCacheInodes() )
+    // the duplicates are merged by the inode cache
+    if( m_doc->isoOptions().doNotCacheInodes() && !m_doc->isoOptions().deduplicateFiles() )
         *m_process << "-no-cache-inodes";
 
     //
@@ -849,7 +872,53 @@ void K3b::IsoImager::writePathSpecForFile( K3b::FileItem* item, QTextStream& str
     else if( item->isSymLink() && d->usedLinkHandling == Private::FOLLOW )
         stream << escapeGraftPoint( K3b::resolveLink( item->localPath() ) ) << "\n";
     else
-        stream << escapeGraftPoint( item->localPath() ) << "\n";
+        stream << escapeGraftPoint( sourcePath( item ) ) << "\n";
+}
+
+
+void K3b::IsoImager::collectDuplicateFiles()
+{
+    d->duplicates = m_doc->duplicateFiles();
+    if( d->duplicates.isEmpty() )
+        return;
+
+    if( m_doc->isSearchingDuplicates() )
+        emit infoMessage( i18n("Not all files have been checked for duplicates yet."), MessageInfo );
+
+    //
+    // The hide lists contain local paths. Thus, a hidden file must neither be
+    // replaced nor used instead of another file. Otherwise mkisofs would hide
+    // the other file, too.
+    //
+    QSet<QString> hiddenPaths;
+    K3b::DataItem* item = m_doc->root();
+    while( (item = item->nextSibling()) ) {
+        if( item->isFile() && ( item->hideOnRockRidge() || item->hideOnJoliet() ) ) {
+            hiddenPaths.insert( item->localPath() );
+            d->duplicates.remove( static_cast<K3b::FileItem*>( item )->localId() );
+        }
+    }
+
+    QMap<K3b::FileItem::Id, QString>::iterator it = d->duplicates.begin();
+    while( it != d->duplicates.end() ) {
+        if( hiddenPaths.contains( it.value() ) )
+            it = d->duplicates.erase( it );
+        else
+            ++it;
+    }
+
+    qDebug() << "(K3b::IsoImager) writing" << d->duplicates.count() << "duplicate files only once.";
+}
+
+
+QString K3b::IsoImager::sourcePath( K3b::FileItem* item ) const
+{
+    if( !item->isSymLink() ) {
+        QMap<K3b::FileItem::Id, QString>::const_iterator it = d->duplicates.constFind( item->localId() );
+        if( it != d->duplicates.constEnd() )
+            return it.value();
+    }
+    return item->localPath();
 }
 
 
@@ -921,6 +990,8 @@ bool K3b::IsoImager::writeSortWeightFile()
                 //
                 s << escapeGraftPoint( dummyDir( static_cast<K3b::DirItem*>(item) ) ) << " " << item->sortWeight() << endl;
             }
+            else if( item->isFile() )
+                s << escapeGraftPoint( sourcePath( static_cast<K3b::FileItem*>( item ) ) ) << " " << item->sortWeight() << endl;
             else
                 s << escapeGraftPoint( item->localPath() ) << " " << item->sortWeight() << endl;
         }
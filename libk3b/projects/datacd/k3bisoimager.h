@@ -41,6 +41,14 @@ namespace K3b {
 
         int size() const { return m_mkisofsPrintSizeResult; }
 
+        /**
+         * If false init() does not run mkisofs to calculate the exact image
+         * size and size() only returns the size estimated by the project.
+         * This is only suitable if the image is written to a file before
+         * it is burned. Defaults to true.
+         */
+        void setCalculateSize( bool b );
+
         bool hasBeenCanceled() const override;
 
         QIODevice* ioDevice() const;
@@ -141,6 +149,19 @@ namespace K3b {
     private:
         void startSizeCalculation();
 
+        /**
+         * Takes the duplicate files from the project. Their graft points
+         * point to the file with the same contents so mkisofs writes
+         * them only once. Called in init() and calculateSize() to keep
+         * the image the same between size calculation and writing.
+         */
+        void collectDuplicateFiles();
+
+        /**
+         * The local file whose contents are written for @p item.
+         */
+        QString sourcePath( FileItem* item ) const;
+
         class Private;
         Private* d;
 
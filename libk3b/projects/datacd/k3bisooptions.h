@@ -119,6 +119,13 @@ namespace K3b {
         bool doNotImportSession() const { return m_doNotImportSession; }
         void setDoNotImportSession( bool b ) { m_doNotImportSession = b; }
 
+        /**
+         * Write files with identical contents only once. This requires
+         * mkisofs to cache inodes, thus hard links are merged, too.
+         */
+        bool deduplicateFiles() const { return m_deduplicateFiles; }
+        void setDeduplicateFiles( bool b ) { m_deduplicateFiles = b; }
+
         void save( KConfigGroup c, bool saveVolumeDesc = true );
 
         static IsoOptions load( const KConfigGroup& c, bool loadVolumeDesc = true );
@@ -168,6 +175,7 @@ namespace K3b {
 
         bool m_doNotCacheInodes;
         bool m_doNotImportSession;
+        bool m_deduplicateFiles;
 
         int m_isoLevel;
 
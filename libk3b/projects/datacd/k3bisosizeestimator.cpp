@@ -0,0 +1,450 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bisosizeestimator.h"
+#include "k3bdataitem.h"
+#include "k3bdiritem.h"
+#include "k3bisooptions.h"
+
+#include <QHash>
+#include <QSet>
+
+
+namespace {
+    const int s_blockSize = 2048;
+
+    // the system area is not used but always written
+    const int s_systemAreaBlocks = 16;
+
+    // mkisofs pads the end of the image by 150 blocks by default
+    const int s_paddingBlocks = 150;
+
+    // anchors, the main and reserve volume descriptor sequences,
+    // the integrity sequence, the file set descriptor, and the root entry
+    const int s_udfFixedBlocks = 41;
+
+    // RR, PX, and TF entries written for every directory record
+    const int s_rockRidgeEntrySize = 5 + 36 + 26;
+
+    // SP and CE entries of the root directory record
+    const int s_rockRidgeRootEntrySize = 7 + 28;
+
+    // rough size of an SL entry, the link target is not known without
+    // accessing the local file
+    const int s_rockRidgeSymLinkEntrySize = 40;
+
+    const int s_maxRecordSize = 255;
+
+
+    qint64 toBlocks( qint64 bytes )
+    {
+        return ( bytes + s_blockSize - 1 ) / s_blockSize;
+    }
+
+
+    struct Options
+    {
+        explicit Options( const K3b::IsoOptions& o = K3b::IsoOptions(), bool udf = false )
+            : rockRidge( o.createRockRidge() ),
+              joliet( o.createJoliet() ),
+              jolietLong( o.jolietLong() ),
+              udf( udf ),
+              omitVersion( o.ISOomitVersionNumbers() ),
+              omitPeriod( o.ISOomitTrailingPeriod() ),
+              maxLength( o.ISOmaxFilenameLength() ),
+              allow31( o.ISOallow31charFilenames() ),
+              followSymlinks( o.followSymbolicLinks() ),
+              discardSymlinks( o.discardSymlinks() ),
+              isoLevel( o.ISOLevel() ) {
+        }
+
+        bool operator==( const Options& o ) const {
+            return( rockRidge == o.rockRidge &&
+                    joliet == o.joliet &&
+                    jolietLong == o.jolietLong &&
+                    udf == o.udf &&
+                    omitVersion == o.omitVersion &&
+                    omitPeriod == o.omitPeriod &&
+                    maxLength == o.maxLength &&
+                    allow31 == o.allow31 &&
+                    followSymlinks == o.followSymlinks &&
+                    discardSymlinks == o.discardSymlinks &&
+                    isoLevel == o.isoLevel );
+        }
+
+        bool rockRidge;
+        bool joliet;
+        bool jolietLong;
+        bool udf;
+        bool omitVersion;
+        bool omitPeriod;
+        bool maxLength;
+        bool allow31;
+        bool followSymlinks;
+        bool discardSymlinks;
+        int isoLevel;
+    };
+
+
+    /**
+     * The blocks and path table bytes one folder contributes.
+     */
+    struct DirInfo
+    {
+        DirInfo()
+            : isoBlocks( 0 ),
+              jolietBlocks( 0 ),
+              udfBlocks( 0 ),
+              isoPathTableBytes( 0 ),
+              jolietPathTableBytes( 0 ) {
+        }
+
+        DirInfo& operator+=( const DirInfo& other ) {
+            isoBlocks += other.isoBlocks;
+            jolietBlocks += other.jolietBlocks;
+            udfBlocks += other.udfBlocks;
+            isoPathTableBytes += other.isoPathTableBytes;
+            jolietPathTableBytes += other.jolietPathTableBytes;
+            return *this;
+        }
+
+        DirInfo& operator-=( const DirInfo& other ) {
+            isoBlocks -= other.isoBlocks;
+            jolietBlocks -= other.jolietBlocks;
+            udfBlocks -= other.udfBlocks;
+            isoPathTableBytes -= other.isoPathTableBytes;
+            jolietPathTableBytes -= other.jolietPathTableBytes;
+            return *this;
+        }
+
+        qint64 isoBlocks;
+        qint64 jolietBlocks;
+        qint64 udfBlocks;
+        qint64 isoPathTableBytes;
+        qint64 jolietPathTableBytes;
+    };
+
+
+    /**
+     * Directory records may not cross block boundaries.
+     */
+    class RecordPacker
+    {
+    public:
+        RecordPacker()
+            : m_blocks( 0 ),
+              m_used( 0 ) {
+        }
+
+        void add( int length ) {
+            if( m_used + length > s_blockSize ) {
+                ++m_blocks;
+                m_used = 0;
+            }
+            m_used += length;
+        }
+
+        qint64 blocks() const {
+            return m_blocks + ( m_used > 0 ? 1 : 0 );
+        }
+
+    private:
+        qint64 m_blocks;
+        int m_used;
+    };
+
+
+    int recordLength( int nameLength )
+    {
+        // records always have an even length
+        return 33 + nameLength + ( nameLength % 2 == 0 ? 1 : 0 );
+    }
+
+
+    int pathTableEntryLength( int nameLength )
+    {
+        return 8 + nameLength + ( nameLength % 2 );
+    }
+
+
+    int isoNameLength( const K3b::DataItem* item, const Options& o )
+    {
+        const QString name = item->k3bName();
+        const bool isFile = !item->isDir();
+
+        // ISO9660:1999 does not know version numbers
+        if( o.isoLevel >= 4 )
+            return qMin( name.length(), 207 );
+
+        const int version = ( isFile && !o.omitVersion ) ? 2 : 0;
+        const int dot = name.lastIndexOf( '.' );
+        const bool addPeriod = ( isFile && dot < 0 && !o.omitPeriod );
+
+        if( o.maxLength )
+            return qMin( name.length(), 37 ) + version;
+
+        if( o.allow31 || o.isoLevel >= 2 )
+            return qMin( name.length() + ( addPeriod ? 1 : 0 ), 31 ) + version;
+
+        // 8.3 names
+        if( !isFile )
+            return qMax( 1, qMin( name.length(), 8 ) );
+
+        const int base = ( dot >= 0 ? dot : name.length() );
+        const int extension = ( dot >= 0 ? name.length() - dot - 1 : 0 );
+        int length = qMin( base, 8 ) + qMin( extension, 3 );
+        if( extension > 0 || addPeriod )
+            ++length;
+        return qMax( 1, length ) + version;
+    }
+
+
+    int jolietNameLength( const K3b::DataItem* item, const Options& o )
+    {
+        const int version = ( !item->isDir() && !o.omitVersion ) ? 2 : 0;
+        return 2 * ( qMin( item->k3bName().length(), o.jolietLong ? 103 : 64 ) + version );
+    }
+
+
+    int udfIdentifierLength( const K3b::DataItem* item )
+    {
+        // one byte for the compression id
+        const QString name = item->k3bName();
+        for( int i = 0; i < name.length(); ++i ) {
+            if( name[i].unicode() > 0xFF )
+                return 1 + 2*name.length();
+        }
+        return 1 + name.length();
+    }
+
+
+    bool inIsoTree( const K3b::DataItem* item, const Options& o )
+    {
+        return( item->writeToCd() &&
+                !item->hideOnRockRidge() &&
+                !( o.discardSymlinks && item->isSymLink() ) );
+    }
+
+
+    bool inJolietTree( const K3b::DataItem* item, const Options& o )
+    {
+        return( item->writeToCd() &&
+                !item->hideOnJoliet() &&
+                !( o.discardSymlinks && item->isSymLink() ) );
+    }
+}
+
+
+class K3b::IsoSizeEstimator::Private
+{
+public:
+    void markDirty( DirItem* dir ) {
+        if( dir && dirs.contains( dir ) )
+            dirtyDirs.insert( dir );
+    }
+
+    void markSubTreeDirty( DirItem* dir ) {
+        markDirty( dir );
+        Q_FOREACH( DataItem* child, dir->children() ) {
+            if( child->isDir() )
+                markSubTreeDirty( static_cast<DirItem*>( child ) );
+        }
+    }
+
+    DirInfo calculate( DirItem* dir ) const;
+
+    QHash<DirItem*, DirInfo> dirs;
+    QSet<DirItem*> dirtyDirs;
+
+    // the sum of all DirInfos in dirs
+    DirInfo total;
+
+    Options options;
+};
+
+
+DirInfo K3b::IsoSizeEstimator::Private::calculate( DirItem* dir ) const
+{
+    DirInfo info;
+    const bool isRoot = !dir->parent();
+
+    if( isRoot || inIsoTree( dir, options ) ) {
+        const int rr = ( options.rockRidge ? s_rockRidgeEntrySize : 0 );
+        qint64 continuationBytes = 0;
+
+        RecordPacker packer;
+        packer.add( recordLength( 1 ) + rr + ( isRoot && options.rockRidge ? s_rockRidgeRootEntrySize : 0 ) );
+        packer.add( recordLength( 1 ) + rr );
+        Q_FOREACH( DataItem* child, dir->children() ) {
+            if( !inIsoTree( child, options ) )
+                continue;
+
+            int length = recordLength( isoNameLength( child, options ) );
+            if( options.rockRidge ) {
+                // RR, PX, TF, and NM with the full name
+                length += rr + 5 + child->k3bName().toUtf8().length();
+                if( child->isSymLink() && !options.followSymlinks )
+                    length += s_rockRidgeSymLinkEntrySize;
+
+                // the rest goes to a continuation area
+                if( length > s_maxRecordSize ) {
+                    continuationBytes += length - s_maxRecordSize + 28;
+                    length = s_maxRecordSize;
+                }
+            }
+            packer.add( length );
+        }
+
+        info.isoBlocks = packer.blocks() + toBlocks( continuationBytes );
+        info.isoPathTableBytes = pathTableEntryLength( isRoot ? 1 : isoNameLength( dir, options ) );
+    }
+
+    if( options.joliet && ( isRoot || inJolietTree( dir, options ) ) ) {
+        RecordPacker packer;
+        packer.add( recordLength( 1 ) );
+        packer.add( recordLength( 1 ) );
+        Q_FOREACH( DataItem* child, dir->children() ) {
+            if( inJolietTree( child, options ) )
+                packer.add( recordLength( jolietNameLength( child, options ) ) );
+        }
+
+        info.jolietBlocks = packer.blocks();
+        info.jolietPathTableBytes = pathTableEntryLength( isRoot ? 1 : jolietNameLength( dir, options ) );
+    }
+
+    if( options.udf ) {
+        // the file identifier of the parent folder
+        qint64 bytes = 40;
+        Q_FOREACH( DataItem* child, dir->children() ) {
+            if( child->writeToCd() ) {
+                // identifiers are padded to multiples of 4 bytes
+                bytes += ( 38 + udfIdentifierLength( child ) + 3 ) & ~3;
+
+                // one file entry per item
+                ++info.udfBlocks;
+            }
+        }
+        info.udfBlocks += toBlocks( bytes );
+    }
+
+    return info;
+}
+
+
+K3b::IsoSizeEstimator::IsoSizeEstimator()
+    : d( new Private() )
+{
+}
+
+
+K3b::IsoSizeEstimator::~IsoSizeEstimator()
+{
+    delete d;
+}
+
+
+void K3b::IsoSizeEstimator::addItem( DataItem* item )
+{
+    if( item->isDir() ) {
+        DirItem* dir = static_cast<DirItem*>( item );
+        if( !d->dirs.contains( dir ) ) {
+            d->dirs.insert( dir, DirInfo() );
+            d->dirtyDirs.insert( dir );
+        }
+    }
+    d->markDirty( item->parent() );
+}
+
+
+void K3b::IsoSizeEstimator::removeItem( DataItem* item )
+{
+    if( item->isDir() ) {
+        DirItem* dir = static_cast<DirItem*>( item );
+        QHash<DirItem*, DirInfo>::iterator it = d->dirs.find( dir );
+        if( it != d->dirs.end() ) {
+            d->total -= it.value();
+            d->dirs.erase( it );
+            d->dirtyDirs.remove( dir );
+        }
+    }
+    d->markDirty( item->parent() );
+}
+
+
+void K3b::IsoSizeEstimator::itemChanged( DataItem* item )
+{
+    // the visibility is inherited by the contents of a folder
+    if( item->isDir() )
+        d->markSubTreeDirty( static_cast<DirItem*>( item ) );
+    d->markDirty( item->parent() );
+}
+
+
+void K3b::IsoSizeEstimator::clear()
+{
+    d->dirs.clear();
+    d->dirtyDirs.clear();
+    d->total = DirInfo();
+}
+
+
+K3b::Msf K3b::IsoSizeEstimator::blocks( DirItem* root, const IsoOptions& isoOptions, bool bootable, bool udf ) const
+{
+    if( !root )
+        return 0;
+
+    const Options options( isoOptions, udf );
+    if( !( options == d->options ) ) {
+        d->options = options;
+        d->dirtyDirs = QSet<DirItem*>::fromList( d->dirs.keys() );
+    }
+
+    if( !d->dirs.contains( root ) ) {
+        d->dirs.insert( root, DirInfo() );
+        d->dirtyDirs.insert( root );
+    }
+
+    Q_FOREACH( DirItem* dir, d->dirtyDirs ) {
+        DirInfo& info = d->dirs[dir];
+        d->total -= info;
+        info = d->calculate( dir );
+        d->total += info;
+    }
+    d->dirtyDirs.clear();
+
+    // system area, primary volume descriptor, terminator, and version descriptor
+    qint64 blocks = s_systemAreaBlocks + 3;
+    if( bootable )
+        ++blocks;
+
+    // there is a little endian and a big endian version of every path table
+    blocks += 2 * toBlocks( d->total.isoPathTableBytes );
+    blocks += d->total.isoBlocks;
+
+    // the ER entry in the continuation area of the root folder
+    if( options.rockRidge )
+        ++blocks;
+
+    if( options.joliet ) {
+        // the supplementary volume descriptor
+        ++blocks;
+        blocks += 2 * toBlocks( d->total.jolietPathTableBytes );
+        blocks += d->total.jolietBlocks;
+    }
+
+    if( options.udf )
+        blocks += s_udfFixedBlocks + d->total.udfBlocks;
+
+    return blocks + s_paddingBlocks;
+}
@@ -0,0 +1,77 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_ISO_SIZE_ESTIMATOR_H_
+#define _K3B_ISO_SIZE_ESTIMATOR_H_
+
+#include "k3b_export.h"
+#include "k3bmsf.h"
+
+namespace K3b {
+    class DataItem;
+    class DirItem;
+    class IsoOptions;
+
+    /**
+     * Estimates the number of blocks mkisofs needs for the filesystem
+     * structures of a data project: the system area, the volume descriptors,
+     * the directory records and path tables of the ISO9660 and Joliet trees
+     * including the Rock Ridge entries, the El Torito boot record, and the
+     * UDF structures.
+     *
+     * The size of every folder is cached and only recalculated after its
+     * contents changed. The file data itself is not included, it is handled
+     * by FileCompilationSizeHandler.
+     *
+     * The ISO9660 and Joliet structures are modelled after mkisofs and
+     * are usually exact. UDF and Rock Ridge continuation areas are only
+     * approximated.
+     */
+    class LIBK3B_EXPORT IsoSizeEstimator
+    {
+    public:
+        IsoSizeEstimator();
+        ~IsoSizeEstimator();
+
+        /**
+         * Has to be called for every item which is added to the project,
+         * including the root item and the contents of added folders.
+         */
+        void addItem( DataItem* item );
+
+        /**
+         * Has to be called for every item which is removed from the project,
+         * including the contents of removed folders.
+         */
+        void removeItem( DataItem* item );
+
+        /**
+         * Has to be called if the name or the visibility of an item changed.
+         */
+        void itemChanged( DataItem* item );
+
+        void clear();
+
+        /**
+         * \return The number of blocks used by the filesystem structures.
+         */
+        Msf blocks( DirItem* root, const IsoOptions& options, bool bootable, bool udf ) const;
+
+    private:
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
@@ -18,6 +18,9 @@
 #include "k3bdevicemanager.h"
 #include "k3bdevicehandler.h"
 #include "k3bglobalsettings.h"
+#include "k3bmediacache.h"
+#include "k3bthroughputestimator.h"
+#include "k3bdiskinfo.h"
 #include "k3b_i18n.h"
 
 
@@ -89,4 +92,16 @@ void K3b::AbstractWriter::slotEjectWhileCancellationFinished( bool success )
 }
 
 
+void K3b::AbstractWriter::prepareThroughputEstimator( K3b::ThroughputEstimator* est )
+{
+    est->reset();
+    est->setTotalSize( 0 );
+
+    const Device::DiskInfo info = k3bcore->mediaCache()->diskInfo( burnDevice() );
+    est->setSpeedProfile( ThroughputEstimator::SpeedProfile::forMediaType( info.mediaType(),
+                                                                          info.capacity().mode1Bytes()/1024 ),
+                          info.size().mode1Bytes()/1024 );
 
+    disconnect( est, SIGNAL(estimatedRemainingTime(int)), this, SIGNAL(remainingTime(int)) );
+    connect( est, SIGNAL(estimatedRemainingTime(int)), this, SIGNAL(remainingTime(int)) );
+}
@@ -26,6 +26,7 @@ class QIODevice;
 
 namespace K3b {
     class JobHandler;
+    class ThroughputEstimator;
 
     class AbstractWriter : public Job
     {
@@ -77,6 +78,12 @@ namespace K3b {
 
         bool wasSourceUnreadable() const { return m_sourceUnreadable; }
 
+        /**
+         * Resets @p est and sets the speed profile of the medium in the
+         * burn device. Also forwards the predicted remaining time.
+         */
+        void prepareThroughputEstimator( ThroughputEstimator* est );
+
     protected Q_SLOTS:
         void slotUnblockWhileCancellationFinished( bool success );
         void slotEjectWhileCancellationFinished( bool success );
@@ -0,0 +1,328 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bbinaryproject.h"
+#include "k3bdoc.h"
+
+#include <QDebug>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QVector>
+
+#include <string.h>
+
+
+namespace {
+    const char s_signature[8] = { 'K', '3', 'B', 'P', 'R', 'O', 'J', '\0' };
+    const quint32 s_version = 1;
+
+    // protects the decoder from overflowing the stack with broken files
+    const int s_maxDepth = 1024;
+
+    enum NodeKind {
+        ElementNode = 0,
+        TextNode = 1,
+        CDataNode = 2
+    };
+
+
+    class Encoder
+    {
+    public:
+        QByteArray encode( const QDomDocument& doc ) {
+            const quint32 docType = stringIndex( doc.doctype().name() );
+            writeElement( doc.documentElement() );
+
+            QByteArray result;
+            result.reserve( m_tree.size() + m_strings.size() + 64 );
+            result.append( s_signature, sizeof( s_signature ) );
+            for( int i = 0; i < 4; ++i )
+                result.append( char( ( s_version >> ( 8*i ) ) & 0xFF ) );
+            appendVarint( result, m_stringCount );
+            result.append( m_strings );
+            appendVarint( result, docType );
+            result.append( m_tree );
+            return result;
+        }
+
+    private:
+        static void appendVarint( QByteArray& data, quint64 value ) {
+            do {
+                char byte = value & 0x7F;
+                value >>= 7;
+                if( value )
+                    byte |= 0x80;
+                data.append( byte );
+            } while( value );
+        }
+
+        quint32 stringIndex( const QString& s ) {
+            QHash<QString, quint32>::const_iterator it = m_stringIndex.constFind( s );
+            if( it != m_stringIndex.constEnd() )
+                return it.value();
+
+            const QByteArray utf8 = s.toUtf8();
+            appendVarint( m_strings, utf8.size() );
+            m_strings.append( utf8 );
+            m_stringIndex.insert( s, m_stringCount );
+            return m_stringCount++;
+        }
+
+        void writeElement( const QDomElement& elem ) {
+            appendVarint( m_tree, stringIndex( elem.tagName() ) );
+
+            const QDomNamedNodeMap attrs = elem.attributes();
+            appendVarint( m_tree, attrs.count() );
+            for( int i = 0; i < attrs.count(); ++i ) {
+                const QDomAttr attr = attrs.item( i ).toAttr();
+                appendVarint( m_tree, stringIndex( attr.name() ) );
+                appendVarint( m_tree, stringIndex( attr.value() ) );
+            }
+
+            int children = 0;
+            for( QDomNode n = elem.firstChild(); !n.isNull(); n = n.nextSibling() ) {
+                if( n.isElement() || n.isText() )
+                    ++children;
+            }
+            appendVarint( m_tree, children );
+
+            for( QDomNode n = elem.firstChild(); !n.isNull(); n = n.nextSibling() ) {
+                if( n.isElement() ) {
+                    m_tree.append( char( ElementNode ) );
+                    writeElement( n.toElement() );
+                }
+                // CDATA sections are text nodes, too
+                else if( n.isCDATASection() ) {
+                    m_tree.append( char( CDataNode ) );
+                    appendVarint( m_tree, stringIndex( n.toCDATASection().data() ) );
+                }
+                else if( n.isText() ) {
+                    m_tree.append( char( TextNode ) );
+                    appendVarint( m_tree, stringIndex( n.toText().data() ) );
+                }
+            }
+        }
+
+        QHash<QString, quint32> m_stringIndex;
+        quint32 m_stringCount = 0;
+        QByteArray m_strings;
+        QByteArray m_tree;
+    };
+
+
+    class Decoder
+    {
+    public:
+        Decoder( const char* data, qint64 size )
+            : m_pos( reinterpret_cast<const uchar*>( data ) ),
+              m_end( reinterpret_cast<const uchar*>( data ) + size ),
+              m_ok( true ) {
+        }
+
+        bool decode( QDomDocument& doc ) {
+            if( m_end - m_pos < qint64( sizeof( s_signature ) + 4 ) ||
+                ::memcmp( m_pos, s_signature, sizeof( s_signature ) ) ) {
+                qDebug() << "(K3b::BinaryProject) invalid signature.";
+                return false;
+            }
+            m_pos += sizeof( s_signature );
+
+            quint32 version = 0;
+            for( int i = 0; i < 4; ++i )
+                version |= quint32( *m_pos++ ) << ( 8*i );
+            if( version > s_version ) {
+                qDebug() << "(K3b::BinaryProject) unsupported version" << version;
+                return false;
+            }
+
+            const quint64 stringCount = readVarint();
+            // every string needs at least one byte
+            if( !m_ok || stringCount > quint64( m_end - m_pos ) ) {
+                qDebug() << "(K3b::BinaryProject) invalid string table.";
+                return false;
+            }
+            m_strings.reserve( stringCount );
+            for( quint64 i = 0; i < stringCount && m_ok; ++i ) {
+                const quint64 length = readVarint();
+                if( !m_ok || length > quint64( m_end - m_pos ) ) {
+                    m_ok = false;
+                    break;
+                }
+                m_strings.append( QString::fromUtf8( reinterpret_cast<const char*>( m_pos ), length ) );
+                m_pos += length;
+            }
+
+            const QString docType = readString();
+            if( !m_ok ) {
+                qDebug() << "(K3b::BinaryProject) invalid string table.";
+                return false;
+            }
+
+            doc = QDomDocument( docType );
+            QDomElement root = readElement( doc, 0 );
+            if( !m_ok ) {
+                qDebug() << "(K3b::BinaryProject) invalid element tree.";
+                return false;
+            }
+            doc.appendChild( root );
+            return true;
+        }
+
+    private:
+        quint64 readVarint() {
+            quint64 value = 0;
+            for( int shift = 0; shift < 64; shift += 7 ) {
+                if( m_pos >= m_end )
+                    break;
+                const uchar byte = *m_pos++;
+                value |= quint64( byte & 0x7F ) << shift;
+                if( !( byte & 0x80 ) )
+                    return value;
+            }
+            m_ok = false;
+            return 0;
+        }
+
+        QString readString() {
+            const quint64 index = readVarint();
+            if( index >= quint64( m_strings.count() ) ) {
+                m_ok = false;
+                return QString();
+            }
+            return m_strings.at( index );
+        }
+
+        QDomElement readElement( QDomDocument& doc, int depth ) {
+            if( depth > s_maxDepth ) {
+                m_ok = false;
+                return QDomElement();
+            }
+
+            QDomElement elem = doc.createElement( readString() );
+
+            const quint64 attrCount = readVarint();
+            for( quint64 i = 0; i < attrCount && m_ok; ++i ) {
+                const QString name = readString();
+                const QString value = readString();
+                elem.setAttribute( name, value );
+            }
+
+            const quint64 childCount = readVarint();
+            for( quint64 i = 0; i < childCount && m_ok; ++i ) {
+                if( m_pos >= m_end ) {
+                    m_ok = false;
+                    break;
+                }
+                switch( *m_pos++ ) {
+                case ElementNode:
+                    elem.appendChild( readElement( doc, depth+1 ) );
+                    break;
+                case TextNode:
+                    elem.appendChild( doc.createTextNode( readString() ) );
+                    break;
+                case CDataNode:
+                    elem.appendChild( doc.createCDATASection( readString() ) );
+                    break;
+                default:
+                    m_ok = false;
+                    break;
+                }
+            }
+
+            return elem;
+        }
+
+        const uchar* m_pos;
+        const uchar* m_end;
+        bool m_ok;
+        QVector<QString> m_strings;
+    };
+}
+
+
+QString K3b::BinaryProject::extension()
+{
+    return QLatin1String( ".k3bb" );
+}
+
+
+bool K3b::BinaryProject::isBinaryProject( const QString& filename )
+{
+    QFile f( filename );
+    char signature[sizeof( s_signature )];
+    return( f.open( QIODevice::ReadOnly ) &&
+            f.read( signature, sizeof( signature ) ) == sizeof( signature ) &&
+            !::memcmp( signature, s_signature, sizeof( signature ) ) );
+}
+
+
+QByteArray K3b::BinaryProject::encode( const QDomDocument& doc )
+{
+    return Encoder().encode( doc );
+}
+
+
+bool K3b::BinaryProject::decode( const char* data, qint64 size, QDomDocument& doc )
+{
+    return Decoder( data, size ).decode( doc );
+}
+
+
+bool K3b::BinaryProject::save( Doc* doc, const QString& filename )
+{
+    const QString docType = "k3b_" + doc->typeString() + "_project";
+    QDomDocument xmlDoc( docType );
+    QDomElement docElem = xmlDoc.createElement( docType );
+    xmlDoc.appendChild( docElem );
+    if( !doc->saveDocumentData( &docElem ) )
+        return false;
+
+    QSaveFile f( filename );
+    if( !f.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::BinaryProject) could not open" << filename;
+        return false;
+    }
+
+    const QByteArray data = encode( xmlDoc );
+    if( f.write( data ) != data.size() ) {
+        f.cancelWriting();
+        return false;
+    }
+
+    return f.commit();
+}
+
+
+bool K3b::BinaryProject::load( const QString& filename, QDomDocument& doc )
+{
+    QFile f( filename );
+    if( !f.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "(K3b::BinaryProject) could not open" << filename;
+        return false;
+    }
+
+    // map the file to avoid copying it around
+    if( uchar* data = f.map( 0, f.size() ) ) {
+        const bool success = decode( reinterpret_cast<const char*>( data ), f.size(), doc );
+        f.unmap( data );
+        return success;
+    }
+    else {
+        const QByteArray data = f.readAll();
+        return decode( data.constData(), data.size(), doc );
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_BINARY_PROJECT_H_
+#define _K3B_BINARY_PROJECT_H_
+
+#include "k3b_export.h"
+
+#include <QByteArray>
+#include <QString>
+
+class QDomDocument;
+
+namespace K3b {
+    class Doc;
+
+    /**
+     * The binary project format is a compact alternative to the zipped xml
+     * project files meant for big projects which are opened over and over
+     * again, like archiving jobs.
+     *
+     * It stores the very same element tree the projects create in
+     * Doc::saveDocumentData(). All names, attribute values and texts are
+     * stored once in a string table and referenced by index. The data
+     * project additionally saves a stat snapshot of every file which lets it
+     * create the file items without touching the files and check them in
+     * the background.
+     *
+     * Files start with an eight byte signature followed by the format
+     * version, the string table, the index of the doctype name, and the
+     * tree of the document element. All numbers are stored as unsigned
+     * LEB128 varints.
+     */
+    namespace BinaryProject {
+        /**
+         * The filename extension used for binary projects.
+         */
+        LIBK3B_EXPORT QString extension();
+
+        /**
+         * \return true if the file starts with the binary project signature.
+         */
+        LIBK3B_EXPORT bool isBinaryProject( const QString& filename );
+
+        LIBK3B_EXPORT QByteArray encode( const QDomDocument& doc );
+
+        /**
+         * Decodes @p size bytes at @p data into @p doc.
+         *
+         * \return false if the data is not a valid binary project.
+         */
+        LIBK3B_EXPORT bool decode( const char* data, qint64 size, QDomDocument& doc );
+
+        /**
+         * Saves @p doc into @p filename using Doc::saveDocumentData().
+         */
+        LIBK3B_EXPORT bool save( Doc* doc, const QString& filename );
+
+        /**
+         * Maps @p filename into memory and decodes it.
+         */
+        LIBK3B_EXPORT bool load( const QString& filename, QDomDocument& doc );
+    }
+}
+
+#endif
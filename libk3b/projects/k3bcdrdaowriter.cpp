@@ -426,7 +426,7 @@ void K3b::CdrdaoWriter::start()
 {
     jobStarted();
 
-    d->speedEst->reset();
+    prepareThroughputEstimator( d->speedEst );
 
     delete m_process;  // kdelibs want this!
     m_process = new K3b::Process();
@@ -910,6 +910,7 @@ void K3b::CdrdaoWriter::parseCdrdaoWrote( const QString& line )
     po2 = line.indexOf( " ", pos + 3 );
     m_size = line.mid( pos+3, po2-pos-3 ).toInt();
 
+    d->speedEst->setTotalSize( m_size*1024 );
     d->speedEst->dataWritten( processed*1024 );
 
     emit processedSize( processed, m_size );
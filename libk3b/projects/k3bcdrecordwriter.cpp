@@ -389,7 +389,7 @@ void K3b::CdrecordWriter::start()
     jobStarted();
 
     d->canceled = false;
-    d->speedEst->reset();
+    prepareThroughputEstimator( d->speedEst );
     d->writingStarted = false;
 
     if ( !prepareProcess() ) {
@@ -566,6 +566,7 @@ void K3b::CdrecordWriter::slotStdLine( const QString& line )
                 emit percent( 100*(d->alreadyWritten+made)/d->totalSize );
             }
 
+            d->speedEst->setTotalSize( d->totalSize*1024 );
             d->speedEst->dataWritten( (d->alreadyWritten+made)*1024 );
         }
     }
@@ -400,7 +400,7 @@ void K3b::CdrskinWriter::start()
     jobStarted();
 
     d->canceled = false;
-    d->speedEst->reset();
+    prepareThroughputEstimator( d->speedEst );
     d->writingStarted = false;
 
     if ( !prepareProcess() ) {
@@ -577,6 +577,7 @@ void K3b::CdrskinWriter::slotStdLine( const QString& line )
                 emit percent( 100*(d->alreadyWritten+made)/d->totalSize );
             }
 
+            d->speedEst->setTotalSize( d->totalSize*1024 );
             d->speedEst->dataWritten( (d->alreadyWritten+made)*1024 );
         }
     }
@@ -23,6 +23,8 @@
 #include <QDebug>
 #include <QString>
 #include <QDomElement>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 #include <QWidget>
 
 
@@ -117,6 +119,87 @@ bool K3b::Doc::newDocument()
 }
 
 
+bool K3b::Doc::loadDocumentStream( QXmlStreamReader* xml )
+{
+    QDomDocument doc;
+    QDomElement root = readDomElement( xml, doc );
+    if( xml->hasError() ) {
+        qDebug() << "(K3b::Doc) parse error:" << xml->errorString();
+        return false;
+    }
+    doc.appendChild( root );
+
+    return loadDocumentData( &root );
+}
+
+
+bool K3b::Doc::saveDocumentStream( QXmlStreamWriter* xml )
+{
+    QDomDocument doc;
+    QDomElement docElem = doc.createElement( "root" );
+    doc.appendChild( docElem );
+    if( !saveDocumentData( &docElem ) )
+        return false;
+
+    for( QDomElement e = docElem.firstChildElement(); !e.isNull(); e = e.nextSiblingElement() )
+        writeDomElement( xml, e );
+
+    return !xml->hasError();
+}
+
+
+QDomElement K3b::Doc::readDomElement( QXmlStreamReader* xml, QDomDocument& doc )
+{
+    QDomElement elem = doc.createElement( xml->name().toString() );
+    Q_FOREACH( const QXmlStreamAttribute& attr, xml->attributes() ) {
+        elem.setAttribute( attr.name().toString(), attr.value().toString() );
+    }
+
+    while( !xml->atEnd() ) {
+        switch( xml->readNext() ) {
+        case QXmlStreamReader::StartElement:
+            elem.appendChild( readDomElement( xml, doc ) );
+            break;
+        case QXmlStreamReader::Characters:
+            if( xml->isCDATA() )
+                elem.appendChild( doc.createCDATASection( xml->text().toString() ) );
+            else if( !xml->isWhitespace() )
+                elem.appendChild( doc.createTextNode( xml->text().toString() ) );
+            break;
+        case QXmlStreamReader::EndElement:
+            return elem;
+        default:
+            break;
+        }
+    }
+
+    return elem;
+}
+
+
+void K3b::Doc::writeDomElement( QXmlStreamWriter* xml, const QDomElement& elem )
+{
+    xml->writeStartElement( elem.tagName() );
+
+    QDomNamedNodeMap attrs = elem.attributes();
+    for( int i = 0; i < attrs.count(); ++i ) {
+        QDomAttr attr = attrs.item( i ).toAttr();
+        xml->writeAttribute( attr.name(), attr.value() );
+    }
+
+    for( QDomNode n = elem.firstChild(); !n.isNull(); n = n.nextSibling() ) {
+        if( n.isElement() )
+            writeDomElement( xml, n.toElement() );
+        else if( n.isCDATASection() )
+            xml->writeCDATA( n.toCDATASection().data() );
+        else if( n.isText() )
+            xml->writeCharacters( n.toText().data() );
+    }
+
+    xml->writeEndElement();
+}
+
+
 bool K3b::Doc::saveGeneralDocumentData( QDomElement* part )
 {
     QDomDocument doc = part->ownerDocument();
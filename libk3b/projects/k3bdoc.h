@@ -26,7 +26,10 @@
 #include <QString>
 #include <QUrl>
 
+class QDomDocument;
 class QDomElement;
+class QXmlStreamReader;
+class QXmlStreamWriter;
 namespace K3b {
     class BurnJob;
     class JobHandler;
@@ -125,6 +128,26 @@ namespace K3b {
          */
         virtual bool saveDocumentData( QDomElement* docElem ) = 0;
 
+        /**
+         * Load a project from an xml stream without building a DOM tree first.
+         * The reader is positioned at the start of the document element and
+         * is left at its end.
+         *
+         * The default implementation reads the document element into a DOM
+         * tree and calls loadDocumentData( QDomElement* ). Projects which can
+         * become very big should reimplement it.
+         */
+        virtual bool loadDocumentStream( QXmlStreamReader* xml );
+
+        /**
+         * Save a project to an xml stream without building a DOM tree first.
+         * Only the contents of the document element are written.
+         *
+         * The default implementation calls saveDocumentData( QDomElement* )
+         * and writes the resulting DOM tree.
+         */
+        virtual bool saveDocumentStream( QXmlStreamWriter* xml );
+
         /** returns the QUrl of the document */
         const QUrl& URL() const;
         /** sets the URL of the document */
@@ -177,6 +200,12 @@ namespace K3b {
         void changed();
         void changed( K3b::Doc* );
 
+        /**
+         * Emitted when the size of the project changed without the project
+         * itself being changed, e.g. after some calculation in the background.
+         */
+        void sizeChanged();
+
     public Q_SLOTS:
         void setDummy( bool d );
         void setWritingMode( WritingMode m ) { m_writingMode = m; }
@@ -200,6 +229,18 @@ namespace K3b {
 
         bool readGeneralDocumentData( const QDomElement& );
 
+        /**
+         * Reads the element the reader is positioned at, including all its
+         * children, into a DOM element created in @p doc. Whitespace-only
+         * text is dropped like QDomDocument::setContent() does.
+         */
+        static QDomElement readDomElement( QXmlStreamReader* xml, QDomDocument& doc );
+
+        /**
+         * Writes @p elem and all its children to the stream.
+         */
+        static void writeDomElement( QXmlStreamWriter* xml, const QDomElement& elem );
+
     private Q_SLOTS:
         void slotChanged();
 
@@ -325,7 +325,7 @@ void K3b::GrowisofsWriter::start()
     d->lastSpeedCalculationBytes = 0;
     d->writingStarted = false;
     d->canceled = false;
-    d->speedEst->reset();
+    prepareThroughputEstimator( d->speedEst );
     d->finished = false;
 
     if( !prepareProcess() ) {
@@ -475,9 +475,10 @@ void K3b::GrowisofsWriter::slotReceivedStderr( const QString& line )
                     qDebug() << "(K3b::GrowisofsWriter) speed parsing failed: '"
                              << line.mid( pos, line.indexOf( 'x', pos ) - pos ) << "'" << endl;
             }
-            else {
-                d->speedEst->dataWritten( done/1024 );
-            }
+
+            // also used to predict the remaining time
+            d->speedEst->setTotalSize( d->overallSizeFromOutput/1024 );
+            d->speedEst->dataWritten( done/1024 );
         }
         else
             qDebug() << "(K3b::GrowisofsWriter) progress parsing failed: '"
@@ -540,7 +541,9 @@ void K3b::GrowisofsWriter::slotProcessExited( int exitCode, QProcess::ExitStatus
 
 void K3b::GrowisofsWriter::slotThroughput( int t )
 {
-    emit writeSpeed( t, d->speedMultiplicator() );
+    // newer growisofs versions report the speed themselves
+    if( d->lastWritingSpeed <= 0 )
+        emit writeSpeed( t, d->speedMultiplicator() );
 }
 
 
@@ -163,6 +163,9 @@ void K3b::MixedJob::start()
     m_currentAction = PREPARING_DATA;
     d->maxSpeed = false;
 
+    // decouple the iso image creation from the writing application
+    d->pipe.setBufferSize( qint64( k3bcore->globalSettings()->pipeBufferSize() ) * 1024LL * 1024LL );
+
     if( m_doc->dummy() )
         d->copies = 1;
 
@@ -585,9 +588,7 @@ void K3b::MixedJob::slotAudioDecoderFinished( bool success )
         if( m_doc->mixedType() == K3b::MixedDoc::DATA_LAST_TRACK ) {
             m_currentAction = WRITING_ISO_IMAGE;
             m_isoImager->start();
-            d->pipe.readFrom( m_isoImager->ioDevice() );
-            d->pipe.writeTo( m_writer->ioDevice() );
-            d->pipe.open();
+            pipeIsoImageToWriter();
         }
     }
     else {
@@ -1065,9 +1066,7 @@ bool K3b::MixedJob::startWriting()
         }
         else {
             m_isoImager->start();
-            d->pipe.readFrom( m_isoImager->ioDevice() );
-            d->pipe.writeTo( m_writer->ioDevice() );
-            d->pipe.open();
+            pipeIsoImageToWriter();
         }
     }
 
@@ -1122,6 +1121,24 @@ void K3b::MixedJob::cleanupAfterError()
 }
 
 
+void K3b::MixedJob::pipeIsoImageToWriter()
+{
+    d->pipe.readFrom( m_isoImager->ioDevice() );
+    d->pipe.writeTo( m_writer->ioDevice() );
+
+    //
+    // The FIFO is a lot bigger than the one of the writing application so
+    // we report its fill level while the data track is written.
+    //
+    if( k3bcore->globalSettings()->pipeBufferSize() > 0 ) {
+        disconnect( m_writer, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)) );
+        connect( &d->pipe, SIGNAL(buffer(int)), this, SIGNAL(bufferStatus(int)), Qt::UniqueConnection );
+    }
+
+    d->pipe.open();
+}
+
+
 void K3b::MixedJob::removeBufferFiles()
 {
     if ( !m_doc->onTheFly() ) {
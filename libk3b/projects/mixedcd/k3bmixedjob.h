@@ -94,6 +94,7 @@ namespace K3b {
         void cleanupAfterError();
         void removeBufferFiles();
         void createIsoImage();
+        void pipeIsoImageToWriter();
         void determineWritingMode();
         void normalizeFiles();
         void prepareProgressInformation();
@@ -368,6 +368,18 @@ bool K3b::MovixDoc::loadDocumentData( QDomElement* rootElem )
 }
 
 
+bool K3b::MovixDoc::loadDocumentStream( QXmlStreamReader* xml )
+{
+    return K3b::Doc::loadDocumentStream( xml );
+}
+
+
+bool K3b::MovixDoc::saveDocumentStream( QXmlStreamWriter* xml )
+{
+    return K3b::Doc::saveDocumentStream( xml );
+}
+
+
 bool K3b::MovixDoc::saveDocumentData( QDomElement* docElem )
 {
     QDomDocument doc = docElem->ownerDocument();
@@ -115,6 +115,10 @@ namespace K3b {
         bool loadDocumentData( QDomElement* root ) override;
         /** reimplemented from Doc */
         bool saveDocumentData( QDomElement* ) override;
+        /** reimplemented from DataDoc, the movix files are not part of the data file tree */
+        bool loadDocumentStream( QXmlStreamReader* xml ) override;
+        /** reimplemented from DataDoc, the movix files are not part of the data file tree */
+        bool saveDocumentStream( QXmlStreamWriter* xml ) override;
 
     private:
         QList<MovixFileItem*> m_movixFiles;
@@ -27,8 +27,12 @@
 #include <KStandardGuiItem>
 
 #include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QThread>
 #include <QTimer>
 #include <QImage>
 #include <QApplication>
@@ -43,6 +47,211 @@ bool aspect_correction = false;
 byte forced_sequence_header = 0;
 #endif
 
+
+namespace {
+    // the files are read sequentially, more analyzers would only compete for the disk
+    int maxAnalyzers()
+    {
+        return qBound( 1, QThread::idealThreadCount(), 4 );
+    }
+
+    struct CachedMpegInfo
+    {
+        KIO::filesize_t size;
+        qint64 mtime;
+        K3b::Mpeginfo info;
+        QString errorString;
+    };
+
+    // analysis results of all projects by local path
+    typedef QHash<QString, CachedMpegInfo> MpegInfoCache;
+    Q_GLOBAL_STATIC( MpegInfoCache, s_mpegInfoCache )
+
+    bool fileStamp( const QString& path, KIO::filesize_t& size, qint64& mtime )
+    {
+        QFileInfo fi( path );
+        if ( !fi.exists() )
+            return false;
+        size = fi.size();
+        mtime = fi.lastModified().toMSecsSinceEpoch();
+        return true;
+    }
+
+    /**
+     * \return the cached analysis of @p path or 0 if there is none or
+     * the file changed since. Only valid until the cache is modified.
+     */
+    const CachedMpegInfo* findCachedMpegInfo( const QString& path )
+    {
+        MpegInfoCache::const_iterator it = s_mpegInfoCache->constFind( path );
+        KIO::filesize_t size = 0;
+        qint64 mtime = 0;
+        if ( it != s_mpegInfoCache->constEnd() &&
+             fileStamp( path, size, mtime ) &&
+             it->size == size &&
+             it->mtime == mtime )
+            return &it.value();
+        else
+            return 0;
+    }
+
+    void saveMpegInfo( QDomDocument& doc, QDomElement& trackElem, const QString& path )
+    {
+        MpegInfoCache::const_iterator it = s_mpegInfoCache->constFind( path );
+        if ( it == s_mpegInfoCache->constEnd() || it->info.version == K3b::MpegInfo::MPEG_VERS_INVALID )
+            return;
+
+        const K3b::Mpeginfo& info = it->info;
+        QDomElement infoElem = doc.createElement( "mpeginfo" );
+        infoElem.setAttribute( "size", QString::number( it->size ) );
+        infoElem.setAttribute( "mtime", QString::number( it->mtime ) );
+        infoElem.setAttribute( "version", QString::number( info.version ) );
+        infoElem.setAttribute( "muxrate", QString::number( info.muxrate ) );
+        infoElem.setAttribute( "playingtime", QString::number( info.playing_time, 'g', 17 ) );
+        infoElem.setAttribute( "video", info.has_video ? "yes" : "no" );
+        infoElem.setAttribute( "audio", info.has_audio ? "yes" : "no" );
+
+        for ( int i = 0; i < 3; ++i ) {
+            const K3b::video_info& video = info.video[ i ];
+            if ( !video.seen )
+                continue;
+            QDomElement videoElem = doc.createElement( "video" );
+            videoElem.setAttribute( "index", i );
+            videoElem.setAttribute( "hsize", QString::number( video.hsize ) );
+            videoElem.setAttribute( "vsize", QString::number( video.vsize ) );
+            videoElem.setAttribute( "aratio", QString::number( video.aratio, 'g', 17 ) );
+            videoElem.setAttribute( "frate", QString::number( video.frate, 'g', 17 ) );
+            videoElem.setAttribute( "bitrate", QString::number( video.bitrate ) );
+            videoElem.setAttribute( "vbvsize", QString::number( video.vbvsize ) );
+            videoElem.setAttribute( "progressive", video.progressive ? "yes" : "no" );
+            videoElem.setAttribute( "videoformat", QString::number( video.video_format ) );
+            videoElem.setAttribute( "chromaformat", QString::number( video.chroma_format ) );
+            videoElem.setAttribute( "constrained", video.constrained_flag ? "yes" : "no" );
+            infoElem.appendChild( videoElem );
+        }
+
+        for ( int i = 0; i < 3; ++i ) {
+            const K3b::audio_info& audio = info.audio[ i ];
+            if ( !audio.seen )
+                continue;
+            QDomElement audioElem = doc.createElement( "audio" );
+            audioElem.setAttribute( "index", i );
+            audioElem.setAttribute( "version", QString::number( audio.version ) );
+            audioElem.setAttribute( "layer", QString::number( audio.layer ) );
+            audioElem.setAttribute( "protect", QString::number( audio.protect ) );
+            audioElem.setAttribute( "bitrate", QString::number( audio.bitrate ) );
+            audioElem.setAttribute( "byterate", QString::number( audio.byterate, 'g', 9 ) );
+            audioElem.setAttribute( "sampfreq", QString::number( audio.sampfreq ) );
+            audioElem.setAttribute( "mode", audio.mode );
+            audioElem.setAttribute( "copyright", audio.copyright ? "yes" : "no" );
+            audioElem.setAttribute( "original", audio.original ? "yes" : "no" );
+            infoElem.appendChild( audioElem );
+        }
+
+        trackElem.appendChild( infoElem );
+    }
+
+    /**
+     * Puts the analysis stored with a track into the cache
+     * if the file did not change since.
+     */
+    void loadMpegInfo( const QDomElement& trackElem, const QString& path )
+    {
+        const QDomElement infoElem = trackElem.firstChildElement( "mpeginfo" );
+        if ( infoElem.isNull() )
+            return;
+
+        CachedMpegInfo entry;
+        if ( !fileStamp( path, entry.size, entry.mtime ) ||
+             entry.size != infoElem.attribute( "size" ).toULongLong() ||
+             entry.mtime != infoElem.attribute( "mtime" ).toLongLong() )
+            return;
+
+        K3b::Mpeginfo& info = entry.info;
+        info.version = infoElem.attribute( "version" ).toUInt();
+        info.muxrate = infoElem.attribute( "muxrate" ).toULong();
+        info.playing_time = infoElem.attribute( "playingtime" ).toDouble();
+        info.has_video = ( infoElem.attribute( "video" ) == "yes" );
+        info.has_audio = ( infoElem.attribute( "audio" ) == "yes" );
+        if ( info.version != K3b::MpegInfo::MPEG_VERS_MPEG1 && info.version != K3b::MpegInfo::MPEG_VERS_MPEG2 )
+            return;
+
+        for ( QDomElement e = infoElem.firstChildElement(); !e.isNull(); e = e.nextSiblingElement() ) {
+            const int i = e.attribute( "index" ).toInt();
+            if ( i < 0 || i > 2 )
+                return;
+
+            if ( e.tagName() == "video" ) {
+                K3b::video_info& video = info.video[ i ];
+                video.seen = true;
+                video.hsize = e.attribute( "hsize" ).toULong();
+                video.vsize = e.attribute( "vsize" ).toULong();
+                video.aratio = e.attribute( "aratio" ).toDouble();
+                video.frate = e.attribute( "frate" ).toDouble();
+                video.bitrate = e.attribute( "bitrate" ).toULong();
+                video.vbvsize = e.attribute( "vbvsize" ).toULong();
+                video.progressive = ( e.attribute( "progressive" ) == "yes" );
+                video.video_format = e.attribute( "videoformat" ).toUInt();
+                video.chroma_format = e.attribute( "chromaformat" ).toUInt();
+                video.constrained_flag = ( e.attribute( "constrained" ) == "yes" );
+            }
+            else if ( e.tagName() == "audio" ) {
+                K3b::audio_info& audio = info.audio[ i ];
+                audio.seen = true;
+                audio.version = e.attribute( "version" ).toUInt();
+                audio.layer = e.attribute( "layer" ).toUInt();
+                audio.protect = e.attribute( "protect" ).toUInt();
+                audio.bitrate = e.attribute( "bitrate" ).toULong();
+                audio.byterate = e.attribute( "byterate" ).toFloat();
+                audio.sampfreq = e.attribute( "sampfreq" ).toULong();
+                audio.mode = e.attribute( "mode" ).toInt();
+                audio.copyright = ( e.attribute( "copyright" ) == "yes" );
+                audio.original = ( e.attribute( "original" ) == "yes" );
+            }
+        }
+
+        s_mpegInfoCache->insert( path, entry );
+    }
+}
+
+
+/**
+ * Analyses one MPEG file. The result is put into the cache
+ * by the GUI thread with storeResult().
+ */
+class K3b::VcdDoc::AnalyzerThread : public QThread
+{
+public:
+    explicit AnalyzerThread( const QString& path )
+        : m_path( path ),
+          m_valid( false ) {
+        m_result.size = 0;
+        m_result.mtime = 0;
+    }
+
+    void storeResult() const {
+        if ( m_valid )
+            s_mpegInfoCache->insert( m_path, m_result );
+    }
+
+protected:
+    void run() override {
+        // take the stamp first so a change during the analysis invalidates the result
+        m_valid = fileStamp( m_path, m_result.size, m_result.mtime );
+
+        // MpegInfo keeps the pointer to the name
+        const QByteArray encodedPath = QFile::encodeName( m_path );
+        K3b::MpegInfo mpeg( encodedPath.constData() );
+        m_result.info = *mpeg.mpeg_info;
+        m_result.errorString = mpeg.error_string();
+    }
+
+private:
+    const QString m_path;
+    CachedMpegInfo m_result;
+    bool m_valid;
+};
+
 K3b::VcdDoc::VcdDoc( QObject* parent )
     : K3b::Doc( parent )
 {
@@ -51,6 +260,9 @@ K3b::VcdDoc::VcdDoc( QObject* parent )
 
     m_vcdType = NONE;
 
+    m_runningAnalyzers = 0;
+    m_workingUrlQueue = false;
+
     m_urlAddingTimer = new QTimer( this );
     connect( m_urlAddingTimer, SIGNAL(timeout()), this, SLOT(slotWorkUrlQueue()) );
 
@@ -61,6 +273,15 @@ K3b::VcdDoc::VcdDoc( QObject* parent )
 
 K3b::VcdDoc::~VcdDoc()
 {
+    // the analyzers do not touch the project, just wait for them
+    Q_FOREACH( PrivateUrlToAdd* item, urlsToAdd ) {
+        if ( item->analyzer ) {
+            item->analyzer->wait();
+            delete item->analyzer;
+        }
+        delete item;
+    }
+
     if ( m_tracks ) {
         qDeleteAll( *m_tracks );
         delete m_tracks;
@@ -148,12 +369,95 @@ void K3b::VcdDoc::addTracks( const QList<QUrl>& urls, uint position )
         urlsToAdd.enqueue( new PrivateUrlToAdd( K3b::convertToLocalUrl(*it), position++ ) );
     }
 
+    startAnalysis();
     m_urlAddingTimer->start( 0 );
 }
 
+void K3b::VcdDoc::startAnalysis()
+{
+    Q_FOREACH( PrivateUrlToAdd* item, urlsToAdd ) {
+        if ( item->analysed || item->analyzer )
+            continue;
+
+        // files which cannot be analysed are handled in slotWorkUrlQueue()
+        const QString path = item->url.toLocalFile();
+        if ( !item->url.isLocalFile() || !QFile::exists( path ) || findCachedMpegInfo( path ) ) {
+            item->analysed = true;
+        }
+        else if ( m_runningAnalyzers < maxAnalyzers() ) {
+            item->analyzer = new AnalyzerThread( path );
+            connect( item->analyzer, SIGNAL(finished()), this, SLOT(slotAnalysisFinished()) );
+            item->analyzer->start( QThread::LowPriority );
+            ++m_runningAnalyzers;
+        }
+        else {
+            break;
+        }
+    }
+}
+
+void K3b::VcdDoc::slotAnalysisFinished()
+{
+    AnalyzerThread* analyzer = static_cast<AnalyzerThread*>( sender() );
+    analyzer->storeResult();
+
+    Q_FOREACH( PrivateUrlToAdd* item, urlsToAdd ) {
+        if ( item->analyzer == analyzer ) {
+            item->analyzer = 0;
+            item->analysed = true;
+        }
+    }
+
+    --m_runningAnalyzers;
+    analyzer->deleteLater();
+
+    startAnalysis();
+
+    if ( !urlsToAdd.isEmpty() && urlsToAdd.head()->analysed && !m_urlAddingTimer->isActive() )
+        m_urlAddingTimer->start( 0 );
+}
+
+void K3b::VcdDoc::analyseFiles( const QStringList& paths )
+{
+    QQueue<AnalyzerThread*> running;
+    Q_FOREACH( const QString& path, paths ) {
+        if ( findCachedMpegInfo( path ) )
+            continue;
+
+        if ( running.count() >= maxAnalyzers() ) {
+            AnalyzerThread* analyzer = running.dequeue();
+            analyzer->wait();
+            analyzer->storeResult();
+            delete analyzer;
+        }
+
+        AnalyzerThread* analyzer = new AnalyzerThread( path );
+        analyzer->start();
+        running.enqueue( analyzer );
+    }
+
+    while ( !running.isEmpty() ) {
+        AnalyzerThread* analyzer = running.dequeue();
+        analyzer->wait();
+        analyzer->storeResult();
+        delete analyzer;
+    }
+}
+
 void K3b::VcdDoc::slotWorkUrlQueue()
 {
+    // a message box about the last track is still open
+    if ( m_workingUrlQueue )
+        return;
+
     if ( !urlsToAdd.isEmpty() ) {
+        // keep the order of the tracks and wait for the analysis of the next one
+        startAnalysis();
+        if ( !urlsToAdd.head()->analysed ) {
+            m_urlAddingTimer->stop();
+            return;
+        }
+
         PrivateUrlToAdd * item = urlsToAdd.dequeue();
         lastAddedPosition = item->position;
 
@@ -163,17 +467,21 @@ void K3b::VcdDoc::slotWorkUrlQueue()
 
         if ( !item->url.isLocalFile() ) {
             qDebug() << item->url.toLocalFile() << " no local file";
+            delete item;
             return ;
         }
 
         if ( !QFile::exists( item->url.toLocalFile() ) ) {
             qDebug() << "(K3b::VcdDoc) file not found: " << item->url.toLocalFile();
             m_notFoundFiles.append( item->url.toLocalFile() );
+            delete item;
             return ;
         }
 
+        m_workingUrlQueue = true;
         if ( K3b::VcdTrack * newTrack = createTrack( item->url ) )
             addTrack( newTrack, lastAddedPosition );
+        m_workingUrlQueue = false;
 
         delete item;
 
@@ -192,93 +500,89 @@ void K3b::VcdDoc::slotWorkUrlQueue()
 
 K3b::VcdTrack* K3b::VcdDoc::createTrack( const QUrl& url )
 {
-    char filename[ 255 ];
-    QString error_string = "";
-    strcpy( filename, QFile::encodeName( url.toLocalFile() ) );
-    K3b::MpegInfo* Mpeg = new K3b::MpegInfo( filename );
+    const CachedMpegInfo* cached = findCachedMpegInfo( url.toLocalFile() );
+    if ( !cached ) {
+        // the file changed after the analysis
+        analyseFiles( QStringList() << url.toLocalFile() );
+        cached = findCachedMpegInfo( url.toLocalFile() );
+    }
 
-    if ( Mpeg ) {
-        int mpegVersion = Mpeg->version();
-        if ( mpegVersion > 0 ) {
+    // copy it, the message boxes below allow the cache to change
+    K3b::Mpeginfo mpegInfo;
+    QString error_string;
+    if ( cached ) {
+        mpegInfo = cached->info;
+        error_string = cached->errorString;
+    }
 
-            if ( vcdType() == NONE && mpegVersion < 2 ) {
-                m_urlAddingTimer->stop();
+    const int mpegVersion = mpegInfo.version;
+    if ( mpegVersion > 0 ) {
+
+        if ( vcdType() == NONE && mpegVersion < 2 ) {
+            m_urlAddingTimer->stop();
+            setVcdType( vcdTypes( mpegVersion ) );
+            // FIXME: properly convert the mpeg version
+            vcdOptions() ->setMpegVersion( ( K3b::VcdOptions::MPEGVersion )mpegVersion );
+            KMessageBox::information( qApp->activeWindow(),
+                                      i18n( "K3b will create a %1 image from the given MPEG "
+                                            "files, but these files must already be in %1 "
+                                            "format. K3b does not yet resample MPEG files.",
+                                             i18n( "VCD" ) ),
+                                      i18n( "Information" ) );
+            m_urlAddingTimer->start( 0 );
+        } else if ( vcdType() == NONE ) {
+            m_urlAddingTimer->stop();
+            vcdOptions() ->setMpegVersion( ( K3b::VcdOptions::MPEGVersion )mpegVersion );
+            bool force = KMessageBox::questionYesNo( qApp->activeWindow(),
+                                                     i18n( "K3b will create a %1 image from the given MPEG "
+                                                           "files, but these files must already be in %1 "
+                                                           "format. K3b does not yet resample MPEG files.",
+                                                           i18n( "SVCD" ) )
+                                                     + "\n\n"
+                                                     + i18n( "Note: Forcing MPEG2 as VCD is not supported by "
+                                                             "some standalone DVD players." ),
+                                                     i18n( "Information" ),
+                                                     KGuiItem( i18n( "Force VCD" ) ),
+                                                     KGuiItem( i18n( "Do not force VCD" ) ) ) == KMessageBox::Yes;
+            if ( force ) {
+                setVcdType( vcdTypes( 1 ) );
+                vcdOptions() ->setAutoDetect( false );
+            } else
                 setVcdType( vcdTypes( mpegVersion ) );
-                // FIXME: properly convert the mpeg version
-                vcdOptions() ->setMpegVersion( ( K3b::VcdOptions::MPEGVersion )mpegVersion );
-                KMessageBox::information( qApp->activeWindow(),
-                                          i18n( "K3b will create a %1 image from the given MPEG "
-                                                "files, but these files must already be in %1 "
-                                                "format. K3b does not yet resample MPEG files.",
-                                                 i18n( "VCD" ) ),
-                                          i18n( "Information" ) );
-                m_urlAddingTimer->start( 0 );
-            } else if ( vcdType() == NONE ) {
-                m_urlAddingTimer->stop();
-                vcdOptions() ->setMpegVersion( ( K3b::VcdOptions::MPEGVersion )mpegVersion );
-                bool force = KMessageBox::questionYesNo( qApp->activeWindow(),
-                                                         i18n( "K3b will create a %1 image from the given MPEG "
-                                                               "files, but these files must already be in %1 "
-                                                               "format. K3b does not yet resample MPEG files.",
-                                                               i18n( "SVCD" ) )
-                                                         + "\n\n"
-                                                         + i18n( "Note: Forcing MPEG2 as VCD is not supported by "
-                                                                 "some standalone DVD players." ),
-                                                         i18n( "Information" ),
-                                                         KGuiItem( i18n( "Force VCD" ) ),
-                                                         KGuiItem( i18n( "Do not force VCD" ) ) ) == KMessageBox::Yes;
-                if ( force ) {
-                    setVcdType( vcdTypes( 1 ) );
-                    vcdOptions() ->setAutoDetect( false );
-                } else
-                    setVcdType( vcdTypes( mpegVersion ) );
-
-                m_urlAddingTimer->start( 0 );
-            }
 
+            m_urlAddingTimer->start( 0 );
+        }
 
-            if ( numOfTracks() > 0 && vcdOptions() ->mpegVersion() != mpegVersion ) {
-                KMessageBox::error( qApp->activeWindow(), '(' + url.toLocalFile() + ")\n" +
-                                    i18n( "You cannot mix MPEG1 and MPEG2 video files.\nPlease start a new Project for this filetype.\nResample not implemented in K3b yet." ),
-                                    i18n( "Wrong File Type for This Project" ) );
 
-                delete Mpeg;
-                return 0;
-            }
+        if ( numOfTracks() > 0 && vcdOptions() ->mpegVersion() != mpegVersion ) {
+            KMessageBox::error( qApp->activeWindow(), '(' + url.toLocalFile() + ")\n" +
+                                i18n( "You cannot mix MPEG1 and MPEG2 video files.\nPlease start a new Project for this filetype.\nResample not implemented in K3b yet." ),
+                                i18n( "Wrong File Type for This Project" ) );
 
-            K3b::VcdTrack* newTrack = new K3b::VcdTrack( m_tracks, url.toLocalFile() );
-            *( newTrack->mpeg_info ) = *( Mpeg->mpeg_info );
+            return 0;
+        }
 
-            if ( newTrack->isSegment() && !vcdOptions()->PbcEnabled() ) {
-                KMessageBox::information( qApp->activeWindow(),
-                                          i18n( "PBC (Playback control) enabled.\n"
-                                                "Video players cannot reach Segments (MPEG Still Pictures) without Playback control." ) ,
-                                          i18n( "Information" ) );
+        K3b::VcdTrack* newTrack = new K3b::VcdTrack( m_tracks, url.toLocalFile() );
+        *( newTrack->mpeg_info ) = mpegInfo;
 
-                vcdOptions()->setPbcEnabled( true );
-            }
+        if ( newTrack->isSegment() && !vcdOptions()->PbcEnabled() ) {
+            KMessageBox::information( qApp->activeWindow(),
+                                      i18n( "PBC (Playback control) enabled.\n"
+                                            "Video players cannot reach Segments (MPEG Still Pictures) without Playback control." ) ,
+                                      i18n( "Information" ) );
 
-            // set defaults;
-            newTrack->setPlayTime( vcdOptions() ->PbcPlayTime() );
-            newTrack->setWaitTime( vcdOptions() ->PbcWaitTime() );
-            newTrack->setPbcNumKeys( vcdOptions() ->PbcNumkeysEnabled() );
-            delete Mpeg;
+            vcdOptions()->setPbcEnabled( true );
+        }
 
-            // debugging output
-            newTrack->PrintInfo();
+        // set defaults;
+        newTrack->setPlayTime( vcdOptions() ->PbcPlayTime() );
+        newTrack->setWaitTime( vcdOptions() ->PbcWaitTime() );
+        newTrack->setPbcNumKeys( vcdOptions() ->PbcNumkeysEnabled() );
 
-            return newTrack;
-        }
-    } else if ( isImage( url ) ) { // image track
-        // working on ...
-        // for future use
-        // photoalbum starts here
-        // return here the new photoalbum track
-    }
+        // debugging output
+        newTrack->PrintInfo();
 
-    if ( Mpeg ) {
-        error_string = Mpeg->error_string();
-        delete Mpeg;
+        return newTrack;
     }
 
     // error (unsupported files)
@@ -294,6 +598,7 @@ void K3b::VcdDoc::addTrack( const QUrl& url, uint position )
 {
     urlsToAdd.enqueue( new PrivateUrlToAdd( url, position ) );
 
+    startAnalysis();
     m_urlAddingTimer->start( 0 );
 }
 
@@ -637,6 +942,19 @@ bool K3b::VcdDoc::loadDocumentData( QDomElement* root )
     // vcd Tracks
     QDomNodeList trackNodes = nodes.item( 2 ).childNodes();
 
+    // analyse all files in parallel first. The analysis saved with
+    // the project is used as long as the file did not change.
+    QStringList paths;
+    for ( int i = 0; i < trackNodes.length(); i++ ) {
+        QDomElement trackElem = trackNodes.item( i ).toElement();
+        QString url = trackElem.attributeNode( "url" ).value();
+        if ( QFile::exists( url ) ) {
+            loadMpegInfo( trackElem, url );
+            paths.append( url );
+        }
+    }
+    analyseFiles( paths );
+
     for ( int i = 0; i < trackNodes.length(); i++ ) {
 
         // check if url is available
@@ -645,9 +963,7 @@ bool K3b::VcdDoc::loadDocumentData( QDomElement* root )
         if ( !QFile::exists( url ) )
             m_notFoundFiles.append( url );
         else {
-            QUrl k;
-            k.setPath( url );
-            if ( K3b::VcdTrack * track = createTrack( k ) ) {
+            if ( K3b::VcdTrack * track = createTrack( QUrl::fromLocalFile( url ) ) ) {
                 track ->setPlayTime( trackElem.attribute( "playtime", "1" ).toInt() );
                 track ->setWaitTime( trackElem.attribute( "waittime", "2" ).toInt() );
                 track ->setReactivity( trackElem.attribute( "reactivity", "0" ).toInt() );
@@ -881,6 +1197,8 @@ bool K3b::VcdDoc::saveDocumentData( QDomElement * docElem )
             trackElem.appendChild( numElem );
         }
 
+        saveMpegInfo( doc, trackElem, track->absolutePath() );
+
         contentsElem.appendChild( trackElem );
     }
     // -------------------------------------------------------------
@@ -120,6 +120,9 @@ namespace K3b {
         /** processes queue "urlsToAdd" **/
         void slotWorkUrlQueue();
 
+    private Q_SLOTS:
+        void slotAnalysisFinished();
+
     Q_SIGNALS:
         void aboutToAddVCDTracks( int pos, int count );
         void addedVCDTracks();
@@ -137,9 +140,23 @@ namespace K3b {
         bool saveDocumentData( QDomElement* ) override;
 
     private:
+        class AnalyzerThread;
+
         VcdTrack* createTrack( const QUrl& url );
         void informAboutNotFoundFiles();
 
+        /**
+         * Starts the analysis of the queued urls in the background.
+         * At most maxAnalyzers() files are analysed at the same time.
+         */
+        void startAnalysis();
+
+        /**
+         * Analyses all files which are not in the cache yet in parallel
+         * and blocks until they are done.
+         */
+        void analyseFiles( const QStringList& paths );
+
         QStringList m_notFoundFiles;
         QString m_vcdImage;
 
@@ -147,15 +164,19 @@ namespace K3b {
         {
         public:
             PrivateUrlToAdd( const QUrl& u, int _pos )
-                : url( u ), position( _pos )
+                : url( u ), position( _pos ), analyzer( 0 ), analysed( false )
             {}
             QUrl url;
             int position;
+            AnalyzerThread* analyzer;
+            bool analysed;
         };
 
         /** Holds all the urls that have to be added to the list of tracks. **/
         QQueue<PrivateUrlToAdd*> urlsToAdd;
         QTimer* m_urlAddingTimer;
+        int m_runningAnalyzers;
+        bool m_workingUrlQueue;
 
         QList<VcdTrack*>* m_tracks;
         KIO::filesize_t calcTotalSize() const;
@@ -15,10 +15,7 @@
 #include "k3bmpeginfo.h"
 #include "k3b_i18n.h"
 
-#ifdef Q_OS_WIN32
-#define ftello ftell
-#define fseeko fseek
-#endif
+#include <string.h>
 
 static const double frame_rates[ 16 ] =
 {
@@ -27,9 +24,28 @@ static const double frame_rates[ 16 ] =
     60.0, 0.0,
 };
 
+// returns the first position in [begin, end) which starts a 0x 00 00 01 sequence
+// or 0 if there is none. The two bytes following end have to be readable.
+static const byte* findStartCode( const byte* begin, const byte* end )
+{
+    // let memchr look for the 0x01 and check the two zeros in front of it
+    const byte* p = begin + 2;
+    const byte* const last = end + 2;
+    while ( p < last ) {
+        p = static_cast<const byte*>( ::memchr( p, 0x01, last - p ) );
+        if ( !p )
+            return 0;
+        if ( p[ -1 ] == 0x00 && p[ -2 ] == 0x00 )
+            return p - 2;
+        ++p;
+    }
+    return 0;
+}
+
 K3b::MpegInfo::MpegInfo( const char* filename )
-    : m_mpegfile( 0 ),
+    : m_data( 0 ),
       m_filename( filename ),
+      m_filesize( 0 ),
       m_done( false ),
       m_buffstart( 0 ),
       m_buffend( 0 ),
@@ -39,26 +55,14 @@ K3b::MpegInfo::MpegInfo( const char* filename )
 
     mpeg_info = new Mpeginfo();
 
-    m_mpegfile = fopen( filename, "rb" );
+    m_mpegfile.setFileName( QFile::decodeName( filename ) );
 
-    if ( m_mpegfile == 0 ) {
+    if ( !m_mpegfile.open( QIODevice::ReadOnly ) ) {
         qDebug() << QString( "Unable to open %1" ).arg( m_filename );
         return ;
     }
 
-    if ( fseeko( m_mpegfile, 0, SEEK_END ) ) {
-        qDebug() << QString( "Unable to seek in file %1" ).arg( m_filename );
-        return ;
-    }
-
-    llong lof = ftello( m_mpegfile );
-
-    if ( lof == -1 ) {
-        qDebug() << QString( "Seeking to end of input file %1 failed." ).arg( m_filename );
-        //give up..
-        return ;
-    } else
-        m_filesize = lof;
+    m_filesize = m_mpegfile.size();
 
     // nothing to do on an empty file
     if ( !m_filesize ) {
@@ -67,7 +71,14 @@ K3b::MpegInfo::MpegInfo( const char* filename )
         return ;
     }
 
-    m_buffer = new byte[ BUFFERSIZE ];
+    // scanning a mapped file saves the copying and allows searching
+    // for start codes with memchr. Fall back to reading the file in
+    // large windows if it cannot be mapped.
+    m_data = m_mpegfile.map( 0, m_filesize );
+    if ( !m_data ) {
+        qDebug() << QString( "Unable to map %1, reading it instead." ).arg( m_filename );
+        m_buffer = new byte[ BUFFERSIZE ];
+    }
 
     MpegParsePacket ( );
 
@@ -75,12 +86,12 @@ K3b::MpegInfo::MpegInfo( const char* filename )
 
 K3b::MpegInfo::~MpegInfo()
 {
+    if ( m_data ) {
+        m_mpegfile.unmap( const_cast<byte*>( m_data ) );
+    }
     if ( m_buffer ) {
         delete[] m_buffer;
     }
-    if ( m_mpegfile ) {
-        fclose( m_mpegfile );
-    }
 
     delete mpeg_info;
 }
@@ -324,16 +335,16 @@ llong K3b::MpegInfo::MpegParsePacket ( llong offset )
     return offset;
 }
 
-byte K3b::MpegInfo::GetByte( llong offset )
+byte K3b::MpegInfo::GetBufferedByte( llong offset )
 {
-    unsigned long nread;
+    llong nread;
     if ( ( offset >= m_buffend ) || ( offset < m_buffstart ) ) {
 
-        if ( fseeko( m_mpegfile, offset, SEEK_SET ) ) {
+        if ( offset < 0 || !m_mpegfile.seek( offset ) ) {
             qDebug() << QString( "could not get seek to offset (%1) in file %2 (size:%3)" ).arg( offset ).arg( m_filename ).arg( m_filesize );
             return 0x11;
         }
-        nread = fread( m_buffer, 1, BUFFERSIZE, m_mpegfile );
+        nread = qMax( m_mpegfile.read( reinterpret_cast<char*>( m_buffer ), BUFFERSIZE ), llong( 0 ) );
         m_buffstart = offset;
         m_buffend = offset + nread;
         if ( ( offset >= m_buffend ) || ( offset < m_buffstart ) ) {
@@ -346,16 +357,16 @@ byte K3b::MpegInfo::GetByte( llong offset )
 }
 
 // same as above but improved for backward search
-byte K3b::MpegInfo::bdGetByte( llong offset )
+byte K3b::MpegInfo::bdGetBufferedByte( llong offset )
 {
-    unsigned long nread;
+    llong nread;
     if ( ( offset >= m_buffend ) || ( offset < m_buffstart ) ) {
         llong start = offset - BUFFERSIZE + 1 ;
         start = start >= 0 ? start : 0;
 
-        fseeko( m_mpegfile, start, SEEK_SET );
+        m_mpegfile.seek( start );
 
-        nread = fread( m_buffer, 1, BUFFERSIZE, m_mpegfile );
+        nread = qMax( m_mpegfile.read( reinterpret_cast<char*>( m_buffer ), BUFFERSIZE ), llong( 0 ) );
         m_buffstart = start;
         m_buffend = start + nread;
         if ( ( offset >= m_buffend ) || ( offset < m_buffstart ) ) {
@@ -403,13 +414,36 @@ bool K3b::MpegInfo::EnsureMPEG( llong offset, byte mark )
 // find next 0x 00 00 01 xx sequence, returns offset or -1 on err
 llong K3b::MpegInfo::FindNextMarker( llong from )
 {
-    llong offset;
-    for ( offset = from; offset < ( m_filesize - 4 ); offset++ ) {
-        if (
-            ( GetByte( offset + 0 ) == 0x00 ) &&
-            ( GetByte( offset + 1 ) == 0x00 ) &&
-            ( GetByte( offset + 2 ) == 0x01 ) ) {
-            return offset;
+    // bytes outside the file never match
+    llong offset = qMax( from, llong( 0 ) );
+    const llong last = m_filesize - 4;
+
+    if ( m_data ) {
+        if ( offset >= last )
+            return -1;
+        const byte* p = findStartCode( m_data + offset, m_data + last );
+        return p ? p - m_data : -1;
+    }
+
+    while ( offset < last ) {
+        // loads the window starting at offset if necessary
+        GetByte( offset );
+
+        if ( offset >= m_buffstart && offset + 2 < m_buffend ) {
+            const llong end = qMin( last, m_buffend - 2 );
+            const byte* p = findStartCode( m_buffer + ( offset - m_buffstart ), m_buffer + ( end - m_buffstart ) );
+            if ( p )
+                return m_buffstart + ( p - m_buffer );
+            offset = end;
+        }
+        else {
+            // the sequence crosses the end of the window
+            if ( ( GetByte( offset + 0 ) == 0x00 ) &&
+                 ( GetByte( offset + 1 ) == 0x00 ) &&
+                 ( GetByte( offset + 2 ) == 0x01 ) ) {
+                return offset;
+            }
+            offset++;
         }
     }
     return -1;
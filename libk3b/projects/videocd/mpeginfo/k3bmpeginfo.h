@@ -17,8 +17,8 @@
 
 #include <stdio.h>
 
-// #define BUFFERSIZE   16384
-#define BUFFERSIZE   65536
+// size of the read window used if the file cannot be mapped
+#define BUFFERSIZE   (1024*1024)
 
 #define MPEG_START_CODE_PATTERN  ((ulong) 0x00000100)
 #define MPEG_START_CODE_MASK     ((ulong) 0xffffff00)
@@ -52,6 +52,7 @@ typedef unsigned char byte;
 typedef long long llong;
 
 #include <QDebug>
+#include <QFile>
 
 namespace K3b {
     class video_info
@@ -138,8 +139,20 @@ namespace K3b {
 
     private:
         //  General ToolBox
-        byte GetByte( llong offset );
-        byte bdGetByte( llong offset );
+        inline byte GetByte( llong offset )
+        {
+            if ( m_data )
+                return ( offset >= 0 && offset < m_filesize ) ? m_data[ offset ] : 0x11;
+            return GetBufferedByte( offset );
+        };
+        inline byte bdGetByte( llong offset )
+        {
+            if ( m_data )
+                return ( offset >= 0 && offset < m_filesize ) ? m_data[ offset ] : 0x11;
+            return bdGetBufferedByte( offset );
+        };
+        byte GetBufferedByte( llong offset );
+        byte bdGetBufferedByte( llong offset );
         llong GetNBytes( llong, int );
         unsigned short int GetSize( llong offset );
         llong FindNextMarker( llong );
@@ -162,7 +175,10 @@ namespace K3b {
         double ReadTS( llong offset );
         double ReadTSMpeg2( llong offset );
 
-        FILE* m_mpegfile;
+        QFile m_mpegfile;
+
+        // the whole file if it could be mapped, 0 otherwise
+        const byte* m_data;
 
         const char* m_filename;
         llong m_filesize;
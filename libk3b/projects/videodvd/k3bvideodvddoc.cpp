@@ -79,4 +79,11 @@ bool K3b::VideoDvdDoc::saveDocumentData(QDomElement*)
     return true;
 }
 
+
+bool K3b::VideoDvdDoc::saveDocumentStream( QXmlStreamWriter* xml )
+{
+    // bypass the DataDoc implementation as long as saveDocumentData is a stub
+    return K3b::Doc::saveDocumentStream( xml );
+}
+
 //#include "k3bdvddoc.moc"
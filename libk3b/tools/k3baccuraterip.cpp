@@ -0,0 +1,278 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baccuraterip.h"
+
+#include "k3btoc.h"
+#include "k3btrack.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTextStream>
+
+
+namespace {
+    const quint32 s_samplesPerSector = 588;
+
+    // AccurateRip leaves out five sectors at the start and the end of the disc
+    const quint32 s_skippedSamples = 5 * s_samplesPerSector;
+
+    struct CrcTable {
+        CrcTable() {
+            for( quint32 i = 0; i < 256; ++i ) {
+                quint32 c = i;
+                for( int k = 0; k < 8; ++k )
+                    c = ( c & 1 ) ? ( 0xEDB88320U ^ ( c >> 1 ) ) : ( c >> 1 );
+                table[i] = c;
+            }
+        }
+
+        quint32 table[256];
+    };
+
+    const CrcTable s_crcTable;
+
+    inline quint32 updateCrc( quint32 crc, const unsigned char* data, qint64 len )
+    {
+        for( qint64 i = 0; i < len; ++i )
+            crc = s_crcTable.table[( crc ^ data[i] ) & 0xFF] ^ ( crc >> 8 );
+        return crc;
+    }
+
+    inline quint32 sampleAt( const unsigned char* p )
+    {
+        return quint32( p[0] ) | ( quint32( p[1] ) << 8 ) | ( quint32( p[2] ) << 16 ) | ( quint32( p[3] ) << 24 );
+    }
+}
+
+
+K3b::AccurateRipChecksum::AccurateRipChecksum()
+    : m_v1( 0 ),
+      m_v2( 0 ),
+      m_crc( 0xFFFFFFFFU ),
+      m_multiplier( 1 ),
+      m_checkStart( 0 ),
+      m_checkEnd( 0 ),
+      m_samples( 0 ),
+      m_partialLength( 0 )
+{
+}
+
+
+K3b::AccurateRipChecksum::AccurateRipChecksum( long sectors, bool firstTrack, bool lastTrack )
+    : m_v1( 0 ),
+      m_v2( 0 ),
+      m_crc( 0xFFFFFFFFU ),
+      m_multiplier( 1 ),
+      m_partialLength( 0 )
+{
+    m_samples = quint32( qMax( 0L, sectors ) ) * s_samplesPerSector;
+    m_checkStart = firstTrack ? s_skippedSamples : 0;
+    m_checkEnd = ( lastTrack && m_samples > s_skippedSamples ) ? m_samples - s_skippedSamples : m_samples;
+}
+
+
+void K3b::AccurateRipChecksum::updateSample( quint32 sample )
+{
+    if( m_multiplier >= m_checkStart && m_multiplier <= m_checkEnd ) {
+        m_v1 += sample * m_multiplier;
+        const quint64 product = quint64( sample ) * quint64( m_multiplier );
+        m_v2 += quint32( product ) + quint32( product >> 32 );
+    }
+    ++m_multiplier;
+}
+
+
+void K3b::AccurateRipChecksum::update( const char* data, qint64 len )
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>( data );
+    m_crc = updateCrc( m_crc, p, len );
+
+    // complete the sample left over from the last call
+    while( m_partialLength > 0 && len > 0 ) {
+        m_partial[m_partialLength++] = *p++;
+        --len;
+        if( m_partialLength == 4 ) {
+            updateSample( sampleAt( m_partial ) );
+            m_partialLength = 0;
+        }
+    }
+
+    for( ; len >= 4; p += 4, len -= 4 )
+        updateSample( sampleAt( p ) );
+
+    while( len-- > 0 )
+        m_partial[m_partialLength++] = *p++;
+}
+
+
+bool K3b::AccurateRipChecksum::isComplete() const
+{
+    return( m_multiplier > m_samples && m_partialLength == 0 );
+}
+
+
+quint32 K3b::AccurateRipChecksum::crc32() const
+{
+    return m_crc ^ 0xFFFFFFFFU;
+}
+
+
+K3b::AccurateRipDatabase::AccurateRipDatabase( const QString& filename )
+    : m_fileName( filename ),
+      m_modified( false )
+{
+    if( m_fileName.isEmpty() )
+        m_fileName = QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) + QLatin1String( "/accuraterip.db" );
+}
+
+
+QString K3b::AccurateRipDatabase::fileName() const
+{
+    return m_fileName;
+}
+
+
+QString K3b::AccurateRipDatabase::discId( const Device::Toc& toc )
+{
+    if( toc.isEmpty() )
+        return QString();
+
+    quint32 id1 = 0;
+    quint32 id2 = 0;
+    for( int i = 0; i < toc.count(); ++i ) {
+        const quint32 offset = toc[i].firstSector().lba();
+        id1 += offset;
+        id2 += qMax( offset, quint32( 1 ) ) * quint32( i + 1 );
+    }
+    const quint32 leadOut = toc.last().lastSector().lba() + 1;
+    id1 += leadOut;
+    id2 += leadOut * quint32( toc.count() + 1 );
+
+    return QString::asprintf( "%03d-%08x-%08x-%08x", toc.count(), id1, id2, toc.discId() );
+}
+
+
+QString K3b::AccurateRipDatabase::key( const QString& discId, int track )
+{
+    return discId + QLatin1Char( ' ' ) + QString::number( track );
+}
+
+
+bool K3b::AccurateRipDatabase::load()
+{
+    m_entries.clear();
+    m_modified = false;
+
+    QFile f( m_fileName );
+    if( !f.exists() )
+        return true;
+    if( !f.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "(K3b::AccurateRipDatabase) could not open" << m_fileName;
+        return false;
+    }
+
+    QTextStream s( &f );
+    while( !s.atEnd() ) {
+        const QString line = s.readLine().trimmed();
+        if( line.isEmpty() || line.startsWith( QLatin1Char( '#' ) ) )
+            continue;
+
+        const QStringList fields = line.split( QLatin1Char( ' ' ), QString::SkipEmptyParts );
+        bool ok[4] = { false, false, false, false };
+        Entry entry;
+        int track = 0;
+        if( fields.count() == 5 ) {
+            track = fields[1].toInt( &ok[0] );
+            entry.v1 = fields[2].toUInt( &ok[1], 16 );
+            entry.v2 = fields[3].toUInt( &ok[2], 16 );
+            entry.crc = fields[4].toUInt( &ok[3], 16 );
+        }
+        if( !ok[0] || !ok[1] || !ok[2] || !ok[3] ) {
+            qDebug() << "(K3b::AccurateRipDatabase) ignoring invalid line" << line;
+            continue;
+        }
+
+        m_entries[key( fields[0], track )].append( entry );
+    }
+
+    return true;
+}
+
+
+bool K3b::AccurateRipDatabase::save()
+{
+    if( !QDir().mkpath( QFileInfo( m_fileName ).absolutePath() ) )
+        return false;
+
+    QSaveFile f( m_fileName );
+    if( !f.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::AccurateRipDatabase) could not open" << m_fileName;
+        return false;
+    }
+
+    QTextStream s( &f );
+    s << "# <disc id> <track> <AccurateRip v1> <AccurateRip v2> <CRC32>\n";
+    QStringList keys = m_entries.keys();
+    keys.sort();
+    Q_FOREACH( const QString& k, keys ) {
+        Q_FOREACH( const Entry& entry, m_entries.value( k ) ) {
+            s << k << ' '
+              << QString::asprintf( "%08x %08x %08x", entry.v1, entry.v2, entry.crc ) << '\n';
+        }
+    }
+    s.flush();
+
+    if( s.status() != QTextStream::Ok || !f.commit() ) {
+        qDebug() << "(K3b::AccurateRipDatabase) could not write" << m_fileName;
+        return false;
+    }
+
+    m_modified = false;
+    return true;
+}
+
+
+K3b::AccurateRipDatabase::Result K3b::AccurateRipDatabase::verify( const QString& discId, int track, const AccurateRipChecksum& checksum ) const
+{
+    QHash<QString, QList<Entry> >::const_iterator it = m_entries.constFind( key( discId, track ) );
+    if( it == m_entries.constEnd() || it->isEmpty() )
+        return Unknown;
+
+    Q_FOREACH( const Entry& entry, it.value() ) {
+        if( entry.v1 == checksum.v1() || entry.v2 == checksum.v2() )
+            return Match;
+    }
+    return Mismatch;
+}
+
+
+bool K3b::AccurateRipDatabase::add( const QString& discId, int track, const AccurateRipChecksum& checksum )
+{
+    QList<Entry>& entries = m_entries[key( discId, track )];
+    Q_FOREACH( const Entry& entry, entries ) {
+        if( entry.v1 == checksum.v1() && entry.v2 == checksum.v2() && entry.crc == checksum.crc32() )
+            return false;
+    }
+
+    Entry entry = { checksum.v1(), checksum.v2(), checksum.crc32() };
+    entries.append( entry );
+    m_modified = true;
+    return true;
+}
@@ -0,0 +1,146 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_ACCURATE_RIP_H_
+#define _K3B_ACCURATE_RIP_H_
+
+#include "k3b_export.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+namespace K3b {
+    namespace Device {
+        class Toc;
+    }
+
+    /**
+     * Calculates the AccurateRip v1 and v2 checksums and the CRC32 of one
+     * audio track while it is being ripped.
+     *
+     * The data has to be passed in as 16 bit little endian stereo samples,
+     * the way CdparanoiaLib returns it by default. Like AccurateRip does
+     * the first five sectors of the first track and the last five sectors
+     * of the last track are left out of the AccurateRip checksums since
+     * drives cannot read them reliably with their read offset applied.
+     * The CRC32 covers the whole track.
+     */
+    class LIBK3B_EXPORT AccurateRipChecksum
+    {
+    public:
+        AccurateRipChecksum();
+
+        /**
+         * \param sectors the length of the track
+         * \param firstTrack true for the first track of the disc
+         * \param lastTrack true for the last track of the disc
+         */
+        AccurateRipChecksum( long sectors, bool firstTrack, bool lastTrack );
+
+        void update( const char* data, qint64 len );
+
+        /**
+         * \return true once the whole track has been passed to update().
+         */
+        bool isComplete() const;
+
+        quint32 v1() const { return m_v1; }
+        quint32 v2() const { return m_v2; }
+        quint32 crc32() const;
+
+    private:
+        void updateSample( quint32 sample );
+
+        quint32 m_v1;
+        quint32 m_v2;
+        quint32 m_crc;
+
+        // 1-based index of the next sample
+        quint32 m_multiplier;
+        quint32 m_checkStart;
+        quint32 m_checkEnd;
+        quint32 m_samples;
+
+        // bytes of an incomplete sample from the last update()
+        unsigned char m_partial[4];
+        int m_partialLength;
+    };
+
+
+    /**
+     * A local database of verified track checksums. It is a plain text
+     * file with one track per line:
+     *
+     * <pre>
+     * &lt;disc id&gt; &lt;track&gt; &lt;v1&gt; &lt;v2&gt; &lt;crc32&gt;
+     * </pre>
+     *
+     * with the checksums written as hexadecimal numbers. Lines starting
+     * with a hash are ignored so entries from other sources can be added
+     * by hand. A track may have several entries, for example from
+     * different pressings of the same disc.
+     */
+    class LIBK3B_EXPORT AccurateRipDatabase
+    {
+    public:
+        /**
+         * \param filename The database file. Defaults to accuraterip.db in
+         *                 the application data location.
+         */
+        explicit AccurateRipDatabase( const QString& filename = QString() );
+
+        QString fileName() const;
+
+        /**
+         * The AccurateRip disc id made up of the number of tracks, the two
+         * AccurateRip offset sums, and the CDDB disc id.
+         */
+        static QString discId( const Device::Toc& toc );
+
+        bool load();
+        bool save();
+
+        enum Result {
+            Unknown,  /**< There is no entry for the track. */
+            Match,    /**< One of the entries matches the v1 or the v2 checksum. */
+            Mismatch  /**< None of the entries matches. */
+        };
+
+        Result verify( const QString& discId, int track, const AccurateRipChecksum& checksum ) const;
+
+        /**
+         * Adds the checksums of a verified rip unless they are already known.
+         * \return true if the database changed.
+         */
+        bool add( const QString& discId, int track, const AccurateRipChecksum& checksum );
+
+        bool isModified() const { return m_modified; }
+
+    private:
+        struct Entry {
+            quint32 v1;
+            quint32 v2;
+            quint32 crc;
+        };
+
+        static QString key( const QString& discId, int track );
+
+        QString m_fileName;
+        QHash<QString, QList<Entry> > m_entries;
+        bool m_modified;
+    };
+}
+
+#endif
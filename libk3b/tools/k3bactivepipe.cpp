@@ -13,10 +13,22 @@
  */
 
 #include "k3bactivepipe.h"
+#include "k3bbufferpool.h"
 
 #include <QDebug>
 #include <QIODevice>
+#include <QMutex>
 #include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+#include <atomic>
+
+
+namespace {
+    // the maximum amount of data moved through the fifo in one go
+    const qint64 s_fifoChunkSize = 256*1024;
+}
 
 
 class K3b::ActivePipe::Private : public QThread
@@ -27,14 +39,39 @@ public:
         sourceIODevice(0),
         sinkIODevice(0),
         closeSinkIODevice( false ),
-        closeSourceIODevice( false ) {
+        closeSourceIODevice( false ),
+        fifoSize( 0 ),
+        fifoAllocated( 0 ),
+        fifo( 0 ),
+        startWatermark( 50 ),
+        lowWatermark( 10 ),
+        producer( this ),
+        lastBytesRead( 0 ),
+        lastBytesWritten( 0 ),
+        sourceRate( 0 ),
+        sinkRate( 0 ) {
+        head = tail = 0;
+        eof = canceled = false;
+        producerStalls = consumerStalls = lowWatermarkHits = 0;
+        producerWaiting = consumerWaiting = false;
     }
 
     void run() override {
         qDebug() << "(K3b::ActivePipe) writing from" << sourceIODevice << "to" << sinkIODevice;
 
-        bytesRead = bytesWritten = 0;
-        buffer.resize( 10*2048 );
+        bytesRead = 0;
+        bytesWritten = 0;
+
+        if( fifo ) {
+            runFifo();
+            return;
+        }
+
+        K3b::BufferPool::Buffer buffer = K3b::BufferPool::instance()->allocate( 10*2048 );
+        if( buffer.isNull() ) {
+            qDebug() << "(K3b::ActivePipe) failed to allocate buffer.";
+            return;
+        }
 
         bool fail = false;
         qint64 r = 0;
@@ -63,16 +100,203 @@ public:
         qDebug() << "Done:"
                  << ( fail ? QLatin1String( "write failed" ) : QLatin1String( "write success" ) )
                  << ( r != 0 ? QLatin1String( "read failed" ) : QLatin1String( "read success" ) )
-                 << "(total bytes read/written:" << bytesRead << "/" << bytesWritten << ")";
+                 << "(total bytes read/written:" << bytesRead.load() << "/" << bytesWritten.load() << ")";
     }
 
     void _k3b_close() {
         qDebug();
+        statusTimer.stop();
         if ( closeWhenDone )
             m_pipe->close();
     }
 
+    void _k3b_updateStatus() {
+        // called once a second
+        const quint64 r = bytesRead.load();
+        const quint64 w = bytesWritten.load();
+        sourceRate = r - lastBytesRead;
+        sinkRate = w - lastBytesWritten;
+        lastBytesRead = r;
+        lastBytesWritten = w;
+        emit m_pipe->buffer( fillLevel() );
+    }
+
+    int fillLevel() const {
+        if( !fifo )
+            return 0;
+        return (int)( ( head.load() - tail.load() ) * 100 / fifoSize );
+    }
+
+    void resetFifo() {
+        if( fifoSize > 0 && fifoAllocated != fifoSize ) {
+            // the pool aligns big buffers to huge pages which saves a lot of
+            // TLB misses with buffers of several hundred MB
+            fifoBuffer.release();
+            fifoBuffer = K3b::BufferPool::instance()->allocate( fifoSize );
+            fifo = fifoBuffer.data();
+            fifoAllocated = fifo ? fifoSize : 0;
+            if( !fifo )
+                qDebug() << "(K3b::ActivePipe) failed to allocate fifo of" << fifoSize << "bytes.";
+        }
+        else if( fifoSize == 0 && fifo ) {
+            fifoBuffer.release();
+            fifo = 0;
+            fifoAllocated = 0;
+        }
+
+        head = tail = 0;
+        eof = canceled = false;
+        producerStalls = consumerStalls = lowWatermarkHits = 0;
+        lastBytesRead = lastBytesWritten = 0;
+        sourceRate = sinkRate = 0;
+    }
+
+    void cancelFifo() {
+        canceled = true;
+        wake( producerWaiting );
+        wake( consumerWaiting );
+    }
+
 private:
+    //
+    // The fifo is a single-producer/single-consumer ring. head is only
+    // advanced by the producer, tail only by the consumer. The mutex is
+    // only used to sleep when the ring is full or empty.
+    //
+    class Producer : public QThread
+    {
+    public:
+        Producer( Private* d ) : m_d( d ) {}
+
+    protected:
+        void run() override { m_d->produce(); }
+
+    private:
+        Private* m_d;
+    };
+
+    void produce() {
+        qint64 r = 0;
+        while( !canceled ) {
+            const quint64 h = head.load( std::memory_order_relaxed );
+            const quint64 space = fifoSize - ( h - tail.load( std::memory_order_acquire ) );
+            if( space == 0 ) {
+                ++producerStalls;
+                waitUntil( producerWaiting, [this]() { return canceled || head.load() - tail.load() < (quint64)fifoSize; } );
+                continue;
+            }
+
+            const quint64 offset = h % fifoSize;
+            const qint64 len = qMin( qMin( (qint64)space, fifoSize - (qint64)offset ), s_fifoChunkSize );
+            r = m_pipe->readData( fifo + offset, len );
+            if( r <= 0 )
+                break;
+
+            bytesRead += r;
+            head.store( h + r, std::memory_order_release );
+            wake( consumerWaiting );
+        }
+
+        if ( r < 0 ) {
+            qDebug() << "Read failed:" << sourceIODevice->errorString();
+            readFailed = true;
+        }
+
+        eof = true;
+        wake( consumerWaiting );
+    }
+
+    void runFifo() {
+        readFailed = false;
+        producer.start();
+
+        // let the fifo fill up before feeding the sink
+        waitUntil( consumerWaiting, [this]() {
+                return canceled || eof || fillLevel() >= startWatermark;
+            } );
+
+        bool fail = false;
+        bool low = false;
+        while( !canceled ) {
+            const quint64 t = tail.load( std::memory_order_relaxed );
+            const quint64 avail = head.load( std::memory_order_acquire ) - t;
+            if( avail == 0 ) {
+                // the producer sets eof after publishing its last data
+                if( eof ) {
+                    if( head.load() == t )
+                        break;
+                    continue;
+                }
+                ++consumerStalls;
+                waitUntil( consumerWaiting, [this]() { return canceled || eof || head.load() != tail.load(); } );
+                continue;
+            }
+
+            if( (qint64)avail * 100 < (qint64)lowWatermark * fifoSize ) {
+                if( !low ) {
+                    ++lowWatermarkHits;
+                    low = true;
+                }
+            }
+            else {
+                low = false;
+            }
+
+            const quint64 offset = t % fifoSize;
+            const qint64 len = qMin( qMin( (qint64)avail, fifoSize - (qint64)offset ), s_fifoChunkSize );
+            qint64 w = 0;
+            while( w < len ) {
+                const qint64 ww = m_pipe->write( fifo + offset + w, len - w );
+                if( ww <= 0 ) {
+                    qDebug() << "write failed." << sinkIODevice->errorString();
+                    fail = true;
+                    break;
+                }
+                w += ww;
+            }
+            if( fail )
+                break;
+
+            bytesWritten += len;
+            tail.store( t + len, std::memory_order_release );
+            wake( producerWaiting );
+        }
+
+        // make sure the producer does not wait for space anymore
+        if( fail )
+            cancelFifo();
+        producer.wait();
+
+        qDebug() << "Done:"
+                 << ( fail ? QLatin1String( "write failed" ) : QLatin1String( "write success" ) )
+                 << ( readFailed ? QLatin1String( "read failed" ) : QLatin1String( "read success" ) )
+                 << "(total bytes read/written:" << bytesRead.load() << "/" << bytesWritten.load() << ")"
+                 << "fifo size:" << fifoSize
+                 << "source waited:" << producerStalls
+                 << "sink waited:" << consumerStalls
+                 << "low watermark hits:" << lowWatermarkHits;
+    }
+
+    //
+    // The predicate is checked and the waiting flag read with fifoMutex
+    // held. Thus a state change published before wake() is either seen by
+    // the predicate or the waiter already sleeps when wake() signals it.
+    //
+    template<typename Predicate>
+    void waitUntil( bool& waiting, Predicate done ) {
+        QMutexLocker locker( &fifoMutex );
+        waiting = true;
+        while( !done() )
+            fifoCondition.wait( &fifoMutex );
+        waiting = false;
+    }
+
+    void wake( bool& waiting ) {
+        QMutexLocker locker( &fifoMutex );
+        if( waiting )
+            fifoCondition.wakeAll();
+    }
+
     K3b::ActivePipe* m_pipe;
 
 public:
@@ -83,10 +307,40 @@ public:
     bool closeSinkIODevice;
     bool closeSourceIODevice;
 
-    QByteArray buffer;
-
-    quint64 bytesRead;
-    quint64 bytesWritten;
+    // updated by the pipe threads and read in the GUI thread
+    std::atomic<quint64> bytesRead;
+    std::atomic<quint64> bytesWritten;
+
+    qint64 fifoSize;
+    qint64 fifoAllocated;
+    K3b::BufferPool::Buffer fifoBuffer;
+    char* fifo;
+    int startWatermark;
+    int lowWatermark;
+
+    std::atomic<quint64> head;
+    std::atomic<quint64> tail;
+    std::atomic<bool> eof;
+    std::atomic<bool> canceled;
+    bool readFailed;
+
+    std::atomic<int> producerStalls;
+    std::atomic<int> consumerStalls;
+    std::atomic<int> lowWatermarkHits;
+
+    QMutex fifoMutex;
+    QWaitCondition fifoCondition;
+    // guarded by fifoMutex
+    bool producerWaiting;
+    bool consumerWaiting;
+
+    Producer producer;
+
+    QTimer statusTimer;
+    quint64 lastBytesRead;
+    quint64 lastBytesWritten;
+    qint64 sourceRate;
+    qint64 sinkRate;
 };
 
 
@@ -94,11 +348,14 @@ K3b::ActivePipe::ActivePipe()
 {
     d = new Private( this );
     connect( d, SIGNAL(finished()), this, SLOT(_k3b_close()) );
+    connect( &d->statusTimer, SIGNAL(timeout()), this, SLOT(_k3b_updateStatus()) );
 }
 
 
 K3b::ActivePipe::~ActivePipe()
 {
+    d->cancelFifo();
+    d->wait();
     delete d;
 }
 
@@ -135,6 +392,9 @@ bool K3b::ActivePipe::open( bool closeWhenDone )
     // we only do active piping if both devices are set.
     // Otherwise we only work as a conduit
     if ( d->sourceIODevice && d->sinkIODevice ) {
+        d->resetFifo();
+        if( d->fifo )
+            d->statusTimer.start( 1000 );
         d->start();
     }
 
@@ -145,6 +405,7 @@ bool K3b::ActivePipe::open( bool closeWhenDone )
 void K3b::ActivePipe::close()
 {
     qDebug();
+    d->cancelFifo();
     if( d->sourceIODevice && d->closeSourceIODevice )
         d->sourceIODevice->close();
     if( d->sinkIODevice && d->closeSinkIODevice )
@@ -189,13 +450,68 @@ qint64 K3b::ActivePipe::writeData( const char* data, qint64 max )
 
 quint64 K3b::ActivePipe::bytesRead() const
 {
-    return d->bytesRead;
+    return d->bytesRead.load();
 }
 
 
 quint64 K3b::ActivePipe::bytesWritten() const
 {
-    return d->bytesWritten;
+    return d->bytesWritten.load();
+}
+
+
+void K3b::ActivePipe::setBufferSize( qint64 bytes )
+{
+    d->fifoSize = qMax( qint64( 0 ), bytes );
+}
+
+
+qint64 K3b::ActivePipe::bufferSize() const
+{
+    return d->fifoSize;
+}
+
+
+void K3b::ActivePipe::setWatermarks( int startLevel, int lowLevel )
+{
+    d->startWatermark = qBound( 0, startLevel, 100 );
+    d->lowWatermark = qBound( 0, lowLevel, 100 );
+}
+
+
+int K3b::ActivePipe::fillLevel() const
+{
+    return d->fillLevel();
+}
+
+
+int K3b::ActivePipe::sourceStalls() const
+{
+    return d->producerStalls;
+}
+
+
+int K3b::ActivePipe::sinkStalls() const
+{
+    return d->consumerStalls;
+}
+
+
+int K3b::ActivePipe::lowWatermarkHits() const
+{
+    return d->lowWatermarkHits;
+}
+
+
+qint64 K3b::ActivePipe::sourceRate() const
+{
+    return d->sourceRate;
+}
+
+
+qint64 K3b::ActivePipe::sinkRate() const
+{
+    return d->sinkRate;
 }
 
 #include "moc_k3bactivepipe.cpp"
@@ -29,6 +29,10 @@ namespace K3b {
      * QIODevices are set. Otherwise the pipe only serves as a conduit for
      * data streams. The latter is mostly interesting when using the ChecksumPipe
      * in combination with a Job that can only push data (like the DataTrackReader).
+     *
+     * When actively pumping the pipe can use a large FIFO buffer (see setBufferSize())
+     * which decouples the source from the sink. Reading and writing is then done
+     * in separate threads and short stalls of the source do not reach the sink.
      */
     class LIBK3B_EXPORT ActivePipe : public QIODevice
     {
@@ -80,6 +84,59 @@ namespace K3b {
          */
         quint64 bytesWritten() const;
 
+        /**
+         * Use a FIFO of @p bytes between the source and the sink. 0 (the default)
+         * disables the FIFO. The FIFO is only used for active pumping.
+         *
+         * Has to be called before open().
+         */
+        void setBufferSize( qint64 bytes );
+        qint64 bufferSize() const;
+
+        /**
+         * \param startLevel The fill level in percent the FIFO has to reach before
+         *                   the sink is fed. Defaults to 50.
+         * \param lowLevel   The fill level in percent below which the FIFO is considered
+         *                   to run low. Defaults to 10. See lowWatermarkHits().
+         */
+        void setWatermarks( int startLevel, int lowLevel );
+
+        /**
+         * The fill level of the FIFO in percent.
+         */
+        int fillLevel() const;
+
+        /**
+         * The number of times reading from the source had to wait because
+         * the FIFO was full, i.e. the sink was too slow.
+         */
+        int sourceStalls() const;
+
+        /**
+         * The number of times the sink had to wait because the FIFO ran empty.
+         */
+        int sinkStalls() const;
+
+        /**
+         * The number of times the fill level dropped below the low watermark.
+         */
+        int lowWatermarkHits() const;
+
+        /**
+         * The number of bytes read from the source and written to the sink
+         * during the last second. Only available when using a FIFO.
+         */
+        qint64 sourceRate() const;
+        qint64 sinkRate() const;
+
+    Q_SIGNALS:
+        /**
+         * Emitted once a second with the fill level of the FIFO in percent
+         * while pumping data through the FIFO. Suited to be connected to
+         * BurnJob::bufferStatus().
+         */
+        void buffer( int fillLevel );
+
     protected:
         /**
          * Reads the data from the source.
@@ -107,6 +164,7 @@ namespace K3b {
         Private* d;
 
         Q_PRIVATE_SLOT( d, void _k3b_close() )
+        Q_PRIVATE_SLOT( d, void _k3b_updateStatus() )
     };
 }
 
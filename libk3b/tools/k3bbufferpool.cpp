@@ -0,0 +1,307 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bbufferpool.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+namespace {
+    const int s_minClassShift = 12;   // 4 KB
+    const int s_maxClassShift = 26;   // 64 MB
+    const qint64 s_hugePageSize = 2*1024*1024;
+
+    qint64 pageSize()
+    {
+        static const qint64 size = qMax( 4096L, ::sysconf( _SC_PAGESIZE ) );
+        return size;
+    }
+
+    // \return the size class for a capacity or -1 for buffers not kept in the free lists
+    int classIndex( qint64 capacity )
+    {
+        for( int shift = s_minClassShift; shift <= s_maxClassShift; ++shift ) {
+            if( capacity == ( Q_INT64_C(1) << shift ) )
+                return shift - s_minClassShift;
+        }
+        return -1;
+    }
+
+    char* allocateMemory( qint64 capacity )
+    {
+        const bool huge = ( capacity >= s_hugePageSize );
+        void* mem = 0;
+        if( ::posix_memalign( &mem, huge ? s_hugePageSize : pageSize(), capacity ) != 0 )
+            return 0;
+#ifdef MADV_HUGEPAGE
+        if( huge )
+            ::madvise( mem, capacity, MADV_HUGEPAGE );
+#endif
+        return static_cast<char*>( mem );
+    }
+}
+
+
+class K3b::BufferPool::Private
+{
+public:
+    Private( qint64 maxCached )
+        : ref( 1 ),
+          maxCachedBytes( maxCached ),
+          freeLists( s_maxClassShift - s_minClassShift + 1 ) {
+        ::memset( &stats, 0, sizeof( stats ) );
+    }
+
+    ~Private() {
+        clear();
+    }
+
+    // must be called with the mutex locked
+    void clear() {
+        for( int i = 0; i < freeLists.count(); ++i ) {
+            Q_FOREACH( char* mem, freeLists[i] )
+                ::free( mem );
+            freeLists[i].clear();
+        }
+        stats.bytesCached = 0;
+    }
+
+    void recycle( char* mem, qint64 capacity ) {
+        QMutexLocker locker( &mutex );
+        stats.bytesInUse -= capacity;
+        const int index = classIndex( capacity );
+        if( index >= 0 && stats.bytesCached + capacity <= maxCachedBytes ) {
+            freeLists[index].append( mem );
+            stats.bytesCached += capacity;
+        }
+        else {
+            ::free( mem );
+        }
+    }
+
+    void deref() {
+        if( !ref.deref() )
+            delete this;
+    }
+
+    // held by the pool and each buffer
+    QAtomicInt ref;
+
+    QMutex mutex;
+    qint64 maxCachedBytes;
+    QVector<QList<char*> > freeLists;
+    Statistics stats;
+};
+
+
+struct K3b::BufferPool::Buffer::Data
+{
+    QAtomicInt ref;
+    char* mem;
+    qint64 size;
+    qint64 capacity;
+    BufferPool::Private* pool;
+};
+
+
+K3b::BufferPool::Buffer::Buffer()
+    : d( 0 )
+{
+}
+
+
+K3b::BufferPool::Buffer::Buffer( const Buffer& other )
+    : d( other.d )
+{
+    if( d )
+        d->ref.ref();
+}
+
+
+K3b::BufferPool::Buffer::Buffer( Buffer&& other )
+    : d( other.d )
+{
+    other.d = 0;
+}
+
+
+K3b::BufferPool::Buffer::~Buffer()
+{
+    release();
+}
+
+
+K3b::BufferPool::Buffer& K3b::BufferPool::Buffer::operator=( const Buffer& other )
+{
+    if( other.d != d ) {
+        if( other.d )
+            other.d->ref.ref();
+        release();
+        d = other.d;
+    }
+    return *this;
+}
+
+
+K3b::BufferPool::Buffer& K3b::BufferPool::Buffer::operator=( Buffer&& other )
+{
+    if( &other != this ) {
+        release();
+        d = other.d;
+        other.d = 0;
+    }
+    return *this;
+}
+
+
+char* K3b::BufferPool::Buffer::data() const
+{
+    return d ? d->mem : 0;
+}
+
+
+qint64 K3b::BufferPool::Buffer::size() const
+{
+    return d ? d->size : 0;
+}
+
+
+qint64 K3b::BufferPool::Buffer::capacity() const
+{
+    return d ? d->capacity : 0;
+}
+
+
+bool K3b::BufferPool::Buffer::isShared() const
+{
+    return d && d->ref.load() > 1;
+}
+
+
+void K3b::BufferPool::Buffer::release()
+{
+    if( d && !d->ref.deref() ) {
+        d->pool->recycle( d->mem, d->capacity );
+        d->pool->deref();
+        delete d;
+    }
+    d = 0;
+}
+
+
+K3b::BufferPool::BufferPool( qint64 maxCachedBytes )
+    : d( new Private( maxCachedBytes ) )
+{
+}
+
+
+K3b::BufferPool::~BufferPool()
+{
+    d->mutex.lock();
+    d->clear();
+    d->maxCachedBytes = 0;
+    d->mutex.unlock();
+    d->deref();
+}
+
+
+qint64 K3b::BufferPool::capacityForSize( qint64 size )
+{
+    if( size > ( Q_INT64_C(1) << s_maxClassShift ) ) {
+        // too big for the size classes, round to full pages
+        const qint64 page = pageSize();
+        return ( size + page - 1 ) / page * page;
+    }
+
+    qint64 capacity = Q_INT64_C(1) << s_minClassShift;
+    while( capacity < size )
+        capacity <<= 1;
+    return capacity;
+}
+
+
+K3b::BufferPool::Buffer K3b::BufferPool::allocate( qint64 size )
+{
+    Buffer buffer;
+    if( size <= 0 )
+        return buffer;
+
+    const qint64 capacity = capacityForSize( size );
+    const int index = classIndex( capacity );
+
+    char* mem = 0;
+    {
+        QMutexLocker locker( &d->mutex );
+        if( index >= 0 && !d->freeLists[index].isEmpty() ) {
+            mem = d->freeLists[index].takeLast();
+            d->stats.bytesCached -= capacity;
+            ++d->stats.reuses;
+        }
+        else {
+            ++d->stats.systemAllocations;
+        }
+        ++d->stats.allocations;
+        d->stats.bytesInUse += capacity;
+        d->stats.peakBytesInUse = qMax( d->stats.peakBytesInUse, d->stats.bytesInUse );
+    }
+
+    // allocate outside the lock, big buffers take a while
+    if( !mem && !( mem = allocateMemory( capacity ) ) ) {
+        QMutexLocker locker( &d->mutex );
+        d->stats.bytesInUse -= capacity;
+        --d->stats.allocations;
+        --d->stats.systemAllocations;
+        return buffer;
+    }
+
+    d->ref.ref();
+    buffer.d = new Buffer::Data;
+    buffer.d->ref.store( 1 );
+    buffer.d->mem = mem;
+    buffer.d->size = size;
+    buffer.d->capacity = capacity;
+    buffer.d->pool = d;
+    return buffer;
+}
+
+
+K3b::BufferPool::Statistics K3b::BufferPool::statistics() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->stats;
+}
+
+
+void K3b::BufferPool::clear()
+{
+    QMutexLocker locker( &d->mutex );
+    d->clear();
+}
+
+
+Q_GLOBAL_STATIC( K3b::BufferPool, s_instance )
+
+K3b::BufferPool* K3b::BufferPool::instance()
+{
+    return s_instance();
+}
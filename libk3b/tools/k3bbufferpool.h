@@ -0,0 +1,137 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_BUFFER_POOL_H_
+#define _K3B_BUFFER_POOL_H_
+
+#include "k3b_export.h"
+
+#include <QtGlobal>
+
+namespace K3b {
+    /**
+     * A thread-safe pool of page-aligned data buffers.
+     *
+     * Requests are rounded up to power of two size classes from 4 KB to
+     * 64 MB. Released buffers are kept in per-class free lists up to a
+     * configurable amount of memory and handed out again instead of
+     * allocating new memory. Buffers of 2 MB and more are aligned to and
+     * advised for transparent huge pages where the system supports it.
+     *
+     * Buffers are reference counted. Copying a Buffer shares the memory,
+     * which allows to hand data from one stage of a pipeline to the next
+     * without copying it. The memory returns to the pool when the last
+     * reference is released, even if the pool itself was deleted before.
+     */
+    class LIBK3B_EXPORT BufferPool
+    {
+    public:
+        class LIBK3B_EXPORT Buffer
+        {
+        public:
+            Buffer();
+            Buffer( const Buffer& other );
+            Buffer( Buffer&& other );
+            ~Buffer();
+
+            Buffer& operator=( const Buffer& other );
+            Buffer& operator=( Buffer&& other );
+
+            bool isNull() const { return !d; }
+
+            /**
+             * The memory is shared between all copies of the buffer,
+             * no copy-on-write takes place.
+             */
+            char* data() const;
+            const char* constData() const { return data(); }
+
+            /**
+             * \return the size as requested from the pool.
+             */
+            qint64 size() const;
+
+            /**
+             * \return the size of the size class, at least size().
+             */
+            qint64 capacity() const;
+
+            /**
+             * \return true if other copies of this buffer exist.
+             */
+            bool isShared() const;
+
+            /**
+             * Drops this reference to the memory.
+             */
+            void release();
+
+        private:
+            struct Data;
+            Data* d;
+
+            friend class BufferPool;
+        };
+
+        struct Statistics {
+            quint64 allocations;        /**< Number of served requests. */
+            quint64 reuses;             /**< Requests served from the free lists. */
+            quint64 systemAllocations;  /**< Requests which needed new memory. */
+            qint64 bytesInUse;          /**< Capacity of all buffers in use. */
+            qint64 peakBytesInUse;
+            qint64 bytesCached;         /**< Capacity of all buffers in the free lists. */
+        };
+
+        /**
+         * \param maxCachedBytes The maximum amount of memory kept in the free lists.
+         */
+        explicit BufferPool( qint64 maxCachedBytes = 64*1024*1024 );
+
+        /**
+         * Frees the cached buffers. Buffers still in use stay valid.
+         */
+        ~BufferPool();
+
+        /**
+         * \return a buffer of at least \p size bytes or a null buffer if
+         * \p size is not positive or no memory is available.
+         */
+        Buffer allocate( qint64 size );
+
+        Statistics statistics() const;
+
+        /**
+         * Frees all cached buffers.
+         */
+        void clear();
+
+        /**
+         * \return the capacity of buffers allocated for \p size bytes.
+         */
+        static qint64 capacityForSize( qint64 size );
+
+        /**
+         * The pool shared by all jobs.
+         */
+        static BufferPool* instance();
+
+    private:
+        class Private;
+        Private* d;
+
+        Q_DISABLE_COPY(BufferPool)
+    };
+}
+
+#endif
@@ -18,9 +18,11 @@
 #include "k3bcdparanoialib.h"
 
 #include "k3bdevice.h"
+#include "k3bglobals.h"
 #include "k3btoc.h"
 #include "k3bmsf.h"
 
+#include <QByteArray>
 #include <QDebug>
 #include <QFile>
 #include <QGlobalStatic>
@@ -28,12 +30,17 @@
 #include <QMutex>
 #include <QMutexLocker>
 
+#include <string.h>
+
 #ifdef Q_OS_WIN32
 typedef short int int16_t;
 #endif
 
 static bool s_haveLibCdio = false;
 
+// the number of sectors read with one command if paranoia is disabled
+static const long s_maxSectorsPerRead = 16;
+
 
 
 #define CDDA_IDENTIFY          s_haveLibCdio ? "cdio_cddap_identify" : "cdda_identify"
@@ -43,6 +50,7 @@ static bool s_haveLibCdio = false;
 #define CDDA_TRACK_LASTSECTOR  s_haveLibCdio ? "cdio_cddap_track_lastsector" : "cdda_track_lastsector"
 #define CDDA_VERBOSE_SET       s_haveLibCdio ? "cdio_cddap_verbose_set" : "cdda_verbose_set"
 #define CDDA_DISC_FIRSTSECTOR  s_haveLibCdio ? "cdio_cddap_disc_firstsector" : "cdda_disc_firstsector"
+#define CDDA_READ              s_haveLibCdio ? "cdio_cddap_read" : "cdda_read"
 
 #define PARANOIA_INIT          s_haveLibCdio ? "cdio_paranoia_init" : "paranoia_init"
 #define PARANOIA_FREE          s_haveLibCdio ? "cdio_paranoia_free" : "paranoia_free"
@@ -72,9 +80,17 @@ Q_GLOBAL_STATIC(QLibrary, s_libParanoia)
 
 
 
+// the skips paranoia reported to paranoiaCallback() in this thread,
+// used by readSectors() to count the sectors which could not be verified
+static thread_local long s_paranoiaSkips = 0;
+
+
 static void paranoiaCallback( long, int status )
 {
-    // do nothing so far....
+    if( status == PARANOIA_CB_SKIP )
+        ++s_paranoiaSkips;
+
+    // do nothing else so far....
     return;
 
     switch( status ) {
@@ -139,6 +155,7 @@ extern "C" {
     long (*cdda_cdda_track_lastsector)( cdrom_drive*, int );
     long (*cdda_cdda_disc_firstsector)(cdrom_drive *d);
     void (*cdda_cdda_verbose_set)(cdrom_drive *d,int err_action, int mes_action);
+    long (*cdda_cdda_read)(cdrom_drive *d, void *buffer, long beginsector, long sectors);
 
     // cdda_paranoia
     cdrom_paranoia* (*cdda_paranoia_init)(cdrom_drive*);
@@ -179,6 +196,8 @@ namespace K3b {
         void paranoiaFree();
         int16_t* paranoiaRead( void(*callback)(long,int), int maxRetries );
         long paranoiaSeek( long, int );
+        long readSectors( char* buffer, long sector, long sectors, int mode,
+                          void(*callback)(long,int), int maxRetries, long* recovered = 0 );
         long firstSector( int );
         long lastSector( int );
         long sector() const { return m_currentSector; }
@@ -296,6 +315,75 @@ int16_t* K3b::CdparanoiaLibData::paranoiaRead( void(*callback)(long,int), int ma
 }
 
 
+/**
+ * Reads up to \p sectors sectors starting at \p sector into \p buffer with
+ * one lock and one mode change. Without paranoia the sectors are read
+ * directly from the drive, several at a time. Sectors which cannot be read
+ * that way are retried through paranoia.
+ *
+ * \param recovered If not 0 will be set to the number of sectors which had
+ *                  to be retried through paranoia after the direct read
+ *                  failed or which paranoia had to skip. Skips are only
+ *                  counted with paranoiaCallback().
+ *
+ * \return the number of sectors read.
+ */
+long K3b::CdparanoiaLibData::readSectors( char* buffer, long sector, long sectors, int mode,
+                                         void(*callback)(long,int), int maxRetries, long* recovered )
+{
+    if( recovered )
+        *recovered = 0;
+
+    if( !m_paranoia )
+        return 0;
+
+    QMutexLocker locker( &m_mutex );
+
+    cdda_paranoia_modeset( m_paranoia, mode );
+
+    long done = 0;
+    bool fallback = false;
+
+    if( mode == PARANOIA_MODE_DISABLE && cdda_cdda_read ) {
+        while( done < sectors ) {
+            const long read = cdda_cdda_read( m_drive,
+                                              buffer + done*CD_FRAMESIZE_RAW,
+                                              sector + done,
+                                              qMin( sectors - done, s_maxSectorsPerRead ) );
+            if( read <= 0 )
+                break;
+            done += read;
+        }
+
+        // the paranoia cursor did not move
+        m_currentSector = -1;
+
+        if( done == sectors )
+            return done;
+
+        fallback = true;
+    }
+
+    if( m_currentSector != sector + done )
+        m_currentSector = cdda_paranoia_seek( m_paranoia, sector + done, SEEK_SET );
+
+    while( done < sectors ) {
+        s_paranoiaSkips = 0;
+        int16_t* data = cdda_paranoia_read_limited( m_paranoia, callback, maxRetries );
+        if( !data )
+            break;
+        ::memcpy( buffer + done*CD_FRAMESIZE_RAW, data, CD_FRAMESIZE_RAW );
+        m_currentSector++;
+        done++;
+
+        if( recovered && ( fallback || s_paranoiaSkips > 0 ) )
+            ++*recovered;
+    }
+
+    return done;
+}
+
+
 long K3b::CdparanoiaLibData::firstSector( int track )
 {
     if( m_drive ) {
@@ -344,13 +432,14 @@ public:
           paranoiaLevel(0),
           neverSkip(true),
           maxRetries(5),
+          readErrors(0),
           data(0) {
     }
 
     ~Private() {
     }
 
-    void updateParanoiaMode() {
+    int paranoiaMode() const {
         // from cdrdao 1.1.7
         int paranoiaMode = PARANOIA_MODE_FULL^PARANOIA_MODE_NEVERSKIP;
 
@@ -372,7 +461,11 @@ public:
         if( neverSkip )
             paranoiaMode |= PARANOIA_MODE_NEVERSKIP;
 
-        data->paranoiaModeSet( paranoiaMode );
+        return paranoiaMode;
+    }
+
+    void updateParanoiaMode() {
+        data->paranoiaModeSet( paranoiaMode() );
     }
 
     // high-level api
@@ -387,7 +480,13 @@ public:
     bool neverSkip;
     int maxRetries;
 
+    // sectors since initReading() which failed in burst mode
+    int readErrors;
+
     K3b::CdparanoiaLibData* data;
+
+    // the data returned by readSectors()
+    QByteArray readBuffer;
 };
 
 
@@ -412,6 +511,8 @@ bool K3b::CdparanoiaLib::load()
     cdda_cdda_track_lastsector = (long (*)(cdrom_drive*, int))s_libInterface->resolve( CDDA_TRACK_LASTSECTOR );
     cdda_cdda_verbose_set = (void (*)(cdrom_drive *d,int err_action, int mes_action))s_libInterface->resolve( CDDA_VERBOSE_SET );
     cdda_cdda_disc_firstsector = (long (*)(cdrom_drive *d))s_libInterface->resolve( CDDA_DISC_FIRSTSECTOR );
+    // optional, only used to read many sectors at once without paranoia
+    cdda_cdda_read = (long (*)(cdrom_drive *d, void *buffer, long beginsector, long sectors))s_libInterface->resolve( CDDA_READ );
 
     cdda_paranoia_init = (cdrom_paranoia* (*)(cdrom_drive*))s_libParanoia->resolve( PARANOIA_INIT );
     cdda_paranoia_free = (void (*)(cdrom_paranoia *p))s_libParanoia->resolve( PARANOIA_FREE );
@@ -687,6 +788,7 @@ bool K3b::CdparanoiaLib::initReading( long start, long end )
             d->toc.lastSector().lba() >= end ) {
             d->startSector = d->currentSector = start;
             d->lastSector = end;
+            d->readErrors = 0;
 
             // determine track number
             d->currentTrack = 1;
@@ -737,16 +839,12 @@ char* K3b::CdparanoiaLib::read( int* statusCode, unsigned int* track, bool littl
 
     char* charData = reinterpret_cast<char*>(data);
 
-    if(
+    if( data &&
 #ifndef WORDS_BIGENDIAN // __BYTE_ORDER == __BIG_ENDIAN
         !
 #endif
         littleEndian ) {
-        for( int i = 0; i < CD_FRAMESIZE_RAW-1; i+=2 ) {
-            char b = charData[i];
-            charData[i] = charData[i+1];
-            charData[i+1] = b;
-        }
+        K3b::swapByteOrder16( charData, CD_FRAMESIZE_RAW );
     }
 
 
@@ -770,12 +868,79 @@ char* K3b::CdparanoiaLib::read( int* statusCode, unsigned int* track, bool littl
 }
 
 
+char* K3b::CdparanoiaLib::readSectors( int sectors, int* sectorsRead, int* statusCode, unsigned int* track, bool littleEndian )
+{
+    if( sectorsRead )
+        *sectorsRead = 0;
+
+    if( d->currentSector > d->lastSector ) {
+        qDebug() << "(K3b::CdparanoiaLib) finished ripping. read "
+                 << (d->currentSector - d->startSector) << " sectors." << endl
+                 << "                   current sector: " << d->currentSector << endl;
+        d->status = S_OK;
+        if( statusCode )
+            *statusCode = d->status;
+        return 0;
+    }
+
+    // a batch never spans a track boundary
+    long count = qMin<long>( qMax( sectors, 1 ), d->lastSector - d->currentSector + 1 );
+    count = qMin<long>( count, d->toc[d->currentTrack-1].lastSector().lba() - d->currentSector + 1 );
+
+    if( d->readBuffer.size() < count*CD_FRAMESIZE_RAW )
+        d->readBuffer.resize( count*CD_FRAMESIZE_RAW );
+
+    long recovered = 0;
+    const long read = d->data->readSectors( d->readBuffer.data(), d->currentSector, count,
+                                            d->paranoiaMode(), paranoiaCallback, d->maxRetries,
+                                            &recovered );
+    d->readErrors += recovered;
+
+    if( track )
+        *track = d->currentTrack;
+
+    if( read <= 0 ) {
+        d->status = S_ERROR;
+        if( statusCode )
+            *statusCode = d->status;
+        return 0;
+    }
+
+    if(
+#ifndef WORDS_BIGENDIAN // __BYTE_ORDER == __BIG_ENDIAN
+        !
+#endif
+        littleEndian ) {
+        K3b::swapByteOrder16( d->readBuffer.data(), read*CD_FRAMESIZE_RAW );
+    }
+
+    d->status = S_OK;
+    if( statusCode )
+        *statusCode = d->status;
+    if( sectorsRead )
+        *sectorsRead = read;
+
+    d->currentSector += read;
+
+    if( d->toc[d->currentTrack-1].lastSector() < d->currentSector )
+        d->currentTrack++;
+
+    return d->readBuffer.data();
+}
+
+
 int K3b::CdparanoiaLib::status() const
 {
     return d->status;
 }
 
 
+int K3b::CdparanoiaLib::readErrors() const
+{
+    return d->readErrors;
+}
+
+
 const K3b::Device::Toc& K3b::CdparanoiaLib::toc() const
 {
     return d->toc;
@@ -121,11 +121,37 @@ namespace K3b {
          */
         char* read( int* statusCode = 0, unsigned int* track = 0, bool littleEndian = true );
 
+        /**
+         * Read up to \p sectors sectors at once into one contiguous buffer.
+         * The mode is set and the device is locked only once per call which
+         * makes this considerably faster than read() with paranoia disabled.
+         * With paranoia enabled the sectors are still verified one by one.
+         *
+         * A batch never spans a track boundary, so all returned sectors belong
+         * to \p track. If a sector cannot be read the sectors before it are
+         * returned and the next call fails.
+         *
+         * \param sectorsRead If not 0 will be set to the number of sectors in the buffer.
+         *
+         * \return The read data which is valid until the next call or 0 if all data
+         *         within the specified range has been read or an error has occurred.
+         */
+        char* readSectors( int sectors, int* sectorsRead, int* statusCode = 0,
+                           unsigned int* track = 0, bool littleEndian = true );
+
         /**
          * This only is valid after a call to read()
          */
         int status() const;
 
+        /**
+         * The number of sectors since the last call to initReading() which
+         * could not be read directly from the drive with paranoia disabled
+         * and had to be recovered through paranoia, or which paranoia had
+         * to skip, by readSectors().
+         */
+        int readErrors() const;
+
         enum Status {
             S_OK,
             S_ERROR
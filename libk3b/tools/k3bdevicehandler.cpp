@@ -15,7 +15,6 @@
 
 #include "k3bdevicehandler.h"
 #include "k3bprogressinfoevent.h"
-#include "k3bthread.h"
 #include "k3bdevice.h"
 #include "k3bcdtext.h"
 #include "k3bcore.h"
@@ -213,6 +212,12 @@ void K3b::Device::DeviceHandler::jobFinished( bool success )
 }
 
 
+K3b::Device::Device* K3b::Device::DeviceHandler::executionDevice() const
+{
+    return d->dev;
+}
+
+
 bool K3b::Device::DeviceHandler::run()
 {
     qDebug() << "starting command: " << d->command;
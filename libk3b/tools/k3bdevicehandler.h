@@ -196,6 +196,7 @@ namespace K3b {
         private:
             void jobFinished( bool success ) override;
             bool run() override;
+            Device* executionDevice() const override;
 
             class Private;
             Private* const d;
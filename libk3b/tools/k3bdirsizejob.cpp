@@ -14,7 +14,6 @@
 
 #include "k3bdirsizejob.h"
 
-#include "k3bthread.h"
 #include "k3bthreadjob.h"
 #include "k3bsimplejobhandler.h"
 #include "k3bglobals.h"
@@ -0,0 +1,423 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bfanoutpipe.h"
+#include "k3bbufferpool.h"
+
+#include <QDebug>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <string.h>
+
+
+namespace {
+    struct Chunk {
+        quint64 offset;
+        K3b::BufferPool::Buffer data;
+    };
+}
+
+
+class K3b::FanOutPipe::SinkThread : public QThread
+{
+public:
+    SinkThread( K3b::FanOutPipe::Private* pd, int index )
+        : m_d( pd ),
+          m_index( index ) {
+    }
+
+protected:
+    void run() override;
+
+private:
+    K3b::FanOutPipe::Private* m_d;
+    int m_index;
+};
+
+
+class K3b::FanOutPipe::Private
+{
+public:
+    Private( K3b::FanOutPipe* pipe )
+        : q( pipe ),
+          bufferSize( 32*1024*1024 ),
+          produced( 0 ),
+          eof( false ),
+          canceled( false ) {
+    }
+
+    struct Sink {
+        QIODevice* device;
+        bool close;
+        SinkThread* thread;
+
+        // all below is protected by the mutex
+        quint64 pos;
+        int stalls;
+        bool failed;
+    };
+
+    K3b::FanOutPipe* q;
+
+    qint64 bufferSize;
+    QList<Sink> sinks;
+
+    QMutex mutex;
+    QWaitCondition dataAvailable;
+    QWaitCondition spaceAvailable;
+
+    // the ring of shared chunks, ordered by offset
+    QList<Chunk> ring;
+    quint64 produced;
+    bool eof;
+    bool canceled;
+
+    // must be called with the mutex locked
+    quint64 slowestPos() const {
+        quint64 pos = produced;
+        for( int i = 0; i < sinks.count(); ++i ) {
+            if( !sinks[i].failed )
+                pos = qMin( pos, sinks[i].pos );
+        }
+        return pos;
+    }
+
+    // must be called with the mutex locked
+    bool haveActiveSinks() const {
+        for( int i = 0; i < sinks.count(); ++i ) {
+            if( !sinks[i].failed )
+                return true;
+        }
+        return false;
+    }
+
+    // must be called with the mutex locked
+    void trim() {
+        const quint64 pos = slowestPos();
+        while( !ring.isEmpty() &&
+               ring.first().offset + (quint64)ring.first().data.size() <= pos )
+            ring.removeFirst();
+        spaceAvailable.wakeAll();
+    }
+
+    // must be called with the mutex locked
+    int findChunk( quint64 pos ) const {
+        int first = 0;
+        int last = ring.count() - 1;
+        while( first <= last ) {
+            const int mid = ( first + last ) / 2;
+            const Chunk& c = ring.at( mid );
+            if( pos < c.offset )
+                last = mid - 1;
+            else if( pos >= c.offset + (quint64)c.data.size() )
+                first = mid + 1;
+            else
+                return mid;
+        }
+        return -1;
+    }
+
+    void closeSinks() {
+        for( int i = 0; i < sinks.count(); ++i ) {
+            if( sinks[i].close && sinks[i].device->isOpen() )
+                sinks[i].device->close();
+        }
+    }
+
+    void _k3b_sinkThreadFinished() {
+        for( int i = 0; i < sinks.count(); ++i ) {
+            if( sinks[i].thread->isRunning() )
+                return;
+        }
+
+        if( q->isOpen() ) {
+            qDebug() << "(K3b::FanOutPipe) all sinks done. Written bytes:" << produced;
+            closeSinks();
+            q->QIODevice::close();
+            emit q->finished();
+        }
+    }
+};
+
+
+void K3b::FanOutPipe::SinkThread::run()
+{
+    QMutexLocker locker( &m_d->mutex );
+
+    while( true ) {
+        Private::Sink& sink = m_d->sinks[m_index];
+
+        while( !m_d->canceled && !m_d->eof && sink.pos >= m_d->produced )
+            m_d->dataAvailable.wait( &m_d->mutex );
+
+        if( m_d->canceled || sink.pos >= m_d->produced )
+            break;
+
+        const int index = m_d->findChunk( sink.pos );
+        Q_ASSERT( index >= 0 );
+
+        // sharing the chunk only increases the reference count
+        const K3b::BufferPool::Buffer data = m_d->ring.at( index ).data;
+        const qint64 offset = sink.pos - m_d->ring.at( index ).offset;
+        QIODevice* device = sink.device;
+
+        locker.unlock();
+
+        qint64 written = offset;
+        while( written < data.size() ) {
+            const qint64 w = device->write( data.constData() + written, data.size() - written );
+            if( w <= 0 )
+                break;
+            written += w;
+        }
+
+        locker.relock();
+
+        // the list of sinks does not change while the threads are running
+        Private::Sink& s = m_d->sinks[m_index];
+        s.pos += written - offset;
+        if( written < data.size() ) {
+            qDebug() << "(K3b::FanOutPipe) writing to sink" << m_index << "failed:" << device->errorString();
+            s.failed = true;
+            m_d->trim();
+            QMetaObject::invokeMethod( m_d->q, "sinkError", Qt::QueuedConnection, Q_ARG( int, m_index ) );
+            break;
+        }
+        m_d->trim();
+    }
+}
+
+
+K3b::FanOutPipe::FanOutPipe()
+{
+    d = new Private( this );
+}
+
+
+K3b::FanOutPipe::~FanOutPipe()
+{
+    abort();
+    for( int i = 0; i < d->sinks.count(); ++i )
+        delete d->sinks[i].thread;
+    delete d;
+}
+
+
+void K3b::FanOutPipe::setBufferSize( qint64 bytes )
+{
+    d->bufferSize = qMax( bytes, qint64( 2048 ) );
+}
+
+
+qint64 K3b::FanOutPipe::bufferSize() const
+{
+    return d->bufferSize;
+}
+
+
+int K3b::FanOutPipe::addSink( QIODevice* dev, bool close )
+{
+    if( isOpen() ) {
+        qDebug() << "(K3b::FanOutPipe) cannot add sinks to an open pipe.";
+        return -1;
+    }
+
+    Private::Sink sink;
+    sink.device = dev;
+    sink.close = close;
+    sink.thread = new SinkThread( d, d->sinks.count() );
+    sink.pos = 0;
+    sink.stalls = 0;
+    sink.failed = false;
+    connect( sink.thread, SIGNAL(finished()), this, SLOT(_k3b_sinkThreadFinished()) );
+    d->sinks.append( sink );
+    return d->sinks.count() - 1;
+}
+
+
+void K3b::FanOutPipe::clearSinks()
+{
+    if( isOpen() ) {
+        qDebug() << "(K3b::FanOutPipe) cannot remove sinks from an open pipe.";
+        return;
+    }
+
+    for( int i = 0; i < d->sinks.count(); ++i )
+        delete d->sinks[i].thread;
+    d->sinks.clear();
+}
+
+
+int K3b::FanOutPipe::sinkCount() const
+{
+    return d->sinks.count();
+}
+
+
+bool K3b::FanOutPipe::open( OpenMode )
+{
+    // used by ActivePipe if it writes to the fan out pipe
+    return open();
+}
+
+
+bool K3b::FanOutPipe::open()
+{
+    if( isOpen() || d->sinks.isEmpty() )
+        return false;
+
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        QIODevice* dev = d->sinks[i].device;
+        if( !dev->isOpen() && !dev->open( QIODevice::WriteOnly ) ) {
+            qDebug() << "(K3b::FanOutPipe) failed to open sink" << i;
+            return false;
+        }
+    }
+
+    d->ring.clear();
+    d->produced = 0;
+    d->eof = false;
+    d->canceled = false;
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        d->sinks[i].pos = 0;
+        d->sinks[i].stalls = 0;
+        d->sinks[i].failed = false;
+    }
+
+    QIODevice::open( WriteOnly|Unbuffered );
+
+    for( int i = 0; i < d->sinks.count(); ++i )
+        d->sinks[i].thread->start();
+
+    qDebug() << "(K3b::FanOutPipe) opened pipe with" << d->sinks.count() << "sinks.";
+
+    return true;
+}
+
+
+void K3b::FanOutPipe::close()
+{
+    QMutexLocker locker( &d->mutex );
+    d->eof = true;
+    d->dataAvailable.wakeAll();
+}
+
+
+void K3b::FanOutPipe::abort()
+{
+    d->mutex.lock();
+    d->canceled = true;
+    d->dataAvailable.wakeAll();
+    d->spaceAvailable.wakeAll();
+    d->mutex.unlock();
+
+    for( int i = 0; i < d->sinks.count(); ++i )
+        d->sinks[i].thread->wait();
+
+    if( isOpen() ) {
+        d->closeSinks();
+        QIODevice::close();
+    }
+}
+
+
+quint64 K3b::FanOutPipe::bytesWritten() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->produced;
+}
+
+
+quint64 K3b::FanOutPipe::sinkBytesWritten( int sink ) const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->sinks.at( sink ).pos;
+}
+
+
+int K3b::FanOutPipe::fillLevel() const
+{
+    QMutexLocker locker( &d->mutex );
+    return (int)qMin( qint64( 100 ), (qint64)( d->produced - d->slowestPos() ) * 100 / d->bufferSize );
+}
+
+
+int K3b::FanOutPipe::stalls( int sink ) const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->sinks.at( sink ).stalls;
+}
+
+
+bool K3b::FanOutPipe::sinkFailed( int sink ) const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->sinks.at( sink ).failed;
+}
+
+
+qint64 K3b::FanOutPipe::readData( char*, qint64 )
+{
+    return -1;
+}
+
+
+qint64 K3b::FanOutPipe::writeData( const char* data, qint64 max )
+{
+    if( max <= 0 )
+        return 0;
+
+    // copy the data once into a pooled buffer. All sinks share the same chunk
+    // and the buffer returns to the pool once the slowest sink is done with it.
+    Chunk chunk;
+    chunk.data = K3b::BufferPool::instance()->allocate( max );
+    if( chunk.data.isNull() )
+        return -1;
+    ::memcpy( chunk.data.data(), data, max );
+
+    QMutexLocker locker( &d->mutex );
+
+    bool stalled = false;
+    while( !d->canceled &&
+           d->haveActiveSinks() &&
+           d->produced > d->slowestPos() &&
+           (qint64)( d->produced - d->slowestPos() ) + max > d->bufferSize ) {
+        if( !stalled ) {
+            // account the stall to the sinks holding us back
+            const quint64 pos = d->slowestPos();
+            for( int i = 0; i < d->sinks.count(); ++i ) {
+                if( !d->sinks[i].failed && d->sinks[i].pos == pos )
+                    ++d->sinks[i].stalls;
+            }
+            stalled = true;
+        }
+        d->spaceAvailable.wait( &d->mutex );
+    }
+
+    if( d->canceled || !d->haveActiveSinks() )
+        return -1;
+
+    chunk.offset = d->produced;
+    d->ring.append( chunk );
+    d->produced += max;
+    d->dataAvailable.wakeAll();
+
+    return max;
+}
+
+#include "moc_k3bfanoutpipe.cpp"
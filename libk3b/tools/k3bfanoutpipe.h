@@ -0,0 +1,157 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_FAN_OUT_PIPE_H_
+#define _K3B_FAN_OUT_PIPE_H_
+
+#include "k3b_export.h"
+
+#include <QIODevice>
+
+
+namespace K3b {
+    /**
+     * The fan out pipe duplicates one data stream into several sinks.
+     *
+     * Data written to the pipe is stored once in a shared, reference counted
+     * buffer ring. Every sink is fed by its own thread and consumes the ring
+     * at its own pace. A sink may fall behind the fastest sink by at most
+     * bufferSize() bytes. Once that budget is used up the producer blocks
+     * until the slowest sink catches up.
+     *
+     * A sink which fails to accept data is dropped from the pipe so it does
+     * not block the remaining sinks.
+     *
+     * Typical usage is writing one source medium to several writers at once:
+     * \code
+     * pipe.addSink( writer1->ioDevice() );
+     * pipe.addSink( writer2->ioDevice() );
+     * pipe.open();
+     * reader->writeTo( &pipe );
+     * // once the reader is done
+     * pipe.close();
+     * \endcode
+     */
+    class LIBK3B_EXPORT FanOutPipe : public QIODevice
+    {
+        Q_OBJECT
+
+    public:
+        FanOutPipe();
+        ~FanOutPipe() override;
+
+        /**
+         * The maximum number of bytes the slowest sink may lag behind
+         * the producer. Defaults to 32 MB.
+         */
+        void setBufferSize( qint64 bytes );
+        qint64 bufferSize() const;
+
+        /**
+         * Add a sink. Sinks can only be added while the pipe is closed.
+         *
+         * \param close If true the device will be closed once all data
+         *              has been written to it.
+         *
+         * \return The index of the sink.
+         */
+        int addSink( QIODevice* dev, bool close = false );
+
+        /**
+         * Remove all sinks.
+         */
+        void clearSinks();
+
+        int sinkCount() const;
+
+        /**
+         * Opens the pipe and starts the sink threads.
+         */
+        bool open();
+
+        /**
+         * Signals the end of the data stream. The sinks are fed the remaining
+         * data and the finished() signal is emitted once all of them are done.
+         * The pipe stays open until then. Does not block.
+         *
+         * This allows to use the pipe as the sink of an ActivePipe which closes
+         * its sink once all data has been pumped.
+         */
+        void close() override;
+
+        /**
+         * Stops all sinks without writing the remaining data and waits for
+         * the threads to terminate.
+         */
+        void abort();
+
+        /**
+         * The number of bytes that have been written to the pipe.
+         */
+        quint64 bytesWritten() const;
+
+        /**
+         * The number of bytes that have been written to sink @p sink.
+         */
+        quint64 sinkBytesWritten( int sink ) const;
+
+        /**
+         * The fill level of the shared buffer in percent of bufferSize(),
+         * i.e. how far the slowest active sink lags behind.
+         */
+        int fillLevel() const;
+
+        /**
+         * The number of times the producer had to wait for @p sink
+         * because the buffer budget was used up.
+         */
+        int stalls( int sink ) const;
+
+        /**
+         * \return true if writing to @p sink failed.
+         */
+        bool sinkFailed( int sink ) const;
+
+    Q_SIGNALS:
+        /**
+         * Emitted when writing to a sink failed. The sink has been removed
+         * from the pipe.
+         */
+        void sinkError( int sink );
+
+        /**
+         * Emitted once all sinks have been fed the complete data after close()
+         * has been called.
+         */
+        void finished();
+
+    protected:
+        qint64 readData( char* data, qint64 max ) override;
+        qint64 writeData( const char* data, qint64 max ) override;
+
+        /**
+         * Hidden open method. Same as open().
+         */
+        bool open( OpenMode mode ) override;
+
+    private:
+        class SinkThread;
+        class Private;
+        Private* d;
+
+        Q_PRIVATE_SLOT( d, void _k3b_sinkThreadFinished() )
+    };
+}
+
+#endif
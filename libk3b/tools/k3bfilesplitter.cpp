@@ -121,6 +121,7 @@ void K3b::FileSplitter::setName( const QString& filename )
     close();
     d->maxFileSize = 0;
     d->filename = filename;
+    d->size = 0;
 }
 
 
@@ -17,6 +17,7 @@
 
 #include "k3biso9660.h"
 #include "k3biso9660backend.h"
+#include "k3bbufferpool.h"
 
 #include "k3bdevice.h"
 
@@ -217,7 +218,7 @@ int K3b::Iso9660File::read( unsigned int pos, char* data, int maxlen ) const
     unsigned long startSec = m_startSector + pos/2048;
     int startSecOffset = pos%2048;
     char* buffer = data;
-    bool buffered = false;
+    K3b::BufferPool::Buffer poolBuffer;
     unsigned long bufferLen = maxlen+startSecOffset;
 
     // cut to size
@@ -230,13 +231,15 @@ int K3b::Iso9660File::read( unsigned int pos, char* data, int maxlen ) const
 
     // we need to buffer if we changed the startSec or need a bigger buffer
     if( startSecOffset || bufferLen > (unsigned int)maxlen ) {
-        buffered = true;
-        buffer = new char[bufferLen];
+        poolBuffer = K3b::BufferPool::instance()->allocate( bufferLen );
+        buffer = poolBuffer.data();
+        if( !buffer )
+            return -1;
     }
 
     int read = archive()->read( startSec, buffer, bufferLen/2048 )*2048;
 
-    if( buffered ) {
+    if( !poolBuffer.isNull() ) {
         if( read > 0 ) {
             // cut to requested data
             read -= startSecOffset;
@@ -247,7 +250,6 @@ int K3b::Iso9660File::read( unsigned int pos, char* data, int maxlen ) const
 
             ::memcpy( data, buffer+startSecOffset, read );
         }
-        delete [] buffer;
 
         return read;
     }
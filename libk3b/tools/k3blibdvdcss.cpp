@@ -17,13 +17,25 @@
 #include "k3blibdvdcss.h"
 
 #include "k3bdevice.h"
+#include "k3bdiskinfo.h"
+#include "k3btoc.h"
 #include "k3biso9660.h"
 #include "k3biso9660backend.h"
+#include "k3bmediuminfocache.h"
 
+#include <QDataStream>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QGlobalStatic>
 #include <QLibrary>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPair>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
 
 
 
@@ -41,6 +53,64 @@ extern "C" {
 Q_GLOBAL_STATIC(QLibrary, s_libDvdCss)
 
 
+namespace {
+    const quint32 s_magic = 0x4B334454; // "K3DT"
+    const quint16 s_version = 1;
+
+    Q_GLOBAL_STATIC(QMutex, s_titleCacheMutex)
+
+    QString titleCacheFileName( const QByteArray& fingerprint )
+    {
+        return QStandardPaths::writableLocation( QStandardPaths::CacheLocation )
+            + QLatin1String( "/dvdcss/" ) + QString::fromLatin1( fingerprint.toHex() );
+    }
+
+    bool loadTitleOffsets( const QByteArray& fingerprint, QVector< QPair<int,int> >& titleOffsets )
+    {
+        QMutexLocker locker( s_titleCacheMutex() );
+
+        QFile f( titleCacheFileName( fingerprint ) );
+        if( !f.open( QIODevice::ReadOnly ) )
+            return false;
+
+        QDataStream s( &f );
+        quint32 magic = 0;
+        quint16 version = 0;
+        s >> magic >> version >> titleOffsets;
+        if( magic != s_magic || version != s_version ||
+            s.status() != QDataStream::Ok || titleOffsets.isEmpty() ) {
+            qDebug() << "(K3b::LibDvdCss) invalid title cache entry" << f.fileName();
+            titleOffsets.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void storeTitleOffsets( const QByteArray& fingerprint, const QVector< QPair<int,int> >& titleOffsets )
+    {
+        QMutexLocker locker( s_titleCacheMutex() );
+
+        const QString fileName = titleCacheFileName( fingerprint );
+        if( !QDir().mkpath( QFileInfo( fileName ).path() ) )
+            return;
+
+        QSaveFile f( fileName );
+        if( f.open( QIODevice::WriteOnly ) ) {
+            QDataStream s( &f );
+            s << s_magic << s_version << titleOffsets;
+            if( s.status() == QDataStream::Ok )
+                f.commit();
+        }
+    }
+
+    bool titleStartLessThan( int sector, const QPair<int,int>& title )
+    {
+        return sector < title.first;
+    }
+}
+
+
 
 class K3b::LibDvdCss::Private
 {
@@ -49,11 +119,28 @@ public:
         :dvd(0) {
     }
 
+    /**
+     * Identifies the disc for the title cache like the medium info cache
+     * does: by the toc and the ISO9660 primary volume descriptor.
+     */
+    QByteArray fingerprint() const {
+        const K3b::Device::DiskInfo diskInfo = device->diskInfo();
+        const K3b::Device::Toc toc = device->readToc();
+        QByteArray pvd( 2048, '\0' );
+        if( !device->read10( reinterpret_cast<unsigned char*>( pvd.data() ), 2048, 16, 1 ) )
+            pvd.clear();
+        return K3b::MediumInfoCache::fingerprint( diskInfo, toc, pvd );
+    }
+
     dvdcss_t dvd;
     K3b::Device::Device* device;
+
+    // start sector and length of the titles sorted by start sector
     QVector< QPair<int,int> > titleOffsets;
     int currentSector;
-    bool currentSectorInTitle;
+
+    // the title whose key libdvdcss currently uses
+    int currentTitle;
 };
 
 K3b::LibDvdCss::LibDvdCss()
@@ -75,7 +162,7 @@ bool K3b::LibDvdCss::open( K3b::Device::Device* dev )
     dev->close();
     d->dvd = k3b_dvdcss_open( const_cast<char*>( QFile::encodeName(dev->blockDeviceName()).data() ) );
     d->currentSector = 0;
-    d->currentSectorInTitle = false;
+    d->currentTitle = -1;
     return ( d->dvd != 0 );
 }
 
@@ -102,59 +189,67 @@ int K3b::LibDvdCss::read( void* buffer, int sectors, int flags )
 
 int K3b::LibDvdCss::readWrapped( void* buffer, int firstSector, int sectors )
 {
-    // 1. are we in a title?
-    // 2. does a new title start in the read sector area?
-    //    - see below, set title if firstSector is the first sector of a new title
-    // 3. does a title end in the read sector area?
-    //    3.1 does a previous title end
-    //    3.2 does the title from 2. already end
-
     // we need to seek to the first sector. Otherwise we get faulty data.
     bool needToSeek = ( firstSector != d->currentSector || firstSector == 0 );
     bool inTitle = false;
-    bool startOfTitle = false;
 
     //
     // Make sure we never read encrypted and unencrypted data at once since libdvdcss
     // only decrypts the whole area of read sectors or nothing at all.
     //
-    for( int i = 0; i < d->titleOffsets.count(); ++i ) {
-        int titleStart = d->titleOffsets[i].first;
-        int titleEnd = titleStart + d->titleOffsets[i].second - 1;
-
-        // update key when entrering a new title
-        // FIXME: we also need this if we seek into a new title (not only the start of the title)
-        if( titleStart == firstSector )
-            startOfTitle = needToSeek = inTitle = true;
-
-        // check if a new title or non-title area starts inside the read sector range
-        if( firstSector < titleStart && firstSector+sectors > titleStart ) {
-            qDebug() << "(K3b::LibDvdCss) title start inside of sector range ("
-                     << firstSector << "-" << (firstSector+sectors-1)
-                     << "). only reading " << (titleStart - firstSector) << " sectors up to title offset "
-                     << (titleStart-1);
-            sectors = titleStart - firstSector;
-        }
-
-        if( firstSector < titleEnd && firstSector+sectors > titleEnd ) {
+    // The titles do not overlap, so only the title containing the first sector
+    // or the next one starting after it can be affected.
+    //
+    QVector< QPair<int,int> >::const_iterator next = std::upper_bound( d->titleOffsets.constBegin(),
+                                                                        d->titleOffsets.constEnd(),
+                                                                        firstSector,
+                                                                        titleStartLessThan );
+    const int title = next - d->titleOffsets.constBegin() - 1;
+    int titleStart = 0;
+
+    if( title >= 0 && firstSector < d->titleOffsets[title].first + d->titleOffsets[title].second ) {
+        titleStart = d->titleOffsets[title].first;
+        const int titleEnd = titleStart + d->titleOffsets[title].second - 1;
+        inTitle = true;
+
+        if( firstSector+sectors > titleEnd+1 ) {
             qDebug() << "(K3b::LibDvdCss) title end inside of sector range ("
                      << firstSector << "-" << (firstSector+sectors-1)
                      << "). only reading " << (titleEnd - firstSector + 1) << " sectors up to title offset "
                      << titleEnd;
             sectors = titleEnd - firstSector + 1;
-            inTitle = true;
+        }
+    }
+    else if( next != d->titleOffsets.constEnd() && firstSector+sectors > next->first ) {
+        qDebug() << "(K3b::LibDvdCss) title start inside of sector range ("
+                 << firstSector << "-" << (firstSector+sectors-1)
+                 << "). only reading " << (next->first - firstSector) << " sectors up to title offset "
+                 << (next->first-1);
+        sectors = next->first - firstSector;
+    }
+
+    //
+    // libdvdcss only selects the key of a title when seeking to its very first
+    // sector. The key is cracked or taken from the libdvdcss cache the first
+    // time and kept in memory afterwards.
+    //
+    if( inTitle && title != d->currentTitle ) {
+        qDebug() << "(K3b::LibDvdCss) selecting key of title at " << titleStart;
+
+        d->currentSector = seek( titleStart, DVDCSS_SEEK_KEY );
+        if( d->currentSector != titleStart ) {
+            qDebug() << "(K3b::LibDvdCss) failed to get key for title at " << titleStart;
+            d->currentSector = 0;
+            return -1;
         }
 
-        // is our read range part of one title
-        if( firstSector >= titleStart && firstSector+sectors-1 <= titleEnd )
-            inTitle = true;
+        d->currentTitle = title;
+        needToSeek = ( firstSector != titleStart );
     }
 
     if( needToSeek ) {
         int flags = DVDCSS_NOFLAGS;
-        if( startOfTitle )
-            flags = DVDCSS_SEEK_KEY;
-        else if( inTitle )
+        if( inTitle )
             flags = DVDCSS_SEEK_MPEG;
 
         qDebug() << "(K3b::LibDvdCss) need to seek from " << d->currentSector << " to " << firstSector << " with " << flags;
@@ -188,9 +283,22 @@ bool K3b::LibDvdCss::crackAllKeys()
     //
     // Loop over all titles and crack the keys (inspired by libdvdread)
     //
-    qDebug() << "(K3b::LibDvdCss) cracking all keys.";
-
     d->titleOffsets.clear();
+    d->currentTitle = -1;
+
+    //
+    // For a known disc we already have the title offsets. The keys of the titles
+    // are then selected in readWrapped() on first use which saves seeking over
+    // the whole disc. libdvdcss keeps the cracked keys in its own cache.
+    //
+    const QByteArray fingerprint = d->fingerprint();
+    if( !fingerprint.isEmpty() && loadTitleOffsets( fingerprint, d->titleOffsets ) ) {
+        qDebug() << "(K3b::LibDvdCss) found" << d->titleOffsets.count() << "titles of"
+                 << fingerprint.toHex() << "in cache.";
+        return true;
+    }
+
+    qDebug() << "(K3b::LibDvdCss) cracking all keys.";
 
     K3b::Iso9660 iso( new K3b::Iso9660DeviceBackend( d->device ) );
     iso.setPlainIso9660( true );
@@ -265,6 +373,11 @@ bool K3b::LibDvdCss::crackAllKeys()
 
     qDebug() << "(K3b::LibDvdCss) found " << title << " titles.";
 
+    std::sort( d->titleOffsets.begin(), d->titleOffsets.end() );
+
+    if( title > 0 && !fingerprint.isEmpty() )
+        storeTitleOffsets( fingerprint, d->titleOffsets );
+
     return (title > 0);
 }
 
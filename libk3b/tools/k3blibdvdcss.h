@@ -60,6 +60,10 @@ namespace K3b {
         /**
          * Cache all CSS keys to guarantee smooth reading further on.
          * This method also creates a title offset list which is needed by readWrapped.
+         *
+         * The title offsets are cached on disk per disc. For a known disc the
+         * keys are not retrieved here but by readWrapped() when it enters a title
+         * for the first time.
          */
         bool crackAllKeys();
 
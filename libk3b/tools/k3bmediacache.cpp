@@ -16,6 +16,7 @@
 #include "k3bmediacache_p.h"
 #include "k3bmedium.h"
 #include "k3bmedium_p.h"
+#include "k3bmediuminfocache.h"
 #include "k3bcddb.h"
 #include "k3bdevicemanager.h"
 #include "k3bdeviceglobals.h"
@@ -33,6 +34,22 @@
 
 
 
+class K3b::MediaCache::Private
+{
+public:
+    QMap<K3b::Device::Device*, DeviceEntry*> deviceMap;
+    KCDDB::Client cddbClient;
+
+    // persistent information about known media
+    MediumInfoCache infoCache;
+
+    K3b::MediaCache* q;
+
+    void _k_mediumChanged( K3b::Device::Device* );
+    void _k_cddbJobFinished( KJob* job );
+};
+
+
 K3b::MediaCache::DeviceEntry::DeviceEntry( K3b::MediaCache* c, K3b::Device::Device* dev )
     : medium(dev),
       blockedId(0),
@@ -81,7 +98,7 @@ void K3b::MediaCache::PollThread::run()
             // The medium has changed. We need to update the information.
             //
             K3b::Medium m( m_deviceEntry->medium.device() );
-            m.update();
+            m.update( &m_deviceEntry->cache->d->infoCache );
 
             // block the info since it is not valid anymore
             m_deviceEntry->readMutex.lock();
@@ -113,24 +130,13 @@ void K3b::MediaCache::PollThread::run()
 // ////////////////////////////////////////////////////////////////////////////////
 
 
-class K3b::MediaCache::Private
-{
-public:
-    QMap<K3b::Device::Device*, DeviceEntry*> deviceMap;
-    KCDDB::Client cddbClient;
-
-    K3b::MediaCache* q;
-
-    void _k_mediumChanged( K3b::Device::Device* );
-    void _k_cddbJobFinished( KJob* job );
-};
-
-
 // called from the device thread which updated the medium
 void K3b::MediaCache::Private::_k_mediumChanged( K3b::Device::Device* dev )
 {
-    if ( q->medium( dev ).content() & K3b::Medium::ContentAudio ) {
-        K3b::CDDB::CDDBJob* job = K3b::CDDB::CDDBJob::queryCddb( q->medium( dev ) );
+    // a medium from the info cache already carries its cddb result
+    const K3b::Medium m = q->medium( dev );
+    if ( m.content() & K3b::Medium::ContentAudio && !m.cddbInfo().isValid() ) {
+        K3b::CDDB::CDDBJob* job = K3b::CDDB::CDDBJob::queryCddb( m );
         connect( job, SIGNAL(result(KJob*)),
                  q, SLOT(_k_cddbJobFinished(KJob*)) );
         emit q->checkingMedium( dev, i18n( "CDDB Lookup" ) );
@@ -152,6 +158,7 @@ void K3b::MediaCache::Private::_k_cddbJobFinished( KJob* job )
         if ( !job->error() ) {
             // update it
             deviceMap[oldMedium.device()]->medium.d->cddbInfo = cddbJob->cddbResult();
+            infoCache.store( deviceMap[oldMedium.device()]->medium );
             emit q->mediumCddbChanged( oldMedium.device() );
         }
 
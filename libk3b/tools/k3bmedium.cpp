@@ -15,6 +15,7 @@
 
 #include "k3bmedium.h"
 #include "k3bmedium_p.h"
+#include "k3bmediuminfocache.h"
 #include "k3bcddb.h"
 #include "k3bdeviceglobals.h"
 #include "k3bglobals.h"
@@ -132,6 +133,12 @@ const K3b::Iso9660SimplePrimaryDescriptor& K3b::Medium::iso9660Descriptor() cons
 }
 
 
+QByteArray K3b::Medium::fingerprint() const
+{
+    return d->fingerprint;
+}
+
+
 K3b::Msf K3b::Medium::actuallyUsedCapacity() const
 {
     // DVD+RW, BD-RE, and DVD-RW in restricted overwrite mode have a single track that does not
@@ -168,13 +175,14 @@ void K3b::Medium::reset()
     d->writingSpeeds.clear();
     d->content = ContentNone;
     d->cddbInfo.clear();
+    d->fingerprint.clear();
 
     // clear the desc
     d->isoDesc = K3b::Iso9660SimplePrimaryDescriptor();
 }
 
 
-void K3b::Medium::update()
+void K3b::Medium::update( MediumInfoCache* cache )
 {
     if( d->device ) {
         reset();
@@ -194,23 +202,79 @@ void K3b::Medium::update()
         if( diskInfo().diskState() == K3b::Device::STATE_COMPLETE ||
             diskInfo().diskState() == K3b::Device::STATE_INCOMPLETE ) {
             d->toc = d->device->readToc();
-            if( d->toc.contentType() == K3b::Device::AUDIO ||
+        }
+
+        if( diskInfo().mediaType() & K3b::Device::MEDIA_WRITABLE ) {
+            d->writingSpeeds = d->device->determineSupportedWriteSpeeds();
+        }
+
+        if( cache ) {
+            //
+            // Identify the medium by its toc and the primary volume descriptor
+            // of the filesystem. That is a single sector read compared to reading
+            // the CD-Text and analysing the whole filesystem.
+            //
+            QByteArray pvd;
+            if( d->toc.contentType() == K3b::Device::DATA ||
                 d->toc.contentType() == K3b::Device::MIXED ) {
+                pvd.resize( 2048 );
+                if( !d->device->read10( reinterpret_cast<unsigned char*>( pvd.data() ), 2048, dataStartSector() + 16, 1 ) )
+                    pvd.clear();
+            }
+            d->fingerprint = MediumInfoCache::fingerprint( d->diskInfo, d->toc, pvd );
 
-                // update CD-Text
-                d->cdText = d->device->readCdText();
+            if( cache->load( d->fingerprint, *this ) ) {
+                qDebug() << "(K3b::Medium) found medium" << d->fingerprint.toHex() << "in cache.";
+                return;
             }
         }
 
-        if( diskInfo().mediaType() & K3b::Device::MEDIA_WRITABLE ) {
-            d->writingSpeeds = d->device->determineSupportedWriteSpeeds();
+        if( d->toc.contentType() == K3b::Device::AUDIO ||
+            d->toc.contentType() == K3b::Device::MIXED ) {
+
+            // update CD-Text
+            d->cdText = d->device->readCdText();
         }
 
         analyseContent();
+
+        if( cache )
+            cache->store( *this );
     }
 }
 
 
+unsigned long K3b::Medium::dataStartSector() const
+{
+    unsigned long startSec = 0;
+
+    if( diskInfo().numSessions() > 1 && !d->toc.isEmpty() ) {
+        // We use the last data track
+        // this way we get the latest session on a ms cd
+        for( int i = d->toc.size()-1; i >= 0; --i ) {
+            if( d->toc.at(i).type() == K3b::Device::Track::TYPE_DATA ) {
+                startSec = d->toc.at(i).firstSector().lba();
+                break;
+            }
+        }
+    }
+    else if( !d->toc.isEmpty() ) {
+        // use first data track
+        for( int i = 0; i < d->toc.size(); ++i ) {
+            if( d->toc.at(i).type() == K3b::Device::Track::TYPE_DATA ) {
+                startSec = d->toc.at(i).firstSector().lba();
+                break;
+            }
+        }
+    }
+    else {
+        qDebug() << "(K3b::Medium) ContentData is set and Toc is empty, disk is probably broken!";
+    }
+
+    return startSec;
+}
+
+
 void K3b::Medium::analyseContent()
 {
     // set basic content types
@@ -232,30 +296,7 @@ void K3b::Medium::analyseContent()
     if( d->content & ContentData ) {
         //qDebug() << "(K3b::Medium) Checking file system.";
 
-        unsigned long startSec = 0;
-
-        if( diskInfo().numSessions() > 1 && !d->toc.isEmpty() ) {
-            // We use the last data track
-            // this way we get the latest session on a ms cd
-            for( int i = d->toc.size()-1; i >= 0; --i ) {
-                if( d->toc.at(i).type() == K3b::Device::Track::TYPE_DATA ) {
-                    startSec = d->toc.at(i).firstSector().lba();
-                    break;
-                }
-            }
-        }
-        else if( !d->toc.isEmpty() ) {
-            // use first data track
-            for( int i = 0; i < d->toc.size(); ++i ) {
-                if( d->toc.at(i).type() == K3b::Device::Track::TYPE_DATA ) {
-                    startSec = d->toc.at(i).firstSector().lba();
-                    break;
-                }
-            }
-        }
-        else {
-            qDebug() << "(K3b::Medium) ContentData is set and Toc is empty, disk is probably broken!";
-        }
+        unsigned long startSec = dataStartSector();
 
         //qDebug() << "(K3b::Medium) Checking file system at " << startSec;
 
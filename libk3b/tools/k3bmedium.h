@@ -23,6 +23,7 @@
 #include "k3bdevice.h"
 #include "k3biso9660.h"
 
+#include <QByteArray>
 #include <QSharedDataPointer>
 #include <QList>
 #include <QIcon>
@@ -34,6 +35,7 @@ namespace KCDDB{
 
 namespace K3b {
     class MediumPrivate;
+    class MediumInfoCache;
 
     /**
      * Medium represents a medium in K3b.
@@ -68,8 +70,13 @@ namespace K3b {
          * Updates the medium information if the device is not null.
          * Do not use this in the GUI thread since it uses blocking
          * K3bdevice methods.
+         *
+         * \param cache If not null, a known medium is identified by its toc and
+         *              ISO9660 descriptor and the remaining information is taken
+         *              from the cache instead of being read and analysed again.
+         *              Newly analysed media are added to the cache.
          */
-        void update();
+        void update( MediumInfoCache* cache = 0 );
 
         Device::Device* device() const;
         Device::DiskInfo diskInfo() const;
@@ -127,6 +134,13 @@ namespace K3b {
          */
         const Iso9660SimplePrimaryDescriptor& iso9660Descriptor() const;
 
+        /**
+         * \return The identity fingerprint of the medium as created by
+         *         MediumInfoCache::fingerprint(). Empty if the medium could
+         *         not be identified or no cache was used to update it.
+         */
+        QByteArray fingerprint() const;
+
         /**
          * The used capacity size on the medium. This only differs from DiskInfo::size()
          * in that it handles rewritable media properly. It uses the size of the filesystem
@@ -200,10 +214,12 @@ namespace K3b {
 
     private:
         void analyseContent();
+        unsigned long dataStartSector() const;
 
         QSharedDataPointer<MediumPrivate> d;
 
         friend class MediaCache;
+        friend class MediumInfoCache;
     };
 }
 
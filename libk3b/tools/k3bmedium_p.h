@@ -22,6 +22,7 @@
 #include "k3bcdtext.h"
 #include "k3biso9660.h"
 
+#include <QByteArray>
 #include <QSharedData>
 #include <QList>
 
@@ -46,6 +47,12 @@ namespace K3b {
         Medium::MediumContents content;
 
         KCDDB::CDInfo cddbInfo;
+
+        /**
+         * Identity used by the MediumInfoCache. Empty if the medium
+         * cannot be identified.
+         */
+        QByteArray fingerprint;
     };
 }
 
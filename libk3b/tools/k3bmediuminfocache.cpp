@@ -0,0 +1,247 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bmediuminfocache.h"
+#include "k3bmedium.h"
+#include "k3bmedium_p.h"
+#include "k3bdiskinfo.h"
+#include "k3btoc.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <KCddb/Cdinfo>
+
+
+namespace {
+    const quint32 s_magic = 0x4B33424D; // "K3BM"
+    const quint16 s_version = 1;
+}
+
+
+class K3b::MediumInfoCache::Private
+{
+public:
+    QString path;
+    mutable QMutex mutex;
+
+    QString fileName( const QByteArray& fingerprint ) const {
+        return path + QLatin1Char( '/' ) + QString::fromLatin1( fingerprint.toHex() );
+    }
+};
+
+
+K3b::MediumInfoCache::MediumInfoCache( const QString& path )
+    : d( new Private() )
+{
+    if( path.isEmpty() )
+        d->path = QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + QLatin1String( "/media" );
+    else
+        d->path = path;
+}
+
+
+K3b::MediumInfoCache::~MediumInfoCache()
+{
+    delete d;
+}
+
+
+QString K3b::MediumInfoCache::path() const
+{
+    return d->path;
+}
+
+
+QByteArray K3b::MediumInfoCache::fingerprint( const Device::DiskInfo& diskInfo,
+                                              const Device::Toc& toc,
+                                              const QByteArray& isoPrimaryDescriptor )
+{
+    return fingerprint( diskInfo.mediaType(),
+                        diskInfo.diskState(),
+                        diskInfo.rewritable(),
+                        diskInfo.numSessions(),
+                        diskInfo.capacity(),
+                        diskInfo.mediaId(),
+                        toc,
+                        isoPrimaryDescriptor );
+}
+
+
+QByteArray K3b::MediumInfoCache::fingerprint( Device::MediaType mediaType,
+                                              Device::MediaState diskState,
+                                              bool rewritable,
+                                              int numSessions,
+                                              const K3b::Msf& capacity,
+                                              const QByteArray& mediaId,
+                                              const Device::Toc& toc,
+                                              const QByteArray& isoPrimaryDescriptor )
+{
+    //
+    // Only finished media can be identified. Appendable and rewritable media
+    // may change without the toc telling us in a reliable way.
+    //
+    if( diskState != Device::STATE_COMPLETE ||
+        rewritable ||
+        toc.isEmpty() )
+        return QByteArray();
+
+    QByteArray data;
+    QDataStream s( &data, QIODevice::WriteOnly );
+    s << (qint32)mediaType
+      << (qint32)numSessions
+      << (qint32)capacity.lba()
+      << mediaId
+      << toc.mcn()
+      << (qint32)toc.size();
+    for( Device::Toc::const_iterator it = toc.begin(); it != toc.end(); ++it ) {
+        s << (qint32)it->type()
+          << (qint32)it->mode()
+          << (qint32)it->session()
+          << (qint32)it->firstSector().lba()
+          << (qint32)it->lastSector().lba();
+    }
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( data );
+    if( !isoPrimaryDescriptor.isEmpty() )
+        hash.addData( QCryptographicHash::hash( isoPrimaryDescriptor, QCryptographicHash::Sha1 ) );
+    return hash.result();
+}
+
+
+bool K3b::MediumInfoCache::load( const QByteArray& fingerprint, Medium& medium ) const
+{
+    if( fingerprint.isEmpty() )
+        return false;
+
+    QMutexLocker locker( &d->mutex );
+
+    QFile f( d->fileName( fingerprint ) );
+    if( !f.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream s( &f );
+    quint32 magic = 0;
+    quint16 version = 0;
+    s >> magic >> version;
+    if( magic != s_magic || version != s_version )
+        return false;
+
+    qint32 content = 0;
+    QByteArray cdTextData;
+    QString cddbData;
+    Iso9660SimplePrimaryDescriptor desc;
+    qint32 volumeSetSize = 0, volumeSetNumber = 0;
+    qint64 logicalBlockSize = 0, volumeSpaceSize = 0;
+
+    s >> content
+      >> cdTextData
+      >> desc.volumeId
+      >> desc.systemId
+      >> desc.volumeSetId
+      >> desc.publisherId
+      >> desc.preparerId
+      >> desc.applicationId
+      >> volumeSetSize
+      >> volumeSetNumber
+      >> logicalBlockSize
+      >> volumeSpaceSize
+      >> cddbData;
+
+    if( s.status() != QDataStream::Ok ) {
+        qDebug() << "(K3b::MediumInfoCache) corrupt cache entry" << f.fileName();
+        return false;
+    }
+
+    desc.volumeSetSize = volumeSetSize;
+    desc.volumeSetNumber = volumeSetNumber;
+    desc.logicalBlockSize = logicalBlockSize;
+    desc.volumeSpaceSize = volumeSpaceSize;
+
+    medium.d->fingerprint = fingerprint;
+    medium.d->content = Medium::MediumContents( content );
+    medium.d->isoDesc = desc;
+    if( !cdTextData.isEmpty() )
+        medium.d->cdText.setRawPackData( cdTextData );
+    else
+        medium.d->cdText.clear();
+    medium.d->cddbInfo.clear();
+    if( !cddbData.isEmpty() )
+        medium.d->cddbInfo.load( cddbData );
+
+    return true;
+}
+
+
+bool K3b::MediumInfoCache::store( const Medium& medium )
+{
+    const QByteArray fingerprint = medium.d->fingerprint;
+    if( fingerprint.isEmpty() )
+        return false;
+
+    QMutexLocker locker( &d->mutex );
+
+    if( !QDir().mkpath( d->path ) )
+        return false;
+
+    QSaveFile f( d->fileName( fingerprint ) );
+    if( !f.open( QIODevice::WriteOnly ) )
+        return false;
+
+    const Iso9660SimplePrimaryDescriptor& desc = medium.d->isoDesc;
+
+    QDataStream s( &f );
+    s << s_magic
+      << s_version
+      << (qint32)medium.d->content
+      << medium.d->cdText.rawPackData()
+      << desc.volumeId
+      << desc.systemId
+      << desc.volumeSetId
+      << desc.publisherId
+      << desc.preparerId
+      << desc.applicationId
+      << (qint32)desc.volumeSetSize
+      << (qint32)desc.volumeSetNumber
+      << (qint64)desc.logicalBlockSize
+      << (qint64)desc.volumeSpaceSize
+      << ( medium.d->cddbInfo.isValid() ? medium.d->cddbInfo.toString() : QString() );
+
+    return s.status() == QDataStream::Ok && f.commit();
+}
+
+
+void K3b::MediumInfoCache::remove( const QByteArray& fingerprint )
+{
+    QMutexLocker locker( &d->mutex );
+    QFile::remove( d->fileName( fingerprint ) );
+}
+
+
+void K3b::MediumInfoCache::clear()
+{
+    QMutexLocker locker( &d->mutex );
+    QDir dir( d->path );
+    Q_FOREACH( const QString& entry, dir.entryList( QDir::Files ) ) {
+        dir.remove( entry );
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_MEDIUM_INFO_CACHE_H_
+#define _K3B_MEDIUM_INFO_CACHE_H_
+
+#include "k3b_export.h"
+#include "k3bdevicetypes.h"
+#include "k3bmsf.h"
+
+#include <QByteArray>
+#include <QString>
+
+namespace K3b {
+    namespace Device {
+        class DiskInfo;
+        class Toc;
+    }
+
+    class Medium;
+
+    /**
+     * Persistent on-disk cache of analysed medium information.
+     *
+     * Entries are keyed by a fingerprint built from the TOC, the media id and
+     * a checksum of the ISO9660 primary volume descriptor. A hit provides the
+     * CD-Text, the ISO9660 descriptor, the content analysis, and the CDDB result
+     * so that a known disc does not need to be analysed again.
+     *
+     * All methods are thread-safe. The cache is used from the MediaCache poll
+     * threads through Medium::update().
+     */
+    class LIBK3B_EXPORT MediumInfoCache
+    {
+    public:
+        /**
+         * \param path The directory to store entries in. If empty the
+         *             default cache location is used.
+         */
+        explicit MediumInfoCache( const QString& path = QString() );
+        ~MediumInfoCache();
+
+        QString path() const;
+
+        /**
+         * Create the identity fingerprint of a medium.
+         *
+         * \param isoPrimaryDescriptor The raw 2048 byte primary volume
+         *        descriptor sector. May be empty for media without a filesystem.
+         *
+         * \return An empty array if the medium cannot be identified reliably,
+         *         for example for empty or appendable media.
+         */
+        static QByteArray fingerprint( const Device::DiskInfo& diskInfo,
+                                       const Device::Toc& toc,
+                                       const QByteArray& isoPrimaryDescriptor );
+
+        /**
+         * \overload
+         *
+         * Takes the values of the DiskInfo used for the fingerprint directly.
+         */
+        static QByteArray fingerprint( Device::MediaType mediaType,
+                                       Device::MediaState diskState,
+                                       bool rewritable,
+                                       int numSessions,
+                                       const K3b::Msf& capacity,
+                                       const QByteArray& mediaId,
+                                       const Device::Toc& toc,
+                                       const QByteArray& isoPrimaryDescriptor );
+
+        /**
+         * Fill @p medium with the cached information for @p fingerprint.
+         * DiskInfo and Toc of @p medium are not touched.
+         *
+         * \return false if there is no valid entry.
+         */
+        bool load( const QByteArray& fingerprint, Medium& medium ) const;
+
+        /**
+         * Store the information of @p medium. Does nothing if the medium has
+         * no fingerprint.
+         */
+        bool store( const Medium& medium );
+
+        /**
+         * Remove the entry for @p fingerprint.
+         */
+        void remove( const QByteArray& fingerprint );
+
+        /**
+         * Remove all entries.
+         */
+        void clear();
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( MediumInfoCache )
+    };
+}
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3breaderrormap.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+
+namespace {
+    bool isValidStatus( char c )
+    {
+        return( c == K3b::ReadErrorMap::NonTried ||
+                c == K3b::ReadErrorMap::NonSplit ||
+                c == K3b::ReadErrorMap::BadSector ||
+                c == K3b::ReadErrorMap::Finished );
+    }
+}
+
+
+K3b::ReadErrorMap::ReadErrorMap()
+    : m_first( 0 ),
+      m_last( -1 )
+{
+}
+
+
+void K3b::ReadErrorMap::reset( long firstSector, long lastSector )
+{
+    m_regions.clear();
+    m_first = firstSector;
+    m_last = lastSector;
+    if( !isEmpty() )
+        m_regions.insert( m_first, NonTried );
+}
+
+
+bool K3b::ReadErrorMap::isEmpty() const
+{
+    return m_first > m_last;
+}
+
+
+K3b::ReadErrorMap::Status K3b::ReadErrorMap::status( long sector ) const
+{
+    if( sector < m_first || sector > m_last )
+        return NonTried;
+
+    QMap<long, char>::const_iterator it = m_regions.upperBound( sector );
+    --it;
+    return Status( it.value() );
+}
+
+
+void K3b::ReadErrorMap::setStatus( long start, long count, Status status )
+{
+    long end = qMin( start + count - 1, m_last );
+    start = qMax( start, m_first );
+    if( start > end )
+        return;
+
+    // the region following the changed sectors keeps its status
+    const bool hasFollowing = ( end < m_last );
+    const char following = hasFollowing ? char( this->status( end + 1 ) ) : char( 0 );
+
+    QMap<long, char>::iterator it = m_regions.lowerBound( start );
+    while( it != m_regions.end() && it.key() <= end + 1 )
+        it = m_regions.erase( it );
+
+    if( hasFollowing && following != status )
+        m_regions.insert( end + 1, following );
+
+    // merge with the preceding region
+    it = m_regions.lowerBound( start );
+    if( it == m_regions.begin() || ( it - 1 ).value() != status )
+        m_regions.insert( start, status );
+}
+
+
+bool K3b::ReadErrorMap::nextRegion( Status status, long from, long* start, long* count ) const
+{
+    if( isEmpty() || from > m_last )
+        return false;
+
+    from = qMax( from, m_first );
+    QMap<long, char>::const_iterator it = m_regions.upperBound( from );
+    --it;
+    for( ; it != m_regions.constEnd(); ++it ) {
+        if( it.value() != status )
+            continue;
+
+        QMap<long, char>::const_iterator next = it + 1;
+        const long regionEnd = ( next == m_regions.constEnd() ? m_last + 1 : next.key() );
+        *start = qMax( it.key(), from );
+        *count = regionEnd - *start;
+        return true;
+    }
+
+    return false;
+}
+
+
+long K3b::ReadErrorMap::sectors( Status status ) const
+{
+    long n = 0;
+    for( QMap<long, char>::const_iterator it = m_regions.constBegin(); it != m_regions.constEnd(); ++it ) {
+        if( it.value() == status ) {
+            QMap<long, char>::const_iterator next = it + 1;
+            n += ( next == m_regions.constEnd() ? m_last + 1 : next.key() ) - it.key();
+        }
+    }
+    return n;
+}
+
+
+bool K3b::ReadErrorMap::load( const QString& filename )
+{
+    QFile f( filename );
+    if( !f.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QTextStream s( &f );
+    bool haveRange = false;
+    long expected = 0;
+    ReadErrorMap map;
+    while( !s.atEnd() ) {
+        const QString line = s.readLine().trimmed();
+        if( line.isEmpty() || line.startsWith( QLatin1Char( '#' ) ) )
+            continue;
+
+        const QStringList fields = line.split( QLatin1Char( ' ' ), QString::SkipEmptyParts );
+        bool ok1 = false, ok2 = false;
+        if( !haveRange ) {
+            if( fields.count() != 2 )
+                return false;
+            const long first = fields[0].toLong( &ok1 );
+            const long last = fields[1].toLong( &ok2 );
+            if( !ok1 || !ok2 || first > last )
+                return false;
+            map.reset( first, last );
+            expected = first;
+            haveRange = true;
+        }
+        else {
+            if( fields.count() != 3 || fields[2].length() != 1 )
+                return false;
+            const long start = fields[0].toLong( &ok1 );
+            const long count = fields[1].toLong( &ok2 );
+            const char status = fields[2][0].toLatin1();
+            if( !ok1 || !ok2 || start != expected || count <= 0 || !isValidStatus( status ) )
+                return false;
+            map.setStatus( start, count, Status( status ) );
+            expected += count;
+        }
+    }
+
+    // the regions have to cover the whole range
+    if( !haveRange || expected != map.m_last + 1 ) {
+        qDebug() << "(K3b::ReadErrorMap) incomplete map" << filename;
+        return false;
+    }
+
+    *this = map;
+    return true;
+}
+
+
+bool K3b::ReadErrorMap::save( const QString& filename ) const
+{
+    QSaveFile f( filename );
+    if( !f.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::ReadErrorMap) could not open" << filename;
+        return false;
+    }
+
+    QTextStream s( &f );
+    s << "# K3b read error map\n"
+      << "# <first sector> <last sector>\n"
+      << m_first << ' ' << m_last << '\n'
+      << "# <first sector> <number of sectors> <status>\n";
+    for( QMap<long, char>::const_iterator it = m_regions.constBegin(); it != m_regions.constEnd(); ++it ) {
+        QMap<long, char>::const_iterator next = it + 1;
+        const long end = ( next == m_regions.constEnd() ? m_last + 1 : next.key() );
+        s << it.key() << ' ' << ( end - it.key() ) << ' ' << it.value() << '\n';
+    }
+    s.flush();
+
+    return( s.status() == QTextStream::Ok && f.commit() );
+}
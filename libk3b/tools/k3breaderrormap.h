@@ -0,0 +1,84 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_READ_ERROR_MAP_H_
+#define _K3B_READ_ERROR_MAP_H_
+
+#include "k3b_export.h"
+
+#include <QMap>
+#include <QString>
+
+namespace K3b {
+    /**
+     * Keeps track of the state of every sector while rescuing a damaged
+     * medium, similar to the mapfile of GNU ddrescue.
+     *
+     * The map is stored as a text file. After a header line with the first
+     * and last sector of the range it contains one line per region:
+     *
+     * <pre>
+     * &lt;first sector&gt; &lt;number of sectors&gt; &lt;status&gt;
+     * </pre>
+     *
+     * where the status is one of the characters of the Status enum. Lines
+     * starting with a hash are comments.
+     */
+    class LIBK3B_EXPORT ReadErrorMap
+    {
+    public:
+        enum Status {
+            NonTried = '?',   /**< Not read yet or skipped after an error. */
+            NonSplit = '*',   /**< Failed as part of a bigger read. */
+            BadSector = '-',  /**< Failed when read on its own. */
+            Finished = '+'    /**< Read successfully. */
+        };
+
+        ReadErrorMap();
+
+        /**
+         * Marks all sectors from \p firstSector to \p lastSector as not tried.
+         */
+        void reset( long firstSector, long lastSector );
+
+        bool isEmpty() const;
+        long firstSector() const { return m_first; }
+        long lastSector() const { return m_last; }
+
+        bool load( const QString& filename );
+        bool save( const QString& filename ) const;
+
+        Status status( long sector ) const;
+        void setStatus( long start, long count, Status status );
+
+        /**
+         * Searches the first region with \p status starting at or after \p from.
+         * \return false if there is none.
+         */
+        bool nextRegion( Status status, long from, long* start, long* count ) const;
+
+        /**
+         * \return the number of sectors with \p status.
+         */
+        long sectors( Status status ) const;
+
+    private:
+        // maps the first sector of each region to its status
+        QMap<long, char> m_regions;
+        long m_first;
+        long m_last;
+    };
+}
+
+#endif
@@ -14,16 +14,43 @@
 
 
 #include "k3bthroughputestimator.h"
+#include "k3bdevicetypes.h"
 
 #include <QDateTime>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <cmath>
+
+
+namespace {
+    // limit the memory used by the history. Once reached only every
+    // second sample is kept.
+    const int s_maxHistorySize = 20000;
+
+    // the number of steps used to integrate the remaining time
+    const int s_integrationSteps = 50;
+}
+
 
 class K3b::ThroughputEstimator::Private
 {
 public:
     Private()
-        : started(false) {
+        : firstData(0),
+          lastData(0),
+          lastThroughput(0),
+          smoothedThroughput(0),
+          lastRemainingTime(-1),
+          started(false),
+          totalSize(0),
+          startOffset(0),
+          timeConstant(3000),
+          haveModel(false),
+          modelA(0),
+          modelB(0) {
     }
 
     QElapsedTimer firstDataTime;
@@ -32,11 +59,165 @@ public:
     unsigned long lastData;
 
     int lastThroughput;
+    double smoothedThroughput;
+    int lastRemainingTime;
 
     bool started;
+
+    unsigned long totalSize;
+    SpeedProfile profile;
+    unsigned long startOffset;
+    int timeConstant;
+
+    QVector<Sample> history;
+
+    // linear model of the throughput over the radius: a + b*r
+    // fitted to the history
+    bool haveModel;
+    double modelA;
+    double modelB;
+
+    double radius( double pos ) const {
+        return profile.radius( startOffset + (unsigned long)pos );
+    }
+
+    void fitModel() {
+        haveModel = false;
+        if( !profile.isValid() || history.count() < 4 )
+            return;
+
+        //
+        // weighted least squares fit of the raw throughput over the radius.
+        // Every sample is weighted by the data it covers so slow phases with
+        // many short samples do not dominate.
+        //
+        double sw = 0, sr = 0, sv = 0, srr = 0, srv = 0;
+        for( int i = 1; i < history.count(); ++i ) {
+            const Sample& s = history[i];
+            if( s.throughput <= 0 )
+                continue;
+            const double w = s.data - history[i-1].data;
+            const double r = radius( 0.5*( s.data + history[i-1].data ) );
+            sw += w;
+            sr += w*r;
+            sv += w*s.throughput;
+            srr += w*r*r;
+            srv += w*r*s.throughput;
+        }
+        if( sw <= 0 )
+            return;
+
+        const double meanR = sr/sw;
+        const double varR = srr/sw - meanR*meanR;
+
+        // we need at least half a millimeter of spread to see a trend
+        if( varR < 0.25 )
+            return;
+
+        const double b = ( srv/sw - meanR*sv/sw ) / varR;
+        const double a = sv/sw - b*meanR;
+
+        // a throughput decreasing towards the outer edge is not a property
+        // of the medium but of the source. Treat it as constant.
+        if( b <= 0 )
+            return;
+
+        modelA = a;
+        modelB = b;
+        haveModel = true;
+    }
+
+    // pos and currentPos are amounts of written data as passed to dataWritten()
+    double predictedThroughput( double pos, double currentPos ) const {
+        if( !haveModel )
+            return smoothedThroughput;
+
+        const double cur = modelA + modelB*radius( currentPos );
+        const double at = modelA + modelB*radius( pos );
+        if( cur <= 0 || at <= 0 )
+            return smoothedThroughput;
+
+        // anchor the model at the current smoothed throughput
+        return smoothedThroughput * at / cur;
+    }
+
+    int remainingTime() const {
+        if( !started || totalSize == 0 || smoothedThroughput <= 0 )
+            return -1;
+
+        const double end = totalSize;
+        const double cur = lastData;
+        if( cur >= end )
+            return 0;
+
+        const double step = ( end - cur ) / s_integrationSteps;
+        double t = 0.0;
+        for( int i = 0; i < s_integrationSteps; ++i ) {
+            const double v = predictedThroughput( cur + ( i + 0.5 )*step, cur );
+            if( v <= 0 )
+                return -1;
+            t += step / v;
+        }
+        return (int)( t + 0.5 );
+    }
+
+    void addSample( const Sample& s ) {
+        if( history.count() >= s_maxHistorySize ) {
+            QVector<Sample> thinned;
+            thinned.reserve( s_maxHistorySize/2 + 1 );
+            for( int i = 0; i < history.count(); i += 2 )
+                thinned.append( history[i] );
+            history = thinned;
+        }
+        history.append( s );
+    }
 };
 
 
+K3b::ThroughputEstimator::SpeedProfile::SpeedProfile()
+    : m_innerRadius( 0 ),
+      m_outerRadius( 0 ),
+      m_capacity( 0 )
+{
+}
+
+
+K3b::ThroughputEstimator::SpeedProfile::SpeedProfile( double innerRadius, double outerRadius, unsigned long capacity )
+    : m_innerRadius( innerRadius ),
+      m_outerRadius( outerRadius ),
+      m_capacity( capacity )
+{
+}
+
+
+bool K3b::ThroughputEstimator::SpeedProfile::isValid() const
+{
+    return m_capacity > 0 && m_innerRadius > 0 && m_outerRadius > m_innerRadius;
+}
+
+
+double K3b::ThroughputEstimator::SpeedProfile::radius( unsigned long pos ) const
+{
+    if( !isValid() )
+        return 0.0;
+
+    const double f = qBound( 0.0, (double)pos / (double)m_capacity, 1.0 );
+    return std::sqrt( m_innerRadius*m_innerRadius + ( m_outerRadius*m_outerRadius - m_innerRadius*m_innerRadius )*f );
+}
+
+
+K3b::ThroughputEstimator::SpeedProfile K3b::ThroughputEstimator::SpeedProfile::forMediaType( int mediaType, unsigned long capacity )
+{
+    // radii of the program and data areas as defined by the Red Book, ECMA-267 and the BD specs
+    if( mediaType & Device::MEDIA_CD_ALL )
+        return SpeedProfile( 25.0, 58.0, capacity );
+    else if( mediaType & ( Device::MEDIA_DVD_ALL|Device::MEDIA_BD_ALL ) )
+        return SpeedProfile( 24.0, 58.0, capacity );
+    else
+        return SpeedProfile();
+}
+
+
 K3b::ThroughputEstimator::ThroughputEstimator( QObject* parent )
     : QObject( parent )
 {
@@ -60,9 +241,90 @@ int K3b::ThroughputEstimator::average() const
 }
 
 
+int K3b::ThroughputEstimator::current() const
+{
+    return (int)( d->smoothedThroughput + 0.5 );
+}
+
+
+void K3b::ThroughputEstimator::setTotalSize( unsigned long kb )
+{
+    d->totalSize = kb;
+}
+
+
+unsigned long K3b::ThroughputEstimator::totalSize() const
+{
+    return d->totalSize;
+}
+
+
+void K3b::ThroughputEstimator::setSpeedProfile( const SpeedProfile& profile, unsigned long startOffset )
+{
+    d->profile = profile;
+    d->startOffset = startOffset;
+}
+
+
+void K3b::ThroughputEstimator::setTimeConstant( int msecs )
+{
+    d->timeConstant = qMax( 1, msecs );
+}
+
+
+int K3b::ThroughputEstimator::remainingTime() const
+{
+    return d->remainingTime();
+}
+
+
+QVector<QPointF> K3b::ThroughputEstimator::speedCurve( int points ) const
+{
+    QVector<QPointF> curve;
+    if( !d->started || d->totalSize == 0 || d->smoothedThroughput <= 0 || points < 2 )
+        return curve;
+
+    const double cur = d->lastData;
+    const double end = d->totalSize;
+    curve.reserve( points );
+    for( int i = 0; i < points; ++i ) {
+        const double pos = end * i / ( points - 1 );
+        curve.append( QPointF( pos, d->predictedThroughput( pos, cur ) ) );
+    }
+    return curve;
+}
+
+
+QVector<K3b::ThroughputEstimator::Sample> K3b::ThroughputEstimator::history() const
+{
+    return d->history;
+}
+
+
+bool K3b::ThroughputEstimator::saveHistory( const QString& filename ) const
+{
+    QFile f( filename );
+    if( !f.open( QIODevice::WriteOnly|QIODevice::Truncate ) )
+        return false;
+
+    QTextStream s( &f );
+    s << "time,data,throughput,smoothed_throughput,radius" << endl;
+    Q_FOREACH( const Sample& sample, d->history ) {
+        s << sample.time << ','
+          << sample.data << ','
+          << sample.throughput << ','
+          << sample.smoothedThroughput << ','
+          << d->radius( sample.data ) << endl;
+    }
+    return s.status() == QTextStream::Ok;
+}
+
+
 void K3b::ThroughputEstimator::reset()
 {
     d->started = false;
+    d->history.clear();
+    d->haveModel = false;
 }
 
 
@@ -74,6 +336,12 @@ void K3b::ThroughputEstimator::dataWritten( unsigned long data )
         d->firstDataTime.start();
         d->lastDataTime.start();
         d->lastThroughput = 0;
+        d->smoothedThroughput = 0;
+        d->lastRemainingTime = -1;
+        d->haveModel = false;
+
+        Sample s = { 0, data, 0, 0 };
+        d->addSample( s );
     }
     else if( data > d->lastData ) {
         unsigned long diff = data - d->lastData;
@@ -84,14 +352,36 @@ void K3b::ThroughputEstimator::dataWritten( unsigned long data )
         if( msecs > 500 ) {
             d->lastData = data;
             d->lastDataTime.start();
-            int t = (int)(1000.0*(double)diff/(double)msecs);
+            const double raw = 1000.0*(double)diff/(double)msecs;
+
+            //
+            // exponentially weighted moving average. The weight depends on the
+            // time since the last measurement so irregular updates are handled
+            // properly.
+            //
+            if( d->smoothedThroughput <= 0 ) {
+                d->smoothedThroughput = raw;
+            }
+            else {
+                const double alpha = 1.0 - std::exp( -(double)msecs / (double)d->timeConstant );
+                d->smoothedThroughput += alpha*( raw - d->smoothedThroughput );
+            }
+
+            Sample s = { d->firstDataTime.elapsed(), data, (int)raw, current() };
+            d->addSample( s );
+            d->fitModel();
+
+            int t = current();
             if( t != d->lastThroughput ) {
                 d->lastThroughput = t;
                 emit throughput( t );
             }
+
+            int r = d->remainingTime();
+            if( r != d->lastRemainingTime ) {
+                d->lastRemainingTime = r;
+                emit estimatedRemainingTime( r );
+            }
         }
     }
 }
-
-
-
@@ -15,7 +15,11 @@
 #ifndef _K3B_THROUGHPUT_ESTIMATOR_H_
 #define _K3B_THROUGHPUT_ESTIMATOR_H_
 
+#include "k3b_export.h"
+
 #include <QObject>
+#include <QPointF>
+#include <QVector>
 
 
 namespace K3b {
@@ -24,23 +28,145 @@ namespace K3b {
      * speed. Just init with @p reset() then always call @p dataWritten with
      * the already written data in KB. The class will emit throughput signals
      * whenever the throughput changes.
+     *
+     * The throughput is smoothed with an exponentially weighted moving average
+     * whose weight depends on the time between two measurements. This keeps
+     * the displayed speed from jumping around with drives that constantly
+     * adjust their speed.
+     *
+     * If the total size is known the estimator also predicts the remaining time.
+     * Given a speed profile of the medium the prediction takes into account that
+     * CAV and zoned CLV drives get faster towards the outer edge of the medium.
      */
-    class ThroughputEstimator : public QObject
+    class LIBK3B_EXPORT ThroughputEstimator : public QObject
     {
         Q_OBJECT
 
     public:
+        /**
+         * Describes the geometry of the recordable area of a medium. The data
+         * is written from the inner to the outer radius with constant density,
+         * thus the radius grows with the square root of the written data.
+         */
+        class LIBK3B_EXPORT SpeedProfile
+        {
+        public:
+            /**
+             * Creates an invalid profile. The speed is assumed to
+             * be independent from the position on the medium.
+             */
+            SpeedProfile();
+
+            /**
+             * \param innerRadius The radius in mm at which the recordable area starts.
+             * \param outerRadius The radius in mm at which the recordable area ends.
+             * \param capacity The capacity of the medium in KB.
+             */
+            SpeedProfile( double innerRadius, double outerRadius, unsigned long capacity );
+
+            bool isValid() const;
+
+            /**
+             * The radius in mm at which the data at @p pos KB is written.
+             */
+            double radius( unsigned long pos ) const;
+
+            double innerRadius() const { return m_innerRadius; }
+            double outerRadius() const { return m_outerRadius; }
+            unsigned long capacity() const { return m_capacity; }
+
+            /**
+             * The profile of a medium of type @p mediaType (a Device::MediaType)
+             * with a capacity of @p capacity KB.
+             */
+            static SpeedProfile forMediaType( int mediaType, unsigned long capacity );
+
+        private:
+            double m_innerRadius;
+            double m_outerRadius;
+            unsigned long m_capacity;
+        };
+
+        /**
+         * One measurement.
+         */
+        struct Sample {
+            qint64 time;              ///< msecs since the first measurement
+            unsigned long data;       ///< written KB
+            int throughput;           ///< KB/s since the previous sample
+            int smoothedThroughput;   ///< KB/s
+        };
+
         explicit ThroughputEstimator( QObject* parent = 0 );
         ~ThroughputEstimator() override;
 
+        /**
+         * The average throughput since the first measurement.
+         */
         int average() const;
 
+        /**
+         * The current smoothed throughput in KB/s.
+         */
+        int current() const;
+
+        /**
+         * The total amount of data in KB. Needed for the remaining time.
+         */
+        void setTotalSize( unsigned long kb );
+        unsigned long totalSize() const;
+
+        /**
+         * Set the speed profile of the medium.
+         *
+         * \param startOffset The position on the medium in KB at which
+         *        writing starts. Used when appending to a medium.
+         */
+        void setSpeedProfile( const SpeedProfile& profile, unsigned long startOffset = 0 );
+
+        /**
+         * The time constant in milliseconds used for smoothing the throughput.
+         * Larger values make the estimate steadier but slower to react.
+         * Defaults to 3000.
+         */
+        void setTimeConstant( int msecs );
+
+        /**
+         * The predicted remaining time in seconds or -1 if it cannot be
+         * predicted yet.
+         */
+        int remainingTime() const;
+
+        /**
+         * The predicted throughput over the whole data. The x values are
+         * positions in KB, the y values the predicted throughput in KB/s.
+         *
+         * Empty if the total size is unknown or no data has been written yet.
+         */
+        QVector<QPointF> speedCurve( int points = 100 ) const;
+
+        /**
+         * All measurements since the last reset.
+         */
+        QVector<Sample> history() const;
+
+        /**
+         * Saves the history as comma separated values for later analysis.
+         */
+        bool saveHistory( const QString& filename ) const;
+
     Q_SIGNALS:
         /**
          * kb/s if differs from previous
          */
         void throughput( int );
 
+        /**
+         * Emitted with the predicted remaining time in seconds
+         * whenever it changes.
+         */
+        void estimatedRemainingTime( int );
+
     public Q_SLOTS:
         void reset();
 
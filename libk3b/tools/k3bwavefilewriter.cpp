@@ -94,14 +94,14 @@ void K3b::WaveFileWriter::write( const char* data, int len, Endianess e )
             }
 
             // we need to swap the bytes
-            char* buffer = new char[len];
+            if( m_swapBuffer.size() < len )
+                m_swapBuffer.resize( len );
+            char* buffer = m_swapBuffer.data();
             for( int i = 0; i < len-1; i+=2 ) {
                 buffer[i] = data[i+1];
                 buffer[i+1] = data[i];
             }
             m_outputStream.writeRawData( buffer, len );
-
-            delete [] buffer;
         }
     }
 }
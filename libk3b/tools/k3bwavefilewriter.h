@@ -18,6 +18,7 @@
 
 #include "k3b_export.h"
 
+#include <QByteArray>
 #include <QDataStream>
 #include <QFile>
 #include <QString>
@@ -75,6 +76,9 @@ namespace K3b {
         QFile m_outputFile;
         QDataStream m_outputStream;
         QString m_filename;
+
+        // reused for swapping the bytes of big endian data
+        QByteArray m_swapBuffer;
     };
 }
 
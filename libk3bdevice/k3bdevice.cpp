@@ -21,6 +21,7 @@
 #include "k3bmmc.h"
 #include "k3bscsicommand.h"
 #include "k3bcrc.h"
+#include "k3bdevicecapabilitycache_p.h"
 
 #include "config-k3b.h"
 
@@ -124,7 +125,8 @@ public:
         : supportedProfiles(0),
           deviceHandle(HANDLE_DEFAULT_VALUE),
           openedReadWrite(false),
-          burnfree(false) {
+          burnfree(false),
+          capabilitiesCached(false) {
     }
 
     Solid::Device solidDevice;
@@ -132,6 +134,7 @@ public:
     QString vendor;
     QString description;
     QString version;
+    QString serialNumber;
     int maxReadSpeed;
     int maxWriteSpeed;
     int currentWriteSpeed;
@@ -152,6 +155,10 @@ public:
     bool openedReadWrite;
     bool burnfree;
 
+    // the capabilities as probed or restored from the cache by init()
+    bool capabilitiesCached;
+    Capabilities initCapabilities;
+
     QMutex mutex;
     QMutex openCloseMutex;
 };
@@ -362,7 +369,7 @@ Solid::StorageAccess* K3b::Device::Device::solidStorage() const
 }
 
 
-bool K3b::Device::Device::init( bool bCheckWritingModes )
+bool K3b::Device::Device::init( bool bCheckWritingModes, bool useCapabilityCache )
 {
     qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": init()";
 
@@ -404,6 +411,27 @@ bool K3b::Device::Device::init( bool bCheckWritingModes )
     if( d->description.isEmpty() )
         d->description = "UNKNOWN";
 
+    d->serialNumber = readSerialNumber();
+
+    //
+    // Known drives come up without probing all their features. The cache key contains
+    // the firmware revision. The DeviceManager revalidates the cached capabilities in
+    // the background once the drive is about to be used for writing.
+    //
+    const QString cacheKey = CapabilityCache::key( d->vendor, d->description, d->version, d->serialNumber );
+    Capabilities caps;
+    d->capabilitiesCached = false;
+    if( useCapabilityCache &&
+        CapabilityCache::lookup( cacheKey, caps ) &&
+        ( caps.writingModesChecked || !bCheckWritingModes ) ) {
+        qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": using cached capabilities.";
+        setCapabilities( caps );
+        d->capabilitiesCached = true;
+        d->initCapabilities = caps;
+        close();
+        return furtherInit();
+    }
+
     //
     // We probe all features of the device. Since not all devices support the GET CONFIGURATION command
     // we also query the mode page 2A and use the cdrom.h stuff to get as much information as possible
@@ -442,12 +470,105 @@ bool K3b::Device::Device::init( bool bCheckWritingModes )
     //
     d->readCapabilities |= d->writeCapabilities;
 
+    caps = capabilities();
+    caps.writingModesChecked = bCheckWritingModes;
+    CapabilityCache::store( cacheKey, caps );
+    d->initCapabilities = caps;
+
     close();
 
     return furtherInit();
 }
 
 
+QString K3b::Device::Device::readSerialNumber() const
+{
+    unsigned char buf[255];
+    ::memset( buf, 0, sizeof(buf) );
+    ScsiCommand cmd( this );
+    cmd[0] = MMC_INQUIRY;
+    cmd[1] = 0x1;  // EVPD
+    cmd[2] = 0x80; // Unit Serial Number page
+    cmd[4] = sizeof(buf);
+    cmd[5] = 0;
+    if( cmd.transport( TR_DIR_READ, buf, sizeof(buf) ) || buf[1] != 0x80 )
+        return QString();
+
+    const int len = qMin<int>( buf[3], sizeof(buf) - 4 );
+    return QString::fromLatin1( (char*)&buf[4], len ).trimmed();
+}
+
+
+K3b::Device::Capabilities K3b::Device::Device::capabilities() const
+{
+    Capabilities caps;
+    caps.readCapabilities = d->readCapabilities;
+    caps.writeCapabilities = d->writeCapabilities;
+    caps.supportedProfiles = d->supportedProfiles;
+    caps.writingModes = d->writeModes;
+    caps.maxReadSpeed = d->maxReadSpeed;
+    caps.maxWriteSpeed = d->maxWriteSpeed;
+    caps.bufferSize = d->bufferSize;
+    caps.dvdMinusTestwrite = d->dvdMinusTestwrite;
+    caps.burnfree = d->burnfree;
+    return caps;
+}
+
+
+void K3b::Device::Device::setCapabilities( const Capabilities& caps )
+{
+    d->readCapabilities = caps.readCapabilities;
+    d->writeCapabilities = caps.writeCapabilities;
+    d->supportedProfiles = caps.supportedProfiles;
+    d->writeModes = caps.writingModes;
+    d->maxReadSpeed = caps.maxReadSpeed;
+    d->maxWriteSpeed = caps.maxWriteSpeed;
+    d->bufferSize = caps.bufferSize;
+    d->dvdMinusTestwrite = caps.dvdMinusTestwrite;
+    d->burnfree = caps.burnfree;
+}
+
+
+bool K3b::Device::Device::capabilitiesCached() const
+{
+    return d->capabilitiesCached;
+}
+
+
+bool K3b::Device::Device::revalidateCapabilities( const Device& probe )
+{
+    if( !d->capabilitiesCached )
+        return false;
+    d->capabilitiesCached = false;
+
+    Capabilities initCaps = probe.d->initCapabilities;
+    Capabilities caps = probe.capabilities();
+
+    // a probe without the writing mode check keeps the cached results of that check
+    if( !initCaps.writingModesChecked && d->initCapabilities.writingModesChecked ) {
+        const WritingModes checkedModes = d->initCapabilities.writingModes &
+                                          ( WRITINGMODE_TAO|WRITINGMODE_SAO|WRITINGMODE_SAO_R96P|WRITINGMODE_SAO_R96R|
+                                            WRITINGMODE_RAW|WRITINGMODE_RAW_R16|WRITINGMODE_RAW_R96P|WRITINGMODE_RAW_R96R );
+        initCaps.writingModes |= checkedModes;
+        caps.writingModes |= checkedModes;
+        if( checkedModes & WRITINGMODE_TAO ) {
+            initCaps.writeCapabilities |= MEDIA_CD_R;
+            caps.writeCapabilities |= MEDIA_CD_R;
+        }
+    }
+    initCaps.writingModesChecked = caps.writingModesChecked = d->initCapabilities.writingModesChecked;
+
+    // keep the speeds which have been changed in the meantime if the drive is unchanged
+    if( initCaps == d->initCapabilities )
+        return false;
+
+    qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": cached capabilities are outdated.";
+    setCapabilities( caps );
+    d->initCapabilities = initCaps;
+    return true;
+}
+
+
 bool K3b::Device::Device::furtherInit()
 {
 #ifdef Q_OS_LINUX
@@ -47,6 +47,7 @@ namespace K3b {
     namespace Device
     {
         class Toc;
+        class Capabilities;
 
         typedef QVarLengthArray< unsigned char > UByteArray;
 
@@ -725,8 +726,34 @@ namespace K3b {
              *
              * @param checkWritingModes if true the CD writing modes will be checked using
              *                          MMC_MODE_SELECT.
+             * @param useCapabilityCache if true the capabilities of a known drive are taken
+             *                           from the CapabilityCache instead of probing them.
              */
-            bool init( bool checkWritingModes = true );
+            bool init( bool checkWritingModes = true, bool useCapabilityCache = true );
+
+            /**
+             * Reads the unit serial number vital product data page.
+             * Not all drives provide it.
+             */
+            QString readSerialNumber() const;
+
+            Capabilities capabilities() const;
+            void setCapabilities( const Capabilities& caps );
+
+            /**
+             * \return true if the capabilities have been taken from the cache
+             *         and have not been revalidated yet.
+             */
+            bool capabilitiesCached() const;
+
+            /**
+             * Takes over the capabilities of a device which has been probed
+             * with the same drive to revalidate the cached capabilities. The
+             * cached writing modes are kept if the probe did not check them.
+             *
+             * \return true if the capabilities changed.
+             */
+            bool revalidateCapabilities( const Device& probe );
 
             void searchIndexTransitions( long start, long end, K3b::Device::Track& track ) const;
             void checkWritingModes();
@@ -0,0 +1,183 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdevicecapabilitycache_p.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+
+// QDataStream operators for QHash need to be found by argument-dependent lookup
+namespace K3b {
+    namespace Device {
+        static QDataStream& operator<<( QDataStream& s, const Capabilities& caps )
+        {
+            return s << caps.writingModesChecked
+                     << quint32( caps.readCapabilities )
+                     << quint32( caps.writeCapabilities )
+                     << quint32( caps.supportedProfiles )
+                     << quint32( caps.writingModes )
+                     << qint32( caps.maxReadSpeed )
+                     << qint32( caps.maxWriteSpeed )
+                     << qint32( caps.bufferSize )
+                     << caps.dvdMinusTestwrite
+                     << caps.burnfree;
+        }
+
+        static QDataStream& operator>>( QDataStream& s, Capabilities& caps )
+        {
+            quint32 readCaps = 0, writeCaps = 0, profiles = 0, modes = 0;
+            qint32 maxReadSpeed = 0, maxWriteSpeed = 0, bufferSize = 0;
+            s >> caps.writingModesChecked
+              >> readCaps
+              >> writeCaps
+              >> profiles
+              >> modes
+              >> maxReadSpeed
+              >> maxWriteSpeed
+              >> bufferSize
+              >> caps.dvdMinusTestwrite
+              >> caps.burnfree;
+            caps.readCapabilities = MediaTypes( readCaps );
+            caps.writeCapabilities = MediaTypes( writeCaps );
+            caps.supportedProfiles = MediaTypes( profiles );
+            caps.writingModes = WritingModes( modes );
+            caps.maxReadSpeed = maxReadSpeed;
+            caps.maxWriteSpeed = maxWriteSpeed;
+            caps.bufferSize = bufferSize;
+            return s;
+        }
+    }
+}
+
+
+namespace {
+    const quint32 s_magic = 0x4B334443; // "K3DC"
+    const quint16 s_version = 1;
+
+    // the devices are initialized in parallel
+    Q_GLOBAL_STATIC( QMutex, s_mutex )
+
+    QString cacheFileName()
+    {
+        return QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + QLatin1String( "/devicecapabilities" );
+    }
+
+    QHash<QString, K3b::Device::Capabilities> load()
+    {
+        QHash<QString, K3b::Device::Capabilities> entries;
+
+        QFile f( cacheFileName() );
+        if( !f.open( QIODevice::ReadOnly ) )
+            return entries;
+
+        QDataStream s( &f );
+        quint32 magic = 0;
+        quint16 version = 0;
+        s >> magic >> version;
+        if( magic != s_magic || version != s_version ) {
+            qDebug() << "(K3b::Device::CapabilityCache) ignoring incompatible cache" << f.fileName();
+            return entries;
+        }
+
+        s >> entries;
+        if( s.status() != QDataStream::Ok )
+            entries.clear();
+        return entries;
+    }
+}
+
+
+K3b::Device::Capabilities::Capabilities()
+    : writingModesChecked( false ),
+      maxReadSpeed( 0 ),
+      maxWriteSpeed( 0 ),
+      bufferSize( 0 ),
+      dvdMinusTestwrite( true ),
+      burnfree( false )
+{
+}
+
+
+bool K3b::Device::Capabilities::operator==( const Capabilities& other ) const
+{
+    return( writingModesChecked == other.writingModesChecked &&
+            readCapabilities == other.readCapabilities &&
+            writeCapabilities == other.writeCapabilities &&
+            supportedProfiles == other.supportedProfiles &&
+            writingModes == other.writingModes &&
+            maxReadSpeed == other.maxReadSpeed &&
+            maxWriteSpeed == other.maxWriteSpeed &&
+            bufferSize == other.bufferSize &&
+            dvdMinusTestwrite == other.dvdMinusTestwrite &&
+            burnfree == other.burnfree );
+}
+
+
+QString K3b::Device::CapabilityCache::key( const QString& vendor,
+                                           const QString& description,
+                                           const QString& version,
+                                           const QString& serialNumber )
+{
+    return ( QStringList() << vendor << description << version << serialNumber ).join( QLatin1Char( '\n' ) );
+}
+
+
+bool K3b::Device::CapabilityCache::lookup( const QString& key, Capabilities& caps )
+{
+    QMutexLocker locker( s_mutex() );
+
+    const QHash<QString, Capabilities> entries = load();
+    QHash<QString, Capabilities>::const_iterator it = entries.constFind( key );
+    if( it == entries.constEnd() )
+        return false;
+
+    caps = it.value();
+    return true;
+}
+
+
+void K3b::Device::CapabilityCache::store( const QString& key, const Capabilities& caps )
+{
+    QMutexLocker locker( s_mutex() );
+
+    QHash<QString, Capabilities> entries = load();
+    QHash<QString, Capabilities>::const_iterator it = entries.constFind( key );
+    if( it != entries.constEnd() && it.value() == caps )
+        return;
+    entries.insert( key, caps );
+
+    const QString dir = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+    if( dir.isEmpty() || !QDir().mkpath( dir ) )
+        return;
+
+    QSaveFile f( cacheFileName() );
+    if( !f.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::Device::CapabilityCache) could not open" << f.fileName();
+        return;
+    }
+
+    QDataStream s( &f );
+    s << s_magic << s_version << entries;
+    if( s.status() != QDataStream::Ok || !f.commit() )
+        qDebug() << "(K3b::Device::CapabilityCache) could not write" << f.fileName();
+}
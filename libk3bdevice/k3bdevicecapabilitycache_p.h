@@ -0,0 +1,72 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_DEVICE_CAPABILITY_CACHE_P_H_
+#define _K3B_DEVICE_CAPABILITY_CACHE_P_H_
+
+#include "k3bdevicetypes.h"
+
+#include <QString>
+
+namespace K3b {
+    namespace Device {
+        /**
+         * The capabilities of a drive as determined by Device::init().
+         */
+        class Capabilities
+        {
+        public:
+            Capabilities();
+
+            bool operator==( const Capabilities& other ) const;
+            bool operator!=( const Capabilities& other ) const { return !operator==( other ); }
+
+            /**
+             * false if the writing modes have not been probed.
+             */
+            bool writingModesChecked;
+
+            MediaTypes readCapabilities;
+            MediaTypes writeCapabilities;
+            MediaTypes supportedProfiles;
+            WritingModes writingModes;
+            int maxReadSpeed;
+            int maxWriteSpeed;
+            int bufferSize;
+            bool dvdMinusTestwrite;
+            bool burnfree;
+        };
+
+
+        /**
+         * Stores the capabilities of all drives ever seen in the cache
+         * location. The drives are identified by vendor, model, firmware
+         * version, and serial number, so a firmware update results in
+         * probing the drive again.
+         */
+        class CapabilityCache
+        {
+        public:
+            static QString key( const QString& vendor,
+                                const QString& description,
+                                const QString& version,
+                                const QString& serialNumber );
+
+            static bool lookup( const QString& key, Capabilities& caps );
+            static void store( const QString& key, const Capabilities& caps );
+        };
+    }
+}
+
+#endif
@@ -34,12 +34,14 @@
 #endif
 
 #include <QDebug>
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <QFile>
 #include <QFileInfo>
 #include <QRegExp>
 #include <QTemporaryFile>
+#include <QThread>
 
 #include <iostream>
 #include <limits.h>
@@ -113,6 +115,13 @@ typedef unsigned char u8;
 class K3b::Device::DeviceManager::Private
 {
 public:
+    class InitThread;
+    class RevalidationThread;
+
+    void addToLists( Device* device );
+    void removeFromLists( Device* device );
+    void cancelRevalidation( Device* device );
+
     QList<Device*> allDevices;
     QList<Device*> cdReader;
     QList<Device*> cdWriter;
@@ -122,9 +131,122 @@ public:
     QList<Device*> bdWriter;
 
     bool checkWritingModes;
+
+    // the devices initialized by scanBus() which have not been added yet by udi,
+    // 0 if the initialization failed
+    QHash<QString, Device*> initializedDevices;
+
+    QList<RevalidationThread*> revalidationThreads;
+};
+
+
+/**
+ * Initializes one device. Every drive gets its own thread since most
+ * of the time is spent waiting for the drive.
+ */
+class K3b::Device::DeviceManager::Private::InitThread : public QThread
+{
+public:
+    explicit InitThread( Device* device )
+        : m_device( device ),
+          m_success( false ) {
+    }
+
+    Device* device() const { return m_device; }
+    bool success() const { return m_success; }
+
+protected:
+    void run() override {
+        m_success = m_device->init();
+    }
+
+private:
+    Device* m_device;
+    bool m_success;
 };
 
 
+/**
+ * Probes a drive whose capabilities have been taken from the cache
+ * through a second Device object. The writing modes are not checked
+ * since that changes the write parameters of the drive. Thus, only
+ * reading commands are sent and the device does not need to be locked.
+ */
+class K3b::Device::DeviceManager::Private::RevalidationThread : public QThread
+{
+public:
+    explicit RevalidationThread( Device* device, Device* probe )
+        : m_device( device ),
+          m_probe( probe ),
+          m_success( false ) {
+    }
+
+    ~RevalidationThread() override {
+        delete m_probe;
+    }
+
+    Device* device() const { return m_device; }
+    Device* probe() const { return m_probe; }
+    bool success() const { return m_success; }
+
+protected:
+    void run() override {
+        m_success = m_probe->init( false, false );
+    }
+
+private:
+    Device* m_device;
+    Device* m_probe;
+    bool m_success;
+};
+
+
+void K3b::Device::DeviceManager::Private::addToLists( Device* device )
+{
+    // not every drive is able to read CDs
+    // there are some 1st generation DVD writer that cannot
+    if( device->type() & K3b::Device::DEVICE_CD_ROM )
+        cdReader.append( device );
+    if( device->readsDvd() )
+        dvdReader.append( device );
+    if( device->writesCd() )
+        cdWriter.append( device );
+    if( device->writesDvd() )
+        dvdWriter.append( device );
+    if( device->readCapabilities() & MEDIA_BD_ALL )
+        bdReader.append( device );
+    if( device->writeCapabilities() & MEDIA_BD_ALL )
+        bdWriter.append( device );
+}
+
+
+void K3b::Device::DeviceManager::Private::removeFromLists( Device* device )
+{
+    cdReader.removeAll( device );
+    dvdReader.removeAll( device );
+    bdReader.removeAll( device );
+    cdWriter.removeAll( device );
+    dvdWriter.removeAll( device );
+    bdWriter.removeAll( device );
+}
+
+
+void K3b::Device::DeviceManager::Private::cancelRevalidation( Device* device )
+{
+    QList<RevalidationThread*>::iterator it = revalidationThreads.begin();
+    while( it != revalidationThreads.end() ) {
+        RevalidationThread* thread = *it;
+        if( device && thread->device() != device ) {
+            ++it;
+            continue;
+        }
+        thread->wait();
+        delete thread;
+        it = revalidationThreads.erase( it );
+    }
+}
+
+
 
 K3b::Device::DeviceManager::DeviceManager( QObject* parent )
     : QObject( parent ),
@@ -139,6 +261,7 @@ K3b::Device::DeviceManager::DeviceManager( QObject* parent )
 
 K3b::Device::DeviceManager::~DeviceManager()
 {
+    d->cancelRevalidation( 0 );
     qDeleteAll( d->allDevices );
     delete d;
 }
@@ -235,12 +358,42 @@ int K3b::Device::DeviceManager::scanBus()
     int cnt = 0;
 
     QList<Solid::Device> dl = Solid::Device::listFromType( Solid::DeviceInterface::OpticalDrive );
+
+    //
+    // Initialize all new devices in parallel. The initialized devices are
+    // picked up by addDevice().
+    //
+    QList<Private::InitThread*> threads;
+    Q_FOREACH( const Solid::Device& solidDev, dl ) {
+        if( solidDev.is<Solid::OpticalDrive>() && solidDev.is<Solid::Block>() && !findDeviceByUdi( solidDev.udi() ) ) {
+            Private::InitThread* thread = new Private::InitThread( new K3b::Device::Device( solidDev ) );
+            threads.append( thread );
+            thread->start();
+        }
+    }
+    Q_FOREACH( Private::InitThread* thread, threads ) {
+        thread->wait();
+        if( thread->success() ) {
+            d->initializedDevices.insert( thread->device()->solidDevice().udi(), thread->device() );
+        }
+        else {
+            qDebug() << "Could not initialize device " << thread->device()->blockDeviceName();
+            d->initializedDevices.insert( thread->device()->solidDevice().udi(), 0 );
+            delete thread->device();
+        }
+    }
+    qDeleteAll( threads );
+
     Q_FOREACH( const Solid::Device& solidDev, dl ) {
         if ( checkDevice( solidDev ) ) {
             ++cnt;
         }
     }
 
+    // in case a derived class did not add all devices
+    qDeleteAll( d->initializedDevices );
+    d->initializedDevices.clear();
+
     return cnt;
 }
 
@@ -277,6 +430,8 @@ void K3b::Device::DeviceManager::printDevices()
 
 void K3b::Device::DeviceManager::clear()
 {
+    d->cancelRevalidation( 0 );
+
     // clear current devices
     d->cdReader.clear();
     d->cdWriter.clear();
@@ -362,7 +517,23 @@ K3b::Device::Device* K3b::Device::DeviceManager::addDevice( const Solid::Device&
 #else
         if( !findDevice( solidDevice.as<Solid::GenericInterface>()->propertyExists("block.netbsd.raw_device") ? solidDevice.as<Solid::GenericInterface>()->property("block.netbsd.raw_device").toString() : blockDevice->device() ) )
 #endif
-            return addDevice( new K3b::Device::Device( solidDevice ) );
+        {
+            // scanBus() already initialized the device
+            QHash<QString, Device*>::iterator it = d->initializedDevices.find( solidDevice.udi() );
+            if( it != d->initializedDevices.end() ) {
+                Device* device = it.value();
+                d->initializedDevices.erase( it );
+                return device ? addDevice( device ) : 0;
+            }
+
+            Device* device = new K3b::Device::Device( solidDevice );
+            if( !device->init() ) {
+                qDebug() << "Could not initialize device " << device->blockDeviceName();
+                delete device;
+                return 0;
+            }
+            return addDevice( device );
+        }
         else
             qDebug() << "(K3b::Device::DeviceManager) dev " << blockDevice->device()  << " already found";
     }
@@ -372,31 +543,9 @@ K3b::Device::Device* K3b::Device::DeviceManager::addDevice( const Solid::Device&
 
 K3b::Device::Device* K3b::Device::DeviceManager::addDevice( K3b::Device::Device* device )
 {
-    const QString devicename = device->blockDeviceName();
-
-    if( !device->init() ) {
-        qDebug() << "Could not initialize device " << devicename;
-        delete device;
-        return 0;
-    }
-
     if( device ) {
         d->allDevices.append( device );
-
-        // not every drive is able to read CDs
-        // there are some 1st generation DVD writer that cannot
-        if( device->type() & K3b::Device::DEVICE_CD_ROM )
-            d->cdReader.append( device );
-        if( device->readsDvd() )
-            d->dvdReader.append( device );
-        if( device->writesCd() )
-            d->cdWriter.append( device );
-        if( device->writesDvd() )
-            d->dvdWriter.append( device );
-        if( device->readCapabilities() & MEDIA_BD_ALL )
-            d->bdReader.append( device );
-        if( device->writeCapabilities() & MEDIA_BD_ALL )
-            d->bdWriter.append( device );
+        d->addToLists( device );
 
         if( device->writesCd() ) {
             // default to max write speed
@@ -414,16 +563,29 @@ K3b::Device::Device* K3b::Device::DeviceManager::addDevice( K3b::Device::Device*
 }
 
 
+void K3b::Device::DeviceManager::revalidateCapabilities( Device* dev )
+{
+    if( !dev || !dev->capabilitiesCached() || !d->allDevices.contains( dev ) )
+        return;
+
+    Q_FOREACH( Private::RevalidationThread* thread, d->revalidationThreads ) {
+        if( thread->device() == dev )
+            return;
+    }
+
+    Private::RevalidationThread* thread = new Private::RevalidationThread( dev, new K3b::Device::Device( dev->solidDevice() ) );
+    connect( thread, SIGNAL(finished()), this, SLOT(slotRevalidationFinished()) );
+    d->revalidationThreads.append( thread );
+    thread->start( QThread::LowPriority );
+}
+
+
 void K3b::Device::DeviceManager::removeDevice( const Solid::Device& dev )
 {
     if( const Solid::Block* blockDevice = dev.as<Solid::Block>() ) {
         if( Device* device = findDevice( blockDevice->device() ) ) {
-            d->cdReader.removeAll( device );
-            d->dvdReader.removeAll( device );
-            d->bdReader.removeAll( device );
-            d->cdWriter.removeAll( device );
-            d->dvdWriter.removeAll( device );
-            d->bdWriter.removeAll( device );
+            d->cancelRevalidation( device );
+            d->removeFromLists( device );
             d->allDevices.removeAll( device );
 
             emit changed( this );
@@ -442,6 +604,37 @@ void K3b::Device::DeviceManager::slotSolidDeviceAdded( const QString& udi )
 }
 
 
+void K3b::Device::DeviceManager::slotRevalidationFinished()
+{
+    bool updated = false;
+
+    QList<Private::RevalidationThread*>::iterator it = d->revalidationThreads.begin();
+    while( it != d->revalidationThreads.end() ) {
+        Private::RevalidationThread* thread = *it;
+        if( !thread->isFinished() ) {
+            ++it;
+            continue;
+        }
+        it = d->revalidationThreads.erase( it );
+
+        Device* device = thread->device();
+        if( thread->success() && device->revalidateCapabilities( *thread->probe() ) ) {
+            d->removeFromLists( device );
+            d->addToLists( device );
+            if( device->writesCd() )
+                device->setCurrentWriteSpeed( device->maxWriteSpeed() );
+            updated = true;
+        }
+        delete thread;
+    }
+
+    if( updated ) {
+        emit changed( this );
+        emit changed();
+    }
+}
+
+
 void K3b::Device::DeviceManager::slotSolidDeviceRemoved( const QString& udi )
 {
     qDebug() << udi;
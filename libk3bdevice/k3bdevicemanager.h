@@ -164,6 +164,18 @@ namespace K3b {
 
             virtual bool saveConfig( KConfigGroup );
 
+            /**
+             * Checks the capabilities of @p dev in the background if they have
+             * been taken from the capability cache. changed() is emitted if they
+             * turn out to be outdated. Nothing happens if the capabilities have
+             * been probed or checked before.
+             *
+             * A firmware update already results in a full probe of the drive, so
+             * this only needs to be called once the drive is about to be used for
+             * writing.
+             */
+            void revalidateCapabilities( Device* dev );
+
 
         public Q_SLOTS:
             /**
@@ -194,6 +206,7 @@ namespace K3b {
             K3b::Device::Device* checkDevice( const Solid::Device& dev );
             void slotSolidDeviceAdded( const QString& );
             void slotSolidDeviceRemoved( const QString& );
+            void slotRevalidationFinished();
 
         protected:
             /**
@@ -215,7 +228,7 @@ namespace K3b {
             Private* const d;
 
             /**
-             * Add a device to the managers device lists and initialize the device.
+             * Add an initialized device to the managers device lists.
              */
             Device *addDevice( Device* );
         };
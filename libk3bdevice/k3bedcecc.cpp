@@ -0,0 +1,303 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bedcecc.h"
+
+#include <string.h>
+
+
+namespace {
+    // sector layout as defined in ECMA-130
+    const int s_headerOffset = 12;
+    const int s_modeOffset = 15;
+    const int s_subheaderOffset = 16;
+    const int s_mode1EdcOffset = 0x810;
+    const int s_form1EdcOffset = 0x818;
+    const int s_form2EdcOffset = 0x92C;
+    const int s_pParityOffset = 0x81C;
+    const int s_qParityOffset = 0x8C8;
+    const int s_pParitySize = 172;
+    const int s_qParitySize = 104;
+
+    const unsigned char s_sync[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+    struct Tables {
+        Tables() {
+            for( quint32 i = 0; i < 256; ++i ) {
+                quint32 edc = i;
+                for( int k = 0; k < 8; ++k )
+                    edc = ( edc >> 1 ) ^ ( ( edc & 1 ) ? 0xD8018001U : 0 );
+                edcTable[0][i] = edc;
+
+                // multiplication by alpha in GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1
+                const unsigned char j = ( i << 1 ) ^ ( ( i & 0x80 ) ? 0x1D : 0 );
+                eccForward[i] = j;
+                eccBackward[i ^ j] = i;
+            }
+
+            // tables for processing eight bytes at a time
+            for( int k = 1; k < 8; ++k ) {
+                for( int i = 0; i < 256; ++i )
+                    edcTable[k][i] = ( edcTable[k-1][i] >> 8 ) ^ edcTable[0][edcTable[k-1][i] & 0xFF];
+            }
+
+            // the scrambler is a 15 bit shift register with the polynomial x^15 + x + 1
+            quint32 reg = 1;
+            for( int i = 0; i < K3b::Device::RAW_SECTOR_SIZE - s_headerOffset; ++i ) {
+                unsigned char byte = 0;
+                for( int bit = 0; bit < 8; ++bit ) {
+                    byte |= ( reg & 1 ) << bit;
+                    const quint32 feedback = ( reg ^ ( reg >> 1 ) ) & 1;
+                    reg = ( reg >> 1 ) | ( feedback << 14 );
+                }
+                scrambler[i] = byte;
+            }
+        }
+
+        quint32 edcTable[8][256];
+        unsigned char eccForward[256];
+        unsigned char eccBackward[256];
+        unsigned char scrambler[K3b::Device::RAW_SECTOR_SIZE - s_headerOffset];
+    };
+
+    const Tables s_tables;
+
+
+    inline quint32 readLE32( const unsigned char* p )
+    {
+        return quint32( p[0] ) | ( quint32( p[1] ) << 8 ) | ( quint32( p[2] ) << 16 ) | ( quint32( p[3] ) << 24 );
+    }
+
+
+    inline void writeLE32( unsigned char* p, quint32 v )
+    {
+        p[0] = v & 0xFF;
+        p[1] = ( v >> 8 ) & 0xFF;
+        p[2] = ( v >> 16 ) & 0xFF;
+        p[3] = ( v >> 24 ) & 0xFF;
+    }
+
+
+    /**
+     * Calculates one set of Reed-Solomon product code parity bytes. The P
+     * parity uses 86 columns of 24 bytes, the Q parity 52 diagonals of 43 bytes.
+     * \p src points to the header of the sector.
+     */
+    void computeParity( const unsigned char* src, int majorCount, int minorCount,
+                        int majorMult, int minorInc, unsigned char* dest )
+    {
+        const int size = majorCount * minorCount;
+        for( int major = 0; major < majorCount; ++major ) {
+            int index = ( major >> 1 ) * majorMult + ( major & 1 );
+            unsigned char a = 0;
+            unsigned char b = 0;
+            for( int minor = 0; minor < minorCount; ++minor ) {
+                const unsigned char t = src[index];
+                index += minorInc;
+                if( index >= size )
+                    index -= size;
+                a ^= t;
+                b ^= t;
+                a = s_tables.eccForward[a];
+            }
+            a = s_tables.eccBackward[s_tables.eccForward[a] ^ b];
+            dest[major] = a;
+            dest[major + majorCount] = a ^ b;
+        }
+    }
+
+
+    void computePParity( const unsigned char* src, unsigned char* dest )
+    {
+        computeParity( src, 86, 24, 2, 86, dest );
+    }
+
+
+    void computeQParity( const unsigned char* src, unsigned char* dest )
+    {
+        computeParity( src, 52, 43, 86, 88, dest );
+    }
+
+
+    // the part of the sector covered by the Q parity, from the header up to the Q parity
+    const int s_eccBlockSize = s_qParityOffset - s_headerOffset;
+
+
+    /**
+     * Mode 2 sectors are protected as if their header were zero so the
+     * parity does not depend on the address. For those the covered bytes are
+     * copied to \p buffer first.
+     */
+    const unsigned char* eccSource( const unsigned char* sector, K3b::Device::Track::DataMode mode, unsigned char* buffer )
+    {
+        if( mode == K3b::Device::Track::MODE1 )
+            return sector + s_headerOffset;
+
+        ::memcpy( buffer, sector + s_headerOffset, s_eccBlockSize );
+        ::memset( buffer, 0, 4 );
+        return buffer;
+    }
+}
+
+
+quint32 K3b::Device::calcEdc( const unsigned char* data, unsigned int len, quint32 edc )
+{
+    const quint32 (*t)[256] = s_tables.edcTable;
+
+    while( len >= 8 ) {
+        const quint32 low = edc ^ readLE32( data );
+        edc = t[7][low & 0xFF] ^
+              t[6][( low >> 8 ) & 0xFF] ^
+              t[5][( low >> 16 ) & 0xFF] ^
+              t[4][low >> 24] ^
+              t[3][data[4]] ^
+              t[2][data[5]] ^
+              t[1][data[6]] ^
+              t[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+
+    while( len-- )
+        edc = ( edc >> 8 ) ^ t[0][( edc ^ *data++ ) & 0xFF];
+
+    return edc;
+}
+
+
+K3b::Device::Track::DataMode K3b::Device::sectorMode( const unsigned char* sector )
+{
+    if( ::memcmp( sector, s_sync, sizeof( s_sync ) ) != 0 )
+        return Track::UNKNOWN;
+
+    switch( sector[s_modeOffset] & 0x03 ) {
+    case 1:
+        return Track::MODE1;
+
+    case 2: {
+        // XA sectors repeat their subheader, the form is in the submode byte
+        const unsigned char* subheader = sector + s_subheaderOffset;
+        if( ::memcmp( subheader, subheader + 4, 4 ) != 0 )
+            return Track::MODE2;
+        return ( subheader[2] & 0x20 ) ? Track::XA_FORM2 : Track::XA_FORM1;
+    }
+
+    default:
+        return Track::UNKNOWN;
+    }
+}
+
+
+bool K3b::Device::checkSectorEdc( const unsigned char* sector )
+{
+    switch( sectorMode( sector ) ) {
+    case Track::MODE1:
+        return calcEdc( sector, s_mode1EdcOffset ) == readLE32( sector + s_mode1EdcOffset );
+
+    case Track::XA_FORM1:
+        return calcEdc( sector + s_subheaderOffset, s_form1EdcOffset - s_subheaderOffset ) == readLE32( sector + s_form1EdcOffset );
+
+    case Track::XA_FORM2: {
+        const quint32 edc = readLE32( sector + s_form2EdcOffset );
+        return edc == 0 || calcEdc( sector + s_subheaderOffset, s_form2EdcOffset - s_subheaderOffset ) == edc;
+    }
+
+    case Track::MODE2:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+bool K3b::Device::checkSectorEcc( const unsigned char* sector )
+{
+    const Track::DataMode mode = sectorMode( sector );
+    if( mode != Track::MODE1 && mode != Track::XA_FORM1 )
+        return( mode != Track::UNKNOWN );
+
+    unsigned char buffer[s_eccBlockSize];
+    const unsigned char* src = eccSource( sector, mode, buffer );
+
+    unsigned char parity[s_pParitySize];
+    computePParity( src, parity );
+    if( ::memcmp( parity, sector + s_pParityOffset, s_pParitySize ) != 0 )
+        return false;
+
+    computeQParity( src, parity );
+    return( ::memcmp( parity, sector + s_qParityOffset, s_qParitySize ) == 0 );
+}
+
+
+bool K3b::Device::checkSector( const unsigned char* sector )
+{
+    // the EDC is much cheaper, check it first
+    return checkSectorEdc( sector ) && checkSectorEcc( sector );
+}
+
+
+int K3b::Device::countCorruptSectors( const unsigned char* sectors, int count, int stride )
+{
+    int corrupt = 0;
+    for( int i = 0; i < count; ++i ) {
+        if( !checkSector( sectors + i*stride ) )
+            ++corrupt;
+    }
+    return corrupt;
+}
+
+
+bool K3b::Device::generateSectorEdcEcc( unsigned char* sector )
+{
+    const Track::DataMode mode = sectorMode( sector );
+    switch( mode ) {
+    case Track::MODE1:
+        writeLE32( sector + s_mode1EdcOffset, calcEdc( sector, s_mode1EdcOffset ) );
+        ::memset( sector + s_mode1EdcOffset + 4, 0, s_pParityOffset - s_mode1EdcOffset - 4 );
+        break;
+
+    case Track::XA_FORM1:
+        writeLE32( sector + s_form1EdcOffset, calcEdc( sector + s_subheaderOffset, s_form1EdcOffset - s_subheaderOffset ) );
+        break;
+
+    case Track::XA_FORM2:
+        writeLE32( sector + s_form2EdcOffset, calcEdc( sector + s_subheaderOffset, s_form2EdcOffset - s_subheaderOffset ) );
+        return true;
+
+    case Track::MODE2:
+        return true;
+
+    default:
+        return false;
+    }
+
+    unsigned char buffer[s_eccBlockSize];
+    const unsigned char* src = eccSource( sector, mode, buffer );
+    computePParity( src, sector + s_pParityOffset );
+
+    // the Q parity covers the P parity
+    if( src == buffer )
+        ::memcpy( buffer + s_pParityOffset - s_headerOffset, sector + s_pParityOffset, s_pParitySize );
+    computeQParity( src, sector + s_qParityOffset );
+    return true;
+}
+
+
+void K3b::Device::scrambleSector( unsigned char* sector )
+{
+    unsigned char* p = sector + s_headerOffset;
+    for( int i = 0; i < RAW_SECTOR_SIZE - s_headerOffset; ++i )
+        p[i] ^= s_tables.scrambler[i];
+}
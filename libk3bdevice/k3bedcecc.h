@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_EDC_ECC_H_
+#define _K3B_EDC_ECC_H_
+
+#include "k3bdevice_export.h"
+#include "k3btrack.h"
+
+#include <qglobal.h>
+
+namespace K3b {
+    namespace Device
+    {
+        /**
+         * Size of a raw CD sector including sync, header, and EDC/ECC.
+         */
+        const int RAW_SECTOR_SIZE = 2352;
+
+        /**
+         * Calculates the CD-ROM EDC, a CRC-32 with the polynomial
+         * (x^16 + x^15 + x^2 + 1)(x^16 + x^2 + x + 1), as defined in ECMA-130.
+         * The data is processed eight bytes at a time.
+         */
+        LIBK3BDEVICE_EXPORT quint32 calcEdc( const unsigned char* data, unsigned int len, quint32 edc = 0 );
+
+        /**
+         * Determines the mode of a raw sector from its sync pattern, header,
+         * and subheader.
+         *
+         * \return Track::MODE1, Track::XA_FORM1, Track::XA_FORM2, Track::MODE2 for
+         *         formless Mode 2 sectors, or Track::UNKNOWN if the sector does not
+         *         start with a sync pattern or is a Mode 0 sector.
+         */
+        LIBK3BDEVICE_EXPORT Track::DataMode sectorMode( const unsigned char* sector );
+
+        /**
+         * Checks the EDC of a raw sector. Formless Mode 2 sectors have no EDC
+         * and Mode 2 Form 2 sectors may leave it empty, both always pass.
+         */
+        LIBK3BDEVICE_EXPORT bool checkSectorEdc( const unsigned char* sector );
+
+        /**
+         * Checks the P and Q parity of a Mode 1 or Mode 2 Form 1 sector. Other
+         * sectors have no ECC and always pass.
+         */
+        LIBK3BDEVICE_EXPORT bool checkSectorEcc( const unsigned char* sector );
+
+        /**
+         * Checks the EDC and the ECC of a raw sector.
+         */
+        LIBK3BDEVICE_EXPORT bool checkSector( const unsigned char* sector );
+
+        /**
+         * Checks \p count raw sectors which are \p stride bytes apart.
+         * Use a stride of 2448 for sectors followed by raw subchannel data as
+         * found in clone images.
+         *
+         * \return the number of sectors which failed the check.
+         */
+        LIBK3BDEVICE_EXPORT int countCorruptSectors( const unsigned char* sectors, int count, int stride = RAW_SECTOR_SIZE );
+
+        /**
+         * Recalculates the EDC and the ECC of a raw sector from its user data.
+         * \return false if the mode of the sector could not be determined.
+         */
+        LIBK3BDEVICE_EXPORT bool generateSectorEdcEcc( unsigned char* sector );
+
+        /**
+         * Scrambles or descrambles bytes 12 to 2351 of a raw sector with the
+         * ECMA-130 scrambler sequence. Applying it twice restores the sector.
+         */
+        LIBK3BDEVICE_EXPORT void scrambleSector( unsigned char* sector );
+    }
+}
+
+#endif
@@ -141,6 +141,7 @@ void K3bFFMpegDecoder::cleanup()
 {
     delete m_file;
     m_file = 0;
+    K3b::AudioDecoder::cleanup();
 }
 
 
@@ -257,6 +257,7 @@ void K3bFLACDecoder::cleanup()
     }
     else
         d = new Private(new QFile(filename()));
+    K3b::AudioDecoder::cleanup();
 }
 
 bool K3bFLACDecoder::analyseFileInternal( K3b::Msf& frames, int& samplerate, int& ch )
@@ -182,6 +182,7 @@ void K3bLibsndfileDecoder::cleanup()
         sf_close( d->sndfile );
         d->isOpen = false;
     }
+    K3b::AudioDecoder::cleanup();
 }
 
 
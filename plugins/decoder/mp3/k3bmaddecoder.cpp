@@ -296,6 +296,7 @@ bool K3bMadDecoder::createPcmSamples( mad_synth* synth )
 void K3bMadDecoder::cleanup()
 {
     d->handle->cleanup();
+    K3b::AudioDecoder::cleanup();
 }
 
 
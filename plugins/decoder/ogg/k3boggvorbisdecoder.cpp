@@ -187,6 +187,7 @@ void K3bOggVorbisDecoder::cleanup()
     d->isOpen = false;
     d->vComment = 0;
     d->vInfo = 0;
+    K3b::AudioDecoder::cleanup();
 }
 
 
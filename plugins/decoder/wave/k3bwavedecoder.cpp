@@ -317,6 +317,7 @@ void K3bWaveDecoder::cleanup()
 {
     if( d->file.isOpen() )
         d->file.close();
+    K3b::AudioDecoder::cleanup();
 }
 
 
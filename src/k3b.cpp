@@ -20,6 +20,7 @@
 #include "k3baudiodoc.h"
 #include "k3baudiotrackdialog.h"
 #include "k3baudioview.h"
+#include "k3bbinaryproject.h"
 #include "k3bcuefileparser.h"
 #include "k3bdatadoc.h"
 #include "k3bdataview.h"
@@ -109,7 +110,8 @@ namespace {
 
     bool isProjectFile( QMimeDatabase const& mimeDatabase, QUrl const& url )
     {
-        return mimeDatabase.mimeTypeForUrl( url ).inherits( "application/x-k3b" );
+        return mimeDatabase.mimeTypeForUrl( url ).inherits( "application/x-k3b" ) ||
+               url.fileName().endsWith( K3b::BinaryProject::extension() );
     }
 
 
@@ -926,7 +928,7 @@ void K3b::MainWindow::slotFileOpen()
     QList<QUrl> urls = QFileDialog::getOpenFileUrls( this,
                                                      i18n("Open Files"),
                                                      QUrl(),
-                                                     i18n("K3b Projects (*.k3b)"));
+                                                     i18n("K3b Projects (*.k3b *.k3bb)"));
     for( QList<QUrl>::iterator it = urls.begin(); it != urls.end(); ++it ) {
         openDocument( *it );
         d->actionFileOpenRecent->addUrl( *it );
@@ -993,7 +995,8 @@ bool K3b::MainWindow::fileSaveAs( K3b::Doc* doc )
 
     if( doc ) {
         // we do not use the static QFileDialog method here to be able to specify a filename suggestion
-        QFileDialog dlg( this, i18n("Save As"), QString(), i18n("K3b Projects (*.k3b)") );
+        QFileDialog dlg( this, i18n("Save As"), QString(),
+                         i18n("K3b Projects (*.k3b)") + ";;" + i18n("K3b Binary Projects (*.k3bb)") );
         dlg.setAcceptMode( QFileDialog::AcceptSave );
         dlg.selectFile( doc->name() );
         dlg.exec();
@@ -24,7 +24,7 @@
 
 #include "k3bcore.h"
 #include "k3bdevicemanager.h"
-#include "k3bthread.h"
+#include "k3bthreadjobexecutor.h"
 #ifdef ENABLE_HAL_SUPPORT
 #include "k3bhalconnection.h"
 #endif
@@ -226,7 +226,7 @@ void K3b::Application::processCmdLineArgs()
 void K3b::Application::slotShutDown()
 {
     k3bcore->mediaCache()->clearDeviceList();
-    Thread::waitUntilFinished();
+    ThreadJobExecutor::instance()->waitForDone();
 }
 
 
@@ -66,6 +66,10 @@ class K3b::JobProgressDialog::Private
 public:
     int lastProgress;
 
+    // the remaining time predicted by the job, -1 if none
+    int predictedRemainingTime;
+    qint64 predictionTime;
+
     QFrame* headerFrame;
     QFrame* progressHeaderFrame;
     QTreeWidget* viewInfo;
@@ -78,6 +82,9 @@ K3b::JobProgressDialog::JobProgressDialog( QWidget* parent,
     : QDialog( parent )
 {
     d = new Private;
+    d->lastProgress = 0;
+    d->predictedRemainingTime = -1;
+    d->predictionTime = 0;
     setupGUI();
 
     if( !showSubProgress ) {
@@ -457,6 +464,7 @@ void K3b::JobProgressDialog::setJob( K3b::Job* job )
 
         connect( job, SIGNAL(percent(int)), m_progressPercent, SLOT(setValue(int)) );
         connect( job, SIGNAL(percent(int)), this, SLOT(slotProgress(int)) );
+        connect( job, SIGNAL(remainingTime(int)), this, SLOT(slotRemainingTime(int)) );
         connect( job, SIGNAL(subPercent(int)), m_progressSubPercent, SLOT(setValue(int)) );
 
         connect( job, SIGNAL(processedSubSize(int,int)), this, SLOT(slotProcessedSubSize(int,int)) );
@@ -516,6 +524,8 @@ void K3b::JobProgressDialog::slotStarted()
 {
     qDebug();
     d->lastProgress = 0;
+    d->predictedRemainingTime = -1;
+    d->predictionTime = 0;
     m_lastProgressUpdateTime = 0;
     m_timer.start();
     m_plainCaption = k3bappcore->k3bMainWindow()->windowTitle();
@@ -555,15 +565,27 @@ void K3b::JobProgressDialog::slotProgress( int percent )
             "Elapsed time: %1", QTime::fromMSecsSinceStartOfDay(elapsed).toString("hh:mm:ss")));
         // Update "Remaining time" max. each second (1000 ms)
         if (elapsed - m_lastProgressUpdateTime > 999) {
+            qint64 remaining = 0;
+            // prefer the prediction of the job as long as it is up to date
+            if (d->predictedRemainingTime >= 0 && elapsed - d->predictionTime < 10000)
+                remaining = qMax(qint64(0), qint64(d->predictedRemainingTime)*1000 - (elapsed - d->predictionTime));
+            else if (d->lastProgress > 0 && d->lastProgress < 100)
+                remaining = elapsed * (100 - d->lastProgress) / d->lastProgress;
             m_labelRemainingTime->setText(i18nc("@info %1 is a duration formatted",
-                "Remaining: %1", QTime::fromMSecsSinceStartOfDay(
-                (d->lastProgress > 0 && d->lastProgress < 100) ? elapsed * (100 - d->lastProgress) / d->lastProgress : 0).toString("hh:mm:ss")));
+                "Remaining: %1", QTime::fromMSecsSinceStartOfDay(remaining).toString("hh:mm:ss")));
             m_lastProgressUpdateTime = elapsed;
         }
     }
 }
 
 
+void K3b::JobProgressDialog::slotRemainingTime( int seconds )
+{
+    d->predictedRemainingTime = seconds;
+    d->predictionTime = m_timer.isValid() ? m_timer.elapsed() : 0;
+}
+
+
 void K3b::JobProgressDialog::keyPressEvent( QKeyEvent* e )
 {
     qDebug() << e;
@@ -101,6 +101,7 @@ namespace K3b {
 	void slotShowDebuggingOutput();
 
         void slotProgress( int );
+        void slotRemainingTime( int seconds );
 
         virtual void slotThemeChanged();
 
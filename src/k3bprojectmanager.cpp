@@ -31,6 +31,7 @@
 #include "k3bmovixdoc.h"
 #include "k3bglobals.h"
 #include "k3bisooptions.h"
+#include "k3bbinaryproject.h"
 #include "k3bdevicemanager.h"
 #include "k3bprojectinterface.h"
 #include <KoStore.h>
@@ -48,12 +49,13 @@
 #include <QHash>
 #include <QList>
 #include <QTemporaryFile>
-#include <QTextStream>
 #include <QUrl>
-#include <QDomDocument>
-#include <QDomElement>
 #include <QCursor>
 #include <QApplication>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 namespace
 {
@@ -70,6 +72,33 @@ namespace
         else
             return new K3b::ProjectInterface( doc );
     }
+
+
+    bool projectType( const QString& docType, K3b::Doc::Type& type )
+    {
+        if( docType == "k3b_audio_project" )
+            type = K3b::Doc::AudioProject;
+        else if( docType == "k3b_data_project" )
+            type = K3b::Doc::DataProject;
+        else if( docType == "k3b_vcd_project" )
+            type = K3b::Doc::VcdProject;
+        else if( docType == "k3b_mixed_project" )
+            type = K3b::Doc::MixedProject;
+        else if( docType == "k3b_movix_project" )
+            type = K3b::Doc::MovixProject;
+        else if( docType == "k3b_movixdvd_project" )
+            type = K3b::Doc::MovixProject; // backward compatibility
+        else if( docType == "k3b_dvd_project" )
+            type = K3b::Doc::DataProject; // backward compatibility
+        else if( docType == "k3b_video_dvd_project" ) {
+            type = K3b::Doc::VideoDvdProject;
+        } else {
+            qDebug() << "(K3b::Doc) unknown doc type: " << docType;
+            return false;
+        }
+
+        return true;
+    }
 }
 
 class K3b::ProjectManager::Private
@@ -460,53 +489,60 @@ K3b::Doc* K3b::ProjectManager::openProject( const QUrl& url )
     tmpfile.close();
 
     // ///////////////////////////////////////////////
-    // first check if it's a store or an old plain xml file
+    // first check if it's a binary project, a store, or an old plain xml file
     bool success = false;
-    QDomDocument xmlDoc;
-
-    // try opening a store
-    KoStore* store = KoStore::createStore( tmpfile.fileName(), KoStore::Read );
-    if( store ) {
-        if( !store->bad() ) {
-            // try opening the document inside the store
-            if( store->open( "maindata.xml" ) ) {
-                QIODevice* dev = store->device();
-                dev->open( QIODevice::ReadOnly );
-                if( xmlDoc.setContent( dev ) )
-                    success = true;
-                dev->close();
-                store->close();
-            }
-        }
+    K3b::Doc* newDoc = 0;
 
-        delete store;
+    if( K3b::BinaryProject::isBinaryProject( tmpfile.fileName() ) ) {
+        QDomDocument xmlDoc;
+        success = K3b::BinaryProject::load( tmpfile.fileName(), xmlDoc );
+        tmpfile.remove();
+        if( success )
+            newDoc = loadProject( xmlDoc );
     }
+    else {
+        // try opening a store
+        KoStore* store = KoStore::createStore( tmpfile.fileName(), KoStore::Read );
+        if( store ) {
+            if( !store->bad() ) {
+                // try opening the document inside the store
+                if( store->open( "maindata.xml" ) ) {
+                    QIODevice* dev = store->device();
+                    dev->open( QIODevice::ReadOnly );
+                    newDoc = loadProject( dev, &success );
+                    dev->close();
+                    store->close();
+                }
+            }
 
-    if( !success ) {
-        // try reading an old plain document
-        tmpfile.remove();
-        if ( tmpfile.open() ) {
-            //
-            // First check if this is really an xml file because if this is a very big file
-            // the setContent method blocks for a very long time
-            //
-            char test[5];
-            if( tmpfile.read( test, 5 ) ) {
-                if( ::strncmp( test, "<?xml", 5 ) ) {
-                    qDebug() << "(K3b::Doc) " << url.toLocalFile() << " seems to be no xml file.";
+            delete store;
+        }
+
+        if( !success ) {
+            // try reading an old plain document
+            tmpfile.remove();
+            if ( tmpfile.open() ) {
+                //
+                // First check if this is really an xml file because if this is a very big file
+                // the setContent method blocks for a very long time
+                //
+                char test[5];
+                if( tmpfile.read( test, 5 ) ) {
+                    if( ::strncmp( test, "<?xml", 5 ) ) {
+                        qDebug() << "(K3b::Doc) " << url.toLocalFile() << " seems to be no xml file.";
+                        QApplication::restoreOverrideCursor();
+                        return 0;
+                    }
+                    tmpfile.reset();
+                }
+                else {
+                    qDebug() << "(K3b::Doc) could not read from file.";
                     QApplication::restoreOverrideCursor();
                     return 0;
                 }
-                tmpfile.reset();
+                newDoc = loadProject( &tmpfile, &success );
+                tmpfile.remove();
             }
-            else {
-                qDebug() << "(K3b::Doc) could not read from file.";
-                QApplication::restoreOverrideCursor();
-                return 0;
-            }
-            if( xmlDoc.setContent( &tmpfile ) )
-                success = true;
-            tmpfile.remove();
         }
     }
 
@@ -517,37 +553,7 @@ K3b::Doc* K3b::ProjectManager::openProject( const QUrl& url )
         return 0;
     }
 
-    // check the documents DOCTYPE
-    K3b::Doc::Type type = K3b::Doc::AudioProject;
-    if( xmlDoc.doctype().name() == "k3b_audio_project" )
-        type = K3b::Doc::AudioProject;
-    else if( xmlDoc.doctype().name() == "k3b_data_project" )
-        type = K3b::Doc::DataProject;
-    else if( xmlDoc.doctype().name() == "k3b_vcd_project" )
-        type = K3b::Doc::VcdProject;
-    else if( xmlDoc.doctype().name() == "k3b_mixed_project" )
-        type = K3b::Doc::MixedProject;
-    else if( xmlDoc.doctype().name() == "k3b_movix_project" )
-        type = K3b::Doc::MovixProject;
-    else if( xmlDoc.doctype().name() == "k3b_movixdvd_project" )
-        type = K3b::Doc::MovixProject; // backward compatibility
-    else if( xmlDoc.doctype().name() == "k3b_dvd_project" )
-        type = K3b::Doc::DataProject; // backward compatibility
-    else if( xmlDoc.doctype().name() == "k3b_video_dvd_project" ) {
-        type = K3b::Doc::VideoDvdProject;
-    } else {
-        qDebug() << "(K3b::Doc) unknown doc type: " << xmlDoc.doctype().name();
-        QApplication::restoreOverrideCursor();
-        return 0;
-    }
-
-    // we do not know yet if we will be able to actually open the project, so don't inform others yet
-    K3b::Doc* newDoc = createEmptyProject( type );
-
-    // ---------
-    // load the data into the document
-    QDomElement root = xmlDoc.documentElement();
-    if( newDoc->loadDocumentData( &root ) ) {
+    if( newDoc ) {
         newDoc->setURL( url );
         newDoc->setSaved( true );
         newDoc->setModified( false );
@@ -562,12 +568,67 @@ K3b::Doc* K3b::ProjectManager::openProject( const QUrl& url )
 
         qDebug() << "(K3b::ProjectManager) loading project done.";
     }
-    else {
+
+    QApplication::restoreOverrideCursor();
+
+    return newDoc;
+}
+
+
+K3b::Doc* K3b::ProjectManager::loadProject( QIODevice* dev, bool* validXml )
+{
+    //
+    // The document is streamed into the project. We never build a DOM tree
+    // of the whole document since data projects may contain millions of files.
+    //
+    QXmlStreamReader xml( dev );
+
+    // read up to the document element
+    QString docType;
+    while( !xml.atEnd() && !xml.isStartElement() ) {
+        if( xml.readNext() == QXmlStreamReader::DTD )
+            docType = xml.dtdName().toString();
+    }
+
+    if( !xml.isStartElement() ) {
+        qDebug() << "(K3b::Doc) no document element:" << xml.errorString();
+        *validXml = false;
+        return 0;
+    }
+    *validXml = true;
+
+    // check the documents DOCTYPE
+    K3b::Doc::Type type = K3b::Doc::AudioProject;
+    if( !projectType( docType, type ) )
+        return 0;
+
+    // we do not know yet if we will be able to actually open the project, so don't inform others yet
+    K3b::Doc* newDoc = createEmptyProject( type );
+
+    // ---------
+    // load the data into the document
+    if( !newDoc->loadDocumentStream( &xml ) ) {
         delete newDoc;
         newDoc = 0;
     }
 
-    QApplication::restoreOverrideCursor();
+    return newDoc;
+}
+
+
+K3b::Doc* K3b::ProjectManager::loadProject( const QDomDocument& xmlDoc )
+{
+    K3b::Doc::Type type = K3b::Doc::AudioProject;
+    if( !projectType( xmlDoc.doctype().name(), type ) )
+        return 0;
+
+    K3b::Doc* newDoc = createEmptyProject( type );
+
+    QDomElement root = xmlDoc.documentElement();
+    if( !newDoc->loadDocumentData( &root ) ) {
+        delete newDoc;
+        newDoc = 0;
+    }
 
     return newDoc;
 }
@@ -581,43 +642,61 @@ bool K3b::ProjectManager::saveProject( K3b::Doc* doc, const QUrl& url )
 
     bool success = false;
 
-    // create the store
-    KoStore* store = KoStore::createStore( tmpfile.fileName(), KoStore::Write, "application/x-k3b" );
-    if( store ) {
-        if( store->bad() ) {
-            delete store;
+    if( url.fileName().endsWith( K3b::BinaryProject::extension() ) ) {
+        success = K3b::BinaryProject::save( doc, tmpfile.fileName() );
+        if( success ) {
+            doc->setURL( url );
+            doc->setModified( false );
         }
-        else {
-            // open the document inside the store
-            store->open( "maindata.xml" );
-
-            // save the data in the document
-            QDomDocument xmlDoc( "k3b_" + doc->typeString() + "_project" );
-
-            xmlDoc.appendChild( xmlDoc.createProcessingInstruction( "xml", "version=\"1.0\" encoding=\"UTF-8\"" ) );
-            QDomElement docElem = xmlDoc.createElement( "k3b_" + doc->typeString() + "_project" );
-            xmlDoc.appendChild( docElem );
-            success = doc->saveDocumentData( &docElem );
-            if( success ) {
-                KoStoreDevice dev(store);
-                dev.open( QIODevice::WriteOnly );
-                QTextStream xmlStream( &dev );
-                xmlDoc.save( xmlStream, 0 );
 
-                doc->setURL( url );
-                doc->setModified( false );
+        doc->setSaved( success );
+
+        if( success ) {
+            emit projectSaved( doc );
+        }
+    }
+    else {
+        // create the store
+        KoStore* store = KoStore::createStore( tmpfile.fileName(), KoStore::Write, "application/x-k3b" );
+        if( store ) {
+            if( store->bad() ) {
+                delete store;
             }
+            else {
+                // open the document inside the store
+                store->open( "maindata.xml" );
 
-            // close the document inside the store
-            store->close();
+                // save the data in the document. The data is streamed into the
+                // store to avoid building a DOM tree of big data projects.
+                const QString docType = "k3b_" + doc->typeString() + "_project";
+                KoStoreDevice dev(store);
+                dev.open( QIODevice::WriteOnly );
+                QXmlStreamWriter xml( &dev );
+                xml.setAutoFormatting( true );
+                xml.setAutoFormattingIndent( 0 );
+                xml.writeStartDocument();
+                xml.writeDTD( "<!DOCTYPE " + docType + '>' );
+                xml.writeStartElement( docType );
+                success = doc->saveDocumentStream( &xml );
+                xml.writeEndElement();
+                xml.writeEndDocument();
+                success = success && !xml.hasError();
+                if( success ) {
+                    doc->setURL( url );
+                    doc->setModified( false );
+                }
 
-            // remove the store (destructor writes the store to disk)
-            delete store;
+                // close the document inside the store
+                store->close();
 
-            doc->setSaved( success );
+                // remove the store (destructor writes the store to disk)
+                delete store;
 
-            if( success ) {
-                emit projectSaved( doc );
+                doc->setSaved( success );
+
+                if( success ) {
+                    emit projectSaved( doc );
+                }
             }
         }
     }
@@ -22,6 +22,8 @@
 #include <QObject>
 
 
+class QDomDocument;
+class QIODevice;
 class QUrl;
 
 namespace K3b {
@@ -82,6 +84,8 @@ namespace K3b {
     private:
         // used internal
         Doc* createEmptyProject( Doc::Type );
+        Doc* loadProject( QIODevice* dev, bool* validXml );
+        Doc* loadProject( const QDomDocument& xmlDoc );
 
         class Private;
         Private* d;
@@ -486,6 +486,9 @@ void K3b::WriterSelectionWidget::slotWriterChanged()
     if( K3b::Device::Device* dev = writerDevice() ) {
         KConfigGroup g( KSharedConfig::openConfig(), "General Options" );
         g.writeEntry( "current_writer", dev->blockDeviceName() );
+
+        // the drive is about to be used for writing
+        k3bcore->deviceManager()->revalidateCapabilities( dev );
     }
 }
 
@@ -120,12 +120,14 @@ K3b::MediaCopyDialog::MediaCopyDialog( QWidget *parent )
     m_checkOnlyCreateImage = K3b::StdGuiItems::onlyCreateImagesCheckbox( groupOptions );
     m_checkDeleteImages = K3b::StdGuiItems::removeImagesCheckbox( groupOptions );
     m_checkVerifyData = K3b::StdGuiItems::verifyCheckBox( groupOptions );
+    m_checkAllWriters = new QCheckBox( i18n("Write on all writers"), groupOptions );
     QVBoxLayout* groupOptionsLayout = new QVBoxLayout( groupOptions );
     groupOptionsLayout->addWidget( m_checkSimulate );
     groupOptionsLayout->addWidget( m_checkCacheImage );
     groupOptionsLayout->addWidget( m_checkOnlyCreateImage );
     groupOptionsLayout->addWidget( m_checkDeleteImages );
     groupOptionsLayout->addWidget( m_checkVerifyData );
+    groupOptionsLayout->addWidget( m_checkAllWriters );
     groupOptionsLayout->addStretch( 1 );
 
     optionTabGrid->addWidget( groupCopyMode, 0, 0 );
@@ -163,11 +165,15 @@ K3b::MediaCopyDialog::MediaCopyDialog( QWidget *parent )
     m_spinDataRetries->setRange( 1, 128 );
     m_checkIgnoreDataReadErrors = K3b::StdGuiItems::ignoreAudioReadErrorsCheckBox( m_groupAdvancedDataOptions );
     m_checkNoCorrection = new QCheckBox( i18n("No error correction"), m_groupAdvancedDataOptions );
+    m_checkEdcEcc = new QCheckBox( i18n("Check sector checksums"), m_groupAdvancedDataOptions );
+    m_checkRescueMode = new QCheckBox( i18n("Rescue damaged media"), m_groupAdvancedDataOptions );
     groupAdvancedDataOptionsLayout->addWidget( new QLabel( i18n("Read retries:"), m_groupAdvancedDataOptions ), 0, 0 );
     groupAdvancedDataOptionsLayout->addWidget( m_spinDataRetries, 0, 1 );
     groupAdvancedDataOptionsLayout->addWidget( m_checkIgnoreDataReadErrors, 1, 0, 1, 2 );
     groupAdvancedDataOptionsLayout->addWidget( m_checkNoCorrection, 2, 0, 1, 2 );
-    groupAdvancedDataOptionsLayout->setRowStretch( 4, 1 );
+    groupAdvancedDataOptionsLayout->addWidget( m_checkEdcEcc, 3, 0, 1, 2 );
+    groupAdvancedDataOptionsLayout->addWidget( m_checkRescueMode, 4, 0, 1, 2 );
+    groupAdvancedDataOptionsLayout->setRowStretch( 5, 1 );
 
     m_groupAdvancedAudioOptions = new QGroupBox( i18n("Audio"), advancedTab );
     QGridLayout* groupAdvancedAudioOptionsLayout = new QGridLayout( m_groupAdvancedAudioOptions );
@@ -207,16 +213,39 @@ K3b::MediaCopyDialog::MediaCopyDialog( QWidget *parent )
     connect( m_checkOnlyCreateImage, SIGNAL(toggled(bool)), this, SLOT(slotToggleAll()) );
     connect( m_comboCopyMode, SIGNAL(activated(int)), this, SLOT(slotToggleAll()) );
     connect( m_checkReadCdText, SIGNAL(toggled(bool)), this, SLOT(slotToggleAll()) );
+    connect( m_checkNoCorrection, SIGNAL(toggled(bool)), this, SLOT(slotToggleAll()) );
 
     m_checkIgnoreDataReadErrors->setToolTip( i18n("Skip unreadable data sectors") );
     m_checkNoCorrection->setToolTip( i18n("Disable the source drive's error correction") );
+    m_checkEdcEcc->setToolTip( i18n("Verify the error detection and correction codes of the data sectors") );
+    m_checkRescueMode->setToolTip( i18n("Read the readable areas first and retry the damaged ones later") );
     m_checkReadCdText->setToolTip( i18n("Copy CD-Text from the source CD if available.") );
+    m_checkAllWriters->setToolTip( i18n("Write the copy on all writers containing an empty medium at the same time") );
 
     m_checkNoCorrection->setWhatsThis( i18n("<p>If this option is checked K3b will disable the "
                                             "source drive's ECC/EDC error correction. This way sectors "
                                             "that are unreadable by intention can be read."
                                             "<p>This may be useful for cloning CDs with copy "
                                             "protection based on corrupted sectors.") );
+    m_checkEdcEcc->setWhatsThis( i18n("<p>If this option is checked K3b reads the data sectors of CDs in raw "
+                                      "mode and checks their EDC/ECC codes itself. Sectors which fail the check "
+                                      "are read again like unreadable sectors."
+                                      "<p>This option is not available without error correction since corrupted "
+                                      "sectors are copied as they are then.") );
+    m_checkRescueMode->setWhatsThis( i18n("<p>If this option is checked K3b first copies all readable areas "
+                                          "of the data tracks quickly, skipping over damaged ones. Afterwards the "
+                                          "damaged areas are read sector by sector with different reading speeds."
+                                          "<p>The state of every sector is saved next to the image. If the copy "
+                                          "fails the image is kept in a file or folder named after the disc and "
+                                          "copying the same disc again with the same temporary path only retries "
+                                          "the missing sectors without asking to overwrite the image."
+                                          "<p>Rescue mode requires the image to be created on the hard disk and "
+                                          "is not available in clone mode.") );
+    m_checkAllWriters->setWhatsThis( i18n("<p>If this option is checked K3b reads the source medium only once and "
+                                          "writes it on the selected writer and on all other writers which contain "
+                                          "an empty medium of the same type at the same time. Each copy is written on "
+                                          "every writer."
+                                          "<p>Multisession CDs are only written on the selected writer.") );
     m_checkReadCdText->setWhatsThis( i18n("<p>If this option is checked K3b will search for CD-Text on the source CD. "
                                           "Disable it if your CD drive has problems with reading CD-Text or you want "
                                           "to stick to CDDB info.") );
@@ -328,7 +357,10 @@ void K3b::MediaCopyDialog::slotStartClicked()
     else if ( sourceMedium.diskInfo().mediaType() & K3b::Device::MEDIA_CD_ALL ) {
         K3b::CdCopyJob* job = new K3b::CdCopyJob( dlg, this );
 
-        job->setWriterDevice( m_writerSelectionWidget->writerDevice() );
+        if( m_checkAllWriters->isEnabled() && m_checkAllWriters->isChecked() )
+            job->setWriterDevices( writerDevices() );
+        else
+            job->setWriterDevice( m_writerSelectionWidget->writerDevice() );
         job->setReaderDevice( m_comboSourceDevice->selectedDevice() );
         job->setSpeed( m_writerSelectionWidget->writerSpeed() );
         job->setSimulate( m_checkSimulate->isChecked() );
@@ -344,6 +376,8 @@ void K3b::MediaCopyDialog::slotStartClicked()
         job->setIgnoreDataReadErrors( m_checkIgnoreDataReadErrors->isChecked() );
         job->setIgnoreAudioReadErrors( m_checkIgnoreAudioReadErrors->isChecked() );
         job->setNoCorrection( m_checkNoCorrection->isChecked() );
+        job->setCheckEdcEcc( m_checkEdcEcc->isEnabled() && m_checkEdcEcc->isChecked() );
+        job->setRescueMode( m_checkRescueMode->isEnabled() && m_checkRescueMode->isChecked() );
         job->setWritingMode( m_writingModeWidget->writingMode() );
 
         burnJob = job;
@@ -351,7 +385,10 @@ void K3b::MediaCopyDialog::slotStartClicked()
     else if ( sourceMedium.diskInfo().mediaType() & ( K3b::Device::MEDIA_DVD_ALL|K3b::Device::MEDIA_BD_ALL ) ) {
         K3b::DvdCopyJob* job = new K3b::DvdCopyJob( dlg, this );
 
-        job->setWriterDevice( m_writerSelectionWidget->writerDevice() );
+        if( m_checkAllWriters->isEnabled() && m_checkAllWriters->isChecked() )
+            job->setWriterDevices( writerDevices() );
+        else
+            job->setWriterDevice( m_writerSelectionWidget->writerDevice() );
         job->setReaderDevice( m_comboSourceDevice->selectedDevice() );
         job->setImagePath( m_tempDirSelectionWidget->tempPath() );
         job->setRemoveImageFiles( m_checkDeleteImages->isChecked() && !m_checkOnlyCreateImage->isChecked() );
@@ -416,6 +453,12 @@ void K3b::MediaCopyDialog::toggleAll()
     m_writerSelectionWidget->setDisabled( m_checkOnlyCreateImage->isChecked() );
     m_checkCacheImage->setEnabled( !m_checkOnlyCreateImage->isChecked() );
     m_writingModeWidget->setEnabled( !m_checkOnlyCreateImage->isChecked() );
+    m_checkRescueMode->setEnabled( ( m_checkCacheImage->isChecked() || m_checkOnlyCreateImage->isChecked() ) &&
+                                   m_comboCopyMode->currentIndex() == 0 );
+    m_checkEdcEcc->setEnabled( !m_checkNoCorrection->isChecked() );
+    m_checkAllWriters->setEnabled( !m_checkOnlyCreateImage->isChecked() &&
+                                   !m_checkSimulate->isChecked() &&
+                                   m_comboCopyMode->currentIndex() == 0 );
 
     // FIXME: no verification for CD yet
     m_checkVerifyData->setDisabled( sourceMedium.diskInfo().mediaType() & K3b::Device::MEDIA_CD_ALL ||
@@ -579,6 +622,9 @@ void K3b::MediaCopyDialog::loadSettings( const KConfigGroup& c )
     m_checkIgnoreDataReadErrors->setChecked( c.readEntry( "ignore data read errors", false ) );
     m_checkIgnoreAudioReadErrors->setChecked( c.readEntry( "ignore audio read errors", true ) );
     m_checkNoCorrection->setChecked( c.readEntry( "no correction", false ) );
+    m_checkEdcEcc->setChecked( c.readEntry( "check edc ecc", false ) );
+    m_checkRescueMode->setChecked( c.readEntry( "rescue mode", false ) );
+    m_checkAllWriters->setChecked( c.readEntry( "all writers", false ) );
 
     m_spinDataRetries->setValue( c.readEntry( "data retries", 128 ) );
     m_spinAudioRetries->setValue( c.readEntry( "audio retries", 5 ) );
@@ -607,6 +653,9 @@ void K3b::MediaCopyDialog::saveSettings( KConfigGroup c )
     c.writeEntry( "ignore data read errors", m_checkIgnoreDataReadErrors->isChecked() );
     c.writeEntry( "ignore audio read errors", m_checkIgnoreAudioReadErrors->isChecked() );
     c.writeEntry( "no correction", m_checkNoCorrection->isChecked() );
+    c.writeEntry( "check edc ecc", m_checkEdcEcc->isChecked() );
+    c.writeEntry( "rescue mode", m_checkRescueMode->isChecked() );
+    c.writeEntry( "all writers", m_checkAllWriters->isChecked() );
     c.writeEntry( "data retries", m_spinDataRetries->value() );
     c.writeEntry( "audio retries", m_spinAudioRetries->value() );
 
@@ -634,3 +683,23 @@ KIO::filesize_t K3b::MediaCopyDialog::neededSize() const
 }
 
 
+QList<K3b::Device::Device*> K3b::MediaCopyDialog::writerDevices() const
+{
+    QList<K3b::Device::Device*> devices;
+    K3b::Device::Device* writer = m_writerSelectionWidget->writerDevice();
+    if( !writer )
+        return devices;
+    devices.append( writer );
+
+    Q_FOREACH( K3b::Device::Device* dev, k3bcore->deviceManager()->burningDevices() ) {
+        if( dev == writer || dev == m_comboSourceDevice->selectedDevice() )
+            continue;
+
+        const K3b::Medium medium = k3bappcore->mediaCache()->medium( dev );
+        if( medium.diskInfo().diskState() == K3b::Device::STATE_EMPTY &&
+            medium.diskInfo().mediaType() & m_writerSelectionWidget->wantedMediumType() )
+            devices.append( dev );
+    }
+
+    return devices;
+}
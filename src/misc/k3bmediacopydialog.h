@@ -58,6 +58,12 @@ namespace K3b {
 
         KIO::filesize_t neededSize() const;
 
+        /**
+         * The selected writer followed by all other writers
+         * which contain an empty medium of the wanted type.
+         */
+        QList<Device::Device*> writerDevices() const;
+
         WriterSelectionWidget* m_writerSelectionWidget;
         TempDirSelectionWidget* m_tempDirSelectionWidget;
         QCheckBox* m_checkSimulate;
@@ -68,7 +74,10 @@ namespace K3b {
         QCheckBox* m_checkIgnoreDataReadErrors;
         QCheckBox* m_checkIgnoreAudioReadErrors;
         QCheckBox* m_checkNoCorrection;
+        QCheckBox* m_checkEdcEcc;
+        QCheckBox* m_checkRescueMode;
         QCheckBox* m_checkVerifyData;
+        QCheckBox* m_checkAllWriters;
         MediaSelectionComboBox* m_comboSourceDevice;
         QComboBox* m_comboParanoiaMode;
         QSpinBox* m_spinCopies;
@@ -66,13 +66,22 @@ void K3b::AdvancedOptionTab::setupGui()
     m_editWritingBufferSize->setRange( 1, 100 );
     m_editWritingBufferSize->setValue( 4 );
     m_editWritingBufferSize->setSuffix( ' ' + i18n("MB") );
+    QLabel* pipeBufferLabel = new QLabel( i18n("&Image streaming buffer size:"), groupWritingApp );
+    m_editPipeBufferSize = new QSpinBox( groupWritingApp );
+    m_editPipeBufferSize->setRange( 0, 1024 );
+    m_editPipeBufferSize->setSingleStep( 16 );
+    m_editPipeBufferSize->setSuffix( ' ' + i18n("MB") );
+    m_editPipeBufferSize->setSpecialValueText( i18n("Disabled") );
+    pipeBufferLabel->setBuddy( m_editPipeBufferSize );
     m_checkShowForceGuiElements = new QCheckBox( i18n("Show &advanced GUI elements"), groupWritingApp );
     bufferLayout->addWidget( m_checkBurnfree, 0, 0, 1, 3 );
     bufferLayout->addWidget( m_checkOverburn, 1, 0, 1, 2 );
     bufferLayout->addWidget( m_checkForceUnsafeOperations, 2, 0, 1, 3 );
     bufferLayout->addWidget( m_checkManualWritingBufferSize, 3, 0 );
     bufferLayout->addWidget( m_editWritingBufferSize, 3, 1 );
-    bufferLayout->addWidget( m_checkShowForceGuiElements, 4, 0, 1, 3 );
+    bufferLayout->addWidget( pipeBufferLabel, 4, 0 );
+    bufferLayout->addWidget( m_editPipeBufferSize, 4, 1 );
+    bufferLayout->addWidget( m_checkShowForceGuiElements, 5, 0, 1, 3 );
     bufferLayout->setColumnStretch( 2, 1 );
 
     QGroupBox* groupMisc = new QGroupBox( i18n("Miscellaneous"), this );
@@ -132,6 +141,11 @@ void K3b::AdvancedOptionTab::setupGui()
                                                        "<p>If this option is checked the value specified will be used for both "
                                                        "CD and DVD burning.", 4, 32) );
 
+    m_editPipeBufferSize->setWhatsThis( i18n("<p>When writing data projects K3b buffers the created image "
+                                             "before passing it to the writing application. A large buffer "
+                                             "prevents short stalls of the image creation from reducing the "
+                                             "writing speed.") );
+
     m_checkEject->setWhatsThis( i18n("<p>If this option is checked K3b will not eject the medium once the burn process "
                                      "finishes. This can be helpful in case one leaves the computer after starting the "
                                      "burning and does not want the tray to be open all the time."
@@ -161,6 +175,7 @@ void K3b::AdvancedOptionTab::readSettings()
     m_checkManualWritingBufferSize->setChecked( k3bcore->globalSettings()->useManualBufferSize() );
     if( k3bcore->globalSettings()->useManualBufferSize() )
         m_editWritingBufferSize->setValue( k3bcore->globalSettings()->bufferSize() );
+    m_editPipeBufferSize->setValue( k3bcore->globalSettings()->pipeBufferSize() );
 }
 
 
@@ -176,6 +191,7 @@ void K3b::AdvancedOptionTab::saveSettings()
     k3bcore->globalSettings()->setBurnfree( m_checkBurnfree->isChecked() );
     k3bcore->globalSettings()->setUseManualBufferSize( m_checkManualWritingBufferSize->isChecked() );
     k3bcore->globalSettings()->setBufferSize( m_editWritingBufferSize->value() );
+    k3bcore->globalSettings()->setPipeBufferSize( m_editPipeBufferSize->value() );
     k3bcore->globalSettings()->setForce( m_checkForceUnsafeOperations->isChecked() );
 }
 
@@ -48,6 +48,7 @@ namespace K3b {
         QCheckBox*    m_checkOverburn;
         QCheckBox*    m_checkManualWritingBufferSize;
         QSpinBox*     m_editWritingBufferSize;
+        QSpinBox*     m_editPipeBufferSize;
         QCheckBox*    m_checkShowForceGuiElements;
         QCheckBox*    m_checkForceUnsafeOperations;
     };
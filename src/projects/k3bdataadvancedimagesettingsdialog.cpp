@@ -84,6 +84,7 @@ void K3b::DataAdvancedImageSettingsDialog::load( const K3b::IsoOptions& options
     // misc (FIXME: should not be here)
     m_checkDoNotCacheInodes->setChecked( options.doNotCacheInodes() );
     m_checkDoNotImportSession->setChecked( options.doNotImportSession() );
+    m_checkDeduplicateFiles->setChecked( options.deduplicateFiles() );
 }
 
 
@@ -119,6 +120,7 @@ void K3b::DataAdvancedImageSettingsDialog::save( K3b::IsoOptions& options )
     options.setJolietLong( m_checkJolietLong->isChecked() );
     options.setDoNotCacheInodes( m_checkDoNotCacheInodes->isChecked() );
     options.setDoNotImportSession( m_checkDoNotImportSession->isChecked() );
+    options.setDeduplicateFiles( m_checkDeduplicateFiles->isChecked() );
 }
 
 
@@ -84,7 +84,8 @@ static bool compareAdvancedOptions( const K3b::IsoOptions& o1, const K3b::IsoOpt
              o1.jolietLong() == o2.jolietLong() &&
              o1.ISOLevel() == o2.ISOLevel() &&
              o1.preserveFilePermissions() == o2.preserveFilePermissions() &&
-             o1.doNotCacheInodes() == o2.doNotCacheInodes() );
+             o1.doNotCacheInodes() == o2.doNotCacheInodes() &&
+             o1.deduplicateFiles() == o2.deduplicateFiles() );
 }
 
 
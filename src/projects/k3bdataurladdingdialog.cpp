@@ -27,10 +27,8 @@
 #include "k3b.h"
 #include "k3bapplication.h"
 #include "k3biso9660.h"
-#include "k3bdirsizejob.h"
+#include "k3bdirscanner.h"
 #include "k3binteractiondialog.h"
-#include "k3bthread.h"
-#include "k3bsignalwaiter.h"
 #include "k3bexternalbinmanager.h"
 
 #include <KConfig>
@@ -60,6 +58,7 @@ K3b::DataUrlAddingDialog::DataUrlAddingDialog( const QList<QUrl>& urls, DirItem*
     m_urls = urls;
     for( QList<QUrl>::ConstIterator it = urls.begin(); it != urls.end(); ++it )
         m_urlQueue.append( qMakePair( K3b::convertToLocalUrl(*it), dir ) );
+    m_totalFiles = m_urlQueue.count();
 }
 
 
@@ -90,6 +89,9 @@ K3b::DataUrlAddingDialog::DataUrlAddingDialog( DirItem* dir, QWidget* parent )
       m_iAddHiddenFiles(0),
       m_iAddSystemFiles(0),
       m_bCanceled(false),
+      m_bFinished(false),
+      m_bAddingUrl(false),
+      m_bAddUrlsScheduled(false),
       m_copyItems(false),
       m_totalFiles(0),
       m_filesHandled(0),
@@ -115,9 +117,11 @@ K3b::DataUrlAddingDialog::DataUrlAddingDialog( DirItem* dir, QWidget* parent )
     grid->addWidget( m_progressWidget, 1, 0, 1, 2 );
     grid->addWidget( buttonBox, 2, 0, 1, 2 );
 
-    m_dirSizeJob = new K3b::DirSizeJob( this );
-    connect( m_dirSizeJob, SIGNAL(finished(bool)),
-             this, SLOT(slotDirSizeDone(bool)) );
+    m_scanner = new K3b::DirScanner( m_doc, this );
+    connect( m_scanner, SIGNAL(batchesReady()),
+             this, SLOT(slotScannerBatches()) );
+    connect( m_scanner, SIGNAL(idle()),
+             this, SLOT(slotScannerBatches()) );
 
     // try to start with a reasonable size
     resize( (int)( fontMetrics().width( windowTitle() ) * 1.5 ), sizeHint().height() );
@@ -126,9 +130,8 @@ K3b::DataUrlAddingDialog::DataUrlAddingDialog( DirItem* dir, QWidget* parent )
 
 K3b::DataUrlAddingDialog::~DataUrlAddingDialog()
 {
-    // make sure the dir size job is finished
-    m_dirSizeJob->cancel();
-    K3b::SignalWaiter::waitForJob( m_dirSizeJob );
+    // make sure the scanner threads are finished
+    m_scanner->cancel();
 
     QString message = resultMessage();
     if( !message.isEmpty() )
@@ -198,11 +201,9 @@ void K3b::DataUrlAddingDialog::slotStartAddUrls()
         }
     }
 
+    updateScannerSettings();
     slotAddUrls();
-    if( !m_urlQueue.isEmpty() ) {
-        m_dirSizeJob->setUrls( m_urls );
-        m_dirSizeJob->setFollowSymlinks( m_doc->isoOptions().followSymbolicLinks() );
-        m_dirSizeJob->start();
+    if( !m_bFinished && !m_bCanceled ) {
         exec();
     }
 }
@@ -220,8 +221,17 @@ void K3b::DataUrlAddingDialog::slotStartCopyMoveItems()
 
 void K3b::DataUrlAddingDialog::slotAddUrls()
 {
-    if( m_bCanceled )
+    m_bAddUrlsScheduled = false;
+    if( m_bCanceled || m_bFinished )
+        return;
+
+    if( m_urlQueue.isEmpty() ) {
+        if( !m_scanner->isBusy() )
+            finishAddingUrls();
         return;
+    }
+
+    m_bAddingUrl = true;
 
     // add next url
     QUrl url = m_urlQueue.first().first;
@@ -246,10 +256,6 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
     ++m_filesHandled;
 
     m_infoLabel->setText( url.toLocalFile() );
-    if( m_totalFiles == 0 )
-        m_counterLabel->setText( QString("(%1)").arg(m_filesHandled) );
-    else
-        m_counterLabel->setText( QString("(%1/%2)").arg(m_filesHandled).arg(m_totalFiles) );
 
     //
     // 1. Check if we want and can add the url
@@ -447,7 +453,7 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
         // that means if it points to some folder above this one
         // if so we cannot follow it anyway
         if( isDir && isSymLink && !absoluteFilePath.startsWith( resolved ) ) {
-            bool followLink = dir->getDoc()->isoOptions().followSymbolicLinks() || m_bFolderLinksFollowAll;
+            bool followLink = m_doc->isoOptions().followSymbolicLinks() || m_bFolderLinksFollowAll;
             if( !followLink && !m_bFolderLinksAddAll ) {
                 switch( K3b::MultiChoiceDialog::choose( i18n("Adding link to folder"),
                                                       i18n("<p>'%1' is a symbolic link to folder '%2'."
@@ -487,15 +493,6 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
             if( followLink ) {
                 absoluteFilePath = resolved;
                 isSymLink = false;
-
-                // count the files in the followed dir
-                if( m_dirSizeJob->active() )
-                    m_dirSizeQueue.append( QUrl::fromLocalFile(absoluteFilePath) );
-                else {
-                    m_progressWidget->setMaximum( 0 );
-                    m_dirSizeJob->setUrls( QList<QUrl>() << QUrl::fromLocalFile(absoluteFilePath) );
-                    m_dirSizeJob->start();
-                }
             }
         }
     }
@@ -511,9 +508,9 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
         // only if the doc was not changed yet
         //
         if( m_urls.count() == 1 &&
-            !dir->getDoc()->isModified() &&
-            !dir->getDoc()->isSaved() ) {
-            dir->getDoc()->setVolumeID( K3b::removeFilenameExtension( newName ) );
+            !m_doc->isModified() &&
+            !m_doc->isSaved() ) {
+            m_doc->setVolumeID( K3b::removeFilenameExtension( newName ) );
         }
 
         if( isDir && !isSymLink ) {
@@ -521,33 +518,116 @@ void K3b::DataUrlAddingDialog::slotAddUrls()
                 newDirItem = new K3b::DirItem( newName );
                 newDirItem->setLocalPath( url.toLocalFile() ); // HACK: see k3bdiritem.h
                 dir->addDataItem( newDirItem );
-            }
 
-            QDir newDir( absoluteFilePath );
-            foreach( const QString& dir, newDir.entryList( QDir::AllEntries|QDir::Hidden|QDir::System|QDir::NoDotAndDotDot ) ) {
-                m_urlQueue.append( qMakePair( QUrl::fromLocalFile(absoluteFilePath + '/' + dir ), newDirItem ) );
+                // the contents of a new folder cannot clash with existing items.
+                // Thus, there is nothing to ask and the scanner can handle it.
+                updateScannerSettings();
+                m_scanner->scan( absoluteFilePath, newDirItem );
+            }
+            else {
+                QDir newDir( absoluteFilePath );
+                foreach( const QString& dir, newDir.entryList( QDir::AllEntries|QDir::Hidden|QDir::System|QDir::NoDotAndDotDot ) ) {
+                    m_urlQueue.append( qMakePair( QUrl::fromLocalFile(absoluteFilePath + '/' + dir ), newDirItem ) );
+                    ++m_totalFiles;
+                }
             }
         }
         else {
-            m_newItems[ dir ].append( new K3b::FileItem( &statBuf, &resolvedStatBuf, url.toLocalFile(), *dir->getDoc(), newName ) );
+            m_newItems[ dir ].append( new K3b::FileItem( &statBuf, &resolvedStatBuf, url.toLocalFile(), *m_doc, newName ) );
         }
     }
 
-    if( m_urlQueue.isEmpty() ) {
-        Q_FOREACH( DirItem* dir, m_newItems.keys() ) {
-            dir->addDataItems( m_newItems[ dir ] );
-        }
-        m_dirSizeJob->cancel();
-        m_progressWidget->setMaximum( 100 );
-        accept();
-    }
-    else {
+    m_bAddingUrl = false;
+
+    // the user might have made decisions the scanner needs to know about
+    updateScannerSettings();
+
+    if( !m_urlQueue.isEmpty() ) {
         updateProgress();
+        scheduleAddUrls();
+    }
+    else if( !m_scanner->isBusy() ) {
+        finishAddingUrls();
+    }
+}
+
+
+void K3b::DataUrlAddingDialog::slotScannerBatches()
+{
+    if( m_bCanceled || m_bFinished )
+        return;
+
+    addScannedItems();
+
+    if( !m_urlQueue.isEmpty() )
+        scheduleAddUrls();
+    else if( !m_bAddingUrl && !m_scanner->isBusy() )
+        finishAddingUrls();
+
+    updateProgress();
+}
+
+
+void K3b::DataUrlAddingDialog::scheduleAddUrls()
+{
+    // only one url at a time since handling one might open a dialog
+    if( !m_bAddUrlsScheduled && !m_bAddingUrl ) {
+        m_bAddUrlsScheduled = true;
         QMetaObject::invokeMethod( this, "slotAddUrls", Qt::QueuedConnection );
     }
 }
 
 
+void K3b::DataUrlAddingDialog::addScannedItems()
+{
+    Q_FOREACH( const DirScanner::Batch& batch, m_scanner->takeBatches() ) {
+        batch.dir->addDataItems( batch.items );
+
+        // let the user decide on the entries the scanner could not handle
+        Q_FOREACH( const QString& path, batch.pending ) {
+            m_urlQueue.append( qMakePair( QUrl::fromLocalFile( path ), batch.dir ) );
+        }
+        m_unreadableFiles += batch.unreadable;
+
+        if( !batch.items.isEmpty() )
+            m_infoLabel->setText( batch.dir->localPath() );
+    }
+}
+
+
+void K3b::DataUrlAddingDialog::finishAddingUrls()
+{
+    addScannedItems();
+    if( !m_urlQueue.isEmpty() ) {
+        scheduleAddUrls();
+        return;
+    }
+
+    if( m_bFinished )
+        return;
+
+    m_bFinished = true;
+    Q_FOREACH( DirItem* dir, m_newItems.keys() ) {
+        dir->addDataItems( m_newItems[ dir ] );
+    }
+    m_newItems.clear();
+    m_progressWidget->setMaximum( 100 );
+    accept();
+}
+
+
+void K3b::DataUrlAddingDialog::updateScannerSettings()
+{
+    m_scanner->setHiddenFiles( DirScanner::Decision( m_iAddHiddenFiles ) );
+    m_scanner->setSystemFiles( DirScanner::Decision( m_iAddSystemFiles ) );
+    m_scanner->setFollowFolderLinks( m_doc->isoOptions().followSymbolicLinks() || m_bFolderLinksFollowAll );
+    m_scanner->setAddFolderLinks( m_bFolderLinksAddAll );
+
+    const K3b::ExternalBin* mkisofsBin = k3bcore->externalBinManager()->binObject( "mkisofs" );
+    m_scanner->setAllowLargeFiles( mkisofsBin && mkisofsBin->hasFeature( "no-4gb-limit" ) );
+}
+
+
 void K3b::DataUrlAddingDialog::slotCopyMoveItems()
 {
     if( m_bCanceled )
@@ -691,7 +771,6 @@ void K3b::DataUrlAddingDialog::slotCopyMoveItems()
     }
 
     if( m_items.isEmpty() ) {
-        m_dirSizeJob->cancel();
         accept();
     }
     else {
@@ -704,32 +783,28 @@ void K3b::DataUrlAddingDialog::slotCopyMoveItems()
 void K3b::DataUrlAddingDialog::reject()
 {
     m_bCanceled = true;
-    m_dirSizeJob->cancel();
-    QDialog::reject();
-}
 
+    // keep what has been scanned so far, like we keep the items added so far
+    m_scanner->cancel();
+    addScannedItems();
 
-void K3b::DataUrlAddingDialog::slotDirSizeDone( bool success )
-{
-    if( success ) {
-        m_totalFiles += m_dirSizeJob->totalFiles() + m_dirSizeJob->totalDirs();
-        if( m_dirSizeQueue.isEmpty() ) {
-            m_progressWidget->setValue( 100 );
-            updateProgress();
-        }
-        else {
-            m_dirSizeJob->setUrls( QList<QUrl>() << m_dirSizeQueue.back() );
-            m_dirSizeQueue.pop_back();
-            m_dirSizeJob->start();
-        }
-    }
+    QDialog::reject();
 }
 
 
 void K3b::DataUrlAddingDialog::updateProgress()
 {
-    if( m_totalFiles > 0 ) {
-        unsigned int p = 100*m_filesHandled/m_totalFiles;
+    // the scanner counts the entries as a by-product
+    const KIO::filesize_t totalFiles = m_totalFiles + m_scanner->entriesFound();
+    const KIO::filesize_t filesHandled = m_filesHandled + m_scanner->entriesHandled();
+
+    if( totalFiles == 0 )
+        m_counterLabel->setText( QString("(%1)").arg(filesHandled) );
+    else
+        m_counterLabel->setText( QString("(%1/%2)").arg(filesHandled).arg(totalFiles) );
+
+    if( totalFiles > 0 ) {
+        unsigned int p = 100*filesHandled/totalFiles;
         if( p > m_lastProgress ) {
             m_lastProgress = p;
             m_progressWidget->setValue( p );
@@ -737,7 +812,7 @@ void K3b::DataUrlAddingDialog::updateProgress()
     }
     else {
         // make sure the progress bar shows something
-        m_progressWidget->setValue( m_filesHandled );
+        m_progressWidget->setValue( filesHandled );
     }
 }
 
@@ -34,7 +34,7 @@ namespace K3b {
     class DataItem;
     class DirItem;
     class EncodingConverter;
-    class DirSizeJob;
+    class DirScanner;
     class DataDoc;
 
     class DataUrlAddingDialog : public QDialog
@@ -63,7 +63,7 @@ namespace K3b {
         void slotAddUrls();
         void slotCopyMoveItems();
         void reject() override;
-        void slotDirSizeDone( bool );
+        void slotScannerBatches();
         void updateProgress();
 
     private:
@@ -73,6 +73,10 @@ namespace K3b {
         bool getNewName( const QString& oldName, DirItem* dir, QString& newName );
         bool addHiddenFiles();
         bool addSystemFiles();
+        void updateScannerSettings();
+        void addScannedItems();
+        void scheduleAddUrls();
+        void finishAddingUrls();
         QString resultMessage() const;
 
         QProgressBar* m_progressWidget;
@@ -83,7 +87,6 @@ namespace K3b {
         QList<QUrl> m_urls;
         QList< QPair<QUrl, DirItem*> > m_urlQueue;
         QList< QPair<DataItem*, DirItem*> > m_items;
-        QList<QUrl> m_dirSizeQueue;
         QHash< DirItem*, QList<DataItem*> > m_newItems;
 
         DataDoc* m_doc;
@@ -102,11 +105,14 @@ namespace K3b {
         QStringList m_invalidFilenameEncodingFiles;
 
         bool m_bCanceled;
+        bool m_bFinished;
+        bool m_bAddingUrl;
+        bool m_bAddUrlsScheduled;
         bool m_copyItems;
 
         KIO::filesize_t m_totalFiles;
         KIO::filesize_t m_filesHandled;
-        DirSizeJob* m_dirSizeJob;
+        DirScanner* m_scanner;
 
         unsigned int m_lastProgress;
     };
@@ -0,0 +1,493 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include <config-k3b.h>
+
+#include "k3bdirscanner.h"
+#include "k3bencodingconverter.h"
+
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bglobals.h"
+
+#include <QAtomicInt>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_STAT64
+#define k3b_fstatat ::fstatat64
+#else
+#define k3b_fstatat ::fstatat
+#endif
+
+
+namespace {
+    // the maximum number of items in one batch
+    const int s_batchSize = 1024;
+
+    struct Task {
+        QString path;
+        K3b::DirItem* dir;
+    };
+
+    bool isSystemFile( mode_t mode )
+    {
+        return( S_ISCHR(mode) || S_ISBLK(mode) || S_ISFIFO(mode) || S_ISSOCK(mode) );
+    }
+}
+
+
+class K3b::DirScanner::Worker : public QThread
+{
+public:
+    Worker( K3b::DirScanner::Private* pd, int index )
+        : m_d( pd ),
+          m_index( index ) {
+    }
+
+    // the tasks of this worker. Other workers steal from the front.
+    QMutex mutex;
+    QList<Task> tasks;
+
+protected:
+    void run() override;
+
+private:
+    void scanDir( const Task& task, K3b::EncodingConverter& encodingConverter );
+
+    K3b::DirScanner::Private* m_d;
+    int m_index;
+};
+
+
+class K3b::DirScanner::Private
+{
+public:
+    Private( K3b::DirScanner* scanner, DataDoc* doc_ )
+        : q( scanner ),
+          doc( doc_ ),
+          nextWorker( 0 ),
+          pendingTasks( 0 ),
+          stop( false ),
+          hiddenFiles( Ask ),
+          systemFiles( Ask ),
+          followFolderLinks( false ),
+          addFolderLinks( false ),
+          allowLargeFiles( false ),
+          entriesFound( 0 ),
+          entriesHandled( 0 ),
+          totalFiles( 0 ),
+          totalDirs( 0 ),
+          totalSize( 0 ) {
+    }
+
+    K3b::DirScanner* q;
+    DataDoc* doc;
+
+    QVector<Worker*> workers;
+    int nextWorker;
+
+    // the number of queued or running tasks
+    QAtomicInt pendingTasks;
+
+    QMutex idleMutex;
+    QWaitCondition taskAvailable;
+    std::atomic<bool> stop;
+
+    // the settings may be changed by the user while scanning
+    std::atomic<int> hiddenFiles;
+    std::atomic<int> systemFiles;
+    std::atomic<bool> followFolderLinks;
+    std::atomic<bool> addFolderLinks;
+    std::atomic<bool> allowLargeFiles;
+
+    QMutex batchMutex;
+    QList<Batch> batches;
+
+    std::atomic<quint64> entriesFound;
+    std::atomic<quint64> entriesHandled;
+    std::atomic<quint64> totalFiles;
+    std::atomic<quint64> totalDirs;
+    std::atomic<quint64> totalSize;
+
+    void pushTask( int worker, const Task& task ) {
+        pendingTasks.ref();
+        Worker* w = workers[worker];
+        w->mutex.lock();
+        w->tasks.append( task );
+        w->mutex.unlock();
+
+        QMutexLocker locker( &idleMutex );
+        taskAvailable.wakeOne();
+    }
+
+    bool popTask( int worker, Task& task ) {
+        while( !stop ) {
+            // our own queue is used as a stack to stay close to the current folder
+            Worker* w = workers[worker];
+            w->mutex.lock();
+            if( !w->tasks.isEmpty() ) {
+                task = w->tasks.takeLast();
+                w->mutex.unlock();
+                return true;
+            }
+            w->mutex.unlock();
+
+            // steal the oldest folder of another worker which is likely the biggest chunk of work
+            for( int i = 1; i < workers.count(); ++i ) {
+                Worker* victim = workers[( worker + i ) % workers.count()];
+                QMutexLocker locker( &victim->mutex );
+                if( !victim->tasks.isEmpty() ) {
+                    task = victim->tasks.takeFirst();
+                    return true;
+                }
+            }
+
+            QMutexLocker locker( &idleMutex );
+            if( !stop )
+                taskAvailable.wait( &idleMutex, 100 );
+        }
+        return false;
+    }
+
+    void taskDone() {
+        if( !pendingTasks.deref() )
+            QMetaObject::invokeMethod( q, "idle", Qt::QueuedConnection );
+    }
+
+    void addBatch( Batch& batch ) {
+        if( batch.items.isEmpty() && batch.pending.isEmpty() && batch.unreadable.isEmpty() )
+            return;
+
+        batchMutex.lock();
+        const bool notify = batches.isEmpty();
+        batches.append( batch );
+        batchMutex.unlock();
+
+        if( notify )
+            QMetaObject::invokeMethod( q, "batchesReady", Qt::QueuedConnection );
+
+        batch.items.clear();
+        batch.pending.clear();
+        batch.unreadable.clear();
+    }
+};
+
+
+void K3b::DirScanner::Worker::run()
+{
+    // iconv descriptors cannot be shared between threads
+    K3b::EncodingConverter encodingConverter;
+
+    Task task;
+    while( m_d->popTask( m_index, task ) ) {
+        scanDir( task, encodingConverter );
+        m_d->taskDone();
+    }
+}
+
+
+void K3b::DirScanner::Worker::scanDir( const Task& task, K3b::EncodingConverter& encodingConverter )
+{
+    Batch batch;
+    batch.dir = task.dir;
+
+    if( m_d->stop )
+        return;
+
+    //
+    // readdir() uses getdents64 internally and gives us the names in large
+    // chunks. The entries are stat'ed relative to the folder to save the
+    // path lookup for every entry.
+    //
+    DIR* dh = ::opendir( QFile::encodeName( task.path ).constData() );
+    if( !dh ) {
+        batch.unreadable.append( task.path );
+        m_d->addBatch( batch );
+        return;
+    }
+    const int fd = ::dirfd( dh );
+
+    const QString prefix = task.path + QLatin1Char( '/' );
+
+    while( !m_d->stop ) {
+        struct dirent* ent = ::readdir( dh );
+        if( !ent )
+            break;
+
+        const char* rawName = ent->d_name;
+        if( rawName[0] == '.' && ( rawName[1] == '\0' || ( rawName[1] == '.' && rawName[2] == '\0' ) ) )
+            continue;
+
+        ++m_d->entriesFound;
+
+        const QByteArray encodedName( rawName );
+        const QString name = QFile::decodeName( encodedName );
+        const QString path = prefix + name;
+
+        k3b_struct_stat statBuf;
+        k3b_struct_stat resolvedStatBuf;
+        ::memset( &resolvedStatBuf, 0, sizeof(resolvedStatBuf) );
+
+        //
+        // Everything out of the ordinary is handled by the GUI which
+        // asks the user and reports problems.
+        //
+        if( !encodingConverter.encodedLocally( encodedName ) ||
+            k3b_fstatat( fd, rawName, &statBuf, AT_SYMLINK_NOFOLLOW ) != 0 ||
+            name.endsWith( QLatin1Char( '\\' ) ) ) {
+            batch.pending.append( path );
+            continue;
+        }
+
+        if( rawName[0] == '.' ) {
+            const int hidden = m_d->hiddenFiles;
+            if( hidden == Skip ) {
+                ++m_d->entriesHandled;
+                continue;
+            }
+            else if( hidden == Ask ) {
+                batch.pending.append( path );
+                continue;
+            }
+        }
+
+        const bool isSymLink = S_ISLNK( statBuf.st_mode );
+        bool isDir = S_ISDIR( statBuf.st_mode );
+        bool systemFile = isSystemFile( statBuf.st_mode );
+        QString resolved;
+
+        if( isSymLink ) {
+            resolved = K3b::resolveLink( path );
+            if( resolved.isEmpty() || k3b_stat( QFile::encodeName( resolved ), &resolvedStatBuf ) != 0 ) {
+                // broken links count as system files
+                systemFile = true;
+            }
+            else {
+                isDir = S_ISDIR( resolvedStatBuf.st_mode );
+                systemFile = isSystemFile( resolvedStatBuf.st_mode );
+            }
+        }
+        else if( ::faccessat( fd, rawName, R_OK, 0 ) != 0 ||
+                 ( S_ISREG( statBuf.st_mode ) &&
+                   (unsigned long long)statBuf.st_size >= 0xFFFFFFFFULL &&
+                   !m_d->allowLargeFiles ) ) {
+            batch.pending.append( path );
+            continue;
+        }
+
+        if( systemFile ) {
+            const int system = m_d->systemFiles;
+            if( system == Skip ) {
+                ++m_d->entriesHandled;
+                continue;
+            }
+            else if( system == Ask ) {
+                batch.pending.append( path );
+                continue;
+            }
+        }
+
+        K3b::DataItem* item = 0;
+        QString dirPath = path;
+        if( isDir && isSymLink ) {
+            // links which point to a parent folder cannot be followed
+            if( !path.startsWith( resolved ) ) {
+                if( m_d->followFolderLinks )
+                    dirPath = resolved;
+                else if( !m_d->addFolderLinks ) {
+                    batch.pending.append( path );
+                    continue;
+                }
+            }
+            if( dirPath == path )
+                isDir = false;
+        }
+
+        if( isDir ) {
+            K3b::DirItem* dirItem = new K3b::DirItem( name );
+            dirItem->setLocalPath( path ); // HACK: see k3bdiritem.h
+            item = dirItem;
+            ++m_d->totalDirs;
+
+            Task subTask;
+            subTask.path = dirPath;
+            subTask.dir = dirItem;
+            m_d->pushTask( m_index, subTask );
+        }
+        else {
+            item = new K3b::FileItem( &statBuf, &resolvedStatBuf, path, *m_d->doc, name );
+            ++m_d->totalFiles;
+            m_d->totalSize += (quint64)statBuf.st_size;
+        }
+
+        batch.items.append( item );
+        ++m_d->entriesHandled;
+
+        if( batch.items.count() >= s_batchSize )
+            m_d->addBatch( batch );
+    }
+
+    ::closedir( dh );
+
+    // even when canceled the created items need to be handed out
+    m_d->addBatch( batch );
+}
+
+
+K3b::DirScanner::DirScanner( DataDoc* doc, QObject* parent )
+    : QObject( parent ),
+      d( new Private( this, doc ) )
+{
+}
+
+
+K3b::DirScanner::~DirScanner()
+{
+    cancel();
+
+    // make sure no items are leaked
+    Q_FOREACH( const Batch& batch, takeBatches() ) {
+        batch.dir->addDataItems( batch.items );
+    }
+
+    qDeleteAll( d->workers );
+    delete d;
+}
+
+
+void K3b::DirScanner::setHiddenFiles( Decision dec )
+{
+    d->hiddenFiles = dec;
+}
+
+
+void K3b::DirScanner::setSystemFiles( Decision dec )
+{
+    d->systemFiles = dec;
+}
+
+
+void K3b::DirScanner::setFollowFolderLinks( bool b )
+{
+    d->followFolderLinks = b;
+}
+
+
+void K3b::DirScanner::setAddFolderLinks( bool b )
+{
+    d->addFolderLinks = b;
+}
+
+
+void K3b::DirScanner::setAllowLargeFiles( bool b )
+{
+    d->allowLargeFiles = b;
+}
+
+
+void K3b::DirScanner::scan( const QString& path, DirItem* dir )
+{
+    if( d->workers.isEmpty() ) {
+        const int count = qBound( 2, QThread::idealThreadCount(), 8 );
+        for( int i = 0; i < count; ++i )
+            d->workers.append( new Worker( d, i ) );
+    }
+
+    d->stop = false;
+    Q_FOREACH( Worker* worker, d->workers ) {
+        if( !worker->isRunning() )
+            worker->start();
+    }
+
+    Task task;
+    task.path = path;
+    task.dir = dir;
+    d->pushTask( d->nextWorker, task );
+    d->nextWorker = ( d->nextWorker + 1 ) % d->workers.count();
+}
+
+
+bool K3b::DirScanner::isBusy() const
+{
+    return d->pendingTasks.load() > 0;
+}
+
+
+void K3b::DirScanner::cancel()
+{
+    d->idleMutex.lock();
+    d->stop = true;
+    d->taskAvailable.wakeAll();
+    d->idleMutex.unlock();
+
+    Q_FOREACH( Worker* worker, d->workers ) {
+        worker->wait();
+        // forget the folders nobody will scan
+        d->pendingTasks.fetchAndAddOrdered( -worker->tasks.count() );
+        worker->tasks.clear();
+    }
+}
+
+
+QList<K3b::DirScanner::Batch> K3b::DirScanner::takeBatches()
+{
+    QMutexLocker locker( &d->batchMutex );
+    QList<Batch> batches = d->batches;
+    d->batches.clear();
+    return batches;
+}
+
+
+KIO::filesize_t K3b::DirScanner::entriesFound() const
+{
+    return d->entriesFound;
+}
+
+
+KIO::filesize_t K3b::DirScanner::entriesHandled() const
+{
+    return d->entriesHandled;
+}
+
+
+KIO::filesize_t K3b::DirScanner::totalFiles() const
+{
+    return d->totalFiles;
+}
+
+
+KIO::filesize_t K3b::DirScanner::totalDirs() const
+{
+    return d->totalDirs;
+}
+
+
+KIO::filesize_t K3b::DirScanner::totalSize() const
+{
+    return d->totalSize;
+}
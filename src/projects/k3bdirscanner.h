@@ -0,0 +1,157 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_DIR_SCANNER_H_
+#define _K3B_DIR_SCANNER_H_
+
+#include <KIO/Global>
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+
+namespace K3b {
+
+    class DataDoc;
+    class DataItem;
+    class DirItem;
+
+    /**
+     * Scans local folders with several threads and creates the data items
+     * for their contents off the GUI thread.
+     *
+     * Every scanned folder is one unit of work. Worker threads take folders
+     * from their own queue and steal from the other queues when their own
+     * queue runs empty. The created items are handed out in batches which
+     * are meant to be added to their folder with DirItem::addDataItems() in
+     * the GUI thread. New folder items are not attached to their parent
+     * before their batch has been added, so the scanner never touches items
+     * which are part of the project.
+     *
+     * Entries which need a decision by the user (hidden files, system files,
+     * links to folders) or which cannot be added (unreadable files, invalid
+     * filename encoding, ...) are not handled by the scanner. They are
+     * handed out as pending entries instead.
+     */
+    class DirScanner : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * How to handle entries which require a user decision. The values
+         * match the tristate used in DataUrlAddingDialog.
+         */
+        enum Decision {
+            Skip = -1,
+            Ask = 0,
+            Add = 1
+        };
+
+        struct Batch {
+            /**
+             * The folder the items are supposed to be added to.
+             */
+            DirItem* dir;
+            QList<DataItem*> items;
+
+            /**
+             * Local paths of entries which could not be handled by the scanner.
+             */
+            QStringList pending;
+
+            /**
+             * Folders which could not be read.
+             */
+            QStringList unreadable;
+        };
+
+        explicit DirScanner( DataDoc* doc, QObject* parent = 0 );
+        ~DirScanner() override;
+
+        void setHiddenFiles( Decision d );
+        void setSystemFiles( Decision d );
+
+        /**
+         * Follow links to folders. Otherwise they are pending
+         * unless setAddFolderLinks() is true.
+         */
+        void setFollowFolderLinks( bool b );
+
+        /**
+         * Add links to folders as links without asking.
+         */
+        void setAddFolderLinks( bool b );
+
+        /**
+         * Allow files of 4 GB and bigger. Otherwise such files are pending.
+         */
+        void setAllowLargeFiles( bool b );
+
+        /**
+         * Scan the contents of @p path into @p dir.
+         * The threads are started on first use.
+         */
+        void scan( const QString& path, DirItem* dir );
+
+        /**
+         * \return true while there are unfinished folders.
+         */
+        bool isBusy() const;
+
+        /**
+         * Stops the scanning and waits for the threads. Items which have
+         * already been created are still available through takeBatches().
+         */
+        void cancel();
+
+        QList<Batch> takeBatches();
+
+        /**
+         * The number of folder entries found so far.
+         */
+        KIO::filesize_t entriesFound() const;
+
+        /**
+         * The number of folder entries which have been turned into
+         * items or were skipped. Does not include pending entries.
+         */
+        KIO::filesize_t entriesHandled() const;
+
+        KIO::filesize_t totalFiles() const;
+        KIO::filesize_t totalDirs() const;
+        KIO::filesize_t totalSize() const;
+
+    Q_SIGNALS:
+        /**
+         * Emitted when new batches are available after the last call
+         * to takeBatches().
+         */
+        void batchesReady();
+
+        /**
+         * Emitted when all scheduled folders have been scanned.
+         */
+        void idle();
+
+    private:
+        class Worker;
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
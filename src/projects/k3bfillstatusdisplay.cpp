@@ -281,6 +281,9 @@ void K3b::FillStatusDisplayWidget::paintEvent( QPaintEvent* )
 // ----------------------------------------------------------------------------------------------------
 
 
+// the display is refreshed at most this often (msecs), no matter how fast items are added
+static const int s_updateInterval = 100;
+
 
 class K3b::FillStatusDisplay::Private
 {
@@ -314,6 +317,7 @@ public:
     K3b::Doc* doc;
 
     QTimer updateTimer;
+    bool docChanged;
 
     void setCdSize( const K3b::Msf& size );
 };
@@ -374,6 +378,8 @@ K3b::FillStatusDisplay::FillStatusDisplay( K3b::Doc* doc, QWidget *parent )
 {
     d = new Private;
     d->doc = doc;
+    d->docChanged = false;
+    d->updateTimer.setInterval( s_updateInterval );
 
     d->displayWidget = new K3b::FillStatusDisplayWidget( doc, this );
     d->buttonMenu = new QToolButton( this );
@@ -391,7 +397,8 @@ K3b::FillStatusDisplay::FillStatusDisplay( K3b::Doc* doc, QWidget *parent )
     setupPopupMenu();
 
     connect( d->doc, SIGNAL(changed()), this, SLOT(slotDocChanged()) );
-    connect( &d->updateTimer, SIGNAL(timeout()), this, SLOT(slotUpdateDisplay()) );
+    connect( d->doc, SIGNAL(sizeChanged()), this, SLOT(slotDocChanged()) );
+    connect( &d->updateTimer, SIGNAL(timeout()), this, SLOT(slotUpdateTimeout()) );
     connect( k3bappcore->mediaCache(), SIGNAL(mediumChanged(K3b::Device::Device*)),
              this, SLOT(slotMediumChanged(K3b::Device::Device*)) );
 
@@ -825,6 +832,8 @@ void K3b::FillStatusDisplay::slotSaveUserDefaults()
 
 void K3b::FillStatusDisplay::slotUpdateDisplay()
 {
+    d->docChanged = false;
+
     if( d->actionAuto->isChecked() ) {
         //
         // also update the medium list in case the docs size exceeds the capacity
@@ -839,15 +848,28 @@ void K3b::FillStatusDisplay::slotUpdateDisplay()
 
 void K3b::FillStatusDisplay::slotDocChanged()
 {
-    // cache updates
-    if( !d->updateTimer.isActive() ) {
+    // coalesce updates: the first change is shown right away, all following
+    // changes are collected and shown with the next timer tick
+    if( d->updateTimer.isActive() ) {
+        d->docChanged = true;
+    }
+    else {
         slotUpdateDisplay();
-        d->updateTimer.setSingleShot( false );
-        d->updateTimer.start( 500 );
+        d->updateTimer.start();
     }
 }
 
 
+void K3b::FillStatusDisplay::slotUpdateTimeout()
+{
+    // stop ticking once the doc does not change anymore
+    if( d->docChanged )
+        slotUpdateDisplay();
+    else
+        d->updateTimer.stop();
+}
+
+
 bool K3b::FillStatusDisplay::event( QEvent* event )
 {
     if ( event->type() == QEvent::ToolTip ) {
@@ -93,6 +93,7 @@ namespace K3b {
         void slotDocChanged();
         void slotMediumChanged( K3b::Device::Device* dev );
         void slotUpdateDisplay();
+        void slotUpdateTimeout();
 
         void slotLoadUserDefaults();
         void slotSaveUserDefaults();
@@ -105,7 +105,7 @@ bool K3b::MusicBrainzTrackLookupJob::run()
         }
 
         // FIXME: useless since libmusicbrainz does never need all the data
-        emit percent( 100LL*dataRead/trackReader.size() );
+        setProgress( 100LL*dataRead/trackReader.size() );
     }
 
     if( canceled() ) {
@@ -16,6 +16,7 @@
 
 #include "k3baudioripjob.h"
 
+#include "k3baccuraterip.h"
 #include "k3bcdparanoialib.h"
 #include "k3bcore.h"
 #include "k3bdevice.h"
@@ -26,6 +27,8 @@
 
 #include <KLocalizedString>
 
+#include <QHash>
+
 
 namespace K3b {
 
@@ -38,7 +41,9 @@ public:
           neverSkip(false),
           paranoiaLib(0),
           device(0),
-          useIndex0(false) {
+          useIndex0(false),
+          burstMode(false),
+          securePass(false) {
     }
     int paranoiaMode;
     int paranoiaRetries;
@@ -50,11 +55,21 @@ public:
     Device::Device* device;
 
     bool useIndex0;
+
+    bool burstMode;
+    bool securePass;
+    QString discId;
+    AccurateRipDatabase database;
+    QHash<int, AccurateRipChecksum> checksums;
+    QList<int> repeatTracks;
 };
 
 
 namespace {
 
+// one second of audio
+const int s_maxBatchSectors = 75;
+
 class AudioCdReader : public QIODevice
 {
 public:
@@ -70,13 +85,19 @@ protected:
 private:
     int m_trackIndex;
     AudioRipJob::Private* d;
+
+    // the part of the last batch which has not been consumed yet
+    const char* m_pending;
+    qint64 m_pendingLength;
 };
 
 
 AudioCdReader::AudioCdReader( int trackIndex, AudioRipJob::Private* priv, QObject* parent )
     : QIODevice( parent ),
       m_trackIndex( trackIndex ),
-      d( priv )
+      d( priv ),
+      m_pending( 0 ),
+      m_pendingLength( 0 )
 {
 }
 
@@ -92,7 +113,16 @@ bool AudioCdReader::open( OpenMode mode )
                         : tt.lastSector().lba() );
 
         if( d->paranoiaLib->initReading( tt.firstSector().lba(), endSec ) ) {
-            return QIODevice::open( mode );
+            m_pending = 0;
+            m_pendingLength = 0;
+
+            if( d->burstMode )
+                d->checksums.insert( m_trackIndex, AccurateRipChecksum( endSec - tt.firstSector().lba() + 1,
+                                                                        m_trackIndex == 1,
+                                                                        m_trackIndex == d->toc.count() ) );
+
+            // let the reader pass its whole buffer to readData() so we can read big batches
+            return QIODevice::open( mode | QIODevice::Unbuffered );
         }
         else {
             setErrorString( i18n("Error while initializing audio ripping.") );
@@ -123,23 +153,32 @@ qint64 AudioCdReader::writeData( const char* /*data*/, qint64 /*len*/ )
 }
 
 
-qint64 AudioCdReader::readData( char* data, qint64 /*maxlen*/ )
+qint64 AudioCdReader::readData( char* data, qint64 maxlen )
 {
-    int status = 0;
-    char* buf = d->paranoiaLib->read( &status );
-    if( status == CdparanoiaLib::S_OK ) {
-        if( buf == 0 ) {
+    if( m_pendingLength == 0 ) {
+        int status = 0;
+        int sectors = 0;
+        char* buf = d->paranoiaLib->readSectors( int( qBound<qint64>( 1, maxlen / CD_FRAMESIZE_RAW, s_maxBatchSectors ) ),
+                                                 &sectors, &status );
+        if( status != CdparanoiaLib::S_OK ) {
+            setErrorString( i18n("Unrecoverable error while ripping track %1.",m_trackIndex) );
             return -1;
         }
-        else {
-            ::memcpy( data, buf, CD_FRAMESIZE_RAW );
-            return CD_FRAMESIZE_RAW;
+        else if( buf == 0 ) {
+            return -1;
         }
+        m_pending = buf;
+        m_pendingLength = qint64( sectors ) * CD_FRAMESIZE_RAW;
+
+        if( d->burstMode )
+            d->checksums[m_trackIndex].update( m_pending, m_pendingLength );
     }
-    else {
-        setErrorString( i18n("Unrecoverable error while ripping track %1.",m_trackIndex) );
-        return -1;
-    }
+
+    const qint64 len = qMin( maxlen, m_pendingLength );
+    ::memcpy( data, m_pending, len );
+    m_pending += len;
+    m_pendingLength -= len;
+    return len;
 }
 
 } // namespace
@@ -182,12 +221,24 @@ void AudioRipJob::setUseIndex0( bool b )
 }
 
 
+void AudioRipJob::setBurstMode( bool b )
+{
+    d->burstMode = b;
+}
+
+
 void AudioRipJob::setDevice( Device::Device* device )
 {
     d->device = device;
 }
 
 
+Device::Device* AudioRipJob::executionDevice() const
+{
+    return d->device;
+}
+
+
 QString AudioRipJob::jobDescription() const
 {
     if( cddbEntry().get( KCDDB::Title ).toString().isEmpty() )
@@ -256,6 +307,17 @@ bool AudioRipJob::init()
     d->paranoiaLib->setNeverSkip( d->neverSkip );
     d->paranoiaLib->setMaxRetries( d->paranoiaRetries );
 
+    if( d->burstMode ) {
+        // the first pass reads at full speed, paranoia is only used for re-reads
+        d->paranoiaLib->setParanoiaMode( 0 );
+        d->securePass = false;
+        d->checksums.clear();
+        d->repeatTracks.clear();
+        d->discId = AccurateRipDatabase::discId( d->toc );
+        if( !d->database.load() )
+            emit infoMessage( i18n("Unable to read the checksum database %1.", d->database.fileName()), Job::MessageWarning );
+    }
+
 
     if( d->useIndex0 ) {
         emit newSubTask( i18n("Searching index 0 for all tracks") );
@@ -269,6 +331,9 @@ bool AudioRipJob::init()
 
 void AudioRipJob::cleanup()
 {
+    if( d->burstMode && d->database.isModified() && !d->database.save() )
+        emit infoMessage( i18n("Unable to save the checksum database %1.", d->database.fileName()), Job::MessageWarning );
+
     d->paranoiaLib->close();
     d->device->block(false);
 }
@@ -304,10 +369,70 @@ void AudioRipJob::trackStarted(int trackIndex)
 
 void AudioRipJob::trackFinished( int trackIndex, const QString& filename )
 {
+    if( d->burstMode ) {
+        const AccurateRipChecksum checksum = d->checksums.value( trackIndex );
+        const QString checksums = QString::asprintf( "AccurateRip v1 %08X, v2 %08X, CRC32 %08X",
+                                                     checksum.v1(), checksum.v2(), checksum.crc32() );
+
+        if( !checksum.isComplete() ) {
+            // the track has not been read up to its end, there is nothing to verify
+            emit infoMessage( i18n("The checksum of track %1 is incomplete and cannot be verified.", trackIndex), Job::MessageWarning );
+        }
+        else if( d->securePass ) {
+            // only a clean secure read may serve as reference for later rips
+            if( d->paranoiaLib->readErrors() == 0 && d->paranoiaLib->status() == CdparanoiaLib::S_OK ) {
+                d->database.add( d->discId, trackIndex, checksum );
+                emit infoMessage( i18n("Track %1 has been read in secure mode (%2).", trackIndex, checksums), Job::MessageInfo );
+            }
+            else {
+                emit infoMessage( i18n("Track %1 could not be read without errors in secure mode and is not added "
+                                       "to the checksum database (%2).", trackIndex, checksums), Job::MessageWarning );
+            }
+        }
+        else if( d->paranoiaLib->readErrors() > 0 ) {
+            emit infoMessage( i18np("Track %2 had 1 read error and will be read again in secure mode.",
+                                    "Track %2 had %1 read errors and will be read again in secure mode.",
+                                    d->paranoiaLib->readErrors(), trackIndex), Job::MessageWarning );
+            d->repeatTracks.append( trackIndex );
+        }
+        else {
+            switch( d->database.verify( d->discId, trackIndex, checksum ) ) {
+            case AccurateRipDatabase::Match:
+                emit infoMessage( i18n("Track %1 has been ripped accurately (%2).", trackIndex, checksums), Job::MessageSuccess );
+                break;
+            case AccurateRipDatabase::Mismatch:
+                emit infoMessage( i18n("The checksums of track %1 do not match the checksum database (%2). "
+                                       "The track will be read again in secure mode.", trackIndex, checksums), Job::MessageWarning );
+                d->repeatTracks.append( trackIndex );
+                break;
+            case AccurateRipDatabase::Unknown:
+                emit infoMessage( i18n("Track %1 is not in the checksum database (%2). "
+                                       "The track will be read again in secure mode.", trackIndex, checksums), Job::MessageInfo );
+                d->repeatTracks.append( trackIndex );
+                break;
+            }
+        }
+    }
+
     emit infoMessage( i18n("Successfully ripped track %1 to %2.", trackIndex, filename), Job::MessageInfo );
 }
 
 
+QList<int> AudioRipJob::tracksToRepeat()
+{
+    if( !d->burstMode || d->securePass || d->repeatTracks.isEmpty() )
+        return QList<int>();
+
+    d->securePass = true;
+    d->paranoiaLib->setParanoiaMode( 3 );
+
+    emit newTask( i18np("Reading 1 track again in secure mode",
+                        "Reading %1 tracks again in secure mode",
+                        d->repeatTracks.count()) );
+    return d->repeatTracks;
+}
+
+
 } // namespace K3b
 
 
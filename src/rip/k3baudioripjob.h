@@ -41,6 +41,15 @@ namespace K3b {
         void setNeverSkip( bool b );
         void setUseIndex0( bool b );
 
+        /**
+         * In burst mode the tracks are read without paranoia first and
+         * their AccurateRip checksums are compared to the local checksum
+         * database. Tracks which do not match or had read errors are read
+         * again with full paranoia and their checksums are added to the
+         * database.
+         */
+        void setBurstMode( bool b );
+
         void setDevice( Device::Device* device );
 
         QString jobDescription() const override;
@@ -54,6 +63,8 @@ namespace K3b {
     private:
         void jobFinished( bool ) override;
 
+        Device::Device* executionDevice() const override;
+
         bool init() override;
 
         void cleanup() override;
@@ -66,6 +77,8 @@ namespace K3b {
 
         void trackFinished( int trackIndex, const QString& filename ) override;
 
+        QList<int> tracksToRepeat() override;
+
     private:
         QScopedPointer<Private> d;
     };
@@ -178,6 +178,7 @@ void K3b::AudioRippingDialog::setupGui()
     m_spinRetries = new QSpinBox( advancedPage );
     m_checkIgnoreReadErrors = new QCheckBox( i18n("Ignore read errors"), advancedPage );
     m_checkUseIndex0 = new QCheckBox( i18n("Do not read pregaps"), advancedPage );
+    m_checkBurstMode = new QCheckBox( i18n("Burst mode with checksum verification"), advancedPage );
 
     advancedPageLayout->addWidget( new QLabel( i18n("Paranoia mode:"), advancedPage ), 0, 0 );
     advancedPageLayout->addWidget( m_comboParanoiaMode, 0, 1 );
@@ -185,7 +186,8 @@ void K3b::AudioRippingDialog::setupGui()
     advancedPageLayout->addWidget( m_spinRetries, 1, 1 );
     advancedPageLayout->addWidget( m_checkIgnoreReadErrors, 2, 0, 0, 1 );
     advancedPageLayout->addWidget( m_checkUseIndex0, 3, 0, 0, 1 );
-    advancedPageLayout->setRowStretch( 4, 1 );
+    advancedPageLayout->addWidget( m_checkBurstMode, 4, 0, 0, 1 );
+    advancedPageLayout->setRowStretch( 5, 1 );
     advancedPageLayout->setColumnStretch( 2, 1 );
 
     // -------------------------------------------------------------------------------------------
@@ -217,6 +219,14 @@ void K3b::AudioRippingDialog::setupContextHelp()
                                          "software is to include the pregaps for most CDs, it makes more "
                                          "sense to ignore them. In any case, when creating a K3b audio "
                                          "project, the pregaps will be regenerated.</p>") );
+    m_checkBurstMode->setToolTip( i18n("Read the tracks at full speed and only read them again if they cannot be verified") );
+    m_checkBurstMode->setWhatsThis( i18n("<p>If this option is checked K3b reads all tracks at full speed "
+                                         "without paranoia first and calculates their AccurateRip checksums "
+                                         "and CRC32 while ripping. The checksums are compared to a local database "
+                                         "of tracks which have been verified before.</p>"
+                                         "<p>Only the tracks which do not match the database or had read errors "
+                                         "are read again with full paranoia. Their checksums are then added "
+                                         "to the database.</p>") );
 }
 
 
@@ -292,6 +302,7 @@ void K3b::AudioRippingDialog::slotStartClicked()
     job->setNeverSkip( !m_checkIgnoreReadErrors->isChecked() );
     job->setEncoder( encoder );
     job->setUseIndex0( m_checkUseIndex0->isChecked() );
+    job->setBurstMode( m_checkBurstMode->isChecked() );
     job->setWriteCueFile( m_optionWidget->createSingleFile() && m_optionWidget->createCueFile() );
     if( m_optionWidget->createPlaylist() )
         job->setWritePlaylist( d->playlistFilename, m_optionWidget->playlistRelativePath() );
@@ -446,6 +457,7 @@ void K3b::AudioRippingDialog::loadSettings( const KConfigGroup& c )
     m_spinRetries->setValue( c.readEntry( "read_retries", 5 ) );
     m_checkIgnoreReadErrors->setChecked( !c.readEntry( "never_skip", true ) );
     m_checkUseIndex0->setChecked( c.readEntry( "use_index0", false ) );
+    m_checkBurstMode->setChecked( c.readEntry( "burst_mode", false ) );
 
     m_optionWidget->loadConfig( c );
     m_patternWidget->loadConfig( c );
@@ -460,6 +472,7 @@ void K3b::AudioRippingDialog::saveSettings( KConfigGroup c )
     c.writeEntry( "read_retries", m_spinRetries->value() );
     c.writeEntry( "never_skip", !m_checkIgnoreReadErrors->isChecked() );
     c.writeEntry( "use_index0", m_checkUseIndex0->isChecked() );
+    c.writeEntry( "burst_mode", m_checkBurstMode->isChecked() );
 
     m_optionWidget->saveConfig( c );
     m_patternWidget->saveConfig( c );
@@ -67,6 +67,7 @@ namespace K3b {
         QSpinBox* m_spinRetries;
         QCheckBox* m_checkIgnoreReadErrors;
         QCheckBox* m_checkUseIndex0;
+        QCheckBox* m_checkBurstMode;
 
         CddbPatternWidget* m_patternWidget;
         AudioConvertingOptionWidget* m_optionWidget;
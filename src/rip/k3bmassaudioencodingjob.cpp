@@ -15,6 +15,7 @@
 #include "k3bmassaudioencodingjob.h"
 #include "k3baudioencoder.h"
 #include "k3bcuefilewriter.h"
+#include "k3bglobals.h"
 #include "k3bwavefilewriter.h"
 
 #include <KLocalizedString>
@@ -24,6 +25,7 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QSet>
 #include <QTextStream>
 
 #include <vector>
@@ -212,6 +214,12 @@ void MassAudioEncodingJob::cleanup()
 }
 
 
+QList<int> MassAudioEncodingJob::tracksToRepeat()
+{
+    return QList<int>();
+}
+
+
 bool MassAudioEncodingJob::run()
 {
     if ( !init() )
@@ -249,6 +257,33 @@ bool MassAudioEncodingJob::run()
         lastFilename = currentTask->track.key();
     }
 
+    if( !canceled() && success ) {
+        const QList<int> repeat = tracksToRepeat();
+        if( !repeat.isEmpty() ) {
+            // all tracks sharing a file with a repeated track are encoded again
+            QSet<QString> files;
+            for( std::vector<Task>::const_iterator it = tasks.begin(); it != tasks.end(); ++it ) {
+                if( repeat.contains( it->tracknumber ) )
+                    files.insert( it->filename );
+            }
+
+            std::vector<Task> repeatTasks;
+            for( std::vector<Task>::const_iterator it = tasks.begin(); it != tasks.end(); ++it ) {
+                if( files.contains( it->filename ) ) {
+                    repeatTasks.push_back( *it );
+                    d->overallBytesToRead += trackLength( it->tracknumber ).audioBytes();
+                }
+            }
+            tasks.swap( repeatTasks );
+
+            lastFilename.clear();
+            for( currentTask = tasks.begin(); success && currentTask != tasks.end(); ++currentTask ) {
+                success = encodeTrack( currentTask->track.value(), currentTask->track.key(), lastFilename );
+                lastFilename = currentTask->track.key();
+            }
+        }
+    }
+
     if( d->encoder )
         d->encoder->closeFile();
     if( d->waveFileWriter )
@@ -341,8 +376,9 @@ bool K3b::MassAudioEncodingJob::encodeTrack( int trackIndex, const QString& file
     // do the conversion
     // ----------------------
 
-    char buffer[10*1024];
-    const qint64 bufferLength = 10LL*1024LL;
+    // big enough for sources which read many CD sectors at once
+    char buffer[64*1024];
+    const qint64 bufferLength = 64LL*1024LL;
     qint64 readLength = 0;
     qint64 readFile = 0;
 
@@ -359,12 +395,7 @@ bool K3b::MassAudioEncodingJob::encodeTrack( int trackIndex, const QString& file
                 // the tracks produce big endian samples
                 // and encoder encoder consumes little endian
                 // so we need to swap the bytes here
-                char b;
-                for( qint64 i = 0; i < bufferLength-1; i+=2 ) {
-                    b = buffer[i];
-                    buffer[i] = buffer[i+1];
-                    buffer[i+1] = b;
-                }
+                K3b::swapByteOrder16( buffer, readLength );
             }
 
             if( d->encoder->encode( buffer, readLength ) < 0 ) {
@@ -382,8 +413,8 @@ bool K3b::MassAudioEncodingJob::encodeTrack( int trackIndex, const QString& file
 
         d->overallBytesRead += readLength;
         readFile += readLength;
-        emit subPercent( 100LL*readFile/source->size() );
-        emit percent( 100LL*d->overallBytesRead/d->overallBytesToRead );
+        setSubProgress( 100LL*readFile/source->size() );
+        setProgress( 100LL*d->overallBytesRead/d->overallBytesToRead );
     }
 
     if( !canceled() && !source->atEnd() ) {
@@ -19,6 +19,7 @@
 #include "k3bthreadjob.h"
 
 #include <QHash>
+#include <QList>
 #include <QMultiMap>
 #include <QScopedPointer>
 #include <QString>
@@ -120,6 +121,14 @@ namespace K3b {
          * Prints information about previously processed track
          */
         virtual void trackFinished( int trackIndex, const QString& filename ) = 0;
+
+        /**
+         * Called once all tracks have been encoded. Returns the 1-based
+         * indexes of the tracks which need to be read and encoded again.
+         * The files containing them are rewritten completely.
+         * By default returns an empty list.
+         */
+        virtual QList<int> tracksToRepeat();
         
     private:
         bool run() override;
@@ -354,6 +354,18 @@ void K3b::VideoDVDRippingJob::initProgressInfo()
     d->titleProgressParts.resize( m_titleRipInfos.count() );
     d->titleClippingProgressParts.resize( m_titleRipInfos.count() );
 
+    // using my knowledge of the internals of the clipping detection job: it decodes 200 frames
+    // of every chapter unless the values have been detected before
+    QVector<unsigned long long> clippingFrames( m_titleRipInfos.count(), 0ULL );
+    if( d->autoClipping ) {
+        for( int i = 0; i < m_titleRipInfos.count(); ++i ) {
+            int top, left, bottom, right;
+            if( !K3b::VideoDVDTitleDetectClippingJob::cachedClipping( m_dvd, m_titleRipInfos[i].title,
+                                                                     top, left, bottom, right ) )
+                clippingFrames[i] = m_dvd[m_titleRipInfos[i].title-1].numChapters() * 200;
+        }
+    }
+
     unsigned long long totalFrames = 0ULL;
     for( int i = 0; i < m_titleRipInfos.count(); ++i ) {
         if( m_transcodingJob->twoPassEncoding() )
@@ -361,10 +373,7 @@ void K3b::VideoDVDRippingJob::initProgressInfo()
         else
             totalFrames += m_dvd[m_titleRipInfos[i].title-1].playbackTime().totalFrames();
 
-        // using my knowledge of the internals of the clipping detection job: it decodes 200 frames
-        // of every chapter
-        if( d->autoClipping )
-            totalFrames += m_dvd[m_titleRipInfos[i].title-1].numChapters() * 200;
+        totalFrames += clippingFrames[i];
     }
 
     for( int i = 0; i < m_titleRipInfos.count(); ++i ) {
@@ -372,9 +381,7 @@ void K3b::VideoDVDRippingJob::initProgressInfo()
         if( m_transcodingJob->twoPassEncoding() )
             titleFrames *= 2;
 
-        // using my knowledge of the internals of the clipping detection job: it decodes 200 frames
-        // of every chapter
-        unsigned long long titleClippingFrames = m_dvd[m_titleRipInfos[i].title-1].numChapters() * 200;
+        unsigned long long titleClippingFrames = clippingFrames[i];
 
         if (totalFrames) {
             d->titleProgressParts[i] = (double)titleFrames/(double)totalFrames;
@@ -0,0 +1,162 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baccurateriptest.h"
+#include "k3baccuraterip.h"
+#include "k3btoc.h"
+#include "k3btrack.h"
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <algorithm>
+
+QTEST_GUILESS_MAIN( AccurateRipTest )
+
+namespace
+{
+    const int s_sectorSize = 2352;
+
+    QByteArray samples( int sectors, quint32 value )
+    {
+        QByteArray data( sectors * s_sectorSize, Qt::Uninitialized );
+        for( int i = 0; i < data.size(); i += 4 ) {
+            data[i] = char( value & 0xFF );
+            data[i+1] = char( ( value >> 8 ) & 0xFF );
+            data[i+2] = char( ( value >> 16 ) & 0xFF );
+            data[i+3] = char( ( value >> 24 ) & 0xFF );
+        }
+        return data;
+    }
+}
+
+AccurateRipTest::AccurateRipTest()
+{
+}
+
+void AccurateRipTest::testCrc32()
+{
+    K3b::AccurateRipChecksum checksum;
+    checksum.update( "123456789", 9 );
+    QCOMPARE( checksum.crc32(), quint32( 0xCBF43926 ) );
+}
+
+void AccurateRipTest::testChecksum()
+{
+    // the checksums are the sums of the samples multiplied by their 1-based position
+    K3b::AccurateRipChecksum checksum( 1, false, false );
+    const QByteArray data = samples( 1, 1 );
+    checksum.update( data.constData(), data.size() );
+    QVERIFY( checksum.isComplete() );
+    QCOMPARE( checksum.v1(), quint32( 588 * 589 / 2 ) );
+    QCOMPARE( checksum.v2(), quint32( 588 * 589 / 2 ) );
+
+    // v2 adds the upper half of the 64 bit product, v1 drops it
+    K3b::AccurateRipChecksum overflow( 1, false, false );
+    const QByteArray big = samples( 1, 0x80000000 );
+    overflow.update( big.constData(), 8 );
+    QCOMPARE( overflow.v1(), quint32( 0x80000000 ) );
+    QCOMPARE( overflow.v2(), quint32( 0x80000000 + 1 ) );
+    QVERIFY( !overflow.isComplete() );
+}
+
+void AccurateRipTest::testSkippedSamples()
+{
+    // only the samples before position 2940 are set
+    QByteArray data( 10 * s_sectorSize, '\0' );
+    data.replace( 0, 2939 * 4, samples( 5, 0x01010101 ).left( 2939 * 4 ) );
+
+    K3b::AccurateRipChecksum first( 10, true, false );
+    first.update( data.constData(), data.size() );
+    QCOMPARE( first.v1(), quint32( 0 ) );
+    QCOMPARE( first.v2(), quint32( 0 ) );
+
+    K3b::AccurateRipChecksum middle( 10, false, false );
+    middle.update( data.constData(), data.size() );
+    QVERIFY( middle.v1() != 0 );
+    QCOMPARE( middle.crc32(), first.crc32() );
+
+    // the last track leaves out its last five sectors
+    std::reverse( data.begin(), data.end() );
+    K3b::AccurateRipChecksum last( 10, false, true );
+    last.update( data.constData(), data.size() );
+    QCOMPARE( last.v1(), quint32( 0 ) );
+    QCOMPARE( last.v2(), quint32( 0 ) );
+}
+
+void AccurateRipTest::testChunks()
+{
+    QByteArray data( 3 * s_sectorSize, Qt::Uninitialized );
+    for( int i = 0; i < data.size(); ++i )
+        data[i] = char( ( i * 7919 ) >> 3 );
+
+    K3b::AccurateRipChecksum whole( 3, true, true );
+    whole.update( data.constData(), data.size() );
+
+    K3b::AccurateRipChecksum chunked( 3, true, true );
+    int pos = 0;
+    for( int len = 1; pos < data.size(); len = len * 3 % 1001 + 1 ) {
+        len = qMin( len, data.size() - pos );
+        chunked.update( data.constData() + pos, len );
+        pos += len;
+    }
+
+    QVERIFY( chunked.isComplete() );
+    QCOMPARE( chunked.v1(), whole.v1() );
+    QCOMPARE( chunked.v2(), whole.v2() );
+    QCOMPARE( chunked.crc32(), whole.crc32() );
+}
+
+void AccurateRipTest::testDiscId()
+{
+    K3b::Device::Toc toc;
+    toc.append( K3b::Device::Track( 0, 999, K3b::Device::Track::TYPE_AUDIO ) );
+    toc.append( K3b::Device::Track( 1000, 1999, K3b::Device::Track::TYPE_AUDIO ) );
+
+    // offsets 0, 1000, and lead-out 2000
+    QCOMPARE( K3b::AccurateRipDatabase::discId( toc ),
+              QString( "002-00000bb8-00001f41-%1" ).arg( toc.discId(), 8, 16, QChar( '0' ) ) );
+    QVERIFY( K3b::AccurateRipDatabase::discId( K3b::Device::Toc() ).isEmpty() );
+}
+
+void AccurateRipTest::testDatabase()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString fileName = dir.path() + "/sub/accuraterip.db";
+
+    const QByteArray data = samples( 2, 0x00010002 );
+    K3b::AccurateRipChecksum checksum( 2, false, false );
+    checksum.update( data.constData(), data.size() );
+
+    const QByteArray other = samples( 2, 0x00030004 );
+    K3b::AccurateRipChecksum otherChecksum( 2, false, false );
+    otherChecksum.update( other.constData(), other.size() );
+
+    K3b::AccurateRipDatabase db( fileName );
+    QVERIFY( db.load() );
+    QCOMPARE( db.verify( "disc", 1, checksum ), K3b::AccurateRipDatabase::Unknown );
+    QVERIFY( db.add( "disc", 1, checksum ) );
+    QVERIFY( !db.add( "disc", 1, checksum ) );
+    QVERIFY( db.isModified() );
+    QVERIFY( db.save() );
+    QVERIFY( !db.isModified() );
+
+    K3b::AccurateRipDatabase loaded( fileName );
+    QVERIFY( loaded.load() );
+    QCOMPARE( loaded.verify( "disc", 1, checksum ), K3b::AccurateRipDatabase::Match );
+    QCOMPARE( loaded.verify( "disc", 1, otherChecksum ), K3b::AccurateRipDatabase::Mismatch );
+    QCOMPARE( loaded.verify( "disc", 2, checksum ), K3b::AccurateRipDatabase::Unknown );
+    QCOMPARE( loaded.verify( "other", 1, checksum ), K3b::AccurateRipDatabase::Unknown );
+}
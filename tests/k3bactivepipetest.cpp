@@ -0,0 +1,95 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bactivepipetest.h"
+#include "k3bactivepipe.h"
+
+#include <QBuffer>
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN( ActivePipeTest )
+
+namespace {
+    class SlowBuffer : public QBuffer
+    {
+    protected:
+        qint64 writeData( const char* data, qint64 len ) override {
+            QThread::msleep( 1 );
+            return QBuffer::writeData( data, qMin( len, qint64( 4096 ) ) );
+        }
+    };
+
+    QByteArray testData( int size )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for( int i = 0; i < size; ++i )
+            data[i] = char( i*13 + i/509 );
+        return data;
+    }
+}
+
+ActivePipeTest::ActivePipeTest()
+{
+}
+
+void ActivePipeTest::testPumping_data()
+{
+    QTest::addColumn<qint64>( "bufferSize" );
+
+    QTest::newRow( "no fifo" ) << qint64( 0 );
+    QTest::newRow( "small fifo" ) << qint64( 4096 );
+    QTest::newRow( "odd fifo" ) << qint64( 100003 );
+    QTest::newRow( "large fifo" ) << qint64( 8*1024*1024 );
+}
+
+void ActivePipeTest::testPumping()
+{
+    QFETCH( qint64, bufferSize );
+
+    QByteArray data = testData( 2*1024*1024 + 7 );
+    QBuffer source( &data );
+    QBuffer sink;
+
+    K3b::ActivePipe pipe;
+    pipe.setBufferSize( bufferSize );
+    pipe.readFrom( &source, true );
+    pipe.writeTo( &sink, true );
+    QVERIFY( pipe.open( true ) );
+
+    QTRY_VERIFY_WITH_TIMEOUT( !sink.isOpen(), 10000 );
+    QCOMPARE( pipe.bytesRead(), quint64( data.size() ) );
+    QCOMPARE( pipe.bytesWritten(), quint64( data.size() ) );
+    QCOMPARE( sink.data(), data );
+}
+
+void ActivePipeTest::testFifoWaitsForSlowSink()
+{
+    QByteArray data = testData( 512*1024 );
+    QBuffer source( &data );
+    SlowBuffer sink;
+
+    K3b::ActivePipe pipe;
+    pipe.setBufferSize( 64*1024 );
+    pipe.setWatermarks( 100, 10 );
+    pipe.readFrom( &source, true );
+    pipe.writeTo( &sink, true );
+    QVERIFY( pipe.open( true ) );
+
+    QTRY_VERIFY_WITH_TIMEOUT( !sink.isOpen(), 20000 );
+    QCOMPARE( sink.data(), data );
+
+    // the source is a lot faster than the sink
+    QVERIFY( pipe.sourceStalls() > 0 );
+}
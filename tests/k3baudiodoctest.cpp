@@ -0,0 +1,220 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiodoctest.h"
+#include "k3baudiodoc.h"
+#include "k3baudiotrack.h"
+#include "k3baudiotrackreader.h"
+#include "k3baudiozerodata.h"
+
+#include <QScopedPointer>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( AudioDocTest )
+
+namespace {
+    K3b::AudioTrack* createTrack( const K3b::Msf& length )
+    {
+        K3b::AudioTrack* track = new K3b::AudioTrack();
+        track->addSource( new K3b::AudioZeroData( length ) );
+        return track;
+    }
+
+    // the length as it was computed before it was maintained incrementally
+    K3b::Msf summedLength( const K3b::AudioDoc& doc )
+    {
+        K3b::Msf length;
+        for( K3b::AudioTrack* track = doc.firstTrack(); track; track = track->next() )
+            length += track->length();
+        return length;
+    }
+}
+
+
+AudioDocTest::AudioDocTest()
+{
+}
+
+
+void AudioDocTest::testAddRemoveTracks()
+{
+    K3b::AudioDoc doc;
+    QCOMPARE( doc.length(), K3b::Msf() );
+
+    K3b::AudioTrack* track1 = createTrack( 1000 );
+    doc.addTrack( track1, 0 );
+    QCOMPARE( doc.length(), K3b::Msf( 1000 ) );
+
+    K3b::AudioTrack* track2 = createTrack( 500 );
+    doc.addTrack( track2, 99 );
+    K3b::AudioTrack* track3 = createTrack( 250 );
+    doc.addTrack( track3, 0 );
+    QCOMPARE( doc.length(), K3b::Msf( 1750 ) );
+    QCOMPARE( doc.size(), K3b::Msf( 1750 ).mode1Bytes() );
+
+    doc.removeTrack( track2 );
+    QCOMPARE( doc.length(), K3b::Msf( 1250 ) );
+
+    doc.moveTrack( track3, track1 );
+    QCOMPARE( doc.length(), K3b::Msf( 1250 ) );
+
+    doc.clear();
+    QCOMPARE( doc.length(), K3b::Msf() );
+}
+
+
+void AudioDocTest::testSourceChanges()
+{
+    K3b::AudioDoc doc;
+    K3b::AudioTrack* track = createTrack( 1000 );
+    doc.addTrack( track, 0 );
+
+    K3b::AudioZeroData* zero1 = new K3b::AudioZeroData( 300 );
+    K3b::AudioZeroData* zero2 = new K3b::AudioZeroData( 200 );
+    track->addSource( zero1 );
+    track->addSource( zero2 );
+    QCOMPARE( doc.length(), K3b::Msf( 1500 ) );
+
+    // offset and length changes
+    zero1->setLength( 400 );
+    QCOMPARE( doc.length(), K3b::Msf( 1600 ) );
+    track->firstSource()->setStartOffset( 100 );
+    QCOMPARE( doc.length(), summedLength( doc ) );
+
+    // removing a source which is neither first nor last
+    delete zero1;
+    QCOMPARE( doc.length(), summedLength( doc ) );
+    QCOMPARE( doc.length(), K3b::Msf( 1100 ) );
+
+    // removing the last source removes the track
+    delete track->firstSource();
+    delete zero2;
+    QCOMPARE( doc.numOfTracks(), 0 );
+    QCOMPARE( doc.length(), K3b::Msf() );
+}
+
+
+void AudioDocTest::testSplitAndMerge()
+{
+    K3b::AudioDoc doc;
+    K3b::AudioTrack* track = createTrack( 1000 );
+    doc.addTrack( track, 0 );
+    doc.addTrack( createTrack( 200 ), 99 );
+
+    K3b::AudioTrack* splitTrack = track->split( 400 );
+    QVERIFY( splitTrack );
+    QCOMPARE( doc.numOfTracks(), 3 );
+    QCOMPARE( track->length(), K3b::Msf( 400 ) );
+    QCOMPARE( doc.length(), summedLength( doc ) );
+
+    const K3b::Msf length = doc.length();
+    track->merge( splitTrack, track->lastSource() );
+    QCOMPARE( doc.numOfTracks(), 2 );
+    QCOMPARE( doc.length(), length );
+    QCOMPARE( doc.length(), summedLength( doc ) );
+}
+
+
+void AudioDocTest::testMoveBetweenDocs()
+{
+    K3b::AudioDoc doc1;
+    K3b::AudioDoc doc2;
+    K3b::AudioTrack* track = createTrack( 1000 );
+    doc1.addTrack( track, 0 );
+    doc1.addTrack( createTrack( 100 ), 99 );
+    doc2.addTrack( createTrack( 50 ), 0 );
+
+    track->moveAfter( doc2.firstTrack() );
+    QCOMPARE( doc1.length(), K3b::Msf( 100 ) );
+    QCOMPARE( doc2.length(), K3b::Msf( 1050 ) );
+
+    delete track->take();
+    QCOMPARE( doc2.length(), K3b::Msf( 50 ) );
+}
+
+
+void AudioDocTest::testTrackReaderPeek()
+{
+    // destroyed after the reader
+    QScopedPointer<K3b::AudioTrack> track( createTrack( 10 ) );
+    track->addSource( new K3b::AudioZeroData( 5 ) );
+
+    K3b::AudioTrackReader reader( *track );
+    QVERIFY( reader.open( QIODevice::ReadOnly | QIODevice::Unbuffered ) );
+    QCOMPARE( reader.size(), qint64( 15*2352 ) );
+
+    // reading and peeking can be mixed
+    char buffer[1000];
+    QCOMPARE( reader.read( buffer, sizeof( buffer ) ), qint64( sizeof( buffer ) ) );
+
+    // peeking does not consume the data
+    const char* data = 0;
+    const char* again = 0;
+    const qint64 len = reader.peekData( &data, 2352 );
+    QVERIFY( len > 0 );
+    QCOMPARE( reader.peekData( &again, 2352 ), len );
+    QVERIFY( again == data );
+    QCOMPARE( reader.pos(), qint64( sizeof( buffer ) ) );
+
+    qint64 total = sizeof( buffer );
+    while( !reader.atEnd() ) {
+        const qint64 r = reader.peekData( &data, 4*2352 );
+        QVERIFY( r > 0 );
+        QVERIFY( r <= 4*2352 );
+        for( qint64 i = 0; i < r; ++i )
+            QCOMPARE( data[i], char( 0 ) );
+        reader.consumeData( r );
+        total += r;
+        QCOMPARE( reader.pos(), total );
+    }
+    QCOMPARE( total, reader.size() );
+
+    // seeking back into the first source
+    QVERIFY( reader.seek( 2352 ) );
+    QVERIFY( reader.peekData( &data, 2352 ) > 0 );
+
+    reader.close();
+}
+
+
+void AudioDocTest::testTrackReaderPeekRemovedSource()
+{
+    QScopedPointer<K3b::AudioTrack> track( createTrack( 10 ) );
+    track->addSource( new K3b::AudioZeroData( 5 ) );
+
+    K3b::AudioTrackReader reader( *track );
+    QVERIFY( reader.open( QIODevice::ReadOnly | QIODevice::Unbuffered ) );
+
+    const char* data = 0;
+    const qint64 len = reader.peekData( &data, 2352 );
+    QVERIFY( len > 0 );
+
+    // the peeked data stays valid but is not consumed from the next source
+    delete track->firstSource()->take();
+    QCOMPARE( data[len-1], char( 0 ) );
+    reader.consumeData( len );
+    QCOMPARE( reader.pos(), qint64( 0 ) );
+
+    // the remaining source is read from its start
+    qint64 total = 0;
+    qint64 r = 0;
+    while( ( r = reader.peekData( &data, 4*2352 ) ) > 0 ) {
+        reader.consumeData( r );
+        total += r;
+    }
+    QCOMPARE( total, qint64( 5*2352 ) );
+    QCOMPARE( reader.size(), total );
+
+    reader.close();
+}
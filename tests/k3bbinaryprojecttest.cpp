@@ -0,0 +1,128 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bbinaryprojecttest.h"
+#include "k3bbinaryproject.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+
+#include <QDir>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( BinaryProjectTest )
+
+
+BinaryProjectTest::BinaryProjectTest()
+{
+}
+
+
+void BinaryProjectTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    for( int i = 0; i < 10; ++i ) {
+        QFile f( QString( "%1/file%2" ).arg( m_dir.path() ).arg( i ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( QByteArray( 100*i, 'z' ) );
+    }
+}
+
+
+void BinaryProjectTest::testEncodeDecode()
+{
+    QDomDocument doc( "k3b_test_project" );
+    QDomElement root = doc.createElement( "k3b_test_project" );
+    doc.appendChild( root );
+    for( int i = 0; i < 100; ++i ) {
+        QDomElement e = doc.createElement( "file" );
+        e.setAttribute( "name", QString( "name%1" ).arg( i ) );
+        e.setAttribute( "activated", "yes" );
+        QDomElement url = doc.createElement( "url" );
+        url.appendChild( doc.createTextNode( QString::fromUtf8( "/tmp/\xc3\xa4 %1" ).arg( i ) ) );
+        e.appendChild( url );
+        root.appendChild( e );
+    }
+    root.appendChild( doc.createCDATASection( "<raw>" ) );
+
+    const QByteArray data = K3b::BinaryProject::encode( doc );
+    QVERIFY( data.size() < doc.toByteArray( 0 ).size() );
+
+    QDomDocument decoded;
+    QVERIFY( K3b::BinaryProject::decode( data.constData(), data.size(), decoded ) );
+    QCOMPARE( decoded.doctype().name(), QString( "k3b_test_project" ) );
+    QCOMPARE( decoded.toString(), doc.toString() );
+}
+
+
+void BinaryProjectTest::testInvalidData()
+{
+    QDomDocument doc( "k3b_test_project" );
+    QDomElement root = doc.createElement( "k3b_test_project" );
+    doc.appendChild( root );
+    root.appendChild( doc.createElement( "general" ) );
+    const QByteArray data = K3b::BinaryProject::encode( doc );
+
+    QDomDocument decoded;
+    for( int i = 0; i < data.size(); ++i ) {
+        QVERIFY( !K3b::BinaryProject::decode( data.constData(), i, decoded ) );
+    }
+
+    QByteArray broken( data );
+    broken[0] = 'X';
+    QVERIFY( !K3b::BinaryProject::decode( broken.constData(), broken.size(), decoded ) );
+}
+
+
+void BinaryProjectTest::testDataProject()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    K3b::DirItem* dir = new K3b::DirItem( "dir" );
+    doc.root()->addDataItem( dir );
+    for( int i = 0; i < 10; ++i ) {
+        dir->addDataItem( new K3b::FileItem( QString( "%1/file%2" ).arg( m_dir.path() ).arg( i ), doc ) );
+    }
+
+    const QString filename = m_dir.path() + "/project" + K3b::BinaryProject::extension();
+    QVERIFY( K3b::BinaryProject::save( &doc, filename ) );
+    QVERIFY( K3b::BinaryProject::isBinaryProject( filename ) );
+
+    QDomDocument xmlDoc;
+    QVERIFY( K3b::BinaryProject::load( filename, xmlDoc ) );
+    QCOMPARE( xmlDoc.doctype().name(), QString( "k3b_data_project" ) );
+
+    K3b::DataDoc loaded;
+    K3b::Doc* loadedDoc = &loaded;
+    QDomElement root = xmlDoc.documentElement();
+    QVERIFY( loadedDoc->loadDocumentData( &root ) );
+
+    QCOMPARE( loaded.size(), doc.size() );
+    K3b::DataItem* loadedDir = loaded.root()->find( "dir" );
+    QVERIFY( loadedDir && loadedDir->isDir() );
+    QCOMPARE( static_cast<K3b::DirItem*>( loadedDir )->children().count(), 10 );
+
+    K3b::FileItem* original = static_cast<K3b::FileItem*>( dir->children().at( 3 ) );
+    K3b::FileItem* item = static_cast<K3b::FileItem*>( static_cast<K3b::DirItem*>( loadedDir )->children().at( 3 ) );
+    QCOMPARE( item->localPath(), original->localPath() );
+    QCOMPARE( item->localModificationTime(), original->localModificationTime() );
+    QVERIFY( item->localId() == original->localId() );
+
+    // nothing changed, so the background check keeps all items
+    QTest::qWait( 500 );
+    QCOMPARE( static_cast<K3b::DirItem*>( loadedDir )->children().count(), 10 );
+}
@@ -0,0 +1,181 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bbufferpooltest.h"
+#include "k3bbufferpool.h"
+
+#include <QTest>
+#include <QThread>
+
+#include <string.h>
+
+#include <utility>
+
+QTEST_GUILESS_MAIN( BufferPoolTest )
+
+using K3b::BufferPool;
+
+namespace
+{
+    class AllocatingThread : public QThread
+    {
+    public:
+        explicit AllocatingThread( BufferPool* pool ) : m_pool( pool ) {}
+
+    protected:
+        void run() override {
+            for( int i = 0; i < 10000; ++i ) {
+                BufferPool::Buffer buffer = m_pool->allocate( 1 + i % 70000 );
+                buffer.data()[0] = 1;
+                // hand the buffer on without touching the reference count
+                BufferPool::Buffer next( std::move( buffer ) );
+                Q_ASSERT( buffer.isNull() );
+            }
+        }
+
+    private:
+        BufferPool* m_pool;
+    };
+}
+
+BufferPoolTest::BufferPoolTest()
+{
+}
+
+void BufferPoolTest::testSizeClasses()
+{
+    QCOMPARE( BufferPool::capacityForSize( 1 ), Q_INT64_C(4096) );
+    QCOMPARE( BufferPool::capacityForSize( 4096 ), Q_INT64_C(4096) );
+    QCOMPARE( BufferPool::capacityForSize( 4097 ), Q_INT64_C(8192) );
+    QCOMPARE( BufferPool::capacityForSize( 10*2352 ), Q_INT64_C(32768) );
+    QCOMPARE( BufferPool::capacityForSize( 64*1024*1024 ), Q_INT64_C(64*1024*1024) );
+
+    // bigger buffers are rounded to full pages
+    const qint64 big = BufferPool::capacityForSize( 64*1024*1024 + 1 );
+    QVERIFY( big > 64*1024*1024 );
+    QVERIFY( big < 64*1024*1024 + 65536 );
+
+    BufferPool pool;
+    QVERIFY( pool.allocate( 0 ).isNull() );
+    QVERIFY( pool.allocate( -1 ).isNull() );
+
+    BufferPool::Buffer buffer = pool.allocate( 1000 );
+    QVERIFY( !buffer.isNull() );
+    QCOMPARE( buffer.size(), Q_INT64_C(1000) );
+    QCOMPARE( buffer.capacity(), Q_INT64_C(4096) );
+}
+
+void BufferPoolTest::testAlignment()
+{
+    BufferPool pool;
+    BufferPool::Buffer small = pool.allocate( 100 );
+    QCOMPARE( quintptr( small.data() ) % 4096, quintptr( 0 ) );
+
+    BufferPool::Buffer huge = pool.allocate( 3*1024*1024 );
+    QCOMPARE( quintptr( huge.data() ) % ( 2*1024*1024 ), quintptr( 0 ) );
+    ::memset( huge.data(), 0xAB, huge.size() );
+}
+
+void BufferPoolTest::testSharing()
+{
+    BufferPool pool;
+    BufferPool::Buffer a = pool.allocate( 2048 );
+    QVERIFY( !a.isShared() );
+
+    BufferPool::Buffer b( a );
+    QVERIFY( a.isShared() );
+    QVERIFY( b.data() == a.data() );
+    QCOMPARE( pool.statistics().bytesInUse, Q_INT64_C(4096) );
+
+    a.release();
+    QVERIFY( a.isNull() );
+    QVERIFY( !b.isShared() );
+    QCOMPARE( pool.statistics().bytesInUse, Q_INT64_C(4096) );
+
+    // moving transfers the ownership
+    BufferPool::Buffer c( std::move( b ) );
+    QVERIFY( b.isNull() );
+    QVERIFY( !c.isShared() );
+
+    c = BufferPool::Buffer();
+    QCOMPARE( pool.statistics().bytesInUse, Q_INT64_C(0) );
+}
+
+void BufferPoolTest::testReuse()
+{
+    BufferPool pool;
+    BufferPool::Buffer a = pool.allocate( 5000 );
+    char* mem = a.data();
+    a.release();
+    QCOMPARE( pool.statistics().bytesCached, Q_INT64_C(8192) );
+
+    // the same size class is served from the free list
+    BufferPool::Buffer b = pool.allocate( 8000 );
+    QVERIFY( b.data() == mem );
+
+    const BufferPool::Statistics stats = pool.statistics();
+    QCOMPARE( stats.allocations, Q_UINT64_C(2) );
+    QCOMPARE( stats.reuses, Q_UINT64_C(1) );
+    QCOMPARE( stats.systemAllocations, Q_UINT64_C(1) );
+    QCOMPARE( stats.bytesCached, Q_INT64_C(0) );
+    QCOMPARE( stats.peakBytesInUse, Q_INT64_C(8192) );
+
+    b.release();
+    pool.clear();
+    QCOMPARE( pool.statistics().bytesCached, Q_INT64_C(0) );
+}
+
+void BufferPoolTest::testCacheLimit()
+{
+    BufferPool pool( 16*1024 );
+    BufferPool::Buffer a = pool.allocate( 16*1024 );
+    BufferPool::Buffer b = pool.allocate( 16*1024 );
+    a.release();
+    b.release();
+
+    // only one of the buffers fits into the cache
+    QCOMPARE( pool.statistics().bytesCached, Q_INT64_C(16384) );
+    QCOMPARE( pool.statistics().peakBytesInUse, Q_INT64_C(32768) );
+}
+
+void BufferPoolTest::testPoolDeletedFirst()
+{
+    BufferPool* pool = new BufferPool();
+    BufferPool::Buffer buffer = pool->allocate( 4096 );
+    delete pool;
+
+    // the buffer stays valid
+    ::memset( buffer.data(), 0, buffer.size() );
+    buffer.release();
+    QVERIFY( buffer.isNull() );
+}
+
+void BufferPoolTest::testThreads()
+{
+    BufferPool pool;
+    QList<AllocatingThread*> threads;
+    for( int i = 0; i < 4; ++i ) {
+        threads.append( new AllocatingThread( &pool ) );
+        threads.last()->start();
+    }
+    Q_FOREACH( AllocatingThread* thread, threads ) {
+        QVERIFY( thread->wait( 60000 ) );
+        delete thread;
+    }
+
+    const BufferPool::Statistics stats = pool.statistics();
+    QCOMPARE( stats.allocations, Q_UINT64_C(40000) );
+    QCOMPARE( stats.reuses + stats.systemAllocations, stats.allocations );
+    QCOMPARE( stats.bytesInUse, Q_INT64_C(0) );
+}
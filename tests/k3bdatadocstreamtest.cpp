@@ -0,0 +1,138 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdatadocstreamtest.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bisooptions.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QTest>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+QTEST_GUILESS_MAIN( DataDocStreamTest )
+
+namespace {
+    // enough files to make the loader use its threads
+    const int s_fileCount = 600;
+
+    QByteArray saveDoc( K3b::Doc* doc )
+    {
+        QBuffer buffer;
+        buffer.open( QIODevice::WriteOnly );
+        QXmlStreamWriter xml( &buffer );
+        xml.writeStartDocument();
+        xml.writeDTD( "<!DOCTYPE k3b_data_project>" );
+        xml.writeStartElement( "k3b_data_project" );
+        const bool success = doc->saveDocumentStream( &xml );
+        xml.writeEndElement();
+        xml.writeEndDocument();
+        return success ? buffer.data() : QByteArray();
+    }
+
+    bool loadDoc( K3b::Doc* doc, const QByteArray& data )
+    {
+        QXmlStreamReader xml( data );
+        while( !xml.atEnd() && !xml.isStartElement() )
+            xml.readNext();
+        return doc->loadDocumentStream( &xml );
+    }
+}
+
+
+DataDocStreamTest::DataDocStreamTest()
+{
+}
+
+
+void DataDocStreamTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    QVERIFY( QDir( m_dir.path() ).mkdir( "sub" ) );
+
+    QFile top( m_dir.path() + "/top.txt" );
+    QVERIFY( top.open( QIODevice::WriteOnly ) );
+    top.write( QByteArray( 5000, 'x' ) );
+
+    for( int i = 0; i < s_fileCount; ++i ) {
+        QFile f( QString( "%1/sub/file%2" ).arg( m_dir.path() ).arg( i ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( QByteArray( i, 'y' ) );
+    }
+}
+
+
+void DataDocStreamTest::testRoundTrip()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+
+    K3b::DirItem* sub = new K3b::DirItem( "sub" );
+    doc.root()->addDataItem( sub );
+    for( int i = 0; i < s_fileCount; ++i ) {
+        const QString path = QString( "%1/sub/file%2" ).arg( m_dir.path() ).arg( i );
+        sub->addDataItem( new K3b::FileItem( path, doc, QString( "renamed%1" ).arg( i ) ) );
+    }
+    K3b::FileItem* top = new K3b::FileItem( m_dir.path() + "/top.txt", doc );
+    top->setSortWeight( 42 );
+    doc.root()->addDataItem( top );
+    doc.setVolumeID( "STREAMTEST" );
+
+    const QByteArray data = saveDoc( &doc );
+    QVERIFY( !data.isEmpty() );
+
+    K3b::DataDoc loaded;
+    QVERIFY( loadDoc( &loaded, data ) );
+
+    QCOMPARE( loaded.isoOptions().volumeID(), QString( "STREAMTEST" ) );
+    QCOMPARE( loaded.root()->children().count(), 2 );
+    QCOMPARE( loaded.root()->numFiles(), doc.root()->numFiles() );
+    QCOMPARE( loaded.size(), doc.size() );
+
+    // the document order is kept
+    K3b::DataItem* loadedSub = loaded.root()->children().at( 0 );
+    QVERIFY( loadedSub->isDir() );
+    QCOMPARE( loadedSub->k3bName(), QString( "sub" ) );
+    const K3b::DirItem::Children& children = static_cast<K3b::DirItem*>( loadedSub )->children();
+    QCOMPARE( children.count(), s_fileCount );
+    for( int i = 0; i < s_fileCount; ++i ) {
+        QCOMPARE( children.at( i )->k3bName(), QString( "renamed%1" ).arg( i ) );
+        QCOMPARE( children.at( i )->localPath(), QString( "%1/sub/file%2" ).arg( m_dir.path() ).arg( i ) );
+    }
+
+    K3b::DataItem* loadedTop = loaded.root()->children().at( 1 );
+    QCOMPARE( loadedTop->k3bName(), QString( "top.txt" ) );
+    QCOMPARE( loadedTop->sortWeight(), 42L );
+    QCOMPARE( loadedTop->size(), KIO::filesize_t( 5000 ) );
+
+    // saving the loaded project results in the same document
+    QCOMPARE( saveDoc( &loaded ), data );
+}
+
+
+void DataDocStreamTest::testInvalidTag()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    QByteArray data = saveDoc( &doc );
+    QVERIFY( data.contains( "<files/>" ) );
+    data.replace( "<files/>", "<files><bogus/></files>" );
+
+    K3b::DataDoc loaded;
+    QVERIFY( !loadDoc( &loaded, data ) );
+}
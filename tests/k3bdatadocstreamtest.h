@@ -0,0 +1,34 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_DATA_DOC_STREAM_TEST_H
+#define K3B_DATA_DOC_STREAM_TEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class DataDocStreamTest : public QObject
+{
+    Q_OBJECT
+public:
+    DataDocStreamTest();
+private slots:
+    void initTestCase();
+    void testRoundTrip();
+    void testInvalidTag();
+private:
+    QTemporaryDir m_dir;
+};
+
+#endif // K3B_DATA_DOC_STREAM_TEST_H
@@ -0,0 +1,100 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdevicecapabilitycachetest.h"
+#include "k3bdevicecapabilitycache_p.h"
+
+#include <QDir>
+#include <QStandardPaths>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( DeviceCapabilityCacheTest )
+
+
+namespace {
+    K3b::Device::Capabilities dvdWriter()
+    {
+        K3b::Device::Capabilities caps;
+        caps.writingModesChecked = true;
+        caps.readCapabilities = K3b::Device::MEDIA_CD_ALL | K3b::Device::MEDIA_DVD_ALL;
+        caps.writeCapabilities = K3b::Device::MEDIA_CD_R | K3b::Device::MEDIA_CD_RW | K3b::Device::MEDIA_DVD_PLUS_R;
+        caps.supportedProfiles = K3b::Device::MEDIA_CD_R | K3b::Device::MEDIA_DVD_PLUS_R;
+        caps.writingModes = K3b::Device::WRITINGMODE_TAO | K3b::Device::WRITINGMODE_SAO;
+        caps.maxReadSpeed = 8310;
+        caps.maxWriteSpeed = 33240;
+        caps.bufferSize = 2048;
+        caps.dvdMinusTestwrite = false;
+        caps.burnfree = true;
+        return caps;
+    }
+}
+
+
+DeviceCapabilityCacheTest::DeviceCapabilityCacheTest()
+{
+}
+
+
+void DeviceCapabilityCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled( true );
+    QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) ).remove( "devicecapabilities" );
+}
+
+
+void DeviceCapabilityCacheTest::testLookup()
+{
+    const QString key = K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW", "1.00", "SERIAL1" );
+
+    K3b::Device::Capabilities caps;
+    QVERIFY( !K3b::Device::CapabilityCache::lookup( key, caps ) );
+
+    K3b::Device::CapabilityCache::store( key, dvdWriter() );
+    QVERIFY( K3b::Device::CapabilityCache::lookup( key, caps ) );
+    QVERIFY( caps == dvdWriter() );
+}
+
+
+void DeviceCapabilityCacheTest::testUpdate()
+{
+    const QString key1 = K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW", "1.00", "SERIAL1" );
+    const QString key2 = K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW", "1.00", "SERIAL2" );
+
+    K3b::Device::Capabilities other = dvdWriter();
+    other.writeCapabilities |= K3b::Device::MEDIA_DVD_R;
+    other.maxWriteSpeed = 27700;
+    QVERIFY( other != dvdWriter() );
+
+    K3b::Device::CapabilityCache::store( key2, other );
+
+    K3b::Device::Capabilities caps;
+    QVERIFY( K3b::Device::CapabilityCache::lookup( key1, caps ) );
+    QVERIFY( caps == dvdWriter() );
+    QVERIFY( K3b::Device::CapabilityCache::lookup( key2, caps ) );
+    QVERIFY( caps == other );
+
+    K3b::Device::CapabilityCache::store( key1, other );
+    QVERIFY( K3b::Device::CapabilityCache::lookup( key1, caps ) );
+    QVERIFY( caps == other );
+}
+
+
+void DeviceCapabilityCacheTest::testKey()
+{
+    // a firmware update invalidates the entry
+    QVERIFY( K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW", "1.00", "SERIAL1" ) !=
+             K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW", "1.01", "SERIAL1" ) );
+    QVERIFY( K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW", "1.00", QString() ) !=
+             K3b::Device::CapabilityCache::key( "VENDOR", "DVD-RW1.00", QString(), QString() ) );
+}
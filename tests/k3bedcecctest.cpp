@@ -0,0 +1,221 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bedcecctest.h"
+#include "k3bedcecc.h"
+
+#include <QByteArray>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( EdcEccTest )
+
+namespace
+{
+    unsigned char bcd( int value )
+    {
+        return ( ( value / 10 ) << 4 ) | ( value % 10 );
+    }
+
+    // a raw sector with sync pattern and header, everything else is zero
+    QByteArray rawSector( int lba, int mode )
+    {
+        QByteArray sector( K3b::Device::RAW_SECTOR_SIZE, '\0' );
+        for( int i = 1; i < 11; ++i )
+            sector[i] = char( 0xFF );
+
+        const int msf = lba + 150;
+        sector[12] = bcd( msf / 4500 );
+        sector[13] = bcd( msf / 75 % 60 );
+        sector[14] = bcd( msf % 75 );
+        sector[15] = mode;
+        return sector;
+    }
+
+    QByteArray mode1Sector( int lba )
+    {
+        QByteArray sector = rawSector( lba, 1 );
+        for( int i = 0; i < 2048; ++i )
+            sector[16+i] = char( ( i * 7 + lba ) & 0xFF );
+        K3b::Device::generateSectorEdcEcc( reinterpret_cast<unsigned char*>( sector.data() ) );
+        return sector;
+    }
+
+    QByteArray mode2Sector( int lba, bool form2 )
+    {
+        QByteArray sector = rawSector( lba, 2 );
+        const char submode = form2 ? 0x28 : 0x08;
+        sector[18] = submode;
+        sector[22] = submode;
+        for( int i = 0; i < ( form2 ? 2324 : 2048 ); ++i )
+            sector[24+i] = char( ( i * 13 + lba ) & 0xFF );
+        K3b::Device::generateSectorEdcEcc( reinterpret_cast<unsigned char*>( sector.data() ) );
+        return sector;
+    }
+
+    quint32 readLE32( const QByteArray& data, int pos )
+    {
+        return quint32( quint8( data[pos] ) ) |
+            ( quint32( quint8( data[pos+1] ) ) << 8 ) |
+            ( quint32( quint8( data[pos+2] ) ) << 16 ) |
+            ( quint32( quint8( data[pos+3] ) ) << 24 );
+    }
+
+    const unsigned char* bytes( const QByteArray& data )
+    {
+        return reinterpret_cast<const unsigned char*>( data.constData() );
+    }
+}
+
+EdcEccTest::EdcEccTest()
+{
+}
+
+void EdcEccTest::testEdc()
+{
+    QCOMPARE( K3b::Device::calcEdc( reinterpret_cast<const unsigned char*>( "123456789" ), 9 ), quint32( 0x6EC2EDC4 ) );
+
+    // the result must not depend on how the data is split
+    const QByteArray sector = mode1Sector( 0 );
+    const quint32 whole = K3b::Device::calcEdc( bytes( sector ), sector.size() );
+    for( int split = 0; split < 17; ++split ) {
+        const quint32 edc = K3b::Device::calcEdc( bytes( sector ), split );
+        QCOMPARE( K3b::Device::calcEdc( bytes( sector ) + split, sector.size() - split, edc ), whole );
+    }
+}
+
+void EdcEccTest::testSectorMode()
+{
+    QCOMPARE( K3b::Device::sectorMode( bytes( mode1Sector( 0 ) ) ), K3b::Device::Track::MODE1 );
+    QCOMPARE( K3b::Device::sectorMode( bytes( mode2Sector( 0, false ) ) ), K3b::Device::Track::XA_FORM1 );
+    QCOMPARE( K3b::Device::sectorMode( bytes( mode2Sector( 0, true ) ) ), K3b::Device::Track::XA_FORM2 );
+
+    QByteArray formless = mode2Sector( 0, false );
+    formless[22] = 0x01;
+    QCOMPARE( K3b::Device::sectorMode( bytes( formless ) ), K3b::Device::Track::MODE2 );
+
+    QByteArray noSync = mode1Sector( 0 );
+    noSync[5] = 0;
+    QCOMPARE( K3b::Device::sectorMode( bytes( noSync ) ), K3b::Device::Track::UNKNOWN );
+    QVERIFY( !K3b::Device::checkSector( bytes( noSync ) ) );
+}
+
+void EdcEccTest::testMode1()
+{
+    // reference values calculated with the byte-wise ECMA-130 algorithm
+    const QByteArray sector = mode1Sector( 0 );
+    QCOMPARE( readLE32( sector, 0x810 ), quint32( 0xD5CC582B ) );
+    QCOMPARE( quint8( sector[0x81C] ), quint8( 0xFC ) );
+    QCOMPARE( quint8( sector[0x8C8] ), quint8( 0x10 ) );
+    QCOMPARE( quint8( sector[2351] ), quint8( 0xD2 ) );
+
+    QVERIFY( K3b::Device::checkSectorEdc( bytes( sector ) ) );
+    QVERIFY( K3b::Device::checkSectorEcc( bytes( sector ) ) );
+    QVERIFY( K3b::Device::checkSector( bytes( sector ) ) );
+
+    // a corrupt parity byte is only found by the ECC check
+    QByteArray badParity = sector;
+    badParity[0x900] = badParity[0x900] ^ 0x01;
+    QVERIFY( K3b::Device::checkSectorEdc( bytes( badParity ) ) );
+    QVERIFY( !K3b::Device::checkSectorEcc( bytes( badParity ) ) );
+
+    // and can be repaired by recalculating it
+    QVERIFY( K3b::Device::generateSectorEdcEcc( reinterpret_cast<unsigned char*>( badParity.data() ) ) );
+    QCOMPARE( badParity, sector );
+}
+
+void EdcEccTest::testMode2Form1()
+{
+    const QByteArray sector = mode2Sector( 16, false );
+    QCOMPARE( readLE32( sector, 0x818 ), quint32( 0x8FA1E052 ) );
+    QCOMPARE( quint8( sector[0x81C] ), quint8( 0x71 ) );
+    QCOMPARE( quint8( sector[0x8C8] ), quint8( 0xE5 ) );
+    QVERIFY( K3b::Device::checkSector( bytes( sector ) ) );
+
+    // the parity of Mode 2 sectors does not cover the address
+    QByteArray moved = sector;
+    moved[14] = moved[14] ^ 0x01;
+    QVERIFY( K3b::Device::checkSector( bytes( moved ) ) );
+}
+
+void EdcEccTest::testMode2Form2()
+{
+    QByteArray sector = mode2Sector( 16, true );
+    QVERIFY( K3b::Device::checkSector( bytes( sector ) ) );
+
+    sector[100] = sector[100] ^ 0x80;
+    QVERIFY( !K3b::Device::checkSectorEdc( bytes( sector ) ) );
+
+    // an empty EDC is allowed in Form 2
+    for( int i = 0x92C; i < 0x930; ++i )
+        sector[i] = 0;
+    QVERIFY( K3b::Device::checkSector( bytes( sector ) ) );
+}
+
+void EdcEccTest::testCorruptSectors()
+{
+    // clone images store 96 bytes of subchannel data after each sector
+    const int stride = 2448;
+    QByteArray image;
+    for( int i = 0; i < 10; ++i ) {
+        image.append( mode1Sector( i ) );
+        image.append( QByteArray( stride - K3b::Device::RAW_SECTOR_SIZE, char( 0xAA ) ) );
+    }
+    QCOMPARE( K3b::Device::countCorruptSectors( bytes( image ), 10, stride ), 0 );
+
+    image[3*stride + 500] = image[3*stride + 500] ^ 0x10;
+    image[7*stride + 2100] = image[7*stride + 2100] ^ 0x01;
+    QCOMPARE( K3b::Device::countCorruptSectors( bytes( image ), 10, stride ), 2 );
+}
+
+void EdcEccTest::testScrambler()
+{
+    QByteArray sector( K3b::Device::RAW_SECTOR_SIZE, '\0' );
+    K3b::Device::scrambleSector( reinterpret_cast<unsigned char*>( sector.data() ) );
+
+    // the sync pattern is not scrambled
+    QCOMPARE( sector.left( 12 ), QByteArray( 12, '\0' ) );
+    QCOMPARE( sector.mid( 12, 8 ), QByteArray( "\x01\x80\x00\x60\x00\x28\x00\x1E", 8 ) );
+
+    const QByteArray original = mode1Sector( 5 );
+    QByteArray scrambled = original;
+    K3b::Device::scrambleSector( reinterpret_cast<unsigned char*>( scrambled.data() ) );
+    QVERIFY( scrambled != original );
+    K3b::Device::scrambleSector( reinterpret_cast<unsigned char*>( scrambled.data() ) );
+    QCOMPARE( scrambled, original );
+}
+
+void EdcEccTest::benchmarkEdc()
+{
+    const QByteArray data( 16*1024*1024, char( 0x5A ) );
+    quint32 edc = 0;
+    QBENCHMARK {
+        edc = K3b::Device::calcEdc( bytes( data ), data.size() );
+    }
+    Q_UNUSED( edc );
+}
+
+void EdcEccTest::benchmarkCheckSectors()
+{
+    const int count = 4096;
+    QByteArray image;
+    image.reserve( count * K3b::Device::RAW_SECTOR_SIZE );
+    for( int i = 0; i < count; ++i )
+        image.append( mode1Sector( i ) );
+
+    int corrupt = 0;
+    QBENCHMARK {
+        corrupt = K3b::Device::countCorruptSectors( bytes( image ), count );
+    }
+    QCOMPARE( corrupt, 0 );
+}
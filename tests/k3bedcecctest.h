@@ -0,0 +1,37 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_EDC_ECC_TEST_H
+#define K3B_EDC_ECC_TEST_H
+
+#include <QObject>
+
+class EdcEccTest : public QObject
+{
+    Q_OBJECT
+public:
+    EdcEccTest();
+private slots:
+    void testEdc();
+    void testSectorMode();
+    void testMode1();
+    void testMode2Form1();
+    void testMode2Form2();
+    void testCorruptSectors();
+    void testScrambler();
+    void benchmarkEdc();
+    void benchmarkCheckSectors();
+};
+
+#endif // K3B_EDC_ECC_TEST_H
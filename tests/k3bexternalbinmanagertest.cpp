@@ -10,6 +10,9 @@
  * See the file "COPYING" for the exact licensing terms.
  */
 
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTest>
 
 #include "k3bexternalbinmanagertest.h"
@@ -51,6 +54,16 @@ private:
     }
 };
 
+// a program whose features depend on other files
+class UncachedProgram : public K3b::SimpleExternalProgram
+{
+public:
+    UncachedProgram() : K3b::SimpleExternalProgram("k3btestprog") {}
+
+protected:
+    bool cacheScanResults() const override { return false; }
+};
+
 QTEST_GUILESS_MAIN(ExternalBinManagerTest)
 
 ExternalBinManagerTest::ExternalBinManagerTest()
@@ -85,4 +98,67 @@ void ExternalBinManagerTest::testMyBurnJob()
     dlg->startJob(job);
 }
 
+void ExternalBinManagerTest::testProbeCache()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString counterPath = dir.path() + "/counter";
+    const QString programPath = dir.path() + "/k3btestprog";
+
+    // every run of the program is recorded in the counter file
+    auto writeProgram = [&](const QString& version) {
+        QFile program(programPath);
+        QVERIFY(program.open(QIODevice::WriteOnly));
+        program.write("#!/bin/sh\n");
+        program.write(QString("echo run >> \"%1\"\n").arg(counterPath).toLocal8Bit());
+        program.write(QString("echo \"k3btestprog %1 (C) K3b\"\n").arg(version).toLocal8Bit());
+        program.close();
+        QVERIFY(program.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner));
+    };
+    auto runs = [&]() {
+        QFile counter(counterPath);
+        if (!counter.open(QIODevice::ReadOnly))
+            return 0;
+        return counter.readAll().count('\n');
+    };
+    auto search = [&](const QString& expectedVersion) {
+        K3b::ExternalBinManager binManager;
+        K3b::addDefaultPrograms(&binManager);
+        binManager.addProgram(new K3b::SimpleExternalProgram("k3btestprog"));
+        binManager.setSearchPath(QStringList() << dir.path());
+        binManager.startSearch();
+        const K3b::ExternalBin* bin = binManager.binObject("k3btestprog");
+        QVERIFY(bin);
+        QCOMPARE(bin->path(), programPath);
+        QCOMPARE(bin->version().toString(), expectedVersion);
+    };
+
+    writeProgram("1.2.3");
+    search("1.2.3");
+    const int firstRuns = runs();
+    QVERIFY(firstRuns > 0);
+
+    // the unchanged program is not executed again
+    search("1.2.3");
+    QCOMPARE(runs(), firstRuns);
+
+    // a changed program is probed again
+    writeProgram("1.2.10");
+    search("1.2.10");
+    QVERIFY(runs() > firstRuns);
+
+    // programs which opt out of the cache are always probed
+    const int cachedRuns = runs();
+    {
+        K3b::ExternalBinManager binManager;
+        binManager.addProgram(new UncachedProgram);
+        binManager.setSearchPath(QStringList() << dir.path());
+        binManager.startSearch();
+        QVERIFY(binManager.binObject("k3btestprog"));
+    }
+    QVERIFY(runs() > cachedRuns);
+}
+
 #include "k3bexternalbinmanagertest.moc"
@@ -27,6 +27,7 @@ public:
 private Q_SLOTS:
     void testBinObject();
     void testMyBurnJob();
+    void testProbeCache();
 
 private:
     K3b::Application::Core *m_core;
@@ -0,0 +1,98 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bfanoutpipetest.h"
+#include "k3bfanoutpipe.h"
+
+#include <QBuffer>
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( FanOutPipeTest )
+
+namespace {
+    class BrokenDevice : public QIODevice
+    {
+    protected:
+        qint64 readData( char*, qint64 ) override { return -1; }
+        qint64 writeData( const char*, qint64 ) override { return -1; }
+    };
+
+    QByteArray testData( int size )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for( int i = 0; i < size; ++i )
+            data[i] = char( i*7 + i/251 );
+        return data;
+    }
+}
+
+FanOutPipeTest::FanOutPipeTest()
+{
+}
+
+void FanOutPipeTest::testAllSinksGetAllData()
+{
+    const QByteArray data = testData( 1024*1024 + 13 );
+
+    QBuffer sink1, sink2, sink3;
+    K3b::FanOutPipe pipe;
+    // force the producer to wait for the sinks
+    pipe.setBufferSize( 64*1024 );
+    pipe.addSink( &sink1, true );
+    pipe.addSink( &sink2, true );
+    pipe.addSink( &sink3, true );
+    QVERIFY( pipe.open() );
+
+    QSignalSpy finishedSpy( &pipe, SIGNAL(finished()) );
+    for( int pos = 0; pos < data.size(); pos += 10000 )
+        QCOMPARE( pipe.write( data.constData() + pos, qMin( 10000, data.size() - pos ) ), qint64( qMin( 10000, data.size() - pos ) ) );
+    pipe.close();
+
+    QVERIFY( finishedSpy.wait( 10000 ) );
+    QCOMPARE( pipe.bytesWritten(), quint64( data.size() ) );
+    QCOMPARE( sink1.data(), data );
+    QCOMPARE( sink2.data(), data );
+    QCOMPARE( sink3.data(), data );
+    QVERIFY( !sink1.isOpen() );
+    QVERIFY( !pipe.isOpen() );
+}
+
+void FanOutPipeTest::testFailingSinkIsDropped()
+{
+    const QByteArray data = testData( 256*1024 );
+
+    QBuffer sink;
+    BrokenDevice broken;
+    broken.open( QIODevice::WriteOnly );
+
+    K3b::FanOutPipe pipe;
+    pipe.setBufferSize( 16*1024 );
+    pipe.addSink( &sink );
+    pipe.addSink( &broken );
+    QVERIFY( pipe.open() );
+
+    QSignalSpy errorSpy( &pipe, SIGNAL(sinkError(int)) );
+    QSignalSpy finishedSpy( &pipe, SIGNAL(finished()) );
+    for( int pos = 0; pos < data.size(); pos += 4096 )
+        QCOMPARE( pipe.write( data.constData() + pos, 4096 ), qint64( 4096 ) );
+    pipe.close();
+
+    QVERIFY( finishedSpy.wait( 10000 ) );
+    QCOMPARE( errorSpy.count(), 1 );
+    QCOMPARE( errorSpy.first().first().toInt(), 1 );
+    QVERIFY( pipe.sinkFailed( 1 ) );
+    QVERIFY( !pipe.sinkFailed( 0 ) );
+    QCOMPARE( sink.data(), data );
+}
@@ -0,0 +1,202 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bfilededuplicatortest.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bisooptions.h"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+QTEST_GUILESS_MAIN( FileDeduplicatorTest )
+
+namespace {
+    const int s_fileSize = 10*2048;
+
+    void writeFile( const QString& path, char c )
+    {
+        QFile f( path );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( QByteArray( s_fileSize, c ) ), qint64( s_fileSize ) );
+    }
+
+    void setDeduplicate( K3b::DataDoc& doc, bool b )
+    {
+        K3b::IsoOptions options = doc.isoOptions();
+        options.setDeduplicateFiles( b );
+        doc.setIsoOptions( options );
+    }
+}
+
+
+FileDeduplicatorTest::FileDeduplicatorTest()
+{
+}
+
+
+void FileDeduplicatorTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+
+    // a and b are identical, c has the same size but different contents
+    writeFile( m_dir.path() + "/a", 'x' );
+    writeFile( m_dir.path() + "/b", 'x' );
+    writeFile( m_dir.path() + "/c", 'y' );
+    QCOMPARE( ::link( QFile::encodeName( m_dir.path() + "/a" ).constData(),
+                      QFile::encodeName( m_dir.path() + "/a-link" ).constData() ), 0 );
+}
+
+
+void FileDeduplicatorTest::testDuplicates()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    setDeduplicate( doc, true );
+
+    QSignalSpy spy( &doc, SIGNAL(sizeChanged()) );
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/a", doc ) );
+    const KIO::filesize_t singleSize = doc.size();
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/c", doc ) );
+    const KIO::filesize_t size = doc.size();
+    QCOMPARE( size, singleSize + s_fileSize );
+
+    K3b::FileItem* b = new K3b::FileItem( m_dir.path() + "/b", doc );
+    doc.root()->addDataItem( b );
+    QTRY_VERIFY( !doc.isSearchingDuplicates() );
+    QVERIFY( spy.count() > 0 );
+
+    // b is written as a
+    QCOMPARE( doc.size(), size );
+    const QMap<K3b::FileItem::Id, QString> duplicates = doc.duplicateFiles();
+    QCOMPARE( duplicates.count(), 1 );
+    QCOMPARE( duplicates.value( b->localId() ), m_dir.path() + "/a" );
+}
+
+
+void FileDeduplicatorTest::testDisabled()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/a", doc ) );
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/b", doc ) );
+    QVERIFY( !doc.isSearchingDuplicates() );
+    QVERIFY( doc.duplicateFiles().isEmpty() );
+    const KIO::filesize_t size = doc.size();
+
+    // the files added before are checked once enabled
+    setDeduplicate( doc, true );
+    QTRY_VERIFY( !doc.isSearchingDuplicates() );
+    QCOMPARE( doc.duplicateFiles().count(), 1 );
+    QVERIFY( doc.size() < size );
+}
+
+
+void FileDeduplicatorTest::testRemove()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    setDeduplicate( doc, true );
+    K3b::FileItem* a = new K3b::FileItem( m_dir.path() + "/a", doc );
+    doc.root()->addDataItem( a );
+    const KIO::filesize_t singleSize = doc.size();
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/b", doc ) );
+    QTRY_VERIFY( !doc.isSearchingDuplicates() );
+    QCOMPARE( doc.size(), singleSize );
+
+    // b is the only file left
+    doc.removeItem( a );
+    QVERIFY( doc.duplicateFiles().isEmpty() );
+    QCOMPARE( doc.size(), singleSize );
+}
+
+
+void FileDeduplicatorTest::testRemoveSource()
+{
+    const QString path = m_dir.path() + "/e";
+    writeFile( path, 'x' );
+
+    K3b::DataDoc doc;
+    doc.newDocument();
+    setDeduplicate( doc, true );
+    K3b::FileItem* a = new K3b::FileItem( m_dir.path() + "/a", doc );
+    doc.root()->addDataItem( a );
+    const KIO::filesize_t singleSize = doc.size();
+    K3b::FileItem* b = new K3b::FileItem( m_dir.path() + "/b", doc );
+    doc.root()->addDataItem( b );
+    K3b::FileItem* e = new K3b::FileItem( path, doc );
+    doc.root()->addDataItem( e );
+    QTRY_VERIFY( !doc.isSearchingDuplicates() );
+    QCOMPARE( doc.size(), singleSize );
+    QCOMPARE( doc.duplicateFiles().count(), 2 );
+
+    // one of the remaining files is written instead of the other
+    doc.removeItem( a );
+    QTRY_VERIFY( !doc.isSearchingDuplicates() );
+    const QMap<K3b::FileItem::Id, QString> duplicates = doc.duplicateFiles();
+    QCOMPARE( duplicates.count(), 1 );
+    QVERIFY( duplicates.value( e->localId() ) == b->localPath() ||
+             duplicates.value( b->localId() ) == e->localPath() );
+    QCOMPARE( doc.size(), singleSize );
+}
+
+
+void FileDeduplicatorTest::testHardLinks()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    setDeduplicate( doc, true );
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/a", doc ) );
+    const KIO::filesize_t singleSize = doc.size();
+
+    // hard links are merged without hashing
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/a-link", doc ) );
+    QVERIFY( !doc.isSearchingDuplicates() );
+    QCOMPARE( doc.size(), singleSize );
+    QVERIFY( doc.duplicateFiles().isEmpty() );
+}
+
+
+void FileDeduplicatorTest::testChangedContents()
+{
+    const QString path = m_dir.path() + "/d";
+    writeFile( path, 'x' );
+
+    K3b::DataDoc doc;
+    doc.newDocument();
+    setDeduplicate( doc, true );
+    doc.root()->addDataItem( new K3b::FileItem( m_dir.path() + "/a", doc ) );
+    doc.root()->addDataItem( new K3b::FileItem( path, doc ) );
+    QTRY_VERIFY( !doc.isSearchingDuplicates() );
+    QCOMPARE( doc.duplicateFiles().count(), 1 );
+
+    // same inode, size and modification time but different contents
+    // (the change time only has a resolution of one second)
+    struct stat statBuf;
+    QCOMPARE( ::stat( QFile::encodeName( path ).constData(), &statBuf ), 0 );
+    QTest::qSleep( 1100 );
+    writeFile( path, 'z' );
+    struct utimbuf times;
+    times.actime = statBuf.st_atime;
+    times.modtime = statBuf.st_mtime;
+    QCOMPARE( ::utime( QFile::encodeName( path ).constData(), &times ), 0 );
+
+    QVERIFY( doc.duplicateFiles().isEmpty() );
+}
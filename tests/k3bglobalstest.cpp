@@ -36,3 +36,32 @@ void GlobalsTest::testRemoveFilenameExtension()
 }
 
 
+
+void GlobalsTest::testSwapByteOrder16_data()
+{
+    QTest::addColumn<int>( "length" );
+
+    QTest::newRow( "empty" ) << 0;
+    QTest::newRow( "odd" ) << 7;
+    QTest::newRow( "vector" ) << 32;
+    QTest::newRow( "vector with tail" ) << 2352 + 6;
+    QTest::newRow( "vector with odd tail" ) << 2352 + 5;
+}
+
+void GlobalsTest::testSwapByteOrder16()
+{
+    QFETCH( int, length );
+
+    QByteArray data( length, Qt::Uninitialized );
+    for( int i = 0; i < length; ++i )
+        data[i] = char( i * 7 );
+
+    QByteArray expected = data;
+    for( int i = 0; i + 1 < length; i += 2 ) {
+        expected[i] = data.at( i+1 );
+        expected[i+1] = data.at( i );
+    }
+
+    K3b::swapByteOrder16( data.data(), data.size() );
+    QCOMPARE( data, expected );
+}
@@ -25,6 +25,8 @@ public:
 private slots:
     void testCutFilename();
     void testRemoveFilenameExtension();
+    void testSwapByteOrder16_data();
+    void testSwapByteOrder16();
 };
 
 #endif // K3B_GLOBALS_TEST_H
@@ -0,0 +1,161 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bisosizeestimatortest.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bisooptions.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN( IsoSizeEstimatorTest )
+
+namespace {
+    // system area, primary volume descriptor, terminator, version descriptor,
+    // two path tables, the root folder, and the padding
+    const KIO::filesize_t s_emptyIsoSize = ( 16 + 4 + 2 + 1 + 150 ) * 2048ULL;
+
+    K3b::IsoOptions plainIsoOptions()
+    {
+        K3b::IsoOptions o;
+        o.setCreateRockRidge( false );
+        o.setCreateJoliet( false );
+        o.setCreateUdf( false );
+        return o;
+    }
+
+    QString folderName( int i, const QString& suffix = QString() )
+    {
+        return QString( "folder%1%2" ).arg( i ).arg( suffix );
+    }
+
+    void addFolders( K3b::DataDoc& doc, int count, const QString& suffix = QString() )
+    {
+        for( int i = 0; i < count; ++i )
+            doc.root()->addDataItem( new K3b::DirItem( folderName( i, suffix ) ) );
+    }
+}
+
+
+IsoSizeEstimatorTest::IsoSizeEstimatorTest()
+{
+}
+
+
+void IsoSizeEstimatorTest::testEmptyDoc()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    doc.setIsoOptions( plainIsoOptions() );
+
+    QCOMPARE( doc.size(), s_emptyIsoSize );
+}
+
+
+void IsoSizeEstimatorTest::testAddRemoveFolders()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    doc.setIsoOptions( plainIsoOptions() );
+
+    // 200 records do not fit into one block
+    addFolders( doc, 200 );
+    const KIO::filesize_t size = doc.size();
+    QVERIFY( size > s_emptyIsoSize + 200*2048ULL );
+
+    // every folder needs one block and one path table entry
+    K3b::DirItem* sub = new K3b::DirItem( "sub" );
+    doc.root()->addDataItem( sub );
+    QVERIFY( doc.size() >= size + 2048 );
+
+    // nested folders are accounted for, too
+    K3b::DirItem* nested = new K3b::DirItem( "nested" );
+    nested->addDataItem( new K3b::DirItem( "inner" ) );
+    sub->addDataItem( nested );
+    QVERIFY( doc.size() >= size + 3*2048 );
+
+    doc.removeItem( sub );
+    QCOMPARE( doc.size(), size );
+
+    while( !doc.root()->children().isEmpty() )
+        doc.removeItem( doc.root()->children().first() );
+    QCOMPARE( doc.size(), s_emptyIsoSize );
+}
+
+
+void IsoSizeEstimatorTest::testRename()
+{
+    K3b::IsoOptions options;
+    options.setCreateUdf( true );
+
+    K3b::DataDoc doc;
+    doc.newDocument();
+    doc.setIsoOptions( options );
+    addFolders( doc, 100 );
+    const KIO::filesize_t shortSize = doc.size();
+
+    const QString suffix( 60, 'x' );
+    for( int i = 0; i < 100; ++i )
+        doc.root()->children().at( i )->setK3bName( folderName( i, suffix ) );
+    QVERIFY( doc.size() > shortSize );
+
+    // the result is the same as for a project created with the long names
+    K3b::DataDoc other;
+    other.newDocument();
+    other.setIsoOptions( options );
+    addFolders( other, 100, suffix );
+    QCOMPARE( doc.size(), other.size() );
+}
+
+
+void IsoSizeEstimatorTest::testHide()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    doc.setIsoOptions( plainIsoOptions() );
+    K3b::DirItem* sub = new K3b::DirItem( "sub" );
+    doc.root()->addDataItem( sub );
+    sub->addDataItem( new K3b::DirItem( "inner" ) );
+    const KIO::filesize_t size = doc.size();
+
+    // hiding a folder hides its contents
+    sub->setHideOnRockRidge( true );
+    QCOMPARE( doc.size(), s_emptyIsoSize );
+
+    sub->setHideOnRockRidge( false );
+    QCOMPARE( doc.size(), size );
+}
+
+
+void IsoSizeEstimatorTest::testOptions()
+{
+    K3b::DataDoc doc;
+    doc.newDocument();
+    doc.setIsoOptions( plainIsoOptions() );
+    addFolders( doc, 10 );
+    const KIO::filesize_t plainSize = doc.size();
+
+    K3b::IsoOptions options = plainIsoOptions();
+    options.setCreateJoliet( true );
+    doc.setIsoOptions( options );
+    const KIO::filesize_t jolietSize = doc.size();
+    QVERIFY( jolietSize > plainSize );
+
+    options.setCreateRockRidge( true );
+    doc.setIsoOptions( options );
+    QVERIFY( doc.size() > jolietSize );
+
+    doc.setIsoOptions( plainIsoOptions() );
+    QCOMPARE( doc.size(), plainSize );
+}
@@ -0,0 +1,148 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bjobtelemetrytest.h"
+#include "k3bjobtelemetry.h"
+#include "k3bjob.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( JobTelemetryTest )
+
+namespace {
+    class DummyJob : public K3b::Job
+    {
+    public:
+        DummyJob() : K3b::Job( 0 ) {}
+        QString jobDescription() const override { return QLatin1String( "Dummy" ); }
+        void start() override {}
+        void cancel() override {}
+    };
+
+    class MemorySink : public K3b::TelemetrySink
+    {
+    public:
+        explicit MemorySink( QList<QJsonObject>* events ) : m_events( events ) {}
+        void writeEvent( const QByteArray& line ) override {
+            QVERIFY( line.endsWith( '\n' ) );
+            QCOMPARE( line.count( '\n' ), 1 );
+            m_events->append( QJsonDocument::fromJson( line ).object() );
+        }
+
+    private:
+        QList<QJsonObject>* m_events;
+    };
+}
+
+JobTelemetryTest::JobTelemetryTest()
+{
+}
+
+void JobTelemetryTest::testDisabled()
+{
+    K3b::JobTelemetry telemetry;
+    QVERIFY( !telemetry.isEnabled() );
+    QVERIFY( telemetry.setTarget( QString() ) );
+    QVERIFY( !telemetry.isEnabled() );
+
+    QList<QJsonObject> events;
+    telemetry.setSink( new MemorySink( &events ) );
+    QVERIFY( telemetry.isEnabled() );
+    telemetry.setSink( 0 );
+    QVERIFY( !telemetry.isEnabled() );
+
+    DummyJob job;
+    telemetry.record( &job, QLatin1String( "test" ) );
+    QVERIFY( events.isEmpty() );
+}
+
+void JobTelemetryTest::testJobEvents()
+{
+    QList<QJsonObject> events;
+    K3b::JobTelemetry telemetry;
+    telemetry.setSink( new MemorySink( &events ) );
+
+    DummyJob job;
+    telemetry.attach( &job );
+    QCOMPARE( events.count(), 1 );
+    QCOMPARE( events[0].value( "event" ).toString(), QString( "started" ) );
+    QCOMPARE( events[0].value( "description" ).toString(), QString( "Dummy" ) );
+    QVERIFY( events[0].contains( "time" ) );
+    const int id = events[0].value( "job" ).toInt();
+    QVERIFY( id > 0 );
+
+    emit job.percent( 10 );
+    QCOMPARE( events.count(), 2 );
+    QCOMPARE( events[1].value( "event" ).toString(), QString( "percent" ) );
+    QCOMPARE( events[1].value( "value" ).toInt(), 10 );
+    QCOMPARE( events[1].value( "job" ).toInt(), id );
+
+    // the processed size is throttled except for the final update
+    emit job.processedSize( 1, 100 );
+    emit job.processedSize( 2, 100 );
+    emit job.processedSize( 100, 100 );
+    QCOMPARE( events.count(), 4 );
+    QCOMPARE( events[2].value( "processed" ).toInt(), 1 );
+    QCOMPARE( events[3].value( "processed" ).toInt(), 100 );
+
+    emit job.infoMessage( QLatin1String( "oops" ), K3b::Job::MessageError );
+    QCOMPARE( events.count(), 5 );
+    QCOMPARE( events[4].value( "level" ).toString(), QString( "error" ) );
+
+    QVariantMap data;
+    data.insert( QLatin1String( "sector" ), 42 );
+    telemetry.record( &job, QLatin1String( "readRetry" ), data );
+    QCOMPARE( events.count(), 6 );
+    QCOMPARE( events[5].value( "event" ).toString(), QString( "readRetry" ) );
+    QCOMPARE( events[5].value( "sector" ).toInt(), 42 );
+
+    emit job.finished( true );
+    QCOMPARE( events.count(), 7 );
+    QCOMPARE( events[6].value( "event" ).toString(), QString( "finished" ) );
+    QCOMPARE( events[6].value( "success" ).toBool(), true );
+
+    // nothing is recorded once the job finished
+    emit job.percent( 20 );
+    QCOMPARE( events.count(), 7 );
+}
+
+void JobTelemetryTest::testFileSink()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString filename = dir.path() + QLatin1String( "/telemetry.jsonl" );
+
+    K3b::JobTelemetry telemetry;
+    QVERIFY( telemetry.setTarget( filename ) );
+    QVERIFY( telemetry.isEnabled() );
+
+    DummyJob job;
+    telemetry.attach( &job );
+    emit job.newTask( QLatin1String( "Writing" ) );
+    telemetry.setSink( 0 );
+
+    QFile f( filename );
+    QVERIFY( f.open( QIODevice::ReadOnly ) );
+    const QList<QByteArray> lines = f.readAll().split( '\n' );
+    QCOMPARE( lines.count(), 3 );
+    QVERIFY( lines.last().isEmpty() );
+    QCOMPARE( QJsonDocument::fromJson( lines[1] ).object().value( "event" ).toString(), QString( "task" ) );
+
+    QVERIFY( !telemetry.setTarget( dir.path() + QLatin1String( "/missing/telemetry.jsonl" ) ) );
+    QVERIFY( !telemetry.isEnabled() );
+}
@@ -0,0 +1,169 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bmediuminfocachetest.h"
+#include "k3bmediuminfocache.h"
+#include "k3bmedium.h"
+#include "k3btoc.h"
+#include "k3btrack.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( MediumInfoCacheTest )
+
+
+namespace {
+    const quint32 s_magic = 0x4B33424D; // "K3BM"
+    const quint16 s_version = 1;
+
+    K3b::Device::Toc audioToc( int tracks )
+    {
+        K3b::Device::Toc toc;
+        for( int i = 0; i < tracks; ++i )
+            toc.append( K3b::Device::Track( i*1000, i*1000 + 999, K3b::Device::Track::TYPE_AUDIO ) );
+        return toc;
+    }
+
+    QByteArray completeCd( const K3b::Device::Toc& toc )
+    {
+        return K3b::MediumInfoCache::fingerprint( K3b::Device::MEDIA_CD_ROM, K3b::Device::STATE_COMPLETE, false,
+                                                  1, 359849, QByteArray(), toc, QByteArray() );
+    }
+
+    // an entry as written by MediumInfoCache::store() in version 1
+    void writeEntry( const QString& fileName, const QString& volumeId )
+    {
+        QFile f( fileName );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QDataStream s( &f );
+        s << s_magic
+          << s_version
+          << (qint32)K3b::Medium::ContentData
+          << QByteArray()
+          << volumeId
+          << QString( "LINUX" )
+          << QString()
+          << QString()
+          << QString()
+          << QString( "K3B" )
+          << (qint32)1
+          << (qint32)1
+          << (qint64)2048
+          << (qint64)1000
+          << QString();
+        QCOMPARE( s.status(), QDataStream::Ok );
+    }
+
+    QString entryFileName( const K3b::MediumInfoCache& cache, const QByteArray& fingerprint )
+    {
+        return cache.path() + QLatin1Char( '/' ) + QString::fromLatin1( fingerprint.toHex() );
+    }
+}
+
+
+MediumInfoCacheTest::MediumInfoCacheTest()
+{
+}
+
+
+void MediumInfoCacheTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+}
+
+
+void MediumInfoCacheTest::testFingerprint()
+{
+    const K3b::Device::Toc toc = audioToc( 3 );
+    const QByteArray fingerprint = completeCd( toc );
+    QVERIFY( !fingerprint.isEmpty() );
+    QCOMPARE( completeCd( audioToc( 3 ) ), fingerprint );
+
+    // blank, appendable, and rewritable media may change and are not cached
+    QVERIFY( K3b::MediumInfoCache::fingerprint( K3b::Device::MEDIA_CD_R, K3b::Device::STATE_EMPTY, false,
+                                                0, 359849, QByteArray(), K3b::Device::Toc(), QByteArray() ).isEmpty() );
+    QVERIFY( K3b::MediumInfoCache::fingerprint( K3b::Device::MEDIA_CD_R, K3b::Device::STATE_INCOMPLETE, false,
+                                                1, 359849, QByteArray(), toc, QByteArray() ).isEmpty() );
+    QVERIFY( K3b::MediumInfoCache::fingerprint( K3b::Device::MEDIA_CD_RW, K3b::Device::STATE_COMPLETE, true,
+                                                1, 359849, QByteArray(), toc, QByteArray() ).isEmpty() );
+
+    // a different toc or volume descriptor is a different disc
+    QVERIFY( completeCd( audioToc( 4 ) ) != fingerprint );
+    K3b::Device::Toc otherToc = toc;
+    otherToc.last().setLastSector( otherToc.last().lastSector() + 1 );
+    QVERIFY( completeCd( otherToc ) != fingerprint );
+    QVERIFY( K3b::MediumInfoCache::fingerprint( K3b::Device::MEDIA_CD_ROM, K3b::Device::STATE_COMPLETE, false,
+                                                1, 359849, QByteArray(), toc, QByteArray( 2048, 'x' ) ) != fingerprint );
+}
+
+
+void MediumInfoCacheTest::testRoundTrip()
+{
+    K3b::MediumInfoCache cache( m_dir.path() + "/roundtrip" );
+    const QByteArray fingerprint = completeCd( audioToc( 2 ) );
+
+    K3b::Medium medium;
+    QVERIFY( !cache.load( fingerprint, medium ) );
+
+    QVERIFY( QDir().mkpath( cache.path() ) );
+    writeEntry( entryFileName( cache, fingerprint ), "VOLUME" );
+    QVERIFY( cache.load( fingerprint, medium ) );
+    QCOMPARE( medium.fingerprint(), fingerprint );
+    QCOMPARE( medium.content(), K3b::Medium::MediumContents( K3b::Medium::ContentData ) );
+    QCOMPARE( medium.iso9660Descriptor().volumeId, QString( "VOLUME" ) );
+    QCOMPARE( medium.iso9660Descriptor().volumeSpaceSize, 1000LL );
+
+    // storing the loaded medium writes the same entry
+    K3b::MediumInfoCache other( m_dir.path() + "/other" );
+    QVERIFY( other.store( medium ) );
+    QFile f1( entryFileName( cache, fingerprint ) );
+    QFile f2( entryFileName( other, fingerprint ) );
+    QVERIFY( f1.open( QIODevice::ReadOnly ) );
+    QVERIFY( f2.open( QIODevice::ReadOnly ) );
+    QCOMPARE( f2.readAll(), f1.readAll() );
+
+    K3b::Medium reloaded;
+    QVERIFY( other.load( fingerprint, reloaded ) );
+    QCOMPARE( reloaded.iso9660Descriptor().volumeId, QString( "VOLUME" ) );
+
+    other.remove( fingerprint );
+    QVERIFY( !other.load( fingerprint, reloaded ) );
+}
+
+
+void MediumInfoCacheTest::testCorruptEntry()
+{
+    K3b::MediumInfoCache cache( m_dir.path() + "/corrupt" );
+    QVERIFY( QDir().mkpath( cache.path() ) );
+    const QByteArray fingerprint = completeCd( audioToc( 5 ) );
+    const QString fileName = entryFileName( cache, fingerprint );
+    K3b::Medium medium;
+
+    // truncated
+    writeEntry( fileName, "VOLUME" );
+    QFile f( fileName );
+    QVERIFY( f.resize( f.size() - 10 ) );
+    QVERIFY( !cache.load( fingerprint, medium ) );
+
+    // wrong magic
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    QDataStream s( &f );
+    s << quint32( 0x12345678 ) << s_version;
+    f.close();
+    QVERIFY( !cache.load( fingerprint, medium ) );
+    QVERIFY( medium.fingerprint().isEmpty() );
+}
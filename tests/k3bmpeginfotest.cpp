@@ -0,0 +1,288 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bmpeginfotest.h"
+#include "k3bmpeginfo.h"
+
+#include <QFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( MpegInfoTest )
+
+
+namespace {
+
+    // simple deterministic random numbers for the video data
+    quint32 nextRandom( quint32& state )
+    {
+        state = state * 1103515245 + 12345;
+        return state >> 16;
+    }
+
+    void appendStartCode( QByteArray& data, uchar code )
+    {
+        data.append( char( 0x00 ) );
+        data.append( char( 0x00 ) );
+        data.append( char( 0x01 ) );
+        data.append( char( code ) );
+    }
+
+    void appendPackHeader( QByteArray& data, int version, quint64 scr, quint32 muxRate )
+    {
+        appendStartCode( data, 0xba );
+        if ( version == 1 ) {
+            data.append( char( 0x21 | ( ( scr >> 29 ) & 0x0e ) ) );
+            data.append( char( scr >> 22 ) );
+            data.append( char( ( ( scr >> 14 ) & 0xfe ) | 0x01 ) );
+            data.append( char( scr >> 7 ) );
+            data.append( char( ( ( scr << 1 ) & 0xfe ) | 0x01 ) );
+            data.append( char( 0x80 | ( ( muxRate >> 15 ) & 0x7f ) ) );
+            data.append( char( muxRate >> 7 ) );
+            data.append( char( ( ( muxRate << 1 ) & 0xfe ) | 0x01 ) );
+        }
+        else {
+            data.append( char( 0x44 | ( ( scr >> 27 ) & 0x38 ) | ( ( scr >> 28 ) & 0x03 ) ) );
+            data.append( char( scr >> 20 ) );
+            data.append( char( ( ( scr >> 12 ) & 0xf8 ) | 0x04 | ( ( scr >> 13 ) & 0x03 ) ) );
+            data.append( char( scr >> 5 ) );
+            data.append( char( ( ( scr << 3 ) & 0xf8 ) | 0x04 ) );
+            data.append( char( 0x01 ) );
+            data.append( char( muxRate >> 14 ) );
+            data.append( char( muxRate >> 6 ) );
+            data.append( char( ( ( muxRate << 2 ) & 0xfc ) | 0x03 ) );
+            data.append( char( 0xf8 ) );
+        }
+    }
+
+    void appendPacket( QByteArray& data, int version, uchar code, const QByteArray& payload )
+    {
+        QByteArray packet;
+        if ( version == 1 ) {
+            // no stuffing, no timestamps
+            packet.append( char( 0x0f ) );
+        }
+        else {
+            packet.append( char( 0x80 ) );
+            packet.append( char( 0x00 ) );
+            packet.append( char( 0x00 ) );
+        }
+        packet.append( payload.constData(), payload.size() );
+
+        appendStartCode( data, code );
+        data.append( char( packet.size() >> 8 ) );
+        data.append( char( packet.size() ) );
+        data.append( packet.constData(), packet.size() );
+    }
+
+    QByteArray videoPayload( int version )
+    {
+        QByteArray payload;
+        // sequence header: 352x288, 4:3, 25 fps, 1150 kbit/s
+        appendStartCode( payload, 0xb3 );
+        const char sequence[] = { 0x16, 0x01, 0x20, 0x23, 0x02, char( 0xce ), char( 0xe0 ), 0x00 };
+        payload.append( sequence, sizeof( sequence ) );
+        if ( version == 2 ) {
+            // sequence extension, progressive, 4:2:0
+            appendStartCode( payload, 0xb5 );
+            const char ext[] = { 0x14, char( 0x8a ), 0x00, 0x01, 0x00, 0x00 };
+            payload.append( ext, sizeof( ext ) );
+            // sequence display extension, PAL
+            appendStartCode( payload, 0xb5 );
+            const char display[] = { 0x22, 0x00, 0x00, 0x00 };
+            payload.append( display, sizeof( display ) );
+        }
+        appendStartCode( payload, 0xb8 );
+        const char gop[] = { 0x00, 0x08, 0x00, 0x00 };
+        payload.append( gop, sizeof( gop ) );
+        appendStartCode( payload, 0x00 );
+        const char picture[] = { 0x00, 0x0f, char( 0xff ), char( 0xf8 ) };
+        payload.append( picture, sizeof( picture ) );
+        return payload;
+    }
+
+    QByteArray audioPayload()
+    {
+        // MPEG-1 layer II, 224 kbit/s, 44.1 kHz, stereo, original
+        QByteArray payload;
+        const char header[] = { char( 0xff ), char( 0xfd ), char( 0xb0 ), 0x04 };
+        payload.append( header, sizeof( header ) );
+        for ( int i = 0; i < 64; ++i )
+            payload.append( char( 0x55 ) );
+        return payload;
+    }
+
+    QByteArray paddingPayload( quint32& state, int size )
+    {
+        // looks like coded video: slice start codes every few bytes
+        // and no zero bytes in between
+        QByteArray payload;
+        while ( payload.size() < size ) {
+            const quint32 r = nextRandom( state );
+            if ( r % 64 == 0 && payload.size() + 4 <= size )
+                appendStartCode( payload, 0x01 + ( r >> 6 ) % 0xaf );
+            else
+                payload.append( char( 1 + ( r >> 6 ) % 255 ) );
+        }
+        return payload;
+    }
+
+    // a program stream with a video packet in front, @p packs packs of
+    // padding and the first audio packet at the end
+    QByteArray createProgramStream( int version, int packs )
+    {
+        QByteArray data;
+        quint32 state = 42;
+        quint64 scr = 3600;
+        const quint32 muxRate = ( version == 1 ? 3528 : 10080 );
+
+        appendPackHeader( data, version, scr, muxRate );
+        appendPacket( data, version, 0xe0, videoPayload( version ) );
+
+        for ( int i = 0; i < packs; ++i ) {
+            scr += 1200;
+            appendPackHeader( data, version, scr, muxRate );
+            appendPacket( data, version, 0xbe, paddingPayload( state, 2000 ) );
+        }
+
+        scr += 1200;
+        appendPackHeader( data, version, scr, muxRate );
+        appendPacket( data, version, 0xc0, audioPayload() );
+        appendStartCode( data, 0xb9 );
+        return data;
+    }
+}
+
+
+MpegInfoTest::MpegInfoTest()
+{
+}
+
+
+void MpegInfoTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+}
+
+
+QString MpegInfoTest::writeStream( int version, int packs )
+{
+    const QString filename = QString( "%1/stream-%2-%3.mpg" ).arg( m_dir.path() ).arg( version ).arg( packs );
+    if ( !QFile::exists( filename ) ) {
+        QFile f( filename );
+        if ( !f.open( QIODevice::WriteOnly ) )
+            return QString();
+        f.write( createProgramStream( version, packs ) );
+    }
+    return filename;
+}
+
+
+void MpegInfoTest::testProgramStream_data()
+{
+    QTest::addColumn<int>( "version" );
+    QTest::addColumn<int>( "packs" );
+
+    QTest::newRow( "mpeg1, small" ) << 1 << 0;
+    QTest::newRow( "mpeg1" ) << 1 << 1000;
+    QTest::newRow( "mpeg2, small" ) << 2 << 0;
+    QTest::newRow( "mpeg2" ) << 2 << 1000;
+}
+
+
+void MpegInfoTest::testProgramStream()
+{
+    QFETCH( int, version );
+    QFETCH( int, packs );
+
+    const QString filename = writeStream( version, packs );
+    QVERIFY( !filename.isEmpty() );
+
+    // MpegInfo keeps the pointer to the name
+    const QByteArray encodedName = QFile::encodeName( filename );
+    K3b::MpegInfo info( encodedName.constData() );
+    const K3b::Mpeginfo* mpeg = info.mpeg_info;
+
+    QCOMPARE( info.version(), version );
+    QCOMPARE( mpeg->muxrate, version == 1 ? 1411200UL : 4032000UL );
+    QVERIFY( qAbs( mpeg->playing_time - ( packs + 1 ) * 1200 / 90000.0 ) < 0.0001 );
+    QVERIFY( mpeg->has_video );
+    QVERIFY( mpeg->has_audio );
+
+    QVERIFY( mpeg->video[ 0 ].seen );
+    QVERIFY( !mpeg->video[ 1 ].seen );
+    QVERIFY( !mpeg->video[ 2 ].seen );
+    QCOMPARE( mpeg->video[ 0 ].hsize, 352UL );
+    QCOMPARE( mpeg->video[ 0 ].vsize, 288UL );
+    QCOMPARE( mpeg->video[ 0 ].frate, 25.0 );
+    QCOMPARE( mpeg->video[ 0 ].bitrate, 1150000UL );
+    if ( version == 2 ) {
+        QVERIFY( mpeg->video[ 0 ].progressive );
+        QCOMPARE( int( mpeg->video[ 0 ].video_format ), 1 );
+        QCOMPARE( int( mpeg->video[ 0 ].chroma_format ), 1 );
+    }
+
+    QVERIFY( mpeg->audio[ 0 ].seen );
+    QVERIFY( !mpeg->audio[ 1 ].seen );
+    QVERIFY( !mpeg->audio[ 2 ].seen );
+    QCOMPARE( mpeg->audio[ 0 ].version, 1U );
+    QCOMPARE( mpeg->audio[ 0 ].layer, 2U );
+    QCOMPARE( mpeg->audio[ 0 ].protect, 0U );
+    QCOMPARE( mpeg->audio[ 0 ].bitrate, 229376UL );
+    QCOMPARE( mpeg->audio[ 0 ].sampfreq, 44100UL );
+    QCOMPARE( mpeg->audio[ 0 ].mode, int( K3b::MpegInfo::MPEG_STEREO ) );
+    QVERIFY( !mpeg->audio[ 0 ].copyright );
+    QVERIFY( mpeg->audio[ 0 ].original );
+}
+
+
+void MpegInfoTest::testInvalidStream()
+{
+    const QString filename = m_dir.path() + "/invalid.mpg";
+    QFile f( filename );
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    f.write( "RIFF0000WAVEfmt " );
+    f.close();
+
+    // MpegInfo keeps the pointer to the name
+    const QByteArray encodedName = QFile::encodeName( filename );
+    K3b::MpegInfo info( encodedName.constData() );
+    QCOMPARE( info.version(), int( K3b::MpegInfo::MPEG_VERS_INVALID ) );
+    QVERIFY( !info.error_string().isEmpty() );
+}
+
+
+void MpegInfoTest::benchmarkProgramStream_data()
+{
+    QTest::addColumn<int>( "version" );
+
+    QTest::newRow( "mpeg1" ) << 1;
+    QTest::newRow( "mpeg2" ) << 2;
+}
+
+
+void MpegInfoTest::benchmarkProgramStream()
+{
+    QFETCH( int, version );
+
+    // roughly 100 MB of video data in front of the first audio packet
+    const QString filename = writeStream( version, 50000 );
+    QVERIFY( !filename.isEmpty() );
+    const QByteArray encodedName = QFile::encodeName( filename );
+
+    QBENCHMARK {
+        K3b::MpegInfo info( encodedName.constData() );
+        QCOMPARE( info.version(), version );
+        QVERIFY( info.mpeg_info->has_audio );
+    }
+}
@@ -0,0 +1,176 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3breaderrormaptest.h"
+#include "k3breaderrormap.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( ReadErrorMapTest )
+
+using K3b::ReadErrorMap;
+
+ReadErrorMapTest::ReadErrorMapTest()
+{
+}
+
+void ReadErrorMapTest::testReset()
+{
+    ReadErrorMap map;
+    QVERIFY( map.isEmpty() );
+    QCOMPARE( map.sectors( ReadErrorMap::NonTried ), 0L );
+
+    map.reset( 100, 199 );
+    QVERIFY( !map.isEmpty() );
+    QCOMPARE( map.firstSector(), 100L );
+    QCOMPARE( map.lastSector(), 199L );
+    QCOMPARE( map.sectors( ReadErrorMap::NonTried ), 100L );
+    QCOMPARE( map.status( 100 ), ReadErrorMap::NonTried );
+    QCOMPARE( map.status( 199 ), ReadErrorMap::NonTried );
+}
+
+void ReadErrorMapTest::testSetStatus()
+{
+    ReadErrorMap map;
+    map.reset( 0, 99 );
+
+    map.setStatus( 10, 20, ReadErrorMap::Finished );
+    QCOMPARE( map.status( 9 ), ReadErrorMap::NonTried );
+    QCOMPARE( map.status( 10 ), ReadErrorMap::Finished );
+    QCOMPARE( map.status( 29 ), ReadErrorMap::Finished );
+    QCOMPARE( map.status( 30 ), ReadErrorMap::NonTried );
+
+    // overlapping the end of an existing region
+    map.setStatus( 25, 10, ReadErrorMap::BadSector );
+    QCOMPARE( map.status( 24 ), ReadErrorMap::Finished );
+    QCOMPARE( map.status( 25 ), ReadErrorMap::BadSector );
+    QCOMPARE( map.status( 34 ), ReadErrorMap::BadSector );
+    QCOMPARE( map.status( 35 ), ReadErrorMap::NonTried );
+
+    QCOMPARE( map.sectors( ReadErrorMap::Finished ), 15L );
+    QCOMPARE( map.sectors( ReadErrorMap::BadSector ), 10L );
+    QCOMPARE( map.sectors( ReadErrorMap::NonTried ), 75L );
+
+    // sectors outside the range are ignored
+    map.setStatus( 90, 50, ReadErrorMap::NonSplit );
+    QCOMPARE( map.sectors( ReadErrorMap::NonSplit ), 10L );
+    QCOMPARE( map.status( 99 ), ReadErrorMap::NonSplit );
+}
+
+void ReadErrorMapTest::testMerge()
+{
+    ReadErrorMap map;
+    map.reset( 0, 99 );
+
+    // split and merge single sectors
+    for( long i = 0; i < 100; i += 2 )
+        map.setStatus( i, 1, ReadErrorMap::Finished );
+    QCOMPARE( map.sectors( ReadErrorMap::Finished ), 50L );
+    for( long i = 1; i < 100; i += 2 )
+        map.setStatus( i, 1, ReadErrorMap::Finished );
+    QCOMPARE( map.sectors( ReadErrorMap::Finished ), 100L );
+
+    long start = -1, count = -1;
+    QVERIFY( map.nextRegion( ReadErrorMap::Finished, 0, &start, &count ) );
+    QCOMPARE( start, 0L );
+    QCOMPARE( count, 100L );
+}
+
+void ReadErrorMapTest::testNextRegion()
+{
+    ReadErrorMap map;
+    map.reset( 0, 99 );
+    map.setStatus( 0, 10, ReadErrorMap::Finished );
+    map.setStatus( 20, 5, ReadErrorMap::NonSplit );
+    map.setStatus( 50, 50, ReadErrorMap::Finished );
+
+    long start = -1, count = -1;
+    QVERIFY( map.nextRegion( ReadErrorMap::NonTried, 0, &start, &count ) );
+    QCOMPARE( start, 10L );
+    QCOMPARE( count, 10L );
+
+    // starting inside a region
+    QVERIFY( map.nextRegion( ReadErrorMap::NonTried, 15, &start, &count ) );
+    QCOMPARE( start, 15L );
+    QCOMPARE( count, 5L );
+
+    QVERIFY( map.nextRegion( ReadErrorMap::NonTried, 20, &start, &count ) );
+    QCOMPARE( start, 25L );
+    QCOMPARE( count, 25L );
+
+    QVERIFY( map.nextRegion( ReadErrorMap::Finished, 60, &start, &count ) );
+    QCOMPARE( start, 60L );
+    QCOMPARE( count, 40L );
+
+    QVERIFY( !map.nextRegion( ReadErrorMap::NonTried, 50, &start, &count ) );
+    QVERIFY( !map.nextRegion( ReadErrorMap::BadSector, 0, &start, &count ) );
+    QVERIFY( !map.nextRegion( ReadErrorMap::Finished, 100, &start, &count ) );
+}
+
+void ReadErrorMapTest::testSaveLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString filename = dir.path() + QLatin1String( "/track.map" );
+
+    ReadErrorMap map;
+    map.reset( 16, 1015 );
+    map.setStatus( 16, 500, ReadErrorMap::Finished );
+    map.setStatus( 516, 3, ReadErrorMap::BadSector );
+    map.setStatus( 600, 100, ReadErrorMap::NonSplit );
+    QVERIFY( map.save( filename ) );
+
+    ReadErrorMap loaded;
+    QVERIFY( loaded.load( filename ) );
+    QCOMPARE( loaded.firstSector(), 16L );
+    QCOMPARE( loaded.lastSector(), 1015L );
+    for( long i = 16; i <= 1015; ++i )
+        QCOMPARE( loaded.status( i ), map.status( i ) );
+    QCOMPARE( loaded.sectors( ReadErrorMap::NonTried ), map.sectors( ReadErrorMap::NonTried ) );
+
+    QVERIFY( !loaded.load( dir.path() + QLatin1String( "/missing.map" ) ) );
+    QCOMPARE( loaded.lastSector(), 1015L );
+}
+
+void ReadErrorMapTest::testLoadInvalid()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString filename = dir.path() + QLatin1String( "/track.map" );
+
+    ReadErrorMap map;
+    map.reset( 0, 9 );
+
+    // the regions do not cover the whole range
+    QFile f( filename );
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    f.write( "0 9\n0 5 +\n" );
+    f.close();
+    QVERIFY( !map.load( filename ) );
+
+    // unknown status
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    f.write( "0 9\n0 10 x\n" );
+    f.close();
+    QVERIFY( !map.load( filename ) );
+
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    f.write( "# comment\n0 9\n0 4 +\n4 6 -\n" );
+    f.close();
+    QVERIFY( map.load( filename ) );
+    QCOMPARE( map.sectors( ReadErrorMap::Finished ), 4L );
+    QCOMPARE( map.sectors( ReadErrorMap::BadSector ), 6L );
+}
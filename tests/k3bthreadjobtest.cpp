@@ -0,0 +1,174 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+#include "k3bthreadjobtest.h"
+#include "k3bthreadjob.h"
+#include "k3bthreadjobexecutor.h"
+
+#include <QAtomicInt>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN( ThreadJobTest )
+
+namespace {
+    const int s_updates = 1000000;
+
+    class ProgressJob : public K3b::ThreadJob
+    {
+    public:
+        explicit ProgressJob( bool report ) : K3b::ThreadJob( 0 ), m_report( report ) {}
+        QString jobDescription() const override { return QLatin1String( "Progress" ); }
+
+    protected:
+        bool run() override {
+            if( !m_report )
+                return true;
+            for( int i = 1; i <= s_updates; ++i ) {
+                setProgress( 100LL*i/s_updates );
+                setProcessedSize( i, s_updates );
+                setProcessedSubSize( i % 1000, 1000 );
+            }
+            return true;
+        }
+
+    private:
+        bool m_report;
+    };
+
+    class BlockingJob : public K3b::ThreadJob
+    {
+    public:
+        BlockingJob() : K3b::ThreadJob( 0 ), started( 0 ), release( 0 ) {}
+        QString jobDescription() const override { return QLatin1String( "Blocking" ); }
+
+        QAtomicInt started;
+        QAtomicInt release;
+
+    protected:
+        bool run() override {
+            started.store( 1 );
+            while( !release.load() && !canceled() )
+                QThread::msleep( 1 );
+            return true;
+        }
+    };
+}
+
+ThreadJobTest::ThreadJobTest()
+{
+}
+
+void ThreadJobTest::testProgressCoalescing()
+{
+    ProgressJob job( true );
+    QSignalSpy percentSpy( &job, SIGNAL(percent(int)) );
+    QSignalSpy sizeSpy( &job, SIGNAL(processedSize(int,int)) );
+    QSignalSpy subSizeSpy( &job, SIGNAL(processedSubSize(int,int)) );
+    QSignalSpy subPercentSpy( &job, SIGNAL(subPercent(int)) );
+    QSignalSpy finishedSpy( &job, SIGNAL(finished(bool)) );
+
+    QThread* const guiThread = QThread::currentThread();
+    bool emittedInGuiThread = true;
+    connect( &job, &K3b::Job::processedSize, [&]( int, int ) {
+        emittedInGuiThread = emittedInGuiThread && QThread::currentThread() == guiThread;
+    } );
+
+    job.start();
+    QVERIFY( finishedSpy.wait( 60000 ) );
+    QVERIFY( finishedSpy.first().first().toBool() );
+    QVERIFY( emittedInGuiThread );
+
+    // every update changes the processed size but only a fraction is published
+    QVERIFY( sizeSpy.count() >= 1 );
+    QVERIFY( sizeSpy.count() < s_updates / 100 );
+
+    // the final values are always published before finished()
+    QCOMPARE( percentSpy.last().first().toInt(), 100 );
+    QCOMPARE( sizeSpy.last().at( 0 ).toInt(), s_updates );
+    QCOMPARE( sizeSpy.last().at( 1 ).toInt(), s_updates );
+    QCOMPARE( subSizeSpy.last().at( 0 ).toInt(), 0 );
+    QCOMPARE( subSizeSpy.last().at( 1 ).toInt(), 1000 );
+
+    // values are only published when they change
+    for( int i = 1; i < percentSpy.count(); ++i )
+        QVERIFY( percentSpy.at( i ).first().toInt() != percentSpy.at( i-1 ).first().toInt() );
+
+    // nothing was reported for the sub task
+    QVERIFY( subPercentSpy.isEmpty() );
+}
+
+void ThreadJobTest::testNoProgress()
+{
+    ProgressJob job( false );
+    QSignalSpy percentSpy( &job, SIGNAL(percent(int)) );
+    QSignalSpy sizeSpy( &job, SIGNAL(processedSize(int,int)) );
+    QSignalSpy finishedSpy( &job, SIGNAL(finished(bool)) );
+
+    job.start();
+    QVERIFY( finishedSpy.wait( 60000 ) );
+    QVERIFY( percentSpy.isEmpty() );
+    QVERIFY( sizeSpy.isEmpty() );
+}
+
+void ThreadJobTest::testExecutorQueue()
+{
+    K3b::ThreadJobExecutor* executor = K3b::ThreadJobExecutor::instance();
+    const int maxWorkers = executor->maxWorkers();
+    executor->setMaxWorkers( 1 );
+
+    BlockingJob first;
+    BlockingJob second;
+    BlockingJob third;
+    QSignalSpy firstSpy( &first, SIGNAL(finished(bool)) );
+    QSignalSpy secondSpy( &second, SIGNAL(finished(bool)) );
+    QSignalSpy thirdSpy( &third, SIGNAL(finished(bool)) );
+
+    first.start();
+    QTRY_VERIFY( first.started.load() );
+
+    // only one CPU bound job may run, the others are queued
+    second.start();
+    third.start();
+    QVERIFY( second.active() );
+    K3b::ThreadJobExecutor::Statistics stats = executor->statistics();
+    QCOMPARE( stats.runningJobs, 1 );
+    QCOMPARE( stats.queuedJobs, 2 );
+    QVERIFY( stats.deviceQueues.isEmpty() );
+    QVERIFY( !second.wait( 50 ) );
+    QVERIFY( !second.started.load() );
+
+    // a queued job is finished without being run
+    second.cancel();
+    QVERIFY( second.wait( 0 ) );
+    QVERIFY( secondSpy.wait( 5000 ) );
+    QCOMPARE( secondSpy.first().first().toBool(), false );
+    QVERIFY( !second.started.load() );
+    QCOMPARE( executor->statistics().queuedJobs, 1 );
+
+    // the next job starts once the running one is done
+    first.release.store( 1 );
+    QVERIFY( firstSpy.wait( 5000 ) );
+    QCOMPARE( firstSpy.first().first().toBool(), true );
+    QTRY_VERIFY( third.started.load() );
+    third.release.store( 1 );
+    QVERIFY( thirdSpy.wait( 5000 ) );
+
+    QVERIFY( executor->waitForDone( 5000 ) );
+    stats = executor->statistics();
+    QCOMPARE( stats.runningJobs, 0 );
+    QCOMPARE( stats.queuedJobs, 0 );
+
+    executor->setMaxWorkers( maxWorkers );
+}
@@ -0,0 +1,87 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Contributors
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bthroughputestimatortest.h"
+#include "k3bthroughputestimator.h"
+#include "k3bdevicetypes.h"
+
+#include <QTest>
+#include <QThread>
+
+#include <cmath>
+
+QTEST_GUILESS_MAIN( ThroughputEstimatorTest )
+
+ThroughputEstimatorTest::ThroughputEstimatorTest()
+{
+}
+
+void ThroughputEstimatorTest::testSpeedProfile()
+{
+    K3b::ThroughputEstimator::SpeedProfile invalid;
+    QVERIFY( !invalid.isValid() );
+    QCOMPARE( invalid.radius( 100 ), 0.0 );
+
+    K3b::ThroughputEstimator::SpeedProfile profile( 20.0, 40.0, 1200 );
+    QVERIFY( profile.isValid() );
+    QCOMPARE( profile.radius( 0 ), 20.0 );
+    QCOMPARE( profile.radius( 1200 ), 40.0 );
+    QCOMPARE( profile.radius( 5000 ), 40.0 );
+
+    // constant density: the area grows linearly with the data
+    QCOMPARE( profile.radius( 400 ), std::sqrt( 800.0 ) );
+}
+
+void ThroughputEstimatorTest::testSpeedProfileForMediaType()
+{
+    QVERIFY( K3b::ThroughputEstimator::SpeedProfile::forMediaType( K3b::Device::MEDIA_CD_R, 700*1024 ).isValid() );
+    QVERIFY( K3b::ThroughputEstimator::SpeedProfile::forMediaType( K3b::Device::MEDIA_DVD_PLUS_R, 4489250 ).isValid() );
+    QVERIFY( !K3b::ThroughputEstimator::SpeedProfile::forMediaType( K3b::Device::MEDIA_NONE, 1000 ).isValid() );
+    QVERIFY( !K3b::ThroughputEstimator::SpeedProfile::forMediaType( K3b::Device::MEDIA_CD_R, 0 ).isValid() );
+}
+
+void ThroughputEstimatorTest::testRemainingTime()
+{
+    K3b::ThroughputEstimator est;
+    QCOMPARE( est.remainingTime(), -1 );
+    QVERIFY( est.speedCurve().isEmpty() );
+
+    est.setTotalSize( 100000 );
+    est.dataWritten( 0 );
+    QCOMPARE( est.remainingTime(), -1 );
+
+    // write with a constant throughput of roughly 1000 KB/s
+    for( int i = 1; i <= 3; ++i ) {
+        QThread::msleep( 600 );
+        est.dataWritten( 600*i );
+    }
+
+    QVERIFY( est.current() > 500 );
+    QVERIFY( est.current() < 1100 );
+
+    // without a speed profile the throughput is assumed to be constant
+    const int remaining = est.remainingTime();
+    const int expected = ( 100000 - 1800 ) / est.current();
+    QVERIFY( qAbs( remaining - expected ) <= 1 );
+
+    const QVector<QPointF> curve = est.speedCurve( 10 );
+    QCOMPARE( curve.count(), 10 );
+    QCOMPARE( curve.last().x(), 100000.0 );
+
+    QCOMPARE( est.history().count(), 4 );
+
+    est.reset();
+    QCOMPARE( est.remainingTime(), -1 );
+    QVERIFY( est.history().isEmpty() );
+}